@@ -19,7 +19,7 @@ do
     for maxLF in 0.5 1.0 1.5 2.25 2.5 3 4 5 6 10
     do
         # All index types for k = 1.
-        for iType in k1 k1comp k1comptriple;
+        for iType in k1 k1comp k1comptriple k1compext k1packed k1router;
         do
             ./split_index --index-type $iType --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 2 > $outFile
             python check_result.py 3
@@ -31,7 +31,19 @@ do
         done
 
         # k = 2
-        ./split_index --index-type k2 --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 3 > $outFile
+        for iType in k2 k2budgets k2comp k2spaced;
+        do
+            ./split_index --index-type $iType --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 3 > $outFile
+            python check_result.py 5
+
+            if [ $? -eq 1 ]
+            then
+                allTestsPassed=0
+            fi
+        done
+
+        # k = 2 with k + s splitting, a single key part is required for words of size 3.
+        ./split_index --index-type k2ks --key-parts 1 --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 3 > $outFile
         python check_result.py 5
 
         if [ $? -eq 1 ]
@@ -40,7 +52,19 @@ do
         fi
 
         # k = 3
-        ./split_index --index-type k3 --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 4 > $outFile
+        for iType in k3 k3budgets k3comp k3spaced;
+        do
+            ./split_index --index-type $iType --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 4 > $outFile
+            python check_result.py 2
+
+            if [ $? -eq 1 ]
+            then
+                allTestsPassed=0
+            fi
+        done
+
+        # k = 3 with k + s splitting, a single key part is required for words of size 4.
+        ./split_index --index-type k3ks --key-parts 1 --hash-type $hType --max-load-factor $maxLF -i dict_test.txt -I queries_test.txt --min-word-length 4 > $outFile
         python check_result.py 2
 
         if [ $? -eq 1 ]
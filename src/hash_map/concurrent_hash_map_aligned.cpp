@@ -0,0 +1,310 @@
+#include <boost/format.hpp>
+#include <cstring>
+#include <vector>
+
+#include "concurrent_hash_map_aligned.hpp"
+#include "../utils/size_coding.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+namespace hash_map
+{
+
+constexpr size_t ConcurrentHashMapAligned::defaultMaxNReaders;
+constexpr size_t ConcurrentHashMapAligned::defaultNLockStripes;
+constexpr size_t ConcurrentHashMapAligned::bucketRehashFactor;
+
+ConcurrentHashMapAligned::Table::Table(size_t nBucketsArg)
+    :nBuckets(nBucketsArg), buckets(new atomic<char *>[nBucketsArg])
+{
+    for (size_t i = 0; i < nBuckets; ++i)
+    {
+        buckets[i].store(nullptr);
+    }
+}
+
+ConcurrentHashMapAligned::ConcurrentHashMapAligned(const function<size_t(const char *)> &calcEntrySizeBArg,
+        float maxLoadFactorArg,
+        size_t nBucketsHint,
+        hash_functions::HashFunctions::HashType hashType,
+        size_t maxNReaders,
+        size_t nLockStripesArg)
+    :calcEntrySizeB(calcEntrySizeBArg),
+     maxLoadFactor(maxLoadFactorArg),
+     nEntries(0),
+     table(new Table(calcNBuckets(nBucketsHint, nLockStripesArg))),
+     nLockStripes(nLockStripesArg),
+     stripeMutexes(new mutex[nLockStripesArg]),
+     epochs(maxNReaders)
+{
+    assert(maxLoadFactor > 0.0f);
+    assert(nLockStripes > 0);
+
+    hash = hash_functions::HashFunctions::getHashFunction(hashType);
+}
+
+size_t ConcurrentHashMapAligned::calcNBuckets(size_t nBucketsHint, size_t nLockStripes)
+{
+    assert(nLockStripes > 0);
+    return max<size_t>(1, (nBucketsHint + nLockStripes - 1) / nLockStripes) * nLockStripes;
+}
+
+ConcurrentHashMapAligned::~ConcurrentHashMapAligned()
+{
+    Table *curTable = table.load();
+
+    for (size_t i = 0; i < curTable->nBuckets; ++i)
+    {
+        char *bucket = curTable->buckets[i].load();
+
+        if (bucket == nullptr)
+        {
+            continue;
+        }
+
+        for (const char *it = bucket; *it != 0; )
+        {
+            const size_t keyInBucketSize = utils::SizeCoding::read(it);
+
+            free(*reinterpret_cast<char * const *>(it + keyInBucketSize));
+            it += keyInBucketSize + sizeof(char *);
+        }
+
+        free(bucket);
+    }
+
+    delete curTable;
+}
+
+string ConcurrentHashMapAligned::toString() const
+{
+    const string formatStr = "Concurrent hash map: %1% entries, LF = %2% (max = %3%), #buckets = %4%, #lock stripes = %5%";
+    return (boost::format(formatStr) % getNEntries() % getCurLoadFactor() % maxLoadFactor % getNBuckets()
+        % nLockStripes).str();
+}
+
+const char *ConcurrentHashMapAligned::retrieve(const char *key, size_t keySize) const
+{
+    assert(keySize > 0);
+
+    // The table and the bucket are loaded once, later writes publish new copies instead of changing them.
+    const Table *curTable = table.load();
+    const char *bucket = curTable->buckets[hash(key, keySize) % curTable->nBuckets].load();
+
+    return findInBucket(bucket, key, keySize);
+}
+
+void ConcurrentHashMapAligned::insert(const char *key, size_t keySize, const char *entry)
+{
+    assert(entry != nullptr);
+    const size_t entrySize = calcEntrySizeB(entry);
+
+    update(key, keySize, [entry, entrySize](const char *)
+    {
+        char *newEntry = static_cast<char *>(malloc(entrySize * sizeof(char)));
+        memcpy(newEntry, entry, entrySize);
+
+        return newEntry;
+    });
+}
+
+long ConcurrentHashMapAligned::calcTotalSizeB() const
+{
+    const Table *curTable = table.load();
+    long ret = sizeof(Table) + curTable->nBuckets * sizeof(atomic<char *>);
+
+    for (size_t i = 0; i < curTable->nBuckets; ++i)
+    {
+        const char *bucket = curTable->buckets[i].load();
+
+        if (bucket == nullptr)
+        {
+            continue;
+        }
+
+        ret += calcBucketSizeB(bucket);
+
+        for (const char *it = bucket; *it != 0; )
+        {
+            const size_t keyInBucketSize = utils::SizeCoding::read(it);
+
+            ret += calcEntrySizeB(*reinterpret_cast<const char * const *>(it + keyInBucketSize));
+            it += keyInBucketSize + sizeof(char *);
+        }
+    }
+
+    return ret;
+}
+
+char *ConcurrentHashMapAligned::findInBucket(const char *bucket, const char *key, size_t keySize)
+{
+    if (bucket == nullptr)
+    {
+        return nullptr;
+    }
+
+    while (*bucket != 0)
+    {
+        const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
+
+        if (keySize == keyInBucketSize and memcmp(bucket, key, keySize) == 0)
+        {
+            return *reinterpret_cast<char * const *>(bucket + keyInBucketSize);
+        }
+
+        bucket += keyInBucketSize + sizeof(char *);
+    }
+
+    return nullptr;
+}
+
+char *ConcurrentHashMapAligned::copyBucket(const char *bucket, const char *key, size_t keySize, char *entry)
+{
+    const size_t oldSize = (bucket != nullptr) ? calcBucketSizeB(bucket) : 1;
+    const size_t pairSize = utils::SizeCoding::calcSizeB(keySize) + keySize + sizeof(char *);
+
+    // The new bucket is allocated for an added pair, which is slightly too much when replacing.
+    char *newBucket = static_cast<char *>(malloc((oldSize + pairSize) * sizeof(char)));
+    char *out = newBucket;
+    bool isReplaced = false;
+
+    for (const char *it = bucket; it != nullptr and *it != 0; )
+    {
+        const char *pairStart = it;
+        const size_t keyInBucketSize = utils::SizeCoding::read(it);
+        it += keyInBucketSize + sizeof(char *);
+
+        memcpy(out, pairStart, it - pairStart);
+        out += it - pairStart;
+
+        if (keySize == keyInBucketSize and memcmp(it - sizeof(char *) - keySize, key, keySize) == 0)
+        {
+            memcpy(out - sizeof(char *), &entry, sizeof(char *));
+            isReplaced = true;
+        }
+    }
+
+    if (not isReplaced)
+    {
+        out = utils::SizeCoding::write(out, keySize);
+        memcpy(out, key, keySize);
+        memcpy(out + keySize, &entry, sizeof(char *));
+
+        out += keySize + sizeof(char *);
+    }
+
+    *out = 0;
+    return newBucket;
+}
+
+size_t ConcurrentHashMapAligned::calcBucketSizeB(const char *bucket)
+{
+    const char *start = bucket;
+
+    while (*bucket != 0)
+    {
+        const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
+        bucket += keyInBucketSize + sizeof(char *);
+    }
+
+    return bucket - start + 1; // Includes the terminating 0.
+}
+
+char *ConcurrentHashMapAligned::storeLocked(const char *key, size_t keySize, size_t keyHash, char *newEntry)
+{
+    const Table *curTable = table.load();
+    atomic<char *> &slot = curTable->buckets[keyHash % curTable->nBuckets];
+
+    char *bucket = slot.load();
+    char *oldEntry = findInBucket(bucket, key, keySize);
+
+    slot.store(copyBucket(bucket, key, keySize, newEntry));
+
+    if (bucket != nullptr)
+    {
+        epochs.retire(bucket, free);
+    }
+
+    return oldEntry;
+}
+
+void ConcurrentHashMapAligned::rehashIfNeeded()
+{
+    if (getNEntries() <= maxLoadFactor * getNBuckets())
+    {
+        return;
+    }
+
+    vector<unique_lock<mutex>> locks;
+    locks.reserve(nLockStripes);
+
+    // Stripes are always locked in the same order, and writers lock at most a single stripe otherwise.
+    for (size_t iStripe = 0; iStripe < nLockStripes; ++iStripe)
+    {
+        locks.emplace_back(stripeMutexes[iStripe]);
+    }
+
+    Table *oldTable = table.load();
+    size_t nBuckets = oldTable->nBuckets;
+
+    // Another writer might have rehashed in the meantime.
+    while (getNEntries() > maxLoadFactor * nBuckets)
+    {
+        nBuckets *= bucketRehashFactor;
+    }
+
+    if (nBuckets == oldTable->nBuckets)
+    {
+        return;
+    }
+
+    Table *newTable = new Table(nBuckets);
+
+    for (size_t i = 0; i < oldTable->nBuckets; ++i)
+    {
+        char *bucket = oldTable->buckets[i].load();
+
+        if (bucket == nullptr)
+        {
+            continue;
+        }
+
+        for (const char *it = bucket; *it != 0; )
+        {
+            const size_t keyInBucketSize = utils::SizeCoding::read(it);
+            char *entry = *reinterpret_cast<char * const *>(it + keyInBucketSize);
+
+            // The new table is not published yet, so its buckets are replaced without retiring.
+            atomic<char *> &slot = newTable->buckets[hash(it, keyInBucketSize) % nBuckets];
+            char *newBucket = slot.load();
+
+            slot.store(copyBucket(newBucket, it, keyInBucketSize, entry));
+            free(newBucket);
+
+            it += keyInBucketSize + sizeof(char *);
+        }
+    }
+
+    table.store(newTable);
+
+    // The old table is retired together with all its buckets as a single pointer, as retiring each bucket
+    // separately would make the retire list grow with the number of buckets.
+    epochs.retire(oldTable, [](void *ptr)
+    {
+        Table *retiredTable = static_cast<Table *>(ptr);
+
+        for (size_t i = 0; i < retiredTable->nBuckets; ++i)
+        {
+            free(retiredTable->buckets[i].load());
+        }
+
+        delete retiredTable;
+    });
+}
+
+} // namespace hash_map
+
+} // namespace split_index
@@ -0,0 +1,165 @@
+#ifndef CONCURRENT_HASH_MAP_ALIGNED_HPP
+#define CONCURRENT_HASH_MAP_ALIGNED_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "../hash_function/hash_functions.hpp"
+#include "../utils/epoch_reclamation.hpp"
+
+namespace split_index
+{
+
+namespace hash_map
+{
+
+/** A concurrent version of HashMapAligned (with the same bucket layout) for inserting while searching.
+ * Many readers retrieve entries without locks, while writers lock a stripe of keys (by their hashes), so writers
+ * of different stripes run in parallel. Buckets and entries are never changed in place: a writer publishes
+ * a modified copy of a bucket (copy-on-write) and retires the old bucket and the old entry, which are freed
+ * once no reader can access them (see utils::EpochReclamation). The number of buckets is a multiple of the number
+ * of stripes, so that each bucket is only written by the writers of a single stripe. Rehashing locks all stripes
+ * and publishes a new bucket array, entries are moved to new buckets without being copied, and the old array
+ * is retired with its buckets at once.
+ * Readers register once and search inside read sections, entries are valid until the read section ends. */
+class ConcurrentHashMapAligned
+{
+public:
+    ConcurrentHashMapAligned(const std::function<size_t(const char *)> &calcEntrySizeBArg,
+        float maxLoadFactorArg,
+        size_t nBucketsHint,
+        hash_functions::HashFunctions::HashType hashType,
+        size_t maxNReaders = defaultMaxNReaders,
+        size_t nLockStripesArg = defaultNLockStripes);
+    /** No readers or writers can access the map anymore. */
+    ~ConcurrentHashMapAligned();
+
+    ConcurrentHashMapAligned(const ConcurrentHashMapAligned &) = delete;
+    ConcurrentHashMapAligned &operator=(const ConcurrentHashMapAligned &) = delete;
+
+    /** Returns the ID of a new reader, throws if all reader slots are taken. */
+    size_t registerReader() { return epochs.registerReader(); }
+    void unregisterReader(size_t iReader) { epochs.unregisterReader(iReader); }
+
+    /** Entries retrieved by a reader are valid during the lifetime of its read section. */
+    class ReadSection
+    {
+    public:
+        ReadSection(ConcurrentHashMapAligned &map, size_t iReader) :section(map.epochs, iReader) { }
+
+    private:
+        utils::EpochReclamation::ReadSection section;
+    };
+
+    /** Returns the entry from pair [key] (of size [keySize]) -> entry, or nullptr if there is no such pair.
+     * This must be called inside a read section (see ReadSection), it does not lock. */
+    const char *retrieve(const char *key, size_t keySize) const;
+
+    /** Inserts a pair [key] (of size [keySize]) -> copy of [entry], or replaces the entry of [key] with the copy. */
+    void insert(const char *key, size_t keySize, const char *entry);
+    /** Replaces the entry of [key] (of size [keySize]) with [createEntry](oldEntry), where oldEntry is nullptr
+     * if [key] is absent. The new entry must be malloc'd, it is owned by the map from now on, while oldEntry
+     * must not be changed. The key is locked until the new entry is published, so that updates of the same key
+     * are not lost (e.g. when appending to entries). */
+    template<typename CreateEntry>
+    void update(const char *key, size_t keySize, CreateEntry createEntry);
+
+    std::string toString() const;
+    /** Returns the total size in bytes, i.e. including both buckets and entries, this must not run with writers. */
+    long calcTotalSizeB() const;
+
+    size_t getNEntries() const { return nEntries.load(); }
+    size_t getNBuckets() const { return table.load()->nBuckets; }
+    float getCurLoadFactor() const { return static_cast<float>(getNEntries()) / getNBuckets(); }
+    float getMaxLoadFactor() const { return maxLoadFactor; }
+
+    /** The default maximum number of registered readers and the default number of lock stripes. */
+    static constexpr size_t defaultMaxNReaders = 64;
+    static constexpr size_t defaultNLockStripes = 64;
+
+private:
+    /** An array of buckets, which is replaced as a whole when rehashing. */
+    struct Table
+    {
+        explicit Table(size_t nBucketsArg);
+
+        const size_t nBuckets;
+        std::unique_ptr<std::atomic<char *>[]> buckets;
+    };
+
+    /** Returns [nBucketsHint] rounded up to a (positive) multiple of [nLockStripes]. */
+    static size_t calcNBuckets(size_t nBucketsHint, size_t nLockStripes);
+
+    /** Returns the entry of [key] in [bucket] (which may be nullptr), or nullptr if there is none. */
+    static char *findInBucket(const char *bucket, const char *key, size_t keySize);
+    /** Returns a copy of [bucket] (which may be nullptr) with [entry] stored for [key], replacing the old entry
+     * if present. */
+    static char *copyBucket(const char *bucket, const char *key, size_t keySize, char *entry);
+    /** Returns the size of [bucket] in bytes, including the terminating 0. */
+    static size_t calcBucketSizeB(const char *bucket);
+
+    /** Stores [newEntry] for [key] with [keyHash] and returns the replaced entry, the stripe of [key] must be locked. */
+    char *storeLocked(const char *key, size_t keySize, size_t keyHash, char *newEntry);
+    /** Publishes a larger bucket array if the load factor has been crossed, locking all stripes. */
+    void rehashIfNeeded();
+
+    std::mutex &getStripeMutex(size_t keyHash) { return stripeMutexes[keyHash % nLockStripes]; }
+
+    hash_functions::HashFunctions::HashFunctionType hash;
+    std::function<size_t(const char *)> calcEntrySizeB;
+
+    const float maxLoadFactor;
+    std::atomic<size_t> nEntries;
+
+    std::atomic<Table *> table;
+
+    const size_t nLockStripes;
+    std::unique_ptr<std::mutex[]> stripeMutexes;
+
+    /** Replaced buckets, entries and tables are retired here. */
+    utils::EpochReclamation epochs;
+
+    /** A factor used for increasing the number of available buckets when rehashing. */
+    static constexpr size_t bucketRehashFactor = 2;
+};
+
+template<typename CreateEntry>
+void ConcurrentHashMapAligned::update(const char *key, size_t keySize, CreateEntry createEntry)
+{
+    assert(key != nullptr and keySize > 0);
+    const size_t keyHash = hash(key, keySize);
+
+    char *oldEntry;
+
+    {
+        std::lock_guard<std::mutex> lock(getStripeMutex(keyHash));
+
+        const Table *curTable = table.load();
+        const char *bucket = curTable->buckets[keyHash % curTable->nBuckets].load();
+
+        char *newEntry = createEntry(static_cast<const char *>(findInBucket(bucket, key, keySize)));
+        assert(newEntry != nullptr);
+
+        oldEntry = storeLocked(key, keySize, keyHash, newEntry);
+    }
+
+    if (oldEntry != nullptr)
+    {
+        epochs.retire(oldEntry, free);
+        return;
+    }
+
+    nEntries.fetch_add(1);
+    rehashIfNeeded();
+}
+
+} // namespace hash_map
+
+} // namespace split_index
+
+#endif // CONCURRENT_HASH_MAP_ALIGNED_HPP
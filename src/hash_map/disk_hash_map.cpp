@@ -0,0 +1,688 @@
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "disk_hash_map.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+namespace hash_map
+{
+
+namespace
+{
+
+/** Pairs are stored in runs as records: the key hash (64 bits), the key size and the value size (32 bits each),
+ * followed by the key and the value. */
+constexpr size_t runRecordHeaderSizeB = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+template<typename T>
+T readValue(const char *it)
+{
+    T ret;
+    memcpy(&ret, it, sizeof(T));
+
+    return ret;
+}
+
+uint64_t getRecordHash(const char *record) { return readValue<uint64_t>(record); }
+uint32_t getRecordKeySize(const char *record) { return readValue<uint32_t>(record + sizeof(uint64_t)); }
+uint32_t getRecordValueSize(const char *record)
+{
+    return readValue<uint32_t>(record + sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+const char *getRecordKey(const char *record) { return record + runRecordHeaderSizeB; }
+const char *getRecordValue(const char *record) { return getRecordKey(record) + getRecordKeySize(record); }
+
+size_t calcRecordSizeB(const char *record)
+{
+    return runRecordHeaderSizeB + getRecordKeySize(record) + getRecordValueSize(record);
+}
+
+/** Returns a negative number, 0 or a positive number if [record1] goes before, together with or after [record2],
+ * records are ordered by segments, then by hashes, keys and values. */
+int compareRecords(const char *record1, const char *record2, size_t nSegments)
+{
+    const uint64_t hash1 = getRecordHash(record1);
+    const uint64_t hash2 = getRecordHash(record2);
+
+    if (hash1 != hash2)
+    {
+        const uint64_t segment1 = hash1 % nSegments;
+        const uint64_t segment2 = hash2 % nSegments;
+
+        if (segment1 != segment2)
+        {
+            return (segment1 < segment2) ? -1 : 1;
+        }
+
+        return (hash1 < hash2) ? -1 : 1;
+    }
+
+    // Sizes are compared first, so that comparing bytes never goes past the end.
+    const uint32_t keySize1 = getRecordKeySize(record1);
+    const uint32_t keySize2 = getRecordKeySize(record2);
+
+    if (keySize1 != keySize2)
+    {
+        return (keySize1 < keySize2) ? -1 : 1;
+    }
+
+    const int keyCmp = memcmp(getRecordKey(record1), getRecordKey(record2), keySize1);
+
+    if (keyCmp != 0)
+    {
+        return keyCmp;
+    }
+
+    const uint32_t valueSize1 = getRecordValueSize(record1);
+    const uint32_t valueSize2 = getRecordValueSize(record2);
+
+    if (valueSize1 != valueSize2)
+    {
+        return (valueSize1 < valueSize2) ? -1 : 1;
+    }
+
+    return memcmp(getRecordValue(record1), getRecordValue(record2), valueSize1);
+}
+
+/** Reads records of a run sequentially. */
+class RunReader
+{
+public:
+    explicit RunReader(const string &runPath)
+        :streamBuf(streamBufSizeB)
+    {
+        inStream.rdbuf()->pubsetbuf(streamBuf.data(), streamBuf.size());
+        inStream.open(runPath, ios_base::binary);
+
+        if (!inStream)
+        {
+            throw runtime_error("failed to read run file: " + runPath);
+        }
+
+        next();
+    }
+
+    RunReader(const RunReader &) = delete;
+    RunReader &operator=(const RunReader &) = delete;
+
+    bool isDone() const { return done; }
+    /** Returns the current record, which is valid until next() is called. */
+    const char *getRecord() const { return record.data(); }
+
+    void next()
+    {
+        record.resize(runRecordHeaderSizeB);
+
+        if (not inStream.read(record.data(), runRecordHeaderSizeB))
+        {
+            done = true;
+            return;
+        }
+
+        record.resize(calcRecordSizeB(record.data()));
+        inStream.read(record.data() + runRecordHeaderSizeB, record.size() - runRecordHeaderSizeB);
+
+        if (!inStream)
+        {
+            throw runtime_error("truncated run file");
+        }
+    }
+
+private:
+    static constexpr size_t streamBufSizeB = 1 << 20;
+
+    vector<char> streamBuf;
+    ifstream inStream;
+
+    vector<char> record;
+    bool done = false;
+};
+
+constexpr size_t RunReader::streamBufSizeB;
+
+}
+
+class DiskHashMap::SegmentWriter
+{
+public:
+    explicit SegmentWriter(const string &segmentPathArg)
+        :segmentPath(segmentPathArg), outStream(segmentPathArg, ios_base::binary | ios_base::trunc)
+    {
+        if (!outStream)
+        {
+            throw runtime_error("failed to write segment file: " + segmentPath);
+        }
+
+        // The header is written once the number of buckets is known.
+        const SegmentHeader emptyHeader { };
+        outStream.write(reinterpret_cast<const char *>(&emptyHeader), sizeof(SegmentHeader));
+    }
+
+    SegmentWriter(const SegmentWriter &) = delete;
+    SegmentWriter &operator=(const SegmentWriter &) = delete;
+
+    /** Keys must be added in the order of their hashes. */
+    void addKey(uint64_t keyHash, const string &key, const string &entry)
+    {
+        assert(keyHashes.empty() or keyHashes.back() <= keyHash);
+
+        if (key.size() > numeric_limits<uint32_t>::max() or entry.size() > numeric_limits<uint32_t>::max())
+        {
+            throw runtime_error("key or entry too large for a disk hash map");
+        }
+
+        keyHashes.push_back(keyHash);
+        keyOffsets.push_back(recordsSizeB);
+
+        const uint32_t sizes[] = { static_cast<uint32_t>(key.size()), static_cast<uint32_t>(entry.size()) };
+
+        outStream.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+        outStream.write(key.data(), key.size());
+        outStream.write(entry.data(), entry.size());
+
+        recordsSizeB += sizeof(sizes) + key.size() + entry.size();
+    }
+
+    /** Writes bucket offsets and the header, returns the number of keys. */
+    uint64_t finish()
+    {
+        uint64_t bucketBits = 0;
+
+        while ((1ull << bucketBits) * maxLoadFactor < keyHashes.size())
+        {
+            bucketBits += 1;
+        }
+
+        // Bucket i starts at the first key whose bucket is at least i, buckets are ordered as hashes.
+        size_t iKey = 0;
+
+        for (uint64_t iBucket = 0; iBucket <= (1ull << bucketBits); ++iBucket)
+        {
+            while (iKey < keyHashes.size() and getBucket(keyHashes[iKey], bucketBits) < iBucket)
+            {
+                iKey += 1;
+            }
+
+            const uint64_t offset = (iKey < keyHashes.size()) ? keyOffsets[iKey] : recordsSizeB;
+            outStream.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        }
+
+        const SegmentHeader header { segmentMagic, keyHashes.size(), bucketBits, sizeof(SegmentHeader) + recordsSizeB };
+
+        outStream.seekp(0);
+        outStream.write(reinterpret_cast<const char *>(&header), sizeof(SegmentHeader));
+        outStream.close();
+
+        if (!outStream)
+        {
+            throw runtime_error("failed to write segment file: " + segmentPath);
+        }
+
+        return keyHashes.size();
+    }
+
+private:
+    const string segmentPath;
+    ofstream outStream;
+
+    vector<uint64_t> keyHashes;
+    vector<uint64_t> keyOffsets;
+    uint64_t recordsSizeB = 0;
+};
+
+constexpr size_t DiskHashMap::defaultMaxRunSizeB;
+constexpr uint64_t DiskHashMap::segmentMagic;
+constexpr float DiskHashMap::maxLoadFactor;
+
+DiskHashMap::Builder::Builder(const string &dirPathArg, size_t nSegmentsArg,
+    hash_functions::HashFunctions::HashType hashTypeArg, size_t maxRunSizeBArg)
+    :dirPath(dirPathArg), nSegments(nSegmentsArg), hashType(hashTypeArg), maxRunSizeB(maxRunSizeBArg)
+{
+    if (nSegments == 0)
+    {
+        throw invalid_argument("the number of segments must be positive");
+    }
+
+    if (mkdir(dirPath.c_str(), 0755) != 0 and errno != EEXIST)
+    {
+        throw runtime_error("failed to create directory: " + dirPath);
+    }
+
+    hash = hash_functions::HashFunctions::getHashFunction(hashType);
+    DiskHashMap::remove(dirPath);
+}
+
+DiskHashMap::Builder::~Builder()
+{
+    if (not isFinished)
+    {
+        removeRuns();
+    }
+}
+
+void DiskHashMap::Builder::add(const char *key, size_t keySize, const char *value, size_t valueSize)
+{
+    assert(not isFinished);
+    assert(keySize > 0 and keySize <= numeric_limits<uint32_t>::max() and valueSize <= numeric_limits<uint32_t>::max());
+
+    const uint64_t keyHash = calcKeyHash(hash, key, keySize);
+    const uint32_t sizes[] = { static_cast<uint32_t>(keySize), static_cast<uint32_t>(valueSize) };
+
+    const size_t offset = runBuf.size();
+    runBuf.resize(offset + runRecordHeaderSizeB + keySize + valueSize);
+
+    char *it = runBuf.data() + offset;
+
+    memcpy(it, &keyHash, sizeof(keyHash));
+    memcpy(it + sizeof(keyHash), sizes, sizeof(sizes));
+    memcpy(it + runRecordHeaderSizeB, key, keySize);
+    memcpy(it + runRecordHeaderSizeB + keySize, value, valueSize);
+
+    runItems.push_back({ keyHash, offset });
+
+    if (runBuf.size() >= maxRunSizeB)
+    {
+        flushRun();
+    }
+}
+
+void DiskHashMap::Builder::finish()
+{
+    assert(not isFinished);
+
+    flushRun();
+    const uint64_t nKeys = mergeRuns();
+
+    removeRuns();
+    isFinished = true;
+
+    ofstream outStream(getDirectoryPath(dirPath), ios_base::trunc);
+    outStream << nSegments << " " << static_cast<int>(hashType) << " " << nKeys << endl;
+
+    if (!outStream)
+    {
+        throw runtime_error("failed to write directory file: " + getDirectoryPath(dirPath));
+    }
+}
+
+void DiskHashMap::Builder::flushRun()
+{
+    if (runItems.empty())
+    {
+        return;
+    }
+
+    const char *buf = runBuf.data();
+
+    // Hashes are compared first without touching the records, which decides most comparisons.
+    sort(runItems.begin(), runItems.end(), [this, buf](const RunItem &item1, const RunItem &item2)
+    {
+        if (item1.keyHash != item2.keyHash and item1.keyHash % nSegments == item2.keyHash % nSegments)
+        {
+            return item1.keyHash < item2.keyHash;
+        }
+
+        return compareRecords(buf + item1.offset, buf + item2.offset, nSegments) < 0;
+    });
+
+    const string runPath = dirPath + "/run_" + to_string(nRuns) + ".tmp";
+
+    runPaths.push_back(runPath);
+    nRuns += 1;
+
+    ofstream outStream(runPath, ios_base::binary | ios_base::trunc);
+
+    for (const RunItem &item : runItems)
+    {
+        outStream.write(buf + item.offset, calcRecordSizeB(buf + item.offset));
+    }
+
+    outStream.close();
+
+    if (!outStream)
+    {
+        throw runtime_error("failed to write run file: " + runPath);
+    }
+
+    runBuf.clear();
+    runItems.clear();
+}
+
+uint64_t DiskHashMap::Builder::mergeRuns()
+{
+    vector<unique_ptr<RunReader>> readers;
+
+    for (const string &runPath : runPaths)
+    {
+        readers.emplace_back(new RunReader(runPath));
+    }
+
+    auto isAfter = [this, &readers](size_t iReader1, size_t iReader2)
+    {
+        return compareRecords(readers[iReader1]->getRecord(), readers[iReader2]->getRecord(), nSegments) > 0;
+    };
+
+    priority_queue<size_t, vector<size_t>, decltype(isAfter)> heap(isAfter);
+
+    for (size_t iReader = 0; iReader < readers.size(); ++iReader)
+    {
+        if (not readers[iReader]->isDone())
+        {
+            heap.push(iReader);
+        }
+    }
+
+    uint64_t nKeys = 0;
+
+    // The current key with its entry, and the last value appended to the entry.
+    uint64_t curKeyHash = 0;
+    string curKey, curEntry, lastValue;
+
+    for (size_t iSegment = 0; iSegment < nSegments; ++iSegment)
+    {
+        SegmentWriter writer(getSegmentPath(dirPath, iSegment));
+        bool hasKey = false;
+
+        while (not heap.empty() and getRecordHash(readers[heap.top()]->getRecord()) % nSegments == iSegment)
+        {
+            const size_t iReader = heap.top();
+            heap.pop();
+
+            const char *record = readers[iReader]->getRecord();
+
+            const char *key = getRecordKey(record);
+            const size_t keySize = getRecordKeySize(record);
+            const char *value = getRecordValue(record);
+            const size_t valueSize = getRecordValueSize(record);
+
+            if (not hasKey or curKey.size() != keySize or memcmp(curKey.data(), key, keySize) != 0)
+            {
+                if (hasKey)
+                {
+                    writer.addKey(curKeyHash, curKey, curEntry);
+                }
+
+                curKeyHash = getRecordHash(record);
+                curKey.assign(key, keySize);
+                curEntry.assign(value, valueSize);
+                lastValue.assign(value, valueSize);
+
+                hasKey = true;
+            }
+            // Values of a key are sorted, so equal values are adjacent.
+            else if (lastValue.size() != valueSize or memcmp(lastValue.data(), value, valueSize) != 0)
+            {
+                curEntry.append(value, valueSize);
+                lastValue.assign(value, valueSize);
+            }
+
+            readers[iReader]->next();
+
+            if (not readers[iReader]->isDone())
+            {
+                heap.push(iReader);
+            }
+        }
+
+        if (hasKey)
+        {
+            writer.addKey(curKeyHash, curKey, curEntry);
+        }
+
+        nKeys += writer.finish();
+    }
+
+    return nKeys;
+}
+
+void DiskHashMap::Builder::removeRuns()
+{
+    for (const string &runPath : runPaths)
+    {
+        std::remove(runPath.c_str());
+    }
+
+    runPaths.clear();
+}
+
+DiskHashMap::DiskHashMap(const string &dirPathArg)
+    :dirPath(dirPathArg)
+{
+    ifstream inStream(getDirectoryPath(dirPath));
+
+    size_t nSegments = 0;
+    int hashType = 0;
+
+    if (not (inStream >> nSegments >> hashType >> nKeys) or nSegments == 0)
+    {
+        throw runtime_error("failed to read directory file: " + getDirectoryPath(dirPath));
+    }
+
+    using HashType = hash_functions::HashFunctions::HashType;
+    hash = hash_functions::HashFunctions::getHashFunction(static_cast<HashType>(hashType));
+    segments.resize(nSegments);
+
+    try
+    {
+        for (size_t iSegment = 0; iSegment < nSegments; ++iSegment)
+        {
+            mapSegment(iSegment);
+        }
+    }
+    catch (...)
+    {
+        unmapSegments();
+        throw;
+    }
+
+    advise(Advice::Random);
+}
+
+DiskHashMap::~DiskHashMap()
+{
+    unmapSegments();
+}
+
+void DiskHashMap::remove(const string &dirPath)
+{
+    ifstream inStream(getDirectoryPath(dirPath));
+    size_t nSegments = 0;
+
+    if (not (inStream >> nSegments))
+    {
+        return;
+    }
+
+    for (size_t iSegment = 0; iSegment < nSegments; ++iSegment)
+    {
+        std::remove(getSegmentPath(dirPath, iSegment).c_str());
+    }
+
+    std::remove(getDirectoryPath(dirPath).c_str());
+}
+
+DiskHashMap::Location DiskHashMap::locate(const char *key, size_t keySize) const
+{
+    const uint64_t keyHash = calcKeyHash(hash, key, keySize);
+    const size_t iSegment = keyHash % segments.size();
+
+    return { iSegment, getBucket(keyHash, segments[iSegment].bucketBits) };
+}
+
+const char *DiskHashMap::retrieve(const char *key, size_t keySize, const Location &location, size_t &entrySize) const
+{
+    const Segment &segment = segments[location.iSegment];
+
+    const char *bucketOffsets = segment.bucketOffsets + location.iBucket * sizeof(uint64_t);
+    const char *it = segment.records + readValue<uint64_t>(bucketOffsets);
+    const char *bucketEnd = segment.records + readValue<uint64_t>(bucketOffsets + sizeof(uint64_t));
+
+    while (it != bucketEnd)
+    {
+        const uint32_t keyInBucketSize = readValue<uint32_t>(it);
+        const uint32_t entryInBucketSize = readValue<uint32_t>(it + sizeof(uint32_t));
+
+        it += 2 * sizeof(uint32_t);
+
+        if (keyInBucketSize == keySize and memcmp(it, key, keySize) == 0)
+        {
+            entrySize = entryInBucketSize;
+            return it + keyInBucketSize;
+        }
+
+        it += keyInBucketSize + entryInBucketSize;
+    }
+
+    return nullptr;
+}
+
+void DiskHashMap::advise(size_t iSegment, Advice advice) const
+{
+    int flag = MADV_NORMAL;
+
+    switch (advice)
+    {
+        case Advice::Normal:
+            flag = MADV_NORMAL;
+            break;
+        case Advice::Random:
+            flag = MADV_RANDOM;
+            break;
+        case Advice::Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case Advice::WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        case Advice::DontNeed:
+            flag = MADV_DONTNEED;
+            break;
+    }
+
+    // Advice only affects paging, so failing to give it is not an error.
+    const Segment &segment = segments[iSegment];
+    madvise(const_cast<char *>(segment.data), segment.sizeB, flag);
+}
+
+void DiskHashMap::advise(Advice advice) const
+{
+    for (size_t iSegment = 0; iSegment < segments.size(); ++iSegment)
+    {
+        advise(iSegment, advice);
+    }
+}
+
+string DiskHashMap::toString() const
+{
+    return (boost::format("Disk hash map: %1% keys, #segments = %2%, size = %3% KB, directory = %4%")
+        % nKeys % segments.size() % (calcTotalSizeB() / 1024.0f) % dirPath).str();
+}
+
+uint64_t DiskHashMap::calcTotalSizeB() const
+{
+    uint64_t ret = 0;
+
+    for (const Segment &segment : segments)
+    {
+        ret += segment.sizeB;
+    }
+
+    return ret;
+}
+
+uint64_t DiskHashMap::calcKeyHash(hash_functions::HashFunctions::HashFunctionType hash, const char *key,
+    size_t keySize)
+{
+    // Some hash functions are 32-bit or weak in high bits, so hashes are mixed (the finalizer of MurmurHash3).
+    uint64_t keyHash = hash(key, keySize);
+
+    keyHash ^= keyHash >> 33;
+    keyHash *= 0xFF51AFD7ED558CCDull;
+    keyHash ^= keyHash >> 33;
+    keyHash *= 0xC4CEB9FE1A85EC53ull;
+    keyHash ^= keyHash >> 33;
+
+    return keyHash;
+}
+
+void DiskHashMap::mapSegment(size_t iSegment)
+{
+    const string segmentPath = getSegmentPath(dirPath, iSegment);
+    Segment &segment = segments[iSegment];
+
+    segment.fd = open(segmentPath.c_str(), O_RDONLY);
+    struct stat fileStat;
+
+    if (segment.fd < 0 or fstat(segment.fd, &fileStat) != 0)
+    {
+        throw runtime_error("failed to open segment file: " + segmentPath);
+    }
+
+    segment.sizeB = fileStat.st_size;
+
+    if (segment.sizeB < sizeof(SegmentHeader))
+    {
+        throw runtime_error("corrupted segment file: " + segmentPath);
+    }
+
+    void *data = mmap(nullptr, segment.sizeB, PROT_READ, MAP_SHARED, segment.fd, 0);
+
+    if (data == MAP_FAILED)
+    {
+        throw runtime_error("failed to map segment file: " + segmentPath);
+    }
+
+    segment.data = static_cast<const char *>(data);
+    const SegmentHeader header = readValue<SegmentHeader>(segment.data);
+
+    if (header.magic != segmentMagic or header.bucketBits >= 64
+        or header.bucketOffsetsOffset + ((1ull << header.bucketBits) + 1) * sizeof(uint64_t) != segment.sizeB)
+    {
+        throw runtime_error("corrupted segment file: " + segmentPath);
+    }
+
+    segment.bucketBits = header.bucketBits;
+    segment.records = segment.data + sizeof(SegmentHeader);
+    segment.bucketOffsets = segment.data + header.bucketOffsetsOffset;
+}
+
+void DiskHashMap::unmapSegments()
+{
+    for (Segment &segment : segments)
+    {
+        if (segment.data != nullptr)
+        {
+            munmap(const_cast<char *>(segment.data), segment.sizeB);
+        }
+
+        if (segment.fd >= 0)
+        {
+            close(segment.fd);
+        }
+
+        segment = Segment();
+    }
+}
+
+} // namespace hash_map
+
+} // namespace split_index
@@ -0,0 +1,195 @@
+#ifndef DISK_HASH_MAP_HPP
+#define DISK_HASH_MAP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../hash_function/hash_functions.hpp"
+
+namespace split_index
+{
+
+namespace hash_map
+{
+
+/** An immutable hash map stored on disk, for maps which do not fit in memory.
+ * Keys are partitioned by their hashes into segments, each of them is a file which is mapped into memory
+ * (read-only), so that only the pages which are accessed are loaded. The in-memory directory consists of
+ * the segments only, since each segment file stores its own bucket offsets.
+ * A segment file starts with a header (see SegmentHeader), which is followed by buckets and bucket offsets.
+ * Buckets store records in the order of key hashes: the key size and the entry size (32 bits each),
+ * followed by the key and the entry. Bucket i occupies [offsets[i], offsets[i + 1]) of the records. */
+class DiskHashMap
+{
+public:
+    /** Access advice for mapped segments (see madvise). */
+    enum class Advice { Normal, Random, Sequential, WillNeed, DontNeed };
+
+    /** Builds a map in a directory from pairs which are added in any order, using external sorting.
+     * Added pairs are buffered in runs of at most maxRunSizeB bytes, which are sorted and written
+     * to temporary files, and the runs are merged segment by segment. The entry of a key is the concatenation
+     * of its values (equal values are stored once). Memory is bounded by the run size, the largest entry,
+     * and 16 bytes per key of a single segment. */
+    class Builder
+    {
+    public:
+        /** Creates [dirPathArg] if it does not exist, and removes the map which has been built there before. */
+        Builder(const std::string &dirPathArg, size_t nSegmentsArg,
+            hash_functions::HashFunctions::HashType hashTypeArg, size_t maxRunSizeBArg = defaultMaxRunSizeB);
+        /** Removes temporary files if finish() has not been called. */
+        ~Builder();
+
+        Builder(const Builder &) = delete;
+        Builder &operator=(const Builder &) = delete;
+
+        /** Adds a pair [key] (of size [keySize]) -> [value] (of size [valueSize]). */
+        void add(const char *key, size_t keySize, const char *value, size_t valueSize);
+        /** Writes the segments and the directory file, and removes temporary files. Nothing can be added anymore. */
+        void finish();
+
+        /** Returns the number of runs written to temporary files so far. */
+        size_t getNRuns() const { return nRuns; }
+
+    private:
+        /** A pair in the run buffer, whose record starts at [offset] (the key hash is kept for sorting). */
+        struct RunItem
+        {
+            uint64_t keyHash;
+            size_t offset;
+        };
+
+        /** Sorts the buffered pairs and writes them to a temporary file. */
+        void flushRun();
+        /** Merges the runs writing the segments, returns the total number of keys. */
+        uint64_t mergeRuns();
+        void removeRuns();
+
+        const std::string dirPath;
+        const size_t nSegments;
+        const hash_functions::HashFunctions::HashType hashType;
+        const size_t maxRunSizeB;
+
+        hash_functions::HashFunctions::HashFunctionType hash;
+
+        std::vector<char> runBuf;
+        std::vector<RunItem> runItems;
+        std::vector<std::string> runPaths;
+        size_t nRuns = 0;
+
+        bool isFinished = false;
+    };
+
+    /** Opens the map which has been built in [dirPath] (see Builder), throws if it cannot be opened.
+     * Segments are advised for random access. */
+    explicit DiskHashMap(const std::string &dirPathArg);
+    ~DiskHashMap();
+
+    DiskHashMap(const DiskHashMap &) = delete;
+    DiskHashMap &operator=(const DiskHashMap &) = delete;
+
+    /** Removes the map which has been built in [dirPath], i.e. its segments and its directory file. */
+    static void remove(const std::string &dirPath);
+
+    /** The segment and the bucket of a key, looking keys up in the order of locations reads segments sequentially. */
+    struct Location
+    {
+        size_t iSegment;
+        uint64_t iBucket;
+
+        bool operator<(const Location &other) const
+        {
+            return iSegment < other.iSegment or (iSegment == other.iSegment and iBucket < other.iBucket);
+        }
+    };
+
+    Location locate(const char *key, size_t keySize) const;
+
+    /** Returns the entry of [key] (of size [keySize]) and stores its size in [entrySize], or returns nullptr
+     * if there is no such key. Entries are valid during the lifetime of the map. */
+    const char *retrieve(const char *key, size_t keySize, size_t &entrySize) const
+    {
+        return retrieve(key, keySize, locate(key, keySize), entrySize);
+    }
+    /** As above, for the [location] of [key] (see locate). */
+    const char *retrieve(const char *key, size_t keySize, const Location &location, size_t &entrySize) const;
+
+    /** Gives [advice] for segment [iSegment], e.g. to read it ahead or to release its pages. */
+    void advise(size_t iSegment, Advice advice) const;
+    /** Gives [advice] for all segments. */
+    void advise(Advice advice) const;
+
+    std::string toString() const;
+
+    size_t getNSegments() const { return segments.size(); }
+    uint64_t getNKeys() const { return nKeys; }
+    /** Returns the total size of segment files in bytes. */
+    uint64_t calcTotalSizeB() const;
+
+    /** The default size of runs, i.e. the memory used for sorting pairs during construction. */
+    static constexpr size_t defaultMaxRunSizeB = 64 << 20;
+
+private:
+    /** Stored at the beginning of each segment file. */
+    struct SegmentHeader
+    {
+        uint64_t magic;
+        uint64_t nKeys;
+        /** The number of buckets is 2^bucketBits. */
+        uint64_t bucketBits;
+        /** The offset of bucket offsets in the file, records start right after the header. */
+        uint64_t bucketOffsetsOffset;
+    };
+
+    /** A mapped segment file. */
+    struct Segment
+    {
+        int fd = -1;
+        const char *data = nullptr;
+        uint64_t sizeB = 0;
+
+        uint64_t bucketBits = 0;
+        const char *records = nullptr;
+        const char *bucketOffsets = nullptr;
+    };
+
+    /** Returns the mixed hash of [key], whose bits are used for both segments and buckets. */
+    static uint64_t calcKeyHash(hash_functions::HashFunctions::HashFunctionType hash, const char *key,
+        size_t keySize);
+    /** Returns the bucket of [keyHash] for 2^[bucketBits] buckets, buckets are ordered as hashes. */
+    static uint64_t getBucket(uint64_t keyHash, uint64_t bucketBits)
+    {
+        return (bucketBits == 0) ? 0 : keyHash >> (64 - bucketBits);
+    }
+
+    static std::string getDirectoryPath(const std::string &dirPath) { return dirPath + "/disk_hash_map.dir"; }
+    static std::string getSegmentPath(const std::string &dirPath, size_t iSegment)
+    {
+        return dirPath + "/segment_" + std::to_string(iSegment) + ".bin";
+    }
+
+    /** Writes a segment file during construction (see Builder). */
+    class SegmentWriter;
+
+    /** Maps segment [iSegment], throws if it cannot be mapped or it is corrupted. */
+    void mapSegment(size_t iSegment);
+    void unmapSegments();
+
+    const std::string dirPath;
+    hash_functions::HashFunctions::HashFunctionType hash;
+
+    std::vector<Segment> segments;
+    uint64_t nKeys = 0;
+
+    /** Identifies segment files. */
+    static constexpr uint64_t segmentMagic = 0x4745535849444E49ull;
+    /** Segments get at most this many keys per bucket on average (the number of buckets is a power of 2). */
+    static constexpr float maxLoadFactor = 2.0f;
+};
+
+} // namespace hash_map
+
+} // namespace split_index
+
+#endif // DISK_HASH_MAP_HPP
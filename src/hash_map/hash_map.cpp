@@ -15,7 +15,7 @@ namespace hash_map
 
 HashMap::HashMap(const std::function<size_t(const char *)> &calcEntrySizeBArg,
         float maxLoadFactorArg,
-        int nBucketsHint,
+        size_t nBucketsHint,
         hash_functions::HashFunctions::HashType hashType)
     :calcEntrySizeB(calcEntrySizeBArg),
      maxLoadFactor(maxLoadFactorArg),
@@ -29,7 +29,7 @@ HashMap::HashMap(const std::function<size_t(const char *)> &calcEntrySizeBArg,
     initBuckets();
 }
 
-void HashMap::clear(int nBucketsHint)
+void HashMap::clear(size_t nBucketsHint)
 {
     clearBuckets(buckets, nBuckets);
     curLoadFactor = 0.0f;
@@ -61,7 +61,7 @@ long HashMap::calcTotalSizeB() const
     long ret = sizeof(char **);
     ret += nBuckets * sizeof(char *);
 
-    for (int i = 0; i < nBuckets; ++i)
+    for (size_t i = 0; i < nBuckets; ++i)
     {
         if (buckets[i] != nullptr)
         {
@@ -76,20 +76,20 @@ void HashMap::initBuckets()
 {
     buckets = new char *[nBuckets];
 
-    for (int i = 0; i < nBuckets; ++i)
+    for (size_t i = 0; i < nBuckets; ++i)
     {
         buckets[i] = nullptr;
     }
 }
 
-void HashMap::clearBuckets(char **buckets, int nBuckets)
+void HashMap::clearBuckets(char **buckets, size_t nBuckets)
 {
     if (buckets == nullptr)
     {
         return;
     }
 
-    for (int i = 0; i < nBuckets; ++i)
+    for (size_t i = 0; i < nBuckets; ++i)
     {
         if (buckets[i] != nullptr)
         {
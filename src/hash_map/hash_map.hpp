@@ -17,14 +17,14 @@ class HashMap
 public:
     HashMap(const std::function<size_t(const char *)> &calcEntrySizeBArg,
         float maxLoadFactorArg,
-        int nBucketsHint,
+        size_t nBucketsHint,
         hash_functions::HashFunctions::HashType hashType);
     virtual ~HashMap() { }
 
     virtual std::string toString() const = 0;
 
     /** Clears the hash map, setting new bucket count to [nBucketsHint]. */
-    virtual void clear(int nBucketsHint);
+    virtual void clear(size_t nBucketsHint);
 
     /** Inserts a pair [key] (of size [keySize]) -> [entry].
      * Note: this does not overwrite existing entries (for performance reasons), rather, it adds duplicate entries. */
@@ -35,14 +35,14 @@ public:
     /** Returns the total size in bytes, i.e. including both buckets and entries. */
     virtual long calcTotalSizeB() const;
 
-    int getNBuckets() const { return nBuckets; }
+    size_t getNBuckets() const { return nBuckets; }
     float getCurLoadFactor() const { return curLoadFactor; }
     float getMaxLoadFactor() const { return maxLoadFactor; }
 
 protected:
     void initBuckets();
 
-    void clearBuckets(char **buckets, int nBuckets);
+    void clearBuckets(char **buckets, size_t nBuckets);
     virtual void clearBucket(char *bucket) = 0;
 
     virtual void insertEntry(const char *key, size_t keySize, char *entry) = 0;
@@ -58,14 +58,14 @@ protected:
     std::function<size_t(const char *)> calcEntrySizeB;
 
     /** Current load factor. */
-    float curLoadFactor;
+    float curLoadFactor = 0.0f;
     /** A maximum load factor which causes rehashing when crossed. */
     float maxLoadFactor;
 
-    /** Total number of entries (values). */
-    int nEntries = 0;
+    /** Total number of entries (values), 64-bit so that maps can hold billions of keys. */
+    size_t nEntries = 0;
     /** Total number of buckets (length of buckets array). */
-    int nBuckets = 0;
+    size_t nBuckets = 0;
 
     char **buckets = nullptr;
 
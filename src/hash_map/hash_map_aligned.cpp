@@ -7,6 +7,7 @@
 #include <new>
 
 #include "hash_map_aligned.hpp"
+#include "../utils/size_coding.hpp"
 
 using namespace split_index;
 using namespace std;
@@ -19,7 +20,7 @@ namespace hash_map
 
 HashMapAligned::HashMapAligned(const std::function<size_t(const char *)> &calcEntrySizeB,
         float maxLoadFactor,
-        int nBucketsHint,
+        size_t nBucketsHint,
         hash_functions::HashFunctions::HashType hashType)
     :HashMap(calcEntrySizeB,
         maxLoadFactor,
@@ -57,17 +58,17 @@ char **HashMapAligned::retrieve(const char *key, size_t keySize) const
 
     while (*bucket != 0)
     {
-        const size_t keyInBucketSize = *bucket;
+        const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
 
         if (keySize == keyInBucketSize)
         {
-            if (memcmp(bucket + 1, key, keySize) == 0)
+            if (memcmp(bucket, key, keySize) == 0)
             {
-                return reinterpret_cast<char **>(bucket + 1 + keyInBucketSize);
+                return reinterpret_cast<char **>(bucket + keyInBucketSize);
             }
         }
 
-        bucket += 1 + keyInBucketSize + sizeof(char *);
+        bucket += keyInBucketSize + sizeof(char *);
     }
 
     return nullptr;
@@ -80,27 +81,31 @@ void HashMapAligned::clearBucket(char *bucket)
 
     while (*it != 0)
     {
-        const size_t keyInBucketSize = *it;
+        const size_t keyInBucketSize = utils::SizeCoding::read(it);
 
-        free(*reinterpret_cast<void **>(it + 1 + keyInBucketSize));
-        it += 1 + keyInBucketSize + sizeof(char *);
+        free(*reinterpret_cast<void **>(it + keyInBucketSize));
+        it += keyInBucketSize + sizeof(char *);
     }
 
     free(bucket);
 }
 
 void HashMapAligned::insertEntry(const char *key, size_t keySize, char *entry)
+{
+    storeEntry(key, keySize, copyEntry(entry));
+}
+
+void HashMapAligned::storeEntry(const char *key, size_t keySize, char *entry)
 {
     const size_t index = hash(key, keySize) % nBuckets;
-    char *newEntry = copyEntry(entry);
 
     if (buckets[index] == nullptr)
     {
-        buckets[index] = createBucket(key, keySize, newEntry);
+        buckets[index] = createBucket(key, keySize, entry);
     }
     else
     {
-        addToBucket(buckets + index, key, keySize, newEntry);
+        addToBucket(buckets + index, key, keySize, entry);
     }
 }
 
@@ -109,7 +114,7 @@ void HashMapAligned::rehash()
     assert(curLoadFactor > maxLoadFactor);
 
     char **oldBuckets = buckets;
-    const int oldNBuckets = nBuckets;
+    const size_t oldNBuckets = nBuckets;
 
     while (curLoadFactor > maxLoadFactor)
     {
@@ -119,7 +124,9 @@ void HashMapAligned::rehash()
 
     initBuckets();
 
-    for (int i = 0; i < oldNBuckets; ++i)
+    // Entries are not copied but only moved to the new buckets, hence pointers to entries stay valid
+    // (e.g. those used as keys of sub-indexes when words are inserted after construction).
+    for (size_t i = 0; i < oldNBuckets; ++i)
     {
         if (oldBuckets[i] != nullptr)
         {
@@ -127,15 +134,17 @@ void HashMapAligned::rehash()
 
             while (*bucket != 0)
             {
-                const size_t keyInBucketSize = *bucket;
+                const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
 
-                insertEntry(bucket + 1, keyInBucketSize, *reinterpret_cast<char **>(bucket + 1 + keyInBucketSize));
-                bucket += 1 + keyInBucketSize + sizeof(char *);
+                storeEntry(bucket, keyInBucketSize, *reinterpret_cast<char **>(bucket + keyInBucketSize));
+                bucket += keyInBucketSize + sizeof(char *);
             }
+
+            free(oldBuckets[i]);
         }
     }
-    
-    clearBuckets(oldBuckets, oldNBuckets);
+
+    delete[] oldBuckets;
 }
 
 long HashMapAligned::calcBucketTotalSizeB(const char *bucket) const
@@ -145,10 +154,10 @@ long HashMapAligned::calcBucketTotalSizeB(const char *bucket) const
 
     while (*bucket != 0)
     {
-        const size_t keyInBucketSize = *bucket;
+        const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
 
-        ret += calcEntrySizeB(*reinterpret_cast<const char * const*>(bucket + 1 + keyInBucketSize));
-        bucket += 1 + keyInBucketSize + sizeof(char *);
+        ret += calcEntrySizeB(*reinterpret_cast<const char * const*>(bucket + keyInBucketSize));
+        bucket += keyInBucketSize + sizeof(char *);
     }
 
     ret += (bucket - start + 1); // Includes the terminating 0.
@@ -161,7 +170,8 @@ long HashMapAligned::calcBucketSizeB(const char *bucket) const
 
     while (*bucket != 0)
     {
-        bucket += 1 + *bucket + sizeof(char *);
+        const size_t keyInBucketSize = utils::SizeCoding::read(bucket);
+        bucket += keyInBucketSize + sizeof(char *);
     }
 
     return (bucket - start + 1); // Includes the terminating 0.
@@ -179,31 +189,33 @@ char *HashMapAligned::copyEntry(const char *entry) const
 
 char *HashMapAligned::createBucket(const char *key, size_t keySize, char *entry) const
 {
-    const size_t bucketSize = 1 + keySize + sizeof(char *) + 1;
+    const size_t keySizeB = utils::SizeCoding::calcSizeB(keySize);
+    const size_t bucketSize = keySizeB + keySize + sizeof(char *) + 1;
     char *bucket = static_cast<char *>(malloc(bucketSize * sizeof(char)));
 
-    *bucket = keySize;
-    memcpy(bucket + 1, key, keySize);
+    char *it = utils::SizeCoding::write(bucket, keySize);
+    memcpy(it, key, keySize);
 
-    *reinterpret_cast<char **>(bucket + 1 + keySize) = entry;
+    *reinterpret_cast<char **>(it + keySize) = entry;
     bucket[bucketSize - 1] = 0;
 
-    assert(bucketSize == 2 + keySize + sizeof(char *));
+    assert(bucketSize == 1 + keySizeB + keySize + sizeof(char *));
     return bucket;
 }
 
 void HashMapAligned::addToBucket(char **bucket, const char *key, size_t keySize, char *entry)
 {
     const size_t oldSize = calcBucketSizeB(*bucket);
-    const size_t newSize = oldSize + keySize + sizeof(char *) + 1; // This includes the terminating 0.
+    // We start overwriting with the terminating 0, hence the new terminating 0 is already included.
+    const size_t newSize = oldSize + utils::SizeCoding::calcSizeB(keySize) + keySize + sizeof(char *);
 
     *bucket = static_cast<char *>(realloc(*bucket, newSize * sizeof(char)));
     assert(newSize > oldSize and *bucket != nullptr);
-    
-    (*bucket)[oldSize - 1] = keySize;
-    memcpy(*bucket + oldSize, key, keySize);
 
-    *reinterpret_cast<char **>(*bucket + oldSize + keySize) = entry;
+    char *it = utils::SizeCoding::write(*bucket + oldSize - 1, keySize);
+    memcpy(it, key, keySize);
+
+    *reinterpret_cast<char **>(it + keySize) = entry;
     (*bucket)[newSize - 1] = 0;
 }
 
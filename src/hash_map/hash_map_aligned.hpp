@@ -17,13 +17,14 @@ namespace hash_map
 {
 
 /** This is an aligned version of a map.
- * It stores keys in a single bucket contiguously for better cache utilization. */
+ * It stores keys in a single bucket contiguously for better cache utilization.
+ * Each key is preceded by its size (see utils::SizeCoding) and followed by the entry pointer. */
 class HashMapAligned : public HashMap
 {
 public:
     HashMapAligned(const std::function<size_t(const char *)> &calcEntrySizeB,
         float maxLoadFactor,
-        int nBucketsHint,
+        size_t nBucketsHint,
         hash_functions::HashFunctions::HashType hashType);
     ~HashMapAligned() override;
 
@@ -35,6 +36,8 @@ protected:
     void clearBucket(char *bucket) override;
 
     void insertEntry(const char *key, size_t keySize, char *entry) override;
+    /** Stores the pair [key] -> [entry], where [entry] is owned by the map from now on. */
+    void storeEntry(const char *key, size_t keySize, char *entry);
     void rehash() override;
 
     /** Returns the size of bucket including stored entries in bytes. */
@@ -0,0 +1,226 @@
+#include <boost/format.hpp>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+
+#include "delta_split_index.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+constexpr float DeltaSplitIndex::defaultMergeThreshold;
+
+DeltaSplitIndex::DeltaSplitIndex(const unordered_set<string> &words, IndexBuilder builderArg)
+    :builder(move(builderArg))
+{
+    base = builder(words);
+
+    // The base index is immutable, hence erased words are never compacted away but only merged.
+    base->setCompactionThreshold(0.0f);
+}
+
+DeltaSplitIndex::~DeltaSplitIndex()
+{
+    if (isMerging())
+    {
+        delete mergeResult.get();
+    }
+
+    delete base;
+    delete delta;
+}
+
+bool DeltaSplitIndex::insert(const string &word)
+{
+    pollMerge();
+
+    if (not applyInsert(word))
+    {
+        return false;
+    }
+
+    handleUpdate(word, true);
+    return true;
+}
+
+bool DeltaSplitIndex::erase(const string &word)
+{
+    pollMerge();
+
+    if (not applyErase(word))
+    {
+        return false;
+    }
+
+    handleUpdate(word, false);
+    return true;
+}
+
+bool DeltaSplitIndex::contains(const string &word) const
+{
+    return base->contains(word) or (delta != nullptr and delta->contains(word));
+}
+
+bool DeltaSplitIndex::applyInsert(const string &word)
+{
+    // Erased base words are still stored in the base index, so they only lose their tombstones.
+    if (base->isErased(word))
+    {
+        return base->insert(word);
+    }
+
+    if (base->contains(word))
+    {
+        return false;
+    }
+
+    if (delta == nullptr)
+    {
+        delta = builder({ word });
+        return true;
+    }
+
+    return delta->insert(word);
+}
+
+bool DeltaSplitIndex::applyErase(const string &word)
+{
+    if (delta != nullptr and delta->erase(word))
+    {
+        return true;
+    }
+
+    return base->erase(word);
+}
+
+void DeltaSplitIndex::handleUpdate(const string &word, bool isInsert)
+{
+    if (isMerging())
+    {
+        mergeUpdates.emplace_back(word, isInsert);
+        return;
+    }
+
+    const size_t nChanged = getNDeltaWords() + getNErasedBaseWords();
+
+    if (mergeThreshold > 0.0f and nChanged > mergeThreshold * base->getWordSet().size())
+    {
+        startMerge();
+    }
+}
+
+DeltaSplitIndex::ResultSetType DeltaSplitIndex::search(const vector<string> &queries)
+{
+    ResultSetType ret;
+
+    for (const string &query : queries)
+    {
+        forEachMatch(query, [&ret](const char *word, size_t size) { ret.emplace(word, size); });
+    }
+
+    return ret;
+}
+
+bool DeltaSplitIndex::searchExists(const string &query)
+{
+    pollMerge();
+    return base->searchExists(query) or (delta != nullptr and delta->searchExists(query));
+}
+
+size_t DeltaSplitIndex::searchCount(const string &query)
+{
+    pollMerge();
+    return base->searchCount(query) + ((delta != nullptr) ? delta->searchCount(query) : 0);
+}
+
+void DeltaSplitIndex::startMerge()
+{
+    if (isMerging())
+    {
+        return;
+    }
+
+    unordered_set<string> words = base->getWordSet();
+
+    if (delta != nullptr)
+    {
+        words.insert(delta->getWordSet().begin(), delta->getWordSet().end());
+    }
+
+    // An empty index cannot be built, so the erased words stay in the base index.
+    if (words.empty())
+    {
+        return;
+    }
+
+    // The builder is copied, so that the background thread does not share any state with this object.
+    mergeUpdates.clear();
+    mergeResult = async(launch::async, [](IndexBuilder mergeBuilder, unordered_set<string> mergeWords)
+        {
+            return mergeBuilder(mergeWords);
+        }, builder, move(words));
+}
+
+bool DeltaSplitIndex::finishMerge(bool wait)
+{
+    if (not isMerging())
+    {
+        return false;
+    }
+
+    if (not wait and mergeResult.wait_for(chrono::seconds(0)) != future_status::ready)
+    {
+        return false;
+    }
+
+    SplitIndex *newBase = mergeResult.get();
+    newBase->setCompactionThreshold(0.0f);
+
+    delete base;
+    delete delta;
+
+    base = newBase;
+    delta = nullptr;
+    nMerges += 1;
+
+    // The new base index holds the words which were present when the merge started.
+    vector<pair<string, bool>> updates;
+    updates.swap(mergeUpdates);
+
+    for (const pair<string, bool> &update : updates)
+    {
+        if (update.second)
+        {
+            applyInsert(update.first);
+        }
+        else
+        {
+            applyErase(update.first);
+        }
+    }
+
+    return true;
+}
+
+void DeltaSplitIndex::merge()
+{
+    // A running merge does not include the latest updates, so it is finished before a new one is started.
+    finishMerge(true);
+
+    startMerge();
+    finishMerge(true);
+}
+
+string DeltaSplitIndex::toString() const
+{
+    string ret = "Base index:\n" + base->toString();
+
+    ret += (boost::format("\nDelta: #words = %1%, #erased base words = %2%, #merges = %3%%4%")
+        % getNDeltaWords() % getNErasedBaseWords() % nMerges % (isMerging() ? " (merging)" : "")).str();
+
+    return ret;
+}
+
+} // namespace split_index
@@ -0,0 +1,141 @@
+#ifndef DELTA_SPLIT_INDEX_HPP
+#define DELTA_SPLIT_INDEX_HPP
+
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "split_index.hpp"
+
+namespace split_index
+{
+
+/** A dictionary for high update rates which keeps the query performance of split indexes built for its bulk.
+ * Words are stored in an immutable base index and in a small mutable delta index, both are built by the same builder
+ * (e.g. a SplitIndexFactory call). Erased base words only get tombstones, which form the deletion set, the entries
+ * of the base index are never changed. Inserted words are stored in the delta index (see SplitIndex::insert).
+ * Queries consult both indexes and merge their results, each word is present in at most one of them.
+ * Once the delta index and the deletion set grow above a fraction of the base index, a merge builds a new base index
+ * from all present words in a background thread. When the build has finished, the new base index is swapped in
+ * by the next update or query, and updates made in the meantime are applied to it again.
+ * The class is not thread-safe, i.e. all calls must come from a single thread, only merges run concurrently. */
+class DeltaSplitIndex
+{
+public:
+    /** Builds and constructs a split index for a nonempty set of words. */
+    using IndexBuilder = std::function<SplitIndex *(const std::unordered_set<std::string> &)>;
+    using ResultSetType = SplitIndex::ResultSetType;
+
+    /** Builds the base index for [words] using [builderArg], which is also used for delta indexes and merges. */
+    DeltaSplitIndex(const std::unordered_set<std::string> &words, IndexBuilder builderArg);
+    ~DeltaSplitIndex();
+
+    DeltaSplitIndex(const DeltaSplitIndex &) = delete;
+    DeltaSplitIndex &operator=(const DeltaSplitIndex &) = delete;
+
+    /** Inserts [word], returns false if it is already present. Erased base words only lose their tombstones,
+     * other words are stored in the delta index. */
+    bool insert(const std::string &word);
+    /** Erases [word], returns false if it is not present. */
+    bool erase(const std::string &word);
+    bool contains(const std::string &word) const;
+
+    /** Calls [callback](word, size) for each dictionary word matching [query] (each once),
+     * the chars of the word are owned by the index and they are not 0-terminated. */
+    template<typename Callback>
+    void forEachMatch(const std::string &query, Callback callback);
+    /** Returns the set of words matching any of [queries]. */
+    ResultSetType search(const std::vector<std::string> &queries);
+    /** Returns true if any dictionary word matches [query]. */
+    bool searchExists(const std::string &query);
+    /** Returns the number of dictionary words matching [query]. */
+    size_t searchCount(const std::string &query);
+
+    /** Starts building a new base index from all present words in a background thread, unless a merge is running. */
+    void startMerge();
+    /** Swaps in the base index built by the running merge if it has finished, or after waiting for it if [wait]
+     * is true, and applies the updates which have been made since the merge started. Returns true if swapped. */
+    bool finishMerge(bool wait = false);
+    /** Folds the delta index and the deletion set into a new base index, waiting for the merge. */
+    void merge();
+    bool isMerging() const { return mergeResult.valid(); }
+
+    /** Sets the ratio of delta and erased words to base words above which a merge is started, 0 disables merges. */
+    void setMergeThreshold(float mergeThresholdArg) { mergeThreshold = mergeThresholdArg; }
+    /** The default ratio of delta and erased words to base words above which a merge is started. */
+    static constexpr float defaultMergeThreshold = 0.1f;
+
+    /** Returns the number of present words. */
+    size_t getNWords() const { return base->getWordSet().size() + getNDeltaWords(); }
+    size_t getNDeltaWords() const { return (delta != nullptr) ? delta->getWordSet().size() : 0; }
+    /** Returns the number of erased words which are still stored in the base index. */
+    size_t getNErasedBaseWords() const { return base->getNErasedWords(); }
+    /** Returns the number of merges which have been swapped in. */
+    size_t getNMerges() const { return nMerges; }
+
+    const SplitIndex &getBase() const { return *base; }
+    /** Returns the delta index or nullptr if no word has been stored in it yet. */
+    const SplitIndex *getDelta() const { return delta; }
+
+    std::string toString() const;
+
+private:
+    bool applyInsert(const std::string &word);
+    bool applyErase(const std::string &word);
+
+    /** Records an update made while merging, and starts a merge if the delta has grown above the threshold. */
+    void handleUpdate(const std::string &word, bool isInsert);
+
+    /** Swaps in the merged base index if it is ready, this is checked before each update and query. */
+    void pollMerge()
+    {
+        if (isMerging())
+        {
+            finishMerge();
+        }
+    }
+
+    IndexBuilder builder;
+
+    SplitIndex *base = nullptr;
+    SplitIndex *delta = nullptr;
+
+    float mergeThreshold = defaultMergeThreshold;
+    size_t nMerges = 0;
+
+    /** The base index being built by the running merge (invalid if none is running), and the updates
+     * (word, true if inserted) made since its word set has been taken. */
+    std::future<SplitIndex *> mergeResult;
+    std::vector<std::pair<std::string, bool>> mergeUpdates;
+
+    /** IDs of words matching the current query, reused across queries. */
+    std::vector<SplitIndex::WordId> queryWordIds;
+};
+
+template<typename Callback>
+void DeltaSplitIndex::forEachMatch(const std::string &query, Callback callback)
+{
+    pollMerge();
+
+    for (SplitIndex *index : { base, delta })
+    {
+        if (index == nullptr)
+        {
+            continue;
+        }
+
+        index->searchWordIds(query, queryWordIds);
+
+        for (SplitIndex::WordId id : queryWordIds)
+        {
+            callback(index->getWordChars(id), index->getWordSize(id));
+        }
+    }
+}
+
+} // namespace split_index
+
+#endif // DELTA_SPLIT_INDEX_HPP
@@ -0,0 +1,207 @@
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "disk_split_index.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+DiskSplitIndex::Builder::Builder(const string &dirPathArg, size_t kArg, size_t nSegments,
+    hash_functions::HashFunctions::HashType hashType, size_t maxRunSizeB)
+    :dirPath(dirPathArg), k(kArg), mapBuilder(dirPathArg, nSegments, hashType, maxRunSizeB)
+{
+    if (k == 0 or k >= 255)
+    {
+        throw invalid_argument("bad number of mismatches for a disk split index: " + to_string(k));
+    }
+}
+
+void DiskSplitIndex::Builder::add(const string &word)
+{
+    const size_t nParts = k + 1;
+
+    if (word.size() < nParts or word.size() > utils::SizeCoding::maxWordSize)
+    {
+        throw runtime_error("bad word size for a disk split index: " + word);
+    }
+
+    for (size_t iPart = 0; iPart < nParts; ++iPart)
+    {
+        const size_t partStart = getPartStart(word.size(), nParts, iPart);
+        const size_t partSize = getPartSize(word.size(), nParts, iPart);
+
+        const size_t keySize = createKey(iPart, word.size(), word.c_str() + partStart, partSize, keyBuf);
+
+        // The value is the word without the part, parts before iPart keep their positions.
+        valueBuf.assign(word.begin(), word.begin() + partStart);
+        valueBuf.insert(valueBuf.end(), word.begin() + partStart + partSize, word.end());
+
+        mapBuilder.add(keyBuf.data(), keySize, valueBuf.data(), valueBuf.size());
+    }
+
+    nAddedWords += 1;
+}
+
+void DiskSplitIndex::Builder::finish()
+{
+    mapBuilder.finish();
+
+    ofstream outStream(getMetaPath(dirPath), ios_base::trunc);
+    outStream << k << " " << nAddedWords << endl;
+
+    if (!outStream)
+    {
+        throw runtime_error("failed to write index file: " + getMetaPath(dirPath));
+    }
+}
+
+DiskSplitIndex::DiskSplitIndex(const string &dirPathArg)
+    :dirPath(dirPathArg), hashMap(dirPathArg)
+{
+    ifstream inStream(getMetaPath(dirPath));
+
+    if (not (inStream >> k >> nAddedWords) or k == 0)
+    {
+        throw runtime_error("failed to read index file: " + getMetaPath(dirPath));
+    }
+}
+
+void DiskSplitIndex::remove(const string &dirPath)
+{
+    hash_map::DiskHashMap::remove(dirPath);
+    std::remove(getMetaPath(dirPath).c_str());
+}
+
+DiskSplitIndex::ResultSetType DiskSplitIndex::search(const vector<string> &queries, int nIter)
+{
+    ResultSetType ret;
+
+    forEachMatch(queries, [&ret](size_t, const string &word)
+    {
+        ret.insert(word);
+    }, nIter);
+
+    return ret;
+}
+
+string DiskSplitIndex::toString() const
+{
+    static const char *accessPatternNames[] = { "random", "sequential", "prefetch" };
+
+    return (boost::format("Disk split index: k = %1%, #words (added) = %2%, access = %3%\n%4%")
+        % k % nAddedWords % accessPatternNames[static_cast<int>(accessPattern)] % hashMap.toString()).str();
+}
+
+size_t DiskSplitIndex::createKey(size_t iPart, size_t wordSize, const char *part, size_t partSize,
+    vector<char> &keyBuf)
+{
+    keyBuf.resize(1 + utils::SizeCoding::calcSizeB(wordSize) + partSize);
+
+    char *it = keyBuf.data();
+    *it++ = static_cast<char>(iPart);
+
+    it = utils::SizeCoding::write(it, wordSize);
+    memcpy(it, part, partSize);
+
+    return keyBuf.size();
+}
+
+void DiskSplitIndex::createProbes(const vector<string> &queries, vector<Probe> &probes)
+{
+    const size_t nParts = k + 1;
+    probes.clear();
+
+    for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+    {
+        const string &query = queries[iQuery];
+
+        // Words of other sizes cannot match, so there are no keys for such queries.
+        if (query.size() < nParts or query.size() > utils::SizeCoding::maxWordSize)
+        {
+            continue;
+        }
+
+        for (size_t iPart = 0; iPart < nParts; ++iPart)
+        {
+            const char *part = query.c_str() + getPartStart(query.size(), nParts, iPart);
+            const size_t partSize = getPartSize(query.size(), nParts, iPart);
+
+            const size_t keySize = createKey(iPart, query.size(), part, partSize, keyBuf);
+
+            probes.push_back({ hashMap.locate(keyBuf.data(), keySize), iQuery, iPart });
+        }
+    }
+
+    sort(probes.begin(), probes.end());
+}
+
+bool DiskSplitIndex::isCanonicalCandidate(const string &query, const char *wordRemainder, size_t iPart) const
+{
+    const size_t nParts = k + 1;
+
+    for (size_t jPart = 0; jPart < iPart; ++jPart)
+    {
+        const size_t partStart = getPartStart(query.size(), nParts, jPart);
+
+        if (memcmp(wordRemainder + partStart, query.c_str() + partStart, getPartSize(query.size(), nParts, jPart)) == 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DiskSplitIndex::adviseSegment(size_t iSegment, const vector<Probe> &probes, size_t iNextProbe, bool isDone) const
+{
+    using Advice = hash_map::DiskHashMap::Advice;
+
+    switch (accessPattern)
+    {
+        case AccessPattern::Random:
+            break;
+        case AccessPattern::Sequential:
+            if (isDone)
+            {
+                hashMap.advise(iSegment, Advice::DontNeed);
+                hashMap.advise(iSegment, Advice::Random);
+            }
+            else
+            {
+                hashMap.advise(iSegment, Advice::Sequential);
+            }
+
+            break;
+        case AccessPattern::Prefetch:
+        {
+            if (isDone)
+            {
+                break;
+            }
+
+            // The first segment is read ahead right away, later ones while their predecessors are searched.
+            if (iNextProbe == 0)
+            {
+                hashMap.advise(iSegment, Advice::WillNeed);
+            }
+
+            const auto nextSegmentProbe = lower_bound(probes.begin() + iNextProbe, probes.end(), iSegment + 1,
+                [](const Probe &probe, size_t iNextSegment) { return probe.location.iSegment < iNextSegment; });
+
+            if (nextSegmentProbe != probes.end())
+            {
+                hashMap.advise(nextSegmentProbe->location.iSegment, Advice::WillNeed);
+            }
+
+            break;
+        }
+    }
+}
+
+} // namespace split_index
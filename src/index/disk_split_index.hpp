@@ -0,0 +1,217 @@
+#ifndef DISK_SPLIT_INDEX_HPP
+#define DISK_SPLIT_INDEX_HPP
+
+#include <chrono>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../hash_map/disk_hash_map.hpp"
+#include "../utils/distance.hpp"
+#include "../utils/size_coding.hpp"
+
+namespace split_index
+{
+
+/** An out-of-core split index for dictionaries which do not fit in memory, with the same splitting as SplitIndexK
+ * (words are split into k + 1 parts of equal sizes, except for the last part which takes the rest).
+ * Each part of each word is a key of a hash map stored on disk (see hash_map::DiskHashMap): the part index,
+ * the word size and the part, the entry of a key consists of the remaining parts of its words. As all words
+ * of a key have the same size, the entry is a plain array of word remainders. Only the segments of the map
+ * (a few file descriptors and mappings) are kept in memory, and the dictionary is streamed during construction.
+ * Queries are searched in batches: the keys of all query parts are located first, and then entries are read
+ * segment by segment in the order of buckets, so that each segment is accessed (mostly) sequentially. */
+class DiskSplitIndex
+{
+public:
+    using ResultSetType = std::unordered_set<std::string>;
+
+    /** How the segments are accessed during searching (see hash_map::DiskHashMap::Advice).
+     * Random: no readahead, suitable for few queries, which touch few pages of each segment.
+     * Sequential: readahead within each segment, whose pages are released once it has been searched,
+     *     so that the resident memory is bounded by a single segment.
+     * Prefetch: the next segment is read ahead while the current segment is searched. */
+    enum class AccessPattern { Random, Sequential, Prefetch };
+
+    /** Builds an index in a directory from words which are added in any order (see hash_map::DiskHashMap::Builder).
+     * Duplicate words are stored once. */
+    class Builder
+    {
+    public:
+        /** Builds an index for k mismatches in [dirPath] (which is created if it does not exist), using a map
+         * with [nSegments] segments and runs of at most [maxRunSizeB] bytes. Throws if k is 0. */
+        Builder(const std::string &dirPathArg, size_t kArg, size_t nSegments,
+            hash_functions::HashFunctions::HashType hashType,
+            size_t maxRunSizeB = hash_map::DiskHashMap::defaultMaxRunSizeB);
+
+        /** Adds [word], throws if it is too short (fewer than k + 1 chars) or too long. */
+        void add(const std::string &word);
+        /** Writes the index, nothing can be added anymore. */
+        void finish();
+
+        size_t getNAddedWords() const { return nAddedWords; }
+        size_t getNRuns() const { return mapBuilder.getNRuns(); }
+
+    private:
+        const std::string dirPath;
+        const size_t k;
+
+        hash_map::DiskHashMap::Builder mapBuilder;
+        size_t nAddedWords = 0;
+
+        std::vector<char> keyBuf;
+        std::vector<char> valueBuf;
+    };
+
+    /** Opens the index which has been built in [dirPath] (see Builder), throws if it cannot be opened. */
+    explicit DiskSplitIndex(const std::string &dirPathArg);
+
+    DiskSplitIndex(const DiskSplitIndex &) = delete;
+    DiskSplitIndex &operator=(const DiskSplitIndex &) = delete;
+
+    /** Removes the index which has been built in [dirPath], leaving the directory itself. */
+    static void remove(const std::string &dirPath);
+
+    /** Calls [callback](iQuery, word) for each dictionary word matching queries[iQuery] (each once per query),
+     * repeating the search [nIter] times. Matches are reported in the order of the segments, not of the queries. */
+    template<typename Callback>
+    void forEachMatch(const std::vector<std::string> &queries, Callback callback, int nIter = 1);
+    /** Returns the set of words matching any of [queries], the search is repeated [nIter] times. */
+    ResultSetType search(const std::vector<std::string> &queries, int nIter = 1);
+
+    void setAccessPattern(AccessPattern accessPatternArg) { accessPattern = accessPatternArg; }
+    AccessPattern getAccessPattern() const { return accessPattern; }
+
+    std::string toString() const;
+
+    size_t getK() const { return k; }
+    size_t getNAddedWords() const { return nAddedWords; }
+    const hash_map::DiskHashMap &getHashMap() const { return hashMap; }
+    /** Returns the elapsed (wall-clock, since searching waits for disk reads) time of the last search
+     * in microseconds. */
+    float getElapsedUs() const { return elapsedUs; }
+
+private:
+    /** A lookup of the key of part [iPart] of queries[iQuery] at [location]. */
+    struct Probe
+    {
+        hash_map::DiskHashMap::Location location;
+        size_t iQuery;
+        size_t iPart;
+
+        bool operator<(const Probe &other) const { return location < other.location; }
+    };
+
+    /** Returns the start of part [iPart] of a word of size [wordSize] for [nParts] parts. */
+    static size_t getPartStart(size_t wordSize, size_t nParts, size_t iPart)
+    {
+        return iPart * (wordSize / nParts);
+    }
+    static size_t getPartSize(size_t wordSize, size_t nParts, size_t iPart)
+    {
+        return (iPart + 1 == nParts) ? wordSize - iPart * (wordSize / nParts) : wordSize / nParts;
+    }
+
+    /** Stores the key of [part] (of size [partSize]) which is part [iPart] of a word of size [wordSize]
+     * in [keyBuf], returns the size of the key. */
+    static size_t createKey(size_t iPart, size_t wordSize, const char *part, size_t partSize,
+        std::vector<char> &keyBuf);
+
+    static std::string getMetaPath(const std::string &dirPath) { return dirPath + "/disk_split_index.meta"; }
+
+    /** Locates the keys of all parts of [queries] and stores the probes in [probes] sorted by their locations. */
+    void createProbes(const std::vector<std::string> &queries, std::vector<Probe> &probes);
+
+    /** Returns true if [wordRemainder] differs from [query] without its part at [partStart] (of size [partSize])
+     * in at most k positions, the query part itself matches exactly. */
+    bool isMatch(const std::string &query, const char *wordRemainder, size_t partStart, size_t partSize) const
+    {
+        const size_t suffixStart = partStart + partSize;
+        const unsigned nPrefixErrors = utils::Distance::calcHamming(wordRemainder, query.c_str(), partStart);
+
+        return nPrefixErrors <= k and utils::Distance::isHammingAtMost(wordRemainder + partStart,
+            query.c_str() + suffixStart, query.size() - suffixStart, k - nPrefixErrors);
+    }
+
+    /** Returns true if [wordRemainder] (all parts except for [iPart]) stored under the key of query part [iPart]
+     * matches [query] exactly in none of the earlier parts. Such words are reported only through the first
+     * matching part (as in SplitIndexK::isCanonicalCandidate). */
+    bool isCanonicalCandidate(const std::string &query, const char *wordRemainder, size_t iPart) const;
+
+    /** Advises the segments of [probes] for accessPattern before segment [iSegment] is searched,
+     * or after it has been searched if [isDone] is true, [iNextProbe] is the first probe not searched yet. */
+    void adviseSegment(size_t iSegment, const std::vector<Probe> &probes, size_t iNextProbe, bool isDone) const;
+
+    const std::string dirPath;
+    size_t k = 0;
+    size_t nAddedWords = 0;
+
+    hash_map::DiskHashMap hashMap;
+    AccessPattern accessPattern = AccessPattern::Random;
+
+    float elapsedUs = 0.0f;
+
+    /** Reused across searches. */
+    std::vector<char> keyBuf;
+    std::vector<Probe> probes;
+    std::string wordBuf;
+};
+
+template<typename Callback>
+void DiskSplitIndex::forEachMatch(const std::vector<std::string> &queries, Callback callback, int nIter)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    const size_t nParts = k + 1;
+
+    for (int iIter = 0; iIter < nIter; ++iIter)
+    {
+        createProbes(queries, probes);
+
+        for (size_t iProbe = 0; iProbe < probes.size(); ++iProbe)
+        {
+            const Probe &probe = probes[iProbe];
+            const size_t iSegment = probe.location.iSegment;
+
+            if (iProbe == 0 or probes[iProbe - 1].location.iSegment != iSegment)
+            {
+                adviseSegment(iSegment, probes, iProbe, false);
+            }
+
+            const std::string &query = queries[probe.iQuery];
+
+            const size_t partStart = getPartStart(query.size(), nParts, probe.iPart);
+            const size_t partSize = getPartSize(query.size(), nParts, probe.iPart);
+            const size_t remainderSize = query.size() - partSize;
+
+            const size_t keySize = createKey(probe.iPart, query.size(), query.c_str() + partStart, partSize, keyBuf);
+
+            size_t entrySize = 0;
+            const char *entry = hashMap.retrieve(keyBuf.data(), keySize, probe.location, entrySize);
+
+            for (const char *it = entry; it != nullptr and it != entry + entrySize; it += remainderSize)
+            {
+                if (isMatch(query, it, partStart, partSize) and isCanonicalCandidate(query, it, probe.iPart))
+                {
+                    wordBuf.assign(it, partStart);
+                    wordBuf.append(query, partStart, partSize);
+                    wordBuf.append(it + partStart, remainderSize - partStart);
+
+                    callback(probe.iQuery, static_cast<const std::string &>(wordBuf));
+                }
+            }
+
+            if (iProbe + 1 == probes.size() or probes[iProbe + 1].location.iSegment != iSegment)
+            {
+                adviseSegment(iSegment, probes, iProbe + 1, true);
+            }
+        }
+    }
+
+    elapsedUs = std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
+
+} // namespace split_index
+
+#endif // DISK_SPLIT_INDEX_HPP
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cassert>
+
+#include "entry_sub_index.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+void EntrySubIndex::add(const char *part, size_t partSize, const Item &item)
+{
+    nItems += 1;
+
+    if (partSize <= maxErrors)
+    {
+        shortItems.push_back(item);
+        return;
+    }
+
+    for (size_t iPiece = 0; iPiece <= maxErrors; ++iPiece)
+    {
+        const size_t start = getPieceStart(partSize, iPiece);
+        const size_t end = getPieceStart(partSize, iPiece + 1);
+
+        assert(end > start);
+        pieces.emplace_back(hashPiece(part + start, end - start, partSize, iPiece), item);
+    }
+}
+
+void EntrySubIndex::build()
+{
+    // Items having the same hash stay in the order of adding.
+    stable_sort(pieces.begin(), pieces.end(),
+        [](const pair<uint64_t, Item> &p1, const pair<uint64_t, Item> &p2) { return p1.first < p2.first; });
+
+    pieces.shrink_to_fit();
+    shortItems.shrink_to_fit();
+}
+
+size_t EntrySubIndex::calcSizeB() const
+{
+    return sizeof(EntrySubIndex) + shortItems.capacity() * sizeof(Item) + pieces.capacity() * sizeof(pieces[0]);
+}
+
+uint64_t EntrySubIndex::hashPiece(const char *piece, size_t pieceSize, size_t partSize, size_t iPiece)
+{
+    // FNV-1a, the part size and the piece index are mixed in so that pieces at different positions do not collide.
+    uint64_t hash = 14695981039346656037ull ^ (partSize << 8) ^ iPiece;
+
+    for (size_t i = 0; i < pieceSize; ++i)
+    {
+        hash ^= static_cast<unsigned char>(piece[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void EntrySubIndexes::add(const char *entry, EntrySubIndex *subIndex)
+{
+    const auto it = lower_bound(subIndexes.begin(), subIndexes.end(), entry,
+        [](const pair<const char *, EntrySubIndex *> &p, const char *e) { return p.first < e; });
+
+    assert(it == subIndexes.end() or it->first != entry);
+    subIndexes.insert(it, { entry, subIndex });
+}
+
+bool EntrySubIndexes::remove(const char *entry)
+{
+    const auto it = lower_bound(subIndexes.begin(), subIndexes.end(), entry,
+        [](const pair<const char *, EntrySubIndex *> &p, const char *e) { return p.first < e; });
+
+    if (it == subIndexes.end() or it->first != entry)
+    {
+        return false;
+    }
+
+    delete it->second;
+    subIndexes.erase(it);
+
+    return true;
+}
+
+void EntrySubIndexes::clear()
+{
+    for (const auto &p : subIndexes)
+    {
+        delete p.second;
+    }
+
+    subIndexes.clear();
+}
+
+size_t EntrySubIndexes::calcSizeB() const
+{
+    size_t sizeB = subIndexes.capacity() * sizeof(subIndexes[0]);
+
+    for (const auto &p : subIndexes)
+    {
+        sizeB += p.second->calcSizeB();
+    }
+
+    return sizeB;
+}
+
+} // namespace split_index
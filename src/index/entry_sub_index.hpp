@@ -0,0 +1,143 @@
+#ifndef ENTRY_SUB_INDEX_HPP
+#define ENTRY_SUB_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace split_index
+{
+
+/** A second level index for a single oversized entry, i.e. an entry storing many word parts under a single key.
+ * Each stored word part (which may have up to maxErrors mismatches with the query part) is split into
+ * maxErrors + 1 pieces, and by the pigeonhole principle at least one of them matches the query exactly.
+ * Pieces are keyed by their hashes (together with the part size and the piece index), and (hash, item) pairs
+ * are kept sorted by hashes, hence a query only scans the runs (sub-buckets) of its own pieces instead of
+ * the whole entry. Hash collisions only produce extra candidates, which are rejected during verification anyway. */
+class EntrySubIndex
+{
+public:
+    /** A stored word part: the offset of its size byte from the entry start, and its index among all entry words. */
+    struct Item
+    {
+        uint32_t offset;
+        uint32_t iWord;
+    };
+
+    explicit EntrySubIndex(size_t maxErrorsArg) :maxErrors(maxErrorsArg) { }
+
+    /** Adds a stored word [part] of size [partSize] described by [item], build() must be called after all parts are added. */
+    void add(const char *part, size_t partSize, const Item &item);
+    /** Sorts the pieces so that the sub-index can be searched. */
+    void build();
+
+    /** Calls [callback] for each stored word part which can be within maxErrors mismatches from [part]
+     * of size [partSize], until [callback] returns false (e.g. once a match has been found when checking existence).
+     * Items are not filtered by their sizes, and they may be reported more than once. */
+    template<typename Callback>
+    void forEachCandidate(const char *part, size_t partSize, Callback callback) const;
+
+    /** Returns the size of the sub-index in bytes (approximately, excluding allocator overhead). */
+    size_t calcSizeB() const;
+
+    size_t getNItems() const { return nItems; }
+
+private:
+    /** Returns the hash of piece [iPiece] of a part of size [partSize], which starts at [piece] and has [pieceSize] chars. */
+    static uint64_t hashPiece(const char *piece, size_t pieceSize, size_t partSize, size_t iPiece);
+
+    /** Returns the start of piece [iPiece] (or the part size for iPiece = maxErrors + 1) for a part of size [partSize]. */
+    size_t getPieceStart(size_t partSize, size_t iPiece) const { return partSize * iPiece / (maxErrors + 1); }
+
+    const size_t maxErrors;
+    size_t nItems = 0;
+
+    /** Hashes of pieces with their items, sorted by hashes after build(). */
+    std::vector<std::pair<uint64_t, Item>> pieces;
+    /** Parts which are too short to be split into maxErrors + 1 non-empty pieces, they are always candidates. */
+    std::vector<Item> shortItems;
+};
+
+template<typename Callback>
+void EntrySubIndex::forEachCandidate(const char *part, size_t partSize, Callback callback) const
+{
+    for (const Item &item : shortItems)
+    {
+        if (not callback(item))
+        {
+            return;
+        }
+    }
+
+    if (partSize <= maxErrors)
+    {
+        return;
+    }
+
+    for (size_t iPiece = 0; iPiece <= maxErrors; ++iPiece)
+    {
+        const size_t start = getPieceStart(partSize, iPiece);
+        const size_t end = getPieceStart(partSize, iPiece + 1);
+
+        const uint64_t hash = hashPiece(part + start, end - start, partSize, iPiece);
+
+        auto it = std::lower_bound(pieces.begin(), pieces.end(), hash,
+            [](const std::pair<uint64_t, Item> &p, uint64_t h) { return p.first < h; });
+
+        for (; it != pieces.end() and it->first == hash; ++it)
+        {
+            if (not callback(it->second))
+            {
+                return;
+            }
+        }
+    }
+}
+
+/** Sub-indexes of all oversized entries of a split index, looked up by entry addresses.
+ * There are only a handful of oversized entries, so they are kept in a sorted array. */
+class EntrySubIndexes
+{
+public:
+    EntrySubIndexes() = default;
+    ~EntrySubIndexes() { clear(); }
+
+    EntrySubIndexes(const EntrySubIndexes &) = delete;
+    EntrySubIndexes &operator=(const EntrySubIndexes &) = delete;
+
+    /** Adds [subIndex] for [entry], takes ownership of [subIndex]. */
+    void add(const char *entry, EntrySubIndex *subIndex);
+    /** Deletes the sub-index for [entry], returns false if there is none. */
+    bool remove(const char *entry);
+    void clear();
+
+    /** Returns the sub-index for [entry] or nullptr if there is none. */
+    inline const EntrySubIndex *find(const char *entry) const;
+
+    size_t size() const { return subIndexes.size(); }
+    bool empty() const { return subIndexes.empty(); }
+
+    /** Returns the total size of all sub-indexes in bytes. */
+    size_t calcSizeB() const;
+
+private:
+    std::vector<std::pair<const char *, EntrySubIndex *>> subIndexes;
+};
+
+const EntrySubIndex *EntrySubIndexes::find(const char *entry) const
+{
+    if (subIndexes.empty())
+    {
+        return nullptr;
+    }
+
+    const auto it = std::lower_bound(subIndexes.begin(), subIndexes.end(), entry,
+        [](const std::pair<const char *, EntrySubIndex *> &p, const char *e) { return p.first < e; });
+
+    return (it != subIndexes.end() and it->first == entry) ? it->second : nullptr;
+}
+
+} // namespace split_index
+
+#endif // ENTRY_SUB_INDEX_HPP
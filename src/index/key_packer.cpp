@@ -0,0 +1,67 @@
+#include <boost/format.hpp>
+#include <cstring>
+
+#include "key_packer.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+KeyPacker::KeyPacker()
+{
+    clear();
+}
+
+void KeyPacker::build(const unordered_set<string> &wordSet)
+{
+    clear();
+
+    bool isInAlphabet[256] = { };
+
+    for (const string &word : wordSet)
+    {
+        for (const char c : word)
+        {
+            isInAlphabet[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    for (size_t c = 0; c < 256; ++c)
+    {
+        if (isInAlphabet[c])
+        {
+            alphabetSize += 1;
+            charRanks[c] = static_cast<uint8_t>(alphabetSize);
+        }
+    }
+
+    // Ranks are 1-based, hence we need to fit alphabetSize + 1 distinct values.
+    nBitsPerChar = 1;
+
+    while ((static_cast<size_t>(1) << nBitsPerChar) <= alphabetSize)
+    {
+        nBitsPerChar += 1;
+    }
+
+    // All 256 chars cannot be ranked from 1, such keys are not packed at all.
+    if (nBitsPerChar >= 8)
+    {
+        clear();
+    }
+}
+
+void KeyPacker::clear()
+{
+    memset(charRanks, 0, sizeof(charRanks));
+
+    alphabetSize = 0;
+    nBitsPerChar = 8;
+}
+
+string KeyPacker::toString() const
+{
+    return (boost::format("alphabet size = %1%, #bits per char = %2%") % alphabetSize % nBitsPerChar).str();
+}
+
+} // namespace split_index
@@ -0,0 +1,96 @@
+#ifndef KEY_PACKER_HPP
+#define KEY_PACKER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+namespace split_index
+{
+
+/** Packs hash map keys using alphabet ranks, i.e. ceil(log2(sigma + 1)) bits per char for an alphabet of size sigma.
+ * Rank 0 is reserved for padding, hence packed keys of different sizes never collide.
+ * Packing is not invertible without the key size, which is fine since keys are only compared. */
+class KeyPacker
+{
+public:
+    KeyPacker();
+
+    /** Calculates the alphabet of [wordSet] and the resulting number of bits per char. */
+    void build(const std::unordered_set<std::string> &wordSet);
+    /** Clears the alphabet, so that packing is disabled. */
+    void clear();
+
+    /** Returns true if packing saves space, i.e. the alphabet requires less than 8 bits per char. */
+    bool isEnabled() const { return nBitsPerChar < 8; }
+
+    /** Packs [key] of size [keySize] into [out], which must have at least [keySize] bytes.
+     * Returns the size of packed key or 0 if [key] contains chars outside the alphabet. */
+    inline size_t pack(const char *key, size_t keySize, char *out) const;
+
+    /** Returns true if all chars of [key] of size [keySize] are from the alphabet, i.e. [key] can be packed. */
+    bool isInAlphabet(const char *key, size_t keySize) const
+    {
+        for (size_t i = 0; i < keySize; ++i)
+        {
+            if (charRanks[static_cast<unsigned char>(key[i])] == 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Returns the size of packed key for [keySize]. */
+    size_t calcPackedSize(size_t keySize) const { return (keySize * nBitsPerChar + 7) / 8; }
+
+    size_t getAlphabetSize() const { return alphabetSize; }
+    size_t getNBitsPerChar() const { return nBitsPerChar; }
+
+    std::string toString() const;
+
+private:
+    /** 1-based ranks of chars, 0 for chars outside the alphabet. */
+    uint8_t charRanks[256];
+
+    size_t alphabetSize = 0;
+    size_t nBitsPerChar = 8;
+};
+
+size_t KeyPacker::pack(const char *key, size_t keySize, char *out) const
+{
+    uint32_t bits = 0;
+    size_t nBits = 0, iOut = 0;
+
+    for (size_t i = 0; i < keySize; ++i)
+    {
+        const uint32_t rank = charRanks[static_cast<unsigned char>(key[i])];
+
+        if (rank == 0)
+        {
+            return 0;
+        }
+
+        bits |= rank << nBits;
+        nBits += nBitsPerChar;
+
+        if (nBits >= 8)
+        {
+            out[iOut++] = static_cast<char>(bits);
+            bits >>= 8;
+            nBits -= 8;
+        }
+    }
+
+    if (nBits > 0)
+    {
+        out[iOut++] = static_cast<char>(bits);
+    }
+
+    return iOut;
+}
+
+} // namespace split_index
+
+#endif // KEY_PACKER_HPP
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <cassert>
+
+#include "match_collector.hpp"
+#include "../utils/distance.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+constexpr MatchCollector::WordId MatchCollector::noWordId;
+constexpr size_t MatchCollector::maxMismatchPositions;
+
+void MatchCollector::build(const unordered_set<string> &wordSet)
+{
+    clear();
+    assert(wordSet.size() < noWordId);
+
+    size_t totalSize = 0;
+
+    for (const string &word : wordSet)
+    {
+        totalSize += word.size();
+    }
+
+    wordChars.reserve(totalSize);
+    wordStarts.reserve(wordSet.size());
+    wordSizes.reserve(wordSet.size());
+
+    // The table is kept at most half full so that probe sequences are short.
+    size_t nSlots = 2;
+
+    while (nSlots < 2 * wordSet.size())
+    {
+        nSlots *= 2;
+    }
+
+    slots.assign(nSlots, noWordId);
+    slotMask = nSlots - 1;
+
+    for (const string &word : wordSet)
+    {
+        const WordId id = static_cast<WordId>(wordSizes.size());
+
+        wordStarts.push_back(wordChars.size());
+        wordSizes.push_back(static_cast<uint32_t>(word.size()));
+        wordChars.insert(wordChars.end(), word.begin(), word.end());
+
+        insertSlot(id);
+    }
+
+    seenEpochs.assign(wordSet.size(), 0);
+    erasedFlags.assign(wordSet.size(), 0);
+}
+
+MatchCollector::WordId MatchCollector::addWord(const char *word, size_t size, Payload payload)
+{
+    assert(findWordId(word, size) == noWordId);
+    assert(getNWords() + 1 < noWordId);
+
+    const WordId id = static_cast<WordId>(wordSizes.size());
+
+    wordStarts.push_back(wordChars.size());
+    wordSizes.push_back(static_cast<uint32_t>(size));
+    wordChars.insert(wordChars.end(), word, word + size);
+
+    seenEpochs.push_back(0);
+    erasedFlags.push_back(0);
+
+    // Payloads are only stored once any word has one.
+    if (not payloads.empty() or payload != 0)
+    {
+        payloads.resize(getNWords(), 0);
+        payloads[id] = payload;
+    }
+
+    if (2 * getNWords() > slots.size())
+    {
+        rehashSlots(2 * max<size_t>(slots.size(), 1));
+    }
+    else
+    {
+        insertSlot(id);
+    }
+
+    return id;
+}
+
+void MatchCollector::setErased(WordId id, bool isErased)
+{
+    assert(id < getNWords());
+
+    if ((erasedFlags[id] != 0) != isErased)
+    {
+        erasedFlags[id] = isErased ? 1 : 0;
+        nErased = isErased ? nErased + 1 : nErased - 1;
+    }
+}
+
+void MatchCollector::setPayload(WordId id, Payload payload)
+{
+    assert(id < getNWords());
+
+    // Payloads are only stored once any word has one (see addWord).
+    if (payloads.empty() and payload == 0)
+    {
+        return;
+    }
+
+    payloads.resize(getNWords(), 0);
+    payloads[id] = payload;
+}
+
+void MatchCollector::insertSlot(WordId id)
+{
+    size_t iSlot = hashWord(getWordChars(id), getWordSize(id)) & slotMask;
+
+    while (slots[iSlot] != noWordId)
+    {
+        iSlot = (iSlot + 1) & slotMask;
+    }
+
+    slots[iSlot] = id;
+}
+
+void MatchCollector::rehashSlots(size_t nSlots)
+{
+    slots.assign(nSlots, noWordId);
+    slotMask = nSlots - 1;
+
+    for (WordId id = 0; id < getNWords(); ++id)
+    {
+        insertSlot(id);
+    }
+}
+
+void MatchCollector::clear()
+{
+    wordChars.clear();
+    wordStarts.clear();
+    wordSizes.clear();
+    payloads.clear();
+
+    erasedFlags.clear();
+    nErased = 0;
+
+    slots.clear();
+    slotMask = 0;
+
+    seenEpochs.clear();
+    epoch = 0;
+
+    pendingMatches.clear();
+    pendingChars.clear();
+
+    mode = Mode::Words;
+    resultSet = nullptr;
+    wordIds = nullptr;
+
+    found = false;
+    count = 0;
+}
+
+void MatchCollector::setPayloads(const unordered_map<string, Payload> &wordPayloads)
+{
+    payloads.assign(getNWords(), 0);
+
+    for (WordId id = 0; id < getNWords(); ++id)
+    {
+        const auto it = wordPayloads.find(string(getWordChars(id), getWordSize(id)));
+
+        if (it != wordPayloads.end())
+        {
+            payloads[id] = it->second;
+        }
+    }
+}
+
+void MatchCollector::collectWords(ResultSetType &results)
+{
+    startQuery(Mode::Words);
+    resultSet = &results;
+}
+
+void MatchCollector::collectWordIds(vector<WordId> &ids)
+{
+    ids.clear();
+    appendWordIds(ids);
+}
+
+void MatchCollector::appendWordIds(vector<WordId> &ids)
+{
+    startQuery(Mode::WordIds);
+    wordIds = &ids;
+}
+
+void MatchCollector::collectMatches(const char *query, size_t querySize, vector<Match> &results, bool withPositions)
+{
+    startQuery(Mode::Matches);
+
+    matchQuery = query;
+    matchQuerySize = querySize;
+    matchResults = &results;
+    withMismatchPositions = withPositions;
+
+    results.clear();
+}
+
+void MatchCollector::collectTopMatches(const char *query, size_t querySize, size_t nTop, vector<Match> &results)
+{
+    startQuery(Mode::TopMatches);
+
+    matchQuery = query;
+    matchQuerySize = querySize;
+    matchResults = &results;
+    nTopMatches = nTop;
+
+    results.clear();
+}
+
+void MatchCollector::collectExistence()
+{
+    startQuery(Mode::Exists);
+}
+
+void MatchCollector::collectCount()
+{
+    startQuery(Mode::Count);
+}
+
+void MatchCollector::startQuery(Mode newMode)
+{
+    mode = newMode;
+    resultSet = nullptr;
+    wordIds = nullptr;
+    matchResults = nullptr;
+
+    found = false;
+    count = 0;
+
+    pendingMatches.clear();
+    pendingChars.clear();
+
+    epoch += 1;
+
+    // After wrapping around, stale epochs could be taken for the current one.
+    if (epoch == 0)
+    {
+        fill(seenEpochs.begin(), seenEpochs.end(), 0);
+        epoch = 1;
+    }
+}
+
+void MatchCollector::finishQuery()
+{
+    if (mode == Mode::TopMatches)
+    {
+        finishTopMatches();
+        return;
+    }
+
+    for (const PendingMatch &match : pendingMatches)
+    {
+        const WordId id = findWordId(pendingChars.data() + match.start, match.size, match.hash);
+
+        if (id == noWordId or (nErased != 0 and erasedFlags[id] != 0))
+        {
+            continue;
+        }
+
+        if (not match.isUnique)
+        {
+            if (seenEpochs[id] == epoch)
+            {
+                continue;
+            }
+
+            seenEpochs[id] = epoch;
+        }
+
+        if (mode == Mode::WordIds)
+        {
+            wordIds->push_back(id);
+        }
+        else if (mode == Mode::Matches)
+        {
+            storeMatch(id);
+        }
+        else
+        {
+            count += 1;
+        }
+    }
+
+    if (mode == Mode::Matches)
+    {
+        sort(matchResults->begin(), matchResults->end(), [](const Match &m1, const Match &m2)
+        {
+            return m1.distance < m2.distance or (m1.distance == m2.distance and m1.id < m2.id);
+        });
+    }
+
+    pendingMatches.clear();
+    pendingChars.clear();
+}
+
+void MatchCollector::storeMatch(WordId id)
+{
+    assert(wordSizes[id] == matchQuerySize);
+
+    Match match = Match();
+    match.id = id;
+
+    const char *word = wordChars.data() + wordStarts[id];
+
+    if (withMismatchPositions)
+    {
+        match.distance = utils::Distance::calcHammingWithPositions(word, matchQuery, matchQuerySize,
+            match.mismatchPositions, maxMismatchPositions);
+    }
+    else
+    {
+        match.distance = utils::Distance::calcHamming(word, matchQuery, matchQuerySize);
+    }
+
+    match.payload = getPayload(id);
+    matchResults->push_back(match);
+}
+
+void MatchCollector::finishTopMatches()
+{
+    // The results are kept as a heap whose front is the worst of the best matches found so far.
+    vector<Match> &heap = *matchResults;
+
+    for (const PendingMatch &pending : pendingMatches)
+    {
+        if (nTopMatches == 0)
+        {
+            break;
+        }
+
+        const char *word = pendingChars.data() + pending.start;
+        assert(pending.size == matchQuerySize);
+
+        Match match = Match();
+        match.distance = utils::Distance::calcHamming(word, matchQuery, matchQuerySize);
+
+        // Matches which are farther than all of the best ones cannot rank higher, so they are not looked up.
+        if (heap.size() == nTopMatches and match.distance > heap.front().distance)
+        {
+            continue;
+        }
+
+        match.id = findWordId(word, pending.size, pending.hash);
+
+        if (match.id == noWordId or (nErased != 0 and erasedFlags[match.id] != 0))
+        {
+            continue;
+        }
+
+        if (not pending.isUnique)
+        {
+            if (seenEpochs[match.id] == epoch)
+            {
+                continue;
+            }
+
+            seenEpochs[match.id] = epoch;
+        }
+
+        match.payload = getPayload(match.id);
+
+        if (heap.size() == nTopMatches and not isBetterMatch(match, heap.front()))
+        {
+            continue;
+        }
+
+        // Mismatch positions are only found for matches which are kept.
+        utils::Distance::calcHammingWithPositions(word, matchQuery, matchQuerySize,
+            match.mismatchPositions, maxMismatchPositions);
+
+        if (heap.size() < nTopMatches)
+        {
+            heap.push_back(match);
+            push_heap(heap.begin(), heap.end(), isBetterMatch);
+        }
+        else
+        {
+            pop_heap(heap.begin(), heap.end(), isBetterMatch);
+            heap.back() = match;
+            push_heap(heap.begin(), heap.end(), isBetterMatch);
+        }
+    }
+
+    sort_heap(heap.begin(), heap.end(), isBetterMatch);
+
+    pendingMatches.clear();
+    pendingChars.clear();
+}
+
+size_t MatchCollector::calcSizeB() const
+{
+    return wordChars.capacity() + wordStarts.capacity() * sizeof(size_t) + wordSizes.capacity() * sizeof(uint32_t)
+        + payloads.capacity() * sizeof(Payload) + slots.capacity() * sizeof(WordId)
+        + seenEpochs.capacity() * sizeof(uint32_t) + erasedFlags.capacity() * sizeof(uint8_t);
+}
+
+} // namespace split_index
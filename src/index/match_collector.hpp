@@ -0,0 +1,305 @@
+#ifndef MATCH_COLLECTOR_HPP
+#define MATCH_COLLECTOR_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <xmmintrin.h>
+
+#include "../hash_function/hash_functions.hpp"
+
+namespace split_index
+{
+
+/** Collects matches reported by a split index, either as a set of matching words or as IDs of dictionary words,
+ * or only checks whether any match exists or counts distinct matching words.
+ * Dictionary words are stored contiguously in the order of their IDs, and a word is mapped to its ID using
+ * an open addressing table of IDs. When collecting IDs, matches of a query are only buffered (and their table slots
+ * prefetched) while the index is traversed, and they are resolved to IDs at the end of the query, so that
+ * table lookups do not stall the traversal. Each ID is deduplicated using an array of epochs (one per word,
+ * bumped for each query), unless the match is reported with addUnique. All buffers are reused, hence no memory
+ * is allocated once they have grown. Counting works the same way, but matches reported with addUnique are counted
+ * without any lookups. Words can be added after building (getting consecutive IDs) and erased words are marked
+ * with tombstones, they are never reported, and reported words are only looked up early if there are any tombstones. */
+class MatchCollector
+{
+public:
+    /** Defines the type containing all matching words. */
+    using ResultSetType = std::unordered_set<std::string>;
+    /** IDs of dictionary words are consecutive numbers starting from 0. */
+    using WordId = uint32_t;
+    /** A fixed-size payload attached to each dictionary word (e.g. its frequency), 0 if none is set.
+     * When ranking matches (see collectTopMatches), it is used as a weight, i.e. larger payloads rank higher. */
+    using Payload = uint64_t;
+
+    /** Returned by findWordId for words which are not in the dictionary. */
+    static constexpr WordId noWordId = UINT32_MAX;
+    /** The maximum number of mismatch positions stored for a match, i.e. the maximum k for all split indexes. */
+    static constexpr size_t maxMismatchPositions = 3;
+
+    /** A matching word with its payload, its Hamming distance to the query and the positions of
+     * (at most maxMismatchPositions) mismatches, which are valid only for the first min(distance, maxMismatchPositions)
+     * entries and only if positions have been requested (otherwise they are 0). */
+    struct Match
+    {
+        WordId id;
+        uint32_t distance;
+        uint16_t mismatchPositions[maxMismatchPositions];
+        Payload payload;
+    };
+
+    /** Assigns IDs to [wordSet] (in the order of iteration) and builds the ID table. */
+    void build(const std::unordered_set<std::string> &wordSet);
+    void clear();
+
+    /** Sets the payloads of words which are present in [wordPayloads], other words get 0. Must be called after build(). */
+    void setPayloads(const std::unordered_map<std::string, Payload> &wordPayloads);
+
+    /** Adds [word] of size [size] having [payload], which must not be in the dictionary yet, and returns its ID,
+     * i.e. the next consecutive one. The ID table grows when it gets half full. */
+    WordId addWord(const char *word, size_t size, Payload payload);
+    /** Marks word [id] as erased (i.e. sets its tombstone) or as present again. */
+    void setErased(WordId id, bool isErased);
+    /** Sets the payload of word [id], e.g. when an erased word is inserted again with a new payload. */
+    void setPayload(WordId id, Payload payload);
+    bool isErased(WordId id) const { return erasedFlags[id] != 0; }
+    /** Returns the number of erased words, which still have their IDs. */
+    size_t getNErased() const { return nErased; }
+
+    /** Matching words are inserted into [results] until the next collect* call. */
+    void collectWords(ResultSetType &results);
+    /** Starts a new query whose matches are appended to [ids] as word IDs (each once), clears [ids].
+     * The IDs are stored when finishQuery() is called. */
+    void collectWordIds(std::vector<WordId> &ids);
+    /** Starts a new query whose matches are appended to [ids] as word IDs (each once), keeps the contents of [ids],
+     * so that matches of consecutive queries can be stored one after another. */
+    void appendWordIds(std::vector<WordId> &ids);
+    /** Starts a new query [query] of size [querySize] whose matches are stored in [results] (each word once)
+     * together with their distances, and with mismatch positions if [withPositions] is true. [results] is cleared
+     * and then filled when finishQuery() is called, matches are ordered by distance and then by word ID. */
+    void collectMatches(const char *query, size_t querySize, std::vector<Match> &results, bool withPositions);
+    /** Starts a new query [query] of size [querySize] for which at most [nTop] best matches (each word once) are
+     * stored in [results], with their distances, mismatch positions and payloads. Matches are ranked by distance
+     * and then by payload (descending), and they are ordered from the best one when finishQuery() is called.
+     * The prune is lookup-only: all candidates are verified by the index and buffered, and when the query finishes,
+     * buffered matches farther than [nTop] best ones found so far are skipped before their word IDs are looked up. */
+    void collectTopMatches(const char *query, size_t querySize, size_t nTop, std::vector<Match> &results);
+    /** Starts a new query for which only the existence of a match is checked (see hasMatch and isDone). */
+    void collectExistence();
+    /** Starts a new query for which the number of distinct matching words is counted (see getCount). */
+    void collectCount();
+    /** Resolves the matches buffered for the current query to word IDs or counts them. */
+    void finishQuery();
+
+    /** Adds a match, i.e. the dictionary word [word] of size [size]. */
+    inline void add(const char *word, size_t size);
+    /** Adds a match which is reported at most once per query (e.g. by the canonical part rule, see SplitIndexK),
+     * so that it is not deduplicated, and it is counted without a lookup. A word reported using addUnique
+     * must not be reported using add for the same query. */
+    inline void addUnique(const char *word, size_t size);
+
+    /** True if the search for the current query can stop, i.e. a match has been found when checking existence. */
+    bool isDone() const { return found; }
+    bool isCheckingExistence() const { return mode == Mode::Exists; }
+
+    bool hasMatch() const { return found; }
+    size_t getCount() const { return count; }
+
+    /** Returns the ID of [word] of size [size] or noWordId if [word] is not in the dictionary. */
+    inline WordId findWordId(const char *word, size_t size) const;
+
+    size_t getNWords() const { return wordSizes.size(); }
+    /** Returns the chars of word [id], which are owned by the collector and are not 0-terminated. */
+    const char *getWordChars(WordId id) const { return wordChars.data() + wordStarts[id]; }
+    size_t getWordSize(WordId id) const { return wordSizes[id]; }
+    Payload getPayload(WordId id) const { return payloads.empty() ? 0 : payloads[id]; }
+
+    /** Returns the size of the word storage and tables in bytes. Words are copied rather than referenced
+     * in the dictionary set, so that they are contiguous and erased words keep their chars. */
+    size_t calcSizeB() const;
+
+private:
+    enum class Mode { Words, WordIds, Matches, TopMatches, Exists, Count };
+
+    /** A match buffered for the current query, its chars are stored in pendingChars. */
+    struct PendingMatch
+    {
+        size_t start;
+        size_t size;
+        size_t hash;
+        bool isUnique;
+    };
+
+    static size_t hashWord(const char *word, size_t size) { return hash_functions::HashFunctions::xxHash(word, size); }
+
+    /** Returns the ID of [word] of size [size] with [hash] or noWordId if [word] is not in the dictionary. */
+    inline WordId findWordId(const char *word, size_t size, size_t hash) const;
+    /** Returns true if [word] of size [size] has been erased, this requires a lookup. */
+    inline bool isErasedWord(const char *word, size_t size) const;
+
+    /** Stores word [id] in the ID table, which must have a free slot. */
+    void insertSlot(WordId id);
+    /** Resizes the ID table to [nSlots] (a power of 2) and stores all IDs again. */
+    void rehashSlots(size_t nSlots);
+
+    /** Buffers a match until finishQuery(), [isUnique] is true if the match needs no deduplication. */
+    inline void addPending(const char *word, size_t size, bool isUnique);
+
+    /** Clears the state of the previous query and bumps the epoch. */
+    void startQuery(Mode newMode);
+    /** Stores the match of word [id] with its distance to matchQuery. */
+    void storeMatch(WordId id);
+    /** Resolves the buffered matches of the current query keeping only the best nTopMatches ones. */
+    void finishTopMatches();
+
+    /** Returns true if [match1] ranks higher than [match2] (see collectTopMatches). */
+    static bool isBetterMatch(const Match &match1, const Match &match2)
+    {
+        if (match1.distance != match2.distance)
+        {
+            return match1.distance < match2.distance;
+        }
+
+        if (match1.payload != match2.payload)
+        {
+            return match1.payload > match2.payload;
+        }
+
+        return match1.id < match2.id;
+    }
+
+    /** All dictionary words concatenated in the order of IDs, with their starts and sizes. */
+    std::vector<char> wordChars;
+    std::vector<size_t> wordStarts;
+    std::vector<uint32_t> wordSizes;
+    /** Payloads in the order of IDs, empty if no payloads have been set. */
+    std::vector<Payload> payloads;
+    /** Tombstones of erased words in the order of IDs (1 = erased), and the number of erased words. */
+    std::vector<uint8_t> erasedFlags;
+    size_t nErased = 0;
+
+    /** Open addressing table (linear probing) holding word IDs, empty slots hold noWordId. */
+    std::vector<WordId> slots;
+    size_t slotMask = 0;
+
+    /** The epoch of the last query which reported each word, and the epoch of the current query. */
+    std::vector<uint32_t> seenEpochs;
+    uint32_t epoch = 0;
+
+    /** Matches of the current query which have not been resolved to IDs yet. */
+    std::vector<PendingMatch> pendingMatches;
+    std::vector<char> pendingChars;
+
+    Mode mode = Mode::Words;
+    ResultSetType *resultSet = nullptr;
+    std::vector<WordId> *wordIds = nullptr;
+
+    /** The query whose matches are stored with distances, and whether mismatch positions are stored. */
+    const char *matchQuery = nullptr;
+    size_t matchQuerySize = 0;
+    std::vector<Match> *matchResults = nullptr;
+    bool withMismatchPositions = false;
+    size_t nTopMatches = 0;
+
+    /** True if a match has been found when checking existence, and the number of matches when counting. */
+    bool found = false;
+    size_t count = 0;
+};
+
+void MatchCollector::add(const char *word, size_t size)
+{
+    if (mode == Mode::Words)
+    {
+        if (nErased == 0 or not isErasedWord(word, size))
+        {
+            resultSet->emplace(word, size);
+        }
+
+        return;
+    }
+
+    if (mode == Mode::Exists)
+    {
+        if (nErased == 0 or not isErasedWord(word, size))
+        {
+            found = true;
+        }
+
+        return;
+    }
+
+    addPending(word, size, false);
+}
+
+void MatchCollector::addUnique(const char *word, size_t size)
+{
+    // Erased words can only be counted after a lookup, so they are buffered as well.
+    if (mode == Mode::Count and nErased == 0)
+    {
+        count += 1;
+        return;
+    }
+
+    if (mode == Mode::WordIds or mode == Mode::Matches or mode == Mode::TopMatches or mode == Mode::Count)
+    {
+        addPending(word, size, true);
+        return;
+    }
+
+    add(word, size);
+}
+
+void MatchCollector::addPending(const char *word, size_t size, bool isUnique)
+{
+    if (slots.empty())
+    {
+        return;
+    }
+
+    const size_t hash = hashWord(word, size);
+    _mm_prefetch(reinterpret_cast<const char *>(&slots[hash & slotMask]), _MM_HINT_T0);
+
+    pendingMatches.push_back({ pendingChars.size(), size, hash, isUnique });
+    pendingChars.insert(pendingChars.end(), word, word + size);
+}
+
+MatchCollector::WordId MatchCollector::findWordId(const char *word, size_t size) const
+{
+    if (slots.empty())
+    {
+        return noWordId;
+    }
+
+    return findWordId(word, size, hashWord(word, size));
+}
+
+MatchCollector::WordId MatchCollector::findWordId(const char *word, size_t size, size_t hash) const
+{
+    for (size_t iSlot = hash & slotMask; ; iSlot = (iSlot + 1) & slotMask)
+    {
+        const WordId id = slots[iSlot];
+
+        if (id == noWordId)
+        {
+            return noWordId;
+        }
+
+        if (wordSizes[id] == size and std::memcmp(wordChars.data() + wordStarts[id], word, size) == 0)
+        {
+            return id;
+        }
+    }
+}
+
+bool MatchCollector::isErasedWord(const char *word, size_t size) const
+{
+    const WordId id = findWordId(word, size);
+    return id != noWordId and erasedFlags[id] != 0;
+}
+
+} // namespace split_index
+
+#endif // MATCH_COLLECTOR_HPP
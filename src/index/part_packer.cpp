@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <boost/format.hpp>
+
+#include "part_packer.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+PartPacker::PartPacker()
+{
+    build({ });
+}
+
+void PartPacker::build(const unordered_set<string> &wordSet)
+{
+    bool isInAlphabet[256] = { };
+
+    for (const string &word : wordSet)
+    {
+        for (const char c : word)
+        {
+            isInAlphabet[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    alphabetSize = 0;
+
+    for (size_t c = 0; c < 256; ++c)
+    {
+        charRanks[c] = foreignRank;
+
+        if (isInAlphabet[c])
+        {
+            alphabet[alphabetSize] = static_cast<char>(c);
+            charRanks[c] = static_cast<uint16_t>(alphabetSize);
+
+            alphabetSize += 1;
+        }
+    }
+
+    nBitsPerChar = 1;
+
+    while ((static_cast<size_t>(1) << nBitsPerChar) < alphabetSize)
+    {
+        nBitsPerChar += 1;
+    }
+
+    nLanes = 64 / nBitsPerChar;
+
+    lowLaneMask = 0;
+    highLaneMask = 0;
+
+    for (size_t iLane = 0; iLane < nLanes; ++iLane)
+    {
+        const uint64_t highBit = static_cast<uint64_t>(1) << (iLane * nBitsPerChar + nBitsPerChar - 1);
+
+        lowLaneMask |= highBit - (static_cast<uint64_t>(1) << (iLane * nBitsPerChar));
+        highLaneMask |= highBit;
+    }
+
+    for (size_t partSize = 0; partSize <= maxPartSize; ++partSize)
+    {
+        packedSizeLUT[partSize] = (partSize / nLanes) * sizeof(uint64_t)
+            + ((partSize % nLanes) * nBitsPerChar + 7) / 8;
+    }
+}
+
+size_t PartPacker::pack(const char *part, size_t partSize, char *out) const
+{
+    assert(partSize <= maxPartSize);
+
+    uint64_t words[maxNWords];
+    uint64_t foreignMasks[maxNWords];
+
+    packQuery(part, partSize, words, foreignMasks);
+
+    const size_t packedSize = packedSizeLUT[partSize];
+    memcpy(out, words, packedSize);
+
+    return packedSize;
+}
+
+void PartPacker::packQuery(const char *part, size_t partSize, uint64_t *words, uint64_t *foreignMasks) const
+{
+    assert(partSize <= maxPartSize);
+    const size_t nWords = calcNWords(partSize);
+
+    for (size_t iWord = 0; iWord < nWords; ++iWord)
+    {
+        words[iWord] = 0;
+        foreignMasks[iWord] = 0;
+    }
+
+    for (size_t i = 0; i < partSize; ++i)
+    {
+        const size_t iWord = i / nLanes;
+        const size_t shift = (i % nLanes) * nBitsPerChar;
+        const uint16_t rank = charRanks[static_cast<unsigned char>(part[i])];
+
+        if (rank == foreignRank)
+        {
+            foreignMasks[iWord] |= static_cast<uint64_t>(1) << (shift + nBitsPerChar - 1);
+        }
+        else
+        {
+            words[iWord] |= static_cast<uint64_t>(rank) << shift;
+        }
+    }
+}
+
+void PartPacker::unpack(const char *packed, size_t partSize, char *out) const
+{
+    const uint64_t charMask = (static_cast<uint64_t>(1) << nBitsPerChar) - 1;
+    const size_t nWords = calcNWords(partSize);
+
+    for (size_t iWord = 0, i = 0; iWord < nWords; ++iWord)
+    {
+        uint64_t word = 0;
+        memcpy(&word, packed + iWord * sizeof(uint64_t),
+            min(sizeof(uint64_t), packedSizeLUT[partSize] - iWord * sizeof(uint64_t)));
+
+        for (size_t iLane = 0; iLane < nLanes and i < partSize; ++iLane, ++i)
+        {
+            out[i] = alphabet[word & charMask];
+            word >>= nBitsPerChar;
+        }
+    }
+}
+
+string PartPacker::toString() const
+{
+    return (boost::format("alphabet size = %1%, #bits per char = %2%, #chars per 64-bit word = %3%")
+        % alphabetSize % nBitsPerChar % nLanes).str();
+}
+
+} // namespace split_index
@@ -0,0 +1,131 @@
+#ifndef PART_PACKER_HPP
+#define PART_PACKER_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+namespace split_index
+{
+
+/** Packs word parts using alphabet ranks, i.e. ceil(log2(sigma)) bits per char for an alphabet of size sigma.
+ * Chars are stored in lanes of 64-bit words (which do not straddle word boundaries), so that packed parts
+ * can be compared lane-wise using SWAR and popcount, without unpacking.
+ * The last word of a packed part is truncated to the bytes that hold its lanes. */
+class PartPacker
+{
+public:
+    PartPacker();
+
+    /** Calculates the alphabet of [wordSet], the resulting number of bits per char and the lane masks. */
+    void build(const std::unordered_set<std::string> &wordSet);
+
+    /** Packs [part] of size [partSize] into [out], all chars must be from the alphabet.
+     * Returns the size of packed part, i.e. calcPackedSize([partSize]). */
+    size_t pack(const char *part, size_t partSize, char *out) const;
+    /** Packs [part] of size [partSize] into whole 64-bit [words], chars outside the alphabet are packed as rank 0
+     * and marked in [foreignMasks] (using the highest bit of each lane), so that they always count as mismatches. */
+    void packQuery(const char *part, size_t partSize, uint64_t *words, uint64_t *foreignMasks) const;
+    /** Unpacks [packed] part having [partSize] chars into [out]. */
+    void unpack(const char *packed, size_t partSize, char *out) const;
+
+    /** Returns true if the Hamming distance between [packed] part and a query part packed into [queryWords]
+     * (with [queryForeignMasks]), both having [partSize] chars, is at most [k]. */
+    inline bool isHammingAtMostK(const char *packed, const uint64_t *queryWords, const uint64_t *queryForeignMasks,
+        size_t partSize, size_t k) const;
+
+    /** Returns true if all chars of [part] of size [partSize] are from the alphabet, i.e. [part] can be packed. */
+    bool isInAlphabet(const char *part, size_t partSize) const
+    {
+        for (size_t i = 0; i < partSize; ++i)
+        {
+            if (charRanks[static_cast<unsigned char>(part[i])] == foreignRank)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Returns the size of packed part for [partSize]. */
+    size_t calcPackedSize(size_t partSize) const { return packedSizeLUT[partSize]; }
+    /** Returns the number of 64-bit words required for a packed part of size [partSize]. */
+    size_t calcNWords(size_t partSize) const { return (partSize + nLanes - 1) / nLanes; }
+
+    size_t getAlphabetSize() const { return alphabetSize; }
+    size_t getNBitsPerChar() const { return nBitsPerChar; }
+
+    std::string toString() const;
+
+    /** The longest part which can be packed. */
+    static constexpr size_t maxPartSize = 255;
+    /** The maximum number of 64-bit words of a packed part (for 8 bits per char). */
+    static constexpr size_t maxNWords = (maxPartSize + 7) / 8;
+
+private:
+    /** Sorted alphabet, i.e. chars indexed by their ranks. */
+    char alphabet[256];
+    /** 0-based ranks of chars, chars outside the alphabet have foreignRank. */
+    uint16_t charRanks[256];
+
+    size_t alphabetSize = 0;
+    size_t nBitsPerChar = 8;
+    /** The number of lanes (chars) per 64-bit word. */
+    size_t nLanes = 8;
+
+    /** All bits except for the highest one, and the highest bit in each lane, respectively. */
+    uint64_t lowLaneMask = 0, highLaneMask = 0;
+
+    size_t packedSizeLUT[maxPartSize + 1];
+
+    static constexpr uint16_t foreignRank = 256;
+};
+
+bool PartPacker::isHammingAtMostK(const char *packed, const uint64_t *queryWords, const uint64_t *queryForeignMasks,
+    size_t partSize, size_t k) const
+{
+    const size_t nFullWords = partSize / nLanes;
+    size_t nMismatches = 0;
+
+    for (size_t iWord = 0; iWord <= nFullWords; ++iWord)
+    {
+        uint64_t word = 0;
+
+        if (iWord < nFullWords)
+        {
+            memcpy(&word, packed + iWord * sizeof(uint64_t), sizeof(uint64_t));
+        }
+        else
+        {
+            const size_t nTailBytes = packedSizeLUT[partSize] - nFullWords * sizeof(uint64_t);
+
+            if (nTailBytes == 0)
+            {
+                break;
+            }
+
+            memcpy(&word, packed + iWord * sizeof(uint64_t), nTailBytes);
+        }
+
+        // Lanes which differ have their highest bit set: either it differs itself,
+        // or adding the low lane mask to the other differing bits carries into it (but never further).
+        const uint64_t diff = word ^ queryWords[iWord];
+        const uint64_t mismatches = (((diff & lowLaneMask) + lowLaneMask) | diff) & highLaneMask;
+
+        nMismatches += __builtin_popcountll(mismatches | queryForeignMasks[iWord]);
+
+        if (nMismatches > k)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace split_index
+
+#endif // PART_PACKER_HPP
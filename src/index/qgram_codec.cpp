@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <boost/format.hpp>
+#include <iostream>
+#include <iterator>
+
+#include "qgram_codec.hpp"
+#include "../utils/parallel.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+QgramCodec::QgramCodec()
+{
+    static_assert(maxQgramSize <= codingBufPadding, "q-grams must fit in the padding of decoding buffers");
+    clear();
+}
+
+string QgramCodec::toString() const
+{
+    string out = (boost::format("#1-byte codes = %1%, #2-byte codes = %2%, compression ratio = %3%\n")
+        % nOneByteCodes % nTwoByteCodes % calcCompressionRatio()).str();
+
+    for (size_t q = 2; q <= maxQgramSize; ++q)
+    {
+        out += (boost::format("#%1%-grams = %2%%3%") % q % nCodesPerQgramSize[q]
+            % ((q < maxQgramSize) ? ", " : "")).str();
+    }
+
+    return out;
+}
+
+void QgramCodec::build(const unordered_set<string> &wordSet)
+{
+    clear();
+
+    // Pairs: [count, q-gram] for all candidates.
+    vector<pair<uint32_t, string>> candidates;
+
+    for (size_t q = 2; q <= maxQgramSize; ++q)
+    {
+        vector<pair<uint32_t, string>> qgramCounts = calcQgramCounts(wordSet, maxNTwoByteCodes, q);
+        std::move(qgramCounts.begin(), qgramCounts.end(), std::back_inserter(candidates));
+    }
+
+    // 1. Single-byte codes are assigned to q-grams which save the most when compared with no encoding at all.
+    // Pairs: [gain, index of the candidate], the gain ignores overlaps.
+    vector<pair<uint64_t, size_t>> gains;
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        gains.emplace_back(static_cast<uint64_t>(candidates[i].first) * (candidates[i].second.size() - 1), i);
+    }
+
+    std::sort(gains.begin(), gains.end(), std::greater<pair<uint64_t, size_t>>());
+
+    for (size_t i = 0; i < gains.size() and nOneByteCodes < maxNOneByteCodes; ++i)
+    {
+        addCode(candidates[gains[i].second].second, static_cast<unsigned char>(firstChar) + nOneByteCodes);
+        nOneByteCodes += 1;
+    }
+
+    // 2. Two-byte codes are assigned to q-grams which save the most when compared with
+    // their encoding using single-byte codes only.
+    gains.clear();
+    char encodedQgram[maxQgramSize];
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        const string &qgram = candidates[i].second;
+
+        if (findCode(qgram.c_str(), qgram.size()) != 0)
+        {
+            continue;
+        }
+
+        const size_t encodedSize = encode(qgram.c_str(), qgram.size(), encodedQgram);
+
+        if (encodedSize > 2)
+        {
+            gains.emplace_back(static_cast<uint64_t>(candidates[i].first) * (encodedSize - 2), i);
+        }
+    }
+
+    std::sort(gains.begin(), gains.end(), std::greater<pair<uint64_t, size_t>>());
+
+    for (size_t i = 0; i < gains.size() and nTwoByteCodes < maxNTwoByteCodes; ++i)
+    {
+        const size_t escapeChar = static_cast<unsigned char>(firstEscapeChar) + nTwoByteCodes / 256;
+
+        addCode(candidates[gains[i].second].second, (escapeChar << 8) | (nTwoByteCodes % 256));
+        nTwoByteCodes += 1;
+    }
+
+    // Statistics are gathered only for words encoded after the codebook is built.
+    nDecodedBytes = 0;
+    nEncodedBytes = 0;
+
+    cout << boost::format("Filled codebook with %1% 1-byte codes and %2% 2-byte codes")
+        % nOneByteCodes % nTwoByteCodes << endl;
+}
+
+void QgramCodec::clear()
+{
+    for (size_t c = 0; c < 256; ++c)
+    {
+        oneByteDecodingLUT[c].qgram[0] = static_cast<char>(c);
+        oneByteDecodingLUT[c].size = 1;
+    }
+
+    twoByteDecodingLUT.assign(maxNTwoByteCodes, QgramDecoding());
+
+    for (size_t q = 0; q <= maxQgramSize; ++q)
+    {
+        packedCodes[q].clear();
+        nCodesPerQgramSize[q] = 0;
+    }
+
+    nOneByteCodes = 0;
+    nTwoByteCodes = 0;
+
+    nDecodedBytes = 0;
+    nEncodedBytes = 0;
+}
+
+size_t QgramCodec::encode(const char *word, size_t wordSize, char *out)
+{
+    if (parseCosts.size() < wordSize + 1)
+    {
+        parseCosts.resize(wordSize + 1);
+        parseSteps.resize(wordSize + 1);
+    }
+
+    parseCosts[wordSize] = 0;
+
+    // We calculate the shortest encoding of each suffix, starting with the shortest one.
+    for (size_t i = wordSize; i-- > 0; )
+    {
+        size_t bestCost = 1 + parseCosts[i + 1];
+        uint8_t bestStep = 1;
+
+        const size_t maxCurQgramSize = std::min(static_cast<size_t>(maxQgramSize), wordSize - i);
+
+        for (size_t curQgramSize = 2; curQgramSize <= maxCurQgramSize; ++curQgramSize)
+        {
+            const uint16_t code = findCode(word + i, curQgramSize);
+
+            if (code == 0)
+            {
+                continue;
+            }
+
+            const size_t cost = ((code < 256) ? 1 : 2) + parseCosts[i + curQgramSize];
+
+            // Ties are resolved in favor of longer q-grams, which are faster to decode.
+            if (cost <= bestCost)
+            {
+                bestCost = cost;
+                bestStep = curQgramSize;
+            }
+        }
+
+        parseCosts[i] = bestCost;
+        parseSteps[i] = bestStep;
+    }
+
+    size_t iOut = 0;
+
+    for (size_t iW = 0; iW < wordSize; iW += parseSteps[iW])
+    {
+        if (parseSteps[iW] == 1)
+        {
+            out[iOut++] = word[iW];
+            continue;
+        }
+
+        const uint16_t code = findCode(word + iW, parseSteps[iW]);
+
+        if (code >= 256)
+        {
+            out[iOut++] = static_cast<char>(code >> 8);
+        }
+
+        out[iOut++] = static_cast<char>(code & 0xFF);
+    }
+
+    assert(iOut == parseCosts[0] and iOut <= wordSize);
+
+    nDecodedBytes += wordSize;
+    nEncodedBytes += iOut;
+
+    return iOut;
+}
+
+double QgramCodec::calcCompressionRatio() const
+{
+    return (nEncodedBytes == 0) ? 1.0 : static_cast<double>(nDecodedBytes) / nEncodedBytes;
+}
+
+void QgramCodec::addCode(const string &qgram, uint16_t code)
+{
+    const size_t curQgramSize = qgram.size();
+    assert(curQgramSize >= 2 and curQgramSize <= maxQgramSize);
+
+    QgramDecoding *decoding;
+
+    if (code < 256)
+    {
+        assert(code >= static_cast<unsigned char>(firstChar) and code < static_cast<unsigned char>(firstEscapeChar));
+        decoding = &oneByteDecodingLUT[code];
+    }
+    else
+    {
+        assert((code >> 8) >= static_cast<unsigned char>(firstEscapeChar) and (code >> 8) < 255u);
+        decoding = &twoByteDecodingLUT[((code >> 8) - static_cast<unsigned char>(firstEscapeChar)) * 256 + (code & 0xFF)];
+    }
+
+    memcpy(decoding->qgram, qgram.c_str(), curQgramSize);
+    decoding->size = curQgramSize;
+
+    packedCodes[curQgramSize][packQgram(qgram.c_str(), curQgramSize)] = code;
+    nCodesPerQgramSize[curQgramSize] += 1;
+}
+
+uint16_t QgramCodec::findCode(const char *qgram, size_t curQgramSize) const
+{
+    const unordered_map<uint64_t, uint16_t> &codes = packedCodes[curQgramSize];
+    auto it = codes.find(packQgram(qgram, curQgramSize));
+
+    return (it != codes.end()) ? it->second : 0;
+}
+
+vector<pair<uint32_t, string>> QgramCodec::calcQgramCounts(const unordered_set<string> &wordSet,
+    size_t curNQgrams, size_t curQgramSize)
+{
+    assert(curQgramSize >= 2 and curQgramSize <= maxCountedQgramSize);
+
+    // Words are counted in parallel, each thread processes a contiguous range of this vector.
+    vector<const string *> words;
+    words.reserve(wordSet.size());
+
+    for (const string &word : wordSet)
+    {
+        words.push_back(&word);
+    }
+
+    uint32_t charRanks[256];
+    const vector<char> alphabet = calcAlphabet(wordSet, charRanks);
+
+    // The number of all possible q-grams over the alphabet, capped in order to avoid overflows.
+    size_t nPossibleQgrams = 1;
+
+    for (size_t i = 0; i < curQgramSize and nPossibleQgrams <= maxNDenseQgramCounters; ++i)
+    {
+        nPossibleQgrams *= alphabet.size();
+    }
+
+    vector<pair<uint64_t, uint32_t>> counts; // Pairs: [packed q-gram, count].
+    const size_t nThreads = utils::Parallel::getNThreads();
+
+    if (nPossibleQgrams <= maxNDenseQgramCounters)
+    {
+        // Small alphabets: each q-gram is mapped to its rank-based index in a dense counter array.
+        vector<vector<uint32_t>> threadCounters(nThreads);
+
+        utils::Parallel::forRanges(words.size(), [&](size_t begin, size_t end, size_t iThread)
+        {
+            vector<uint32_t> &counters = threadCounters[iThread];
+            counters.assign(nPossibleQgrams, 0);
+
+            for (size_t iWord = begin; iWord < end; ++iWord)
+            {
+                const string &word = *words[iWord];
+
+                for (size_t i = 0; i + curQgramSize <= word.size(); ++i)
+                {
+                    size_t index = 0;
+
+                    for (size_t j = curQgramSize; j-- > 0; )
+                    {
+                        index = index * alphabet.size() + charRanks[static_cast<unsigned char>(word[i + j])];
+                    }
+
+                    counters[index] += 1;
+                }
+            }
+        });
+
+        for (size_t iThread = 1; iThread < nThreads; ++iThread)
+        {
+            for (size_t index = 0; index < nPossibleQgrams; ++index)
+            {
+                threadCounters[0][index] += threadCounters[iThread][index];
+            }
+        }
+
+        for (size_t index = 0; index < nPossibleQgrams; ++index)
+        {
+            if (threadCounters[0][index] == 0)
+            {
+                continue;
+            }
+
+            char qgram[maxCountedQgramSize];
+            size_t rest = index;
+
+            for (size_t j = 0; j < curQgramSize; ++j)
+            {
+                qgram[j] = alphabet[rest % alphabet.size()];
+                rest /= alphabet.size();
+            }
+
+            counts.emplace_back(packQgram(qgram, curQgramSize), threadCounters[0][index]);
+        }
+    }
+    else
+    {
+        // Large alphabets: q-grams are packed into integers and counted using hash maps.
+        vector<unordered_map<uint64_t, uint32_t>> threadCounters(nThreads);
+
+        utils::Parallel::forRanges(words.size(), [&](size_t begin, size_t end, size_t iThread)
+        {
+            unordered_map<uint64_t, uint32_t> &counters = threadCounters[iThread];
+
+            for (size_t iWord = begin; iWord < end; ++iWord)
+            {
+                const string &word = *words[iWord];
+
+                for (size_t i = 0; i + curQgramSize <= word.size(); ++i)
+                {
+                    counters[packQgram(word.c_str() + i, curQgramSize)] += 1;
+                }
+            }
+        });
+
+        for (size_t iThread = 1; iThread < nThreads; ++iThread)
+        {
+            for (const auto &kv : threadCounters[iThread])
+            {
+                threadCounters[0][kv.first] += kv.second;
+            }
+        }
+
+        counts.assign(threadCounters[0].begin(), threadCounters[0].end());
+    }
+
+    vector<pair<uint32_t, string>> sorter; // Pairs: [count, qgram].
+    sorter.reserve(counts.size());
+
+    for (const auto &kv : counts)
+    {
+        string qgram(curQgramSize, '\0');
+
+        for (size_t j = 0; j < curQgramSize; ++j)
+        {
+            qgram[j] = static_cast<char>(kv.first >> (8 * j));
+        }
+
+        sorter.emplace_back(kv.second, move(qgram));
+    }
+
+    const size_t availableNQgrams = std::min(sorter.size(), curNQgrams);
+
+    // We sort in order to obtain the highest counts in front (ties are broken by q-grams themselves).
+    std::partial_sort(sorter.begin(), sorter.begin() + availableNQgrams, sorter.end(),
+        std::greater<pair<uint32_t, string>>());
+
+    sorter.resize(availableNQgrams);
+    return sorter;
+}
+
+vector<char> QgramCodec::calcAlphabet(const unordered_set<string> &wordSet, uint32_t *charRanks)
+{
+    bool isInAlphabet[256] = { };
+
+    for (const string &word : wordSet)
+    {
+        for (const char c : word)
+        {
+            isInAlphabet[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    vector<char> alphabet;
+
+    for (size_t c = 0; c < 256; ++c)
+    {
+        charRanks[c] = alphabet.size();
+
+        if (isInAlphabet[c])
+        {
+            alphabet.push_back(static_cast<char>(c));
+        }
+    }
+
+    return alphabet;
+}
+
+} // namespace split_index
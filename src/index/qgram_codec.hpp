@@ -0,0 +1,159 @@
+#ifndef QGRAM_CODEC_HPP
+#define QGRAM_CODEC_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace split_index
+{
+
+/** Q-gram codec with an extended code space of 2- to 6-grams.
+ * Chars from [firstChar, firstEscapeChar) are single-byte codes, while each escape char from [firstEscapeChar, 255)
+ * followed by an arbitrary byte forms a two-byte code, which allows for thousands of q-grams.
+ * Words are encoded using optimal parsing, i.e. each encoding is the shortest possible for the codebook.
+ * Encoded chars must be less than firstChar, this assumes that the code is compiled using unsigned chars. */
+class QgramCodec
+{
+public:
+    QgramCodec();
+
+    /** Builds the codebook for the (most frequent) q-grams from [wordSet]. */
+    void build(const std::unordered_set<std::string> &wordSet);
+    /** Clears the codebook, so that each char is encoded as itself. */
+    void clear();
+
+    /** Encodes [word] of size [wordSize] into [out] using optimal parsing. Returns the size of encoded word,
+     * which is never greater than [wordSize]. */
+    size_t encode(const char *word, size_t wordSize, char *out);
+    /** Decodes [word] of size [wordSize] into [out], which must have codingBufPadding extra bytes.
+     * Returns the size of decoded word or 0 if [maxDecodedWordSize] is exceeded. */
+    inline size_t decode(const char *word, size_t wordSize, size_t maxDecodedWordSize, char *out) const;
+
+    std::string toString() const;
+
+    /** Returns (at most) [curNQgrams] pairs [count, q-gram] for the most frequent q-grams of size [curQgramSize]
+     * in [wordSet], ordered by decreasing count. Counting is performed in parallel. */
+    static std::vector<std::pair<uint32_t, std::string>> calcQgramCounts(const std::unordered_set<std::string> &wordSet,
+        size_t curNQgrams, size_t curQgramSize);
+
+    /** Returns all distinct chars in [wordSet] (sorted) and fills [charRanks] (256 entries)
+     * with the position of each char in the alphabet (meaningful only for chars from the alphabet). */
+    static std::vector<char> calcAlphabet(const std::unordered_set<std::string> &wordSet, uint32_t *charRanks);
+
+    /** Returns [qgram] of size [curQgramSize] packed into an integer (little-endian),
+     * the size cannot exceed maxCountedQgramSize. */
+    static uint64_t packQgram(const char *qgram, size_t curQgramSize)
+    {
+        assert(curQgramSize <= maxCountedQgramSize);
+        uint64_t packed = 0;
+
+        for (size_t i = 0; i < curQgramSize; ++i)
+        {
+            packed |= static_cast<uint64_t>(static_cast<unsigned char>(qgram[i])) << (8 * i);
+        }
+
+        return packed;
+    }
+
+    /** Returns the compression ratio, i.e. the total size of encoded words before encoding
+     * divided by their total size after encoding. */
+    double calcCompressionRatio() const;
+
+    /** The first char which is used for encoding. */
+    static constexpr char firstChar = 128;
+    /** The first char which starts a two-byte code, the rest (until 255 exclusive) is consecutive. */
+    static constexpr char firstEscapeChar = 223;
+    /** The number of escape chars. */
+    static constexpr size_t nEscapeChars = 255 - 223;
+    /** The number of single-byte and two-byte codes available. */
+    static constexpr size_t maxNOneByteCodes = 223 - 128;
+    static constexpr size_t maxNTwoByteCodes = nEscapeChars * 256;
+
+    /** The longest q-gram which can be assigned a code. */
+    static constexpr size_t maxQgramSize = 6;
+    /** The longest q-gram which can be counted (and packed into a 64-bit integer). */
+    static constexpr size_t maxCountedQgramSize = 8;
+    /** The number of extra bytes required in decoding buffers, since decoding always copies whole fixed-size q-grams. */
+    static constexpr size_t codingBufPadding = 8;
+    /** Q-grams are counted using dense arrays only if the number of all possible q-grams does not exceed this value. */
+    static constexpr size_t maxNDenseQgramCounters = 1 << 22;
+
+private:
+    /** Assigns [code] to [qgram], codes which are not less than 256 consist of an escape char (the higher byte)
+     * followed by the lower byte. */
+    void addCode(const std::string &qgram, uint16_t code);
+
+    /** Returns the code for a q-gram of size [curQgramSize] starting at [qgram], or 0 if it is not encoded. */
+    uint16_t findCode(const char *qgram, size_t curQgramSize) const;
+
+    /** A single decoding table entry, q-grams are padded so that they can be always copied as a whole. */
+    struct QgramDecoding
+    {
+        char qgram[codingBufPadding];
+        uint8_t size;
+    };
+
+    /** A flat decoding table for single-byte codes, other chars are decoded to themselves. */
+    QgramDecoding oneByteDecodingLUT[256];
+    /** A flat decoding table for two-byte codes, indexed by (escape char - firstEscapeChar) * 256 + the second byte. */
+    std::vector<QgramDecoding> twoByteDecodingLUT;
+
+    /** Packed q-grams and their codes, indexed by the q-gram size. */
+    std::unordered_map<uint64_t, uint16_t> packedCodes[maxQgramSize + 1];
+
+    /** The number of single-byte and two-byte codes which have been assigned. */
+    size_t nOneByteCodes = 0, nTwoByteCodes = 0;
+    /** The number of codes assigned to q-grams of each size. */
+    size_t nCodesPerQgramSize[maxQgramSize + 1];
+
+    /** Total sizes of encoded words before and after encoding. */
+    size_t nDecodedBytes = 0, nEncodedBytes = 0;
+
+    /** Temporarily store the shortest encoded size of each word suffix and the size of q-gram
+     * (or 1 for a literal char) chosen at each position during optimal parsing. */
+    std::vector<size_t> parseCosts;
+    std::vector<uint8_t> parseSteps;
+};
+
+size_t QgramCodec::decode(const char *word, size_t wordSize, size_t maxDecodedWordSize, char *out) const
+{
+    const unsigned char *uWord = reinterpret_cast<const unsigned char *>(word);
+    size_t iOut = 0;
+
+    for (size_t iW = 0; iW < wordSize; )
+    {
+        const QgramDecoding *decoding;
+
+        if (uWord[iW] >= static_cast<unsigned char>(firstEscapeChar))
+        {
+            decoding = &twoByteDecodingLUT[(uWord[iW] - static_cast<unsigned char>(firstEscapeChar)) * 256 + uWord[iW + 1]];
+            iW += 2;
+        }
+        else
+        {
+            decoding = &oneByteDecodingLUT[uWord[iW]];
+            iW += 1;
+        }
+
+        // We always copy the whole padded q-gram, the output buffer has some extra space for this purpose.
+        memcpy(out + iOut, decoding->qgram, codingBufPadding);
+        iOut += decoding->size;
+
+        if (iOut > maxDecodedWordSize)
+        {
+            return 0;
+        }
+    }
+
+    return iOut;
+}
+
+} // namespace split_index
+
+#endif // QGRAM_CODEC_HPP
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <boost/format.hpp>
+#include <stdexcept>
+
+#include "spaced_seeds.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+SpacedSeeds::SpacedSeeds(size_t nPartsArg, size_t blockSizeArg, size_t maxWordSizeArg)
+    :nParts(nPartsArg), blockSize(blockSizeArg), maxWordSize(maxWordSizeArg)
+{
+    if (nParts == 0 or blockSize == 0)
+    {
+        throw invalid_argument("#parts and block size must be positive");
+    }
+
+    if (maxWordSize > maxSupportedWordSize)
+    {
+        throw invalid_argument("max word size cannot exceed 256");
+    }
+
+    permutations.resize((maxWordSize + 1) * nParts);
+    partSizes.assign((maxWordSize + 1) * nParts, 0);
+    shuffleMasks.assign((maxSimdWordSize + 1) * nParts * nMaskBytes, 0x80);
+
+    for (size_t wordSize = nParts; wordSize <= maxWordSize; ++wordSize)
+    {
+        for (size_t iPart = 0; iPart < nParts; ++iPart)
+        {
+            fillPermutation(wordSize, iPart);
+        }
+    }
+}
+
+void SpacedSeeds::scatter(const char *gathered, size_t wordSize, size_t iPart, char *out) const
+{
+    assert(wordSize >= nParts and wordSize <= maxWordSize and iPart < nParts);
+    const vector<uint8_t> &permutation = permutations[wordSize * nParts + iPart];
+
+    for (size_t i = 0; i < wordSize; ++i)
+    {
+        out[permutation[i]] = gathered[i];
+    }
+}
+
+size_t SpacedSeeds::getBlockSize(size_t wordSize) const
+{
+    // Each part must get at least one block.
+    return std::max<size_t>(1, std::min(blockSize, wordSize / nParts));
+}
+
+string SpacedSeeds::toString() const
+{
+    return (boost::format("#parts = %1%, block size = %2%%3%")
+        % nParts % blockSize % (blockSize == 1 ? " (interleaved)" : "")).str();
+}
+
+void SpacedSeeds::fillPermutation(size_t wordSize, size_t iPart)
+{
+    const size_t curBlockSize = getBlockSize(wordSize);
+    vector<uint8_t> &permutation = permutations[wordSize * nParts + iPart];
+
+    permutation.clear();
+
+    // Chars of the part go first, other chars follow.
+    for (size_t pos = 0; pos < wordSize; ++pos)
+    {
+        if ((pos / curBlockSize) % nParts == iPart)
+        {
+            permutation.push_back(static_cast<uint8_t>(pos));
+        }
+    }
+
+    partSizes[wordSize * nParts + iPart] = permutation.size();
+    assert(not permutation.empty());
+
+    for (size_t pos = 0; pos < wordSize; ++pos)
+    {
+        if ((pos / curBlockSize) % nParts != iPart)
+        {
+            permutation.push_back(static_cast<uint8_t>(pos));
+        }
+    }
+
+    assert(permutation.size() == wordSize);
+
+    if (wordSize > maxSimdWordSize)
+    {
+        return;
+    }
+
+    uint8_t *masks = shuffleMasks.data() + (wordSize * nParts + iPart) * nMaskBytes;
+
+    for (size_t i = 0; i < wordSize; ++i)
+    {
+        const size_t iChunk = i / 16, iByte = i % 16;
+
+        if (permutation[i] < 16)
+        {
+            masks[iChunk * 32 + iByte] = permutation[i];
+        }
+        else
+        {
+            masks[iChunk * 32 + 16 + iByte] = permutation[i] - 16;
+        }
+    }
+}
+
+} // namespace split_index
@@ -0,0 +1,105 @@
+#ifndef SPACED_SEEDS_HPP
+#define SPACED_SEEDS_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace split_index
+{
+
+/** Defines word parts as spaced seeds, i.e. sets of positions which are not necessarily contiguous.
+ * Positions are grouped in blocks of blockSize chars, and block i belongs to part (i mod nParts),
+ * so blockSize = 1 gives interleaved parts, and larger blocks give patterned parts.
+ * Parts partition all positions, hence any two words having at most (nParts - 1) mismatches
+ * share at least one exact part (seed).
+ * Parts are extracted by permuting the word so that the chars of a given part come first (see gather),
+ * which is done using byte shuffles for words of up to maxSimdWordSize chars. */
+class SpacedSeeds
+{
+public:
+    /** Throws if [nParts] or [blockSize] is 0. */
+    SpacedSeeds(size_t nParts, size_t blockSize, size_t maxWordSize);
+
+    /** Stores chars of part [iPart] of [word] of size [wordSize] in [out], followed by all other chars of [word]
+     * (both in the order of positions). [word] must be readable for max(wordSize, maxSimdWordSize) bytes
+     * and [out] must be writable for max(wordSize, maxSimdWordSize) bytes. */
+    inline void gather(const char *word, size_t wordSize, size_t iPart, char *out) const;
+    /** Reverses gather, i.e. stores the word of size [wordSize] whose part [iPart] followed by other chars
+     * is [gathered] in [out]. */
+    void scatter(const char *gathered, size_t wordSize, size_t iPart, char *out) const;
+
+    /** Returns the number of chars of part [iPart] for [wordSize]. */
+    size_t getPartSize(size_t wordSize, size_t iPart) const { return partSizes[wordSize * nParts + iPart]; }
+    /** Returns the block size used for [wordSize], which is lowered for short words so that no part is empty. */
+    size_t getBlockSize(size_t wordSize) const;
+
+    size_t getNParts() const { return nParts; }
+
+    std::string toString() const;
+
+    /** Words of up to this size are permuted using byte shuffles. */
+    static constexpr size_t maxSimdWordSize = 32;
+    /** Positions are stored as bytes, which limits the word size. */
+    static constexpr size_t maxSupportedWordSize = 256;
+
+private:
+    /** Fills the positions and shuffle masks for [wordSize] and part [iPart]. */
+    void fillPermutation(size_t wordSize, size_t iPart);
+
+    const size_t nParts, blockSize, maxWordSize;
+
+    /** Positions of chars for each word size and part, i.e. out[i] = word[permutations[wordSize * nParts + iPart][i]]. */
+    std::vector<std::vector<uint8_t>> permutations;
+    std::vector<size_t> partSizes;
+
+    /** Shuffle masks for each word size (up to maxSimdWordSize) and part: for each 16-byte chunk of the output,
+     * a mask selecting from the first 16 bytes of the word followed by a mask selecting from the next 16 bytes. */
+    std::vector<uint8_t> shuffleMasks;
+
+    static constexpr size_t nMaskBytes = 4 * 16;
+};
+
+void SpacedSeeds::gather(const char *word, size_t wordSize, size_t iPart, char *out) const
+{
+    assert(wordSize >= nParts and wordSize <= maxWordSize and iPart < nParts);
+
+#ifdef __SSSE3__
+    if (wordSize <= maxSimdWordSize)
+    {
+        const uint8_t *masks = shuffleMasks.data() + (wordSize * nParts + iPart) * nMaskBytes;
+
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(word));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(word + 16));
+
+        // Mask bytes with the highest bit set produce zeros, so both halves can be ORed.
+        for (size_t iChunk = 0; iChunk * 16 < wordSize; ++iChunk)
+        {
+            const __m128i loMask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks + iChunk * 32));
+            const __m128i hiMask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks + iChunk * 32 + 16));
+
+            const __m128i chunk = _mm_or_si128(_mm_shuffle_epi8(lo, loMask), _mm_shuffle_epi8(hi, hiMask));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + iChunk * 16), chunk);
+        }
+
+        return;
+    }
+#endif
+
+    const std::vector<uint8_t> &permutation = permutations[wordSize * nParts + iPart];
+
+    for (size_t i = 0; i < wordSize; ++i)
+    {
+        out[i] = word[permutation[i]];
+    }
+}
+
+} // namespace split_index
+
+#endif // SPACED_SEEDS_HPP
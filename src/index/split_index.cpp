@@ -4,6 +4,7 @@
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
+#include <typeinfo>
 
 #include "split_index.hpp"
 #include "../utils/string_utils.hpp"
@@ -29,29 +30,204 @@ SplitIndex::~SplitIndex()
 
 void SplitIndex::construct()
 {
-    const int nBucketsHint = std::max(1, static_cast<int>(nBucketsHintFactor * wordSet.size()));
+    constructed = false;
+
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
     hashMap->clear(nBucketsHint);
+    subIndexes.clear();
+
+    if (packKeys)
+    {
+        keyPacker.build(wordSet);
+    }
+    else
+    {
+        keyPacker.clear();
+    }
 
     cout << "Set a hash map with hint #buckets = " << nBucketsHint << endl << endl;
     int i = 1;
 
-    const size_t minWordSize = getMinWordSize();
-
     for (const string &word : wordSet)
     {
         utils::StringUtils::printProgress(string("Constructing the hash map"), i++, wordSet.size());
 
-        if (word.size() < minWordSize or word.size() > maxWordSize)
+        checkWordSize(word);
+        initEntry(word);
+    }
+
+    matchCollector.build(wordSet);
+
+    if (not wordPayloads.empty())
+    {
+        matchCollector.setPayloads(wordPayloads);
+    }
+
+    constructed = true;
+}
+
+bool SplitIndex::insert(const string &word)
+{
+    checkWordSize(word);
+
+    if (not wordSet.insert(word).second)
+    {
+        return false;
+    }
+
+    if (not constructed)
+    {
+        return true;
+    }
+
+    const WordId id = matchCollector.findWordId(word.c_str(), word.size());
+    const auto it = wordPayloads.find(word);
+    const Payload payload = (it != wordPayloads.end()) ? it->second : 0;
+
+    // The word has been erased but it is still stored in the entries, so only its tombstone is removed.
+    // Its payload might have changed since it has been added.
+    if (id != MatchCollector::noWordId)
+    {
+        matchCollector.setErased(id, false);
+        matchCollector.setPayload(id, payload);
+        return true;
+    }
+
+    if (not canInsertInPlace(word))
+    {
+        compact();
+        return true;
+    }
+
+    initEntry(word);
+    matchCollector.addWord(word.c_str(), word.size(), payload);
+
+    return true;
+}
+
+bool SplitIndex::erase(const string &word)
+{
+    if (wordSet.erase(word) == 0)
+    {
+        return false;
+    }
+
+    if (not constructed)
+    {
+        return true;
+    }
+
+    const WordId id = matchCollector.findWordId(word.c_str(), word.size());
+    assert(id != MatchCollector::noWordId);
+
+    matchCollector.setErased(id, true);
+
+    if (compactionThreshold > 0.0f and getNErasedWords() > compactionThreshold * getNWords())
+    {
+        compact();
+    }
+
+    return true;
+}
+
+void SplitIndex::compact()
+{
+    assert(constructed);
+
+    // An empty index cannot be constructed, so erased words stay in the entries.
+    if (wordSet.empty())
+    {
+        return;
+    }
+
+    construct();
+    nRebuilds += 1;
+}
+
+size_t SplitIndex::merge(const SplitIndex &other)
+{
+    if (not hasSameConfig(other))
+    {
+        throw runtime_error("cannot merge split indexes of different types or configurations");
+    }
+
+    vector<const string *> newWords;
+    bool isInPlace = true;
+
+    for (const string &word : other.wordSet)
+    {
+        if (contains(word))
         {
-            throw runtime_error((boost::format("bad word size: %1% not in [%2%, %3%]")
-                % word.size() % minWordSize % maxWordSize).str());
+            continue;
         }
 
-        assert(word.size() > 0 and word.size() <= maxWordSize);
-        initEntry(word);
+        checkWordSize(word);
+        newWords.push_back(&word);
+
+        isInPlace = isInPlace and canInsertInPlace(word);
+
+        // Payloads are stored by insert() and by rebuilds, both of which read them from wordPayloads.
+        // Words erased from this index are merged as well, with the payloads from [other].
+        const auto it = other.wordPayloads.find(word);
+
+        if (it != other.wordPayloads.end())
+        {
+            wordPayloads[word] = it->second;
+        }
     }
 
-    constructed = true;
+    if (not constructed or not isInPlace)
+    {
+        for (const string *word : newWords)
+        {
+            wordSet.insert(*word);
+        }
+
+        // Rebuilding once is cheaper than rebuilding for each word which does not fit (see insert).
+        if (constructed)
+        {
+            compact();
+        }
+
+        return newWords.size();
+    }
+
+    // Sub-indexes are built once for all merged words instead of after each of them (see insert).
+    subIndexes.clear();
+    areSubIndexesDeferred = true;
+
+    for (const string *word : newWords)
+    {
+        insert(*word);
+    }
+
+    areSubIndexesDeferred = false;
+    buildSubIndexes();
+
+    return newWords.size();
+}
+
+bool SplitIndex::isErased(const string &word) const
+{
+    if (not constructed)
+    {
+        return false;
+    }
+
+    const WordId id = matchCollector.findWordId(word.c_str(), word.size());
+    return id != MatchCollector::noWordId and matchCollector.isErased(id);
+}
+
+bool SplitIndex::canInsertInPlace(const string &word) const
+{
+    // Packed keys can only hold chars from the alphabet of the dictionary.
+    return not keyPacker.isEnabled() or keyPacker.isInAlphabet(word.c_str(), word.size());
+}
+
+bool SplitIndex::hasSameConfig(const SplitIndex &other) const
+{
+    return typeid(*this) == typeid(other) and packKeys == other.packKeys and tuneSplitPoints == other.tuneSplitPoints
+        and subIndexThreshold == other.subIndexThreshold;
 }
 
 string SplitIndex::toString() const
@@ -66,60 +242,234 @@ string SplitIndex::toString() const
         % wordSet.size() % wordsSizeKB).str();
 
     ret += "\n" + hashMap->toString();
+
+    if (keyPacker.isEnabled())
+    {
+        ret += "\nWith packed keys: " + keyPacker.toString();
+    }
+
+    if (tuneSplitPoints)
+    {
+        ret += "\nWith tuned split points: #word sizes changed = " + to_string(nTunedWordSizes);
+    }
+
+    if (not subIndexes.empty())
+    {
+        ret += (boost::format("\nWith entry sub-indexes: #entries = %1%, size = %2% KB")
+            % subIndexes.size() % (subIndexes.calcSizeB() / 1024.0f)).str();
+    }
+
+    ret += (boost::format("\nWith match collector: #word IDs = %1%, size = %2% KB")
+        % matchCollector.getNWords() % (matchCollector.calcSizeB() / 1024.0f)).str();
+
     return ret;
 }
 
 SplitIndex::ResultSetType SplitIndex::search(const vector<string> &queries, int nIter)
 {
-    assert(constructed);
+    BatchResults results;
+    searchBatch(queries, results, nIter);
+
     ResultSetType ret;
 
-    // We check whether all supplied queries are of sufficient length before
-    // performing the search and time measurement.
-    const size_t minWordSize = getMinWordSize();
+    for (WordId id : results.wordIds)
+    {
+        ret.emplace(getWordChars(id), getWordSize(id));
+    }
 
-    for (const string &query : queries)
+    return ret;
+}
+
+SplitIndex::ResultSetType SplitIndex::searchAndDumpMatchCounts(const vector<string> &queries)
+{
+    BatchResults results;
+    searchBatch(queries, results);
+
+    ResultSetType ret;
+
+    for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
     {
-        if (query.size() < minWordSize or query.size() > maxWordSize)
+        cout << queries[iQuery] << " -> " << results.getNMatches(iQuery) << endl;
+
+        for (const WordId *it = results.begin(iQuery); it != results.end(iQuery); ++it)
         {
-            throw runtime_error((boost::format("bad query size: %1% not in [%2%, %3%]")
-                % query.size() % minWordSize % maxWordSize).str());
+            ret.emplace(getWordChars(*it), getWordSize(*it));
         }
     }
 
-    clock_t start = std::clock();
+    return ret;
+}
 
-    for (int i = 0; i < nIter; ++i)
+void SplitIndex::searchBatch(const vector<string> &queries, BatchResults &results, int nIter)
+{
+    assert(constructed);
+
+    // We check whether all supplied queries are of sufficient length before
+    // performing the search and time measurement.
+    checkQuerySizes(queries);
+
+    results.offsets.reserve(queries.size() + 1);
+
+    measureSearch(nIter, [&]()
     {
+        results.offsets.clear();
+        results.wordIds.clear();
+        results.offsets.push_back(0);
+
         for (const string &query : queries)
         {
-            processQuery(query, ret);
+            matchCollector.appendWordIds(results.wordIds);
+            processQuery(query, matchCollector);
+            matchCollector.finishQuery();
+
+            results.offsets.push_back(results.wordIds.size());
         }
-    }
+    });
+}
 
-    clock_t end = std::clock();
+void SplitIndex::searchExists(const vector<string> &queries, vector<char> &found, int nIter)
+{
+    assert(constructed);
+    checkQuerySizes(queries);
 
-    const float elapsedS = (end - start) / static_cast<float>(CLOCKS_PER_SEC);
-    elapsedUs = elapsedS * 1000000.0f;
+    found.resize(queries.size());
 
-    return ret;
+    measureSearch(nIter, [&]()
+    {
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            matchCollector.collectExistence();
+            processQuery(queries[iQuery], matchCollector);
+
+            found[iQuery] = matchCollector.hasMatch() ? 1 : 0;
+        }
+    });
 }
 
-SplitIndex::ResultSetType SplitIndex::searchAndDumpMatchCounts(const vector<string> &queries)
+void SplitIndex::searchCount(const vector<string> &queries, vector<size_t> &counts, int nIter)
 {
     assert(constructed);
-    ResultSetType ret;
+    checkQuerySizes(queries);
 
-    for (const string &query : queries)
+    counts.resize(queries.size());
+
+    measureSearch(nIter, [&]()
     {
-        ResultSetType curResults;
-        processQuery(query, curResults);
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            matchCollector.collectCount();
+            processQuery(queries[iQuery], matchCollector);
+            matchCollector.finishQuery();
+
+            counts[iQuery] = matchCollector.getCount();
+        }
+    });
+}
 
-        cout << query << " -> " << curResults.size() << endl;
-        ret.insert(curResults.begin(), curResults.end());
+void SplitIndex::searchWordIds(const string &query, vector<WordId> &ids)
+{
+    assert(constructed);
+    checkQuerySize(query);
+
+    matchCollector.collectWordIds(ids);
+    processQuery(query, matchCollector);
+    matchCollector.finishQuery();
+}
+
+void SplitIndex::searchMatches(const string &query, vector<Match> &matches, bool withPositions)
+{
+    assert(constructed);
+    checkQuerySize(query);
+
+    matchCollector.collectMatches(query.c_str(), query.size(), matches, withPositions);
+    processQuery(query, matchCollector);
+    matchCollector.finishQuery();
+}
+
+void SplitIndex::searchTopMatches(const string &query, size_t nTop, vector<Match> &matches)
+{
+    assert(constructed);
+    checkQuerySize(query);
+
+    matchCollector.collectTopMatches(query.c_str(), query.size(), nTop, matches);
+    processQuery(query, matchCollector);
+    matchCollector.finishQuery();
+}
+
+void SplitIndex::searchTopMatches(const vector<string> &queries, size_t nTop, vector<vector<Match>> &matches,
+    int nIter)
+{
+    assert(constructed);
+    checkQuerySizes(queries);
+
+    matches.resize(queries.size());
+
+    measureSearch(nIter, [&]()
+    {
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            matchCollector.collectTopMatches(queries[iQuery].c_str(), queries[iQuery].size(), nTop, matches[iQuery]);
+            processQuery(queries[iQuery], matchCollector);
+            matchCollector.finishQuery();
+        }
+    });
+}
+
+bool SplitIndex::searchExists(const string &query)
+{
+    assert(constructed);
+    checkQuerySize(query);
+
+    matchCollector.collectExistence();
+    processQuery(query, matchCollector);
+
+    return matchCollector.hasMatch();
+}
+
+size_t SplitIndex::searchCount(const string &query)
+{
+    assert(constructed);
+    checkQuerySize(query);
+
+    matchCollector.collectCount();
+    processQuery(query, matchCollector);
+    matchCollector.finishQuery();
+
+    return matchCollector.getCount();
+}
+
+void SplitIndex::checkWordSize(const string &word) const
+{
+    const size_t minWordSize = getMinWordSize();
+    const size_t curMaxWordSize = getMaxWordSize();
+
+    if (word.size() < minWordSize or word.size() > curMaxWordSize)
+    {
+        throw runtime_error((boost::format("bad word size: %1% not in [%2%, %3%]")
+            % word.size() % minWordSize % curMaxWordSize).str());
     }
 
-    return ret;
+    assert(word.size() > 0 and word.size() <= maxWordSize);
+}
+
+void SplitIndex::checkQuerySize(const string &query) const
+{
+    const size_t minWordSize = getMinWordSize();
+    const size_t curMaxWordSize = getMaxWordSize();
+
+    if (query.size() < minWordSize or query.size() > curMaxWordSize)
+    {
+        throw runtime_error((boost::format("bad query size: %1% not in [%2%, %3%]")
+            % query.size() % minWordSize % curMaxWordSize).str());
+    }
+}
+
+void SplitIndex::checkQuerySizes(const vector<string> &queries) const
+{
+    for (const string &query : queries)
+    {
+        checkQuerySize(query);
+    }
 }
 
 long SplitIndex::calcWordsSizeB() const
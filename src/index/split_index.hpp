@@ -1,13 +1,22 @@
 #ifndef SPLIT_INDEX_HPP
 #define SPLIT_INDEX_HPP
 
+#include <algorithm>
+#include <cassert>
+#include <ctime>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "../hash_function/hash_functions.hpp"
 #include "../hash_map/hash_map.hpp"
+#include "../utils/size_coding.hpp"
+
+#include "entry_sub_index.hpp"
+#include "key_packer.hpp"
+#include "match_collector.hpp"
 
 namespace split_index
 {
@@ -17,7 +26,27 @@ class SplitIndex
 {
 public:
     /** Defines the type containing all matches reported by the split index. */
-    using ResultSetType = std::unordered_set<std::string>;
+    using ResultSetType = MatchCollector::ResultSetType;
+    /** IDs of dictionary words, assigned during construction (see getWordChars). */
+    using WordId = MatchCollector::WordId;
+    /** A matching word with its distance, mismatch positions and payload (see searchMatches). */
+    using Match = MatchCollector::Match;
+    /** A fixed-size payload attached to each dictionary word, e.g. its frequency (see setWordPayloads). */
+    using Payload = MatchCollector::Payload;
+
+    /** Matches of a batch of queries in the CSR layout: the IDs of words matching query i (each once) are
+     * wordIds[offsets[i]], ..., wordIds[offsets[i + 1] - 1]. Buffers are reused when results are passed again. */
+    struct BatchResults
+    {
+        std::vector<size_t> offsets;
+        std::vector<WordId> wordIds;
+
+        size_t getNQueries() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        size_t getNMatches(size_t iQuery) const { return offsets[iQuery + 1] - offsets[iQuery]; }
+        /** Returns the range of word IDs matching query [iQuery]. */
+        const WordId *begin(size_t iQuery) const { return wordIds.data() + offsets[iQuery]; }
+        const WordId *end(size_t iQuery) const { return wordIds.data() + offsets[iQuery + 1]; }
+    };
 
     SplitIndex(const std::unordered_set<std::string> &wordSetArg);
     virtual ~SplitIndex();
@@ -25,50 +54,271 @@ public:
     virtual void construct();
     virtual std::string toString() const;
 
-    /** Performs a search for [queries] and returns the set of matching words, iterates [nIter] times. */
+    /** Performs a search for [queries] and returns the set of matching words (the union over all queries),
+     * iterates [nIter] times. The set is built from batch results (see searchBatch) after time measurement. */
     ResultSetType search(const std::vector<std::string> &queries, int nIter = 1);
 
     /** Performs a search for [queries] and returns the set of matching words.
-     * The number of matches for each query is dumped to standard output. Time measurement is not performed. */
+     * The number of matches for each query is dumped to standard output. */
     ResultSetType searchAndDumpMatchCounts(const std::vector<std::string> &queries);
 
+    /** Performs a search for [queries] and stores the matches of each query in [results], iterates [nIter] times
+     * (results are those of the last iteration). Time measurement is performed (see getElapsedUs). */
+    void searchBatch(const std::vector<std::string> &queries, BatchResults &results, int nIter = 1);
+
+    /** Performs a search for [queries] and calls [callback](iQuery, wordId) for each match (each word once per query),
+     * iterates [nIter] times. Time measurement is performed and includes the callback. */
+    template<typename Callback>
+    void forEachMatch(const std::vector<std::string> &queries, Callback callback, int nIter = 1);
+
+    /** Performs a search for a single [query] and stores the IDs of matching words (each once) in [ids],
+     * which is cleared first. No memory is allocated apart from growing [ids], so reusing [ids] across queries
+     * makes the query path allocation-free. Time measurement is not performed. */
+    void searchWordIds(const std::string &query, std::vector<WordId> &ids);
+
+    /** Performs a search for a single [query] and stores matching words (each once) with their Hamming distances
+     * in [matches], which is cleared first. If [withPositions] is true, the positions of mismatches are also stored.
+     * Matches are ordered by distance (and then by word ID), so that the closest ones come first.
+     * As with searchWordIds, no memory is allocated apart from growing [matches]. */
+    void searchMatches(const std::string &query, std::vector<Match> &matches, bool withPositions = false);
+
+    /** Performs a search for a single [query] and stores at most [nTop] best matches in [matches] (cleared first),
+     * ranked by distance and then by payload (descending), the best one first. Candidates are verified as when
+     * searching for all matches, only the lookup of their word IDs is pruned (see MatchCollector::collectTopMatches).
+     * No memory is allocated apart from growing [matches]. */
+    void searchTopMatches(const std::string &query, size_t nTop, std::vector<Match> &matches);
+    /** Performs searchTopMatches for each of [queries] storing the results in [matches] (one vector per query),
+     * iterates [nIter] times. Time measurement is performed (see getElapsedUs). */
+    void searchTopMatches(const std::vector<std::string> &queries, size_t nTop,
+        std::vector<std::vector<Match>> &matches, int nIter = 1);
+
+    /** Returns true if any dictionary word matches [query], the search stops at the first match.
+     * Indexes which store words of many sizes under a single key search their smallest entries first. */
+    bool searchExists(const std::string &query);
+    /** Returns the number of dictionary words matching [query], matches are not materialized. */
+    size_t searchCount(const std::string &query);
+
+    /** Stores 1 in [found] for each query having a match (0 otherwise), iterates [nIter] times.
+     * Time measurement is performed (see getElapsedUs). */
+    void searchExists(const std::vector<std::string> &queries, std::vector<char> &found, int nIter = 1);
+    /** Stores the number of matches of each query in [counts], iterates [nIter] times.
+     * Time measurement is performed (see getElapsedUs). */
+    void searchCount(const std::vector<std::string> &queries, std::vector<size_t> &counts, int nIter = 1);
+
+    /** Inserts [word] into the dictionary, returns false if it is already present. Before construction only the word
+     * set is updated. Afterwards the word is stored in place and it gets the next word ID, unless it does not fit
+     * the layout chosen during construction (e.g. it has chars outside a packed alphabet), in which case
+     * the index is rebuilt. Throws if the size of [word] is not supported. */
+    bool insert(const std::string &word);
+    /** Erases [word] from the dictionary, returns false if it is not present. After construction the word gets
+     * a tombstone (by its ID), so that it is no longer reported, while its parts stay in the entries
+     * until the index is compacted, which happens once the ratio of erased words crosses the compaction threshold
+     * (if it is set, see setCompactionThreshold) or when compact() is called. */
+    bool erase(const std::string &word);
+    /** Rebuilds the index from present words (unless there are none), dropping erased ones, this reassigns word IDs. */
+    void compact();
+    /** Adds the words of [other] (e.g. a shard built from another dictionary) with their payloads to this index,
+     * and returns the number of added words. Both indexes must be of the same type and configuration,
+     * otherwise this throws. After construction the words are stored in place (see insert) and existing
+     * entries are not rebuilt, unless any of the words does not fit the layout, in which case the index
+     * is rebuilt once. Words erased from this index are merged as well, and they get the payloads from [other].
+     * [other] is not changed. */
+    size_t merge(const SplitIndex &other);
+
+    /** Sets the ratio of erased words to all word IDs above which erase() compacts the index, 0 disables compaction. */
+    void setCompactionThreshold(float compactionThresholdArg) { compactionThreshold = compactionThresholdArg; }
+    /** Returns the number of erased words which are still stored in the entries. */
+    size_t getNErasedWords() const { return matchCollector.getNErased(); }
+    /** Returns the number of times the index has been rebuilt after construction (see insert and erase). */
+    size_t getNRebuilds() const { return nRebuilds; }
+
+    /** The default ratio of erased words above which the index is compacted. Compaction rebuilds the whole index
+     * within the erase() call which crosses the threshold, so it is disabled by default. */
+    static constexpr float defaultCompactionThreshold = 0.0f;
+
+    /** Returns true if [word] is in the dictionary, i.e. it has been inserted and not erased. */
+    bool contains(const std::string &word) const { return wordSet.count(word) != 0; }
+    /** Returns true if [word] is still stored in the entries but it has been erased (i.e. it has a tombstone). */
+    bool isErased(const std::string &word) const;
+    /** Returns the words which are in the dictionary, i.e. without erased ones. */
+    const std::unordered_set<std::string> &getWordSet() const { return wordSet; }
+
+    /** Returns the number of dictionary words including erased ones, i.e. the upper bound (exclusive) of word IDs. */
+    size_t getNWords() const { return matchCollector.getNWords(); }
+    /** Returns the chars of word [id], which are owned by the index and are not 0-terminated. */
+    const char *getWordChars(WordId id) const { return matchCollector.getWordChars(id); }
+    size_t getWordSize(WordId id) const { return matchCollector.getWordSize(id); }
+    std::string getWord(WordId id) const { return std::string(getWordChars(id), getWordSize(id)); }
+    Payload getPayload(WordId id) const { return matchCollector.getPayload(id); }
+
     /** Returns the total size of stored words in bytes. */
     long calcWordsSizeB() const;
-    /* Returns the size of the underlying hash map in bytes. */
-    long calcHashMapSizeB() const { return hashMap->calcTotalSizeB(); }
+    /* Returns the size of the underlying hash map in bytes, including the match collector, which keeps
+     * its own contiguous copy of all dictionary words. */
+    virtual long calcHashMapSizeB() const
+    {
+        return hashMap->calcTotalSizeB() + subIndexes.calcSizeB() + matchCollector.calcSizeB();
+    }
 
     /** Returns the time elapsed during the search in microseconds (us). */
     float getElapsedUs() const { return elapsedUs; }
 
+    /** Sets the payloads of dictionary words (other words get 0), this takes effect on the next construct(),
+     * after which payloads are stored with the words in the order of their IDs. */
+    void setWordPayloads(std::unordered_map<std::string, Payload> wordPayloadsArg)
+    {
+        wordPayloads = std::move(wordPayloadsArg);
+    }
+
+    /** Enables or disables packing of hash map keys (see KeyPacker), this takes effect on the next construct(). */
+    void setKeyPacking(bool packKeysArg) { packKeys = packKeysArg; }
+    /** Enables or disables tuning of split points for each word size (see SplitPointTuner),
+     * this takes effect on the next construct(). Otherwise words are split into parts of (almost) equal sizes. */
+    void setSplitPointTuning(bool tuneSplitPointsArg) { tuneSplitPoints = tuneSplitPointsArg; }
+    /** Sets the number of word parts above which an entry gets its own sub-index (see EntrySubIndex),
+     * 0 disables sub-indexes, this takes effect on the next construct(). Only some index types build sub-indexes. */
+    void setSubIndexThreshold(size_t subIndexThresholdArg) { subIndexThreshold = subIndexThresholdArg; }
+
+    /** The default number of word parts above which an entry gets its own sub-index. */
+    static constexpr size_t defaultSubIndexThreshold = 256;
+
 protected:
     virtual void initEntry(const std::string &word) = 0;
 
-    /** Processes a query, adding matches to [results]. */
-    virtual void processQuery(const std::string &query, ResultSetType &results) = 0;
+    /** Returns true if [word] can be stored in the entries built during construction, i.e. its chars and size
+     * fit the alphabets and schemes which have been calculated for the dictionary. */
+    virtual bool canInsertInPlace(const std::string &word) const;
+    /** Builds sub-indexes for entries storing more than subIndexThreshold word parts (see EntrySubIndex),
+     * index types without sub-indexes do nothing. */
+    virtual void buildSubIndexes() { }
+
+    /** Returns true if [other] is of the same type as this index and it has the same configuration,
+     * i.e. both indexes store words in the same way for the same dictionary (see merge). */
+    virtual bool hasSameConfig(const SplitIndex &other) const;
+
+    /** Processes a query, adding matches to [matches]. */
+    virtual void processQuery(const std::string &query, MatchCollector &matches) = 0;
+
+    /** Calls [search] [nIter] times and stores the elapsed time in elapsedUs. */
+    template<typename Search>
+    void measureSearch(int nIter, Search search);
+
+    /** Throws if [word] cannot be stored in a split index because of its size. */
+    void checkWordSize(const std::string &word) const;
+    /** Throws if [query] cannot be processed by a split index because of its size. */
+    void checkQuerySize(const std::string &query) const;
+    void checkQuerySizes(const std::vector<std::string> &queries) const;
 
     /** Returns the size of an entry in bytes, including the terminating '\0' if present. */
     virtual size_t calcEntrySizeB(const char *entry) const = 0;
 
     /** Returns the minimum word size which can be processed by a split index. */
     virtual size_t getMinWordSize() const = 0;
+    /** Returns the maximum word size which can be processed by a split index,
+     * this is lower than maxWordSize for indexes whose entries store sizes in single bytes. */
+    virtual size_t getMaxWordSize() const { return maxWordSize; }
+
+    /** Returns the hash map key for [wordPart] of size [partSize] and stores its size in [keySize].
+     * This is either the word part itself or the word part packed into [keyBuf] if key packing is enabled.
+     * Returns nullptr if [wordPart] cannot be a key, i.e. it contains chars outside the alphabet. */
+    inline const char *getKey(const char *wordPart, size_t partSize, char *keyBuf, size_t &keySize) const;
 
-    /** True if index has been constructed, false otherwise. */
+    /** True if index has been constructed, false otherwise (also while it is being rebuilt). */
     bool constructed = false;
 
+    /** The ratio of erased words above which the index is compacted (0 = never), and the number of rebuilds. */
+    float compactionThreshold = defaultCompactionThreshold;
+    size_t nRebuilds = 0;
+
     /** Elapsed time during the search in microseconds. */
     float elapsedUs = 0.0f;
 
     hash_map::HashMap *hashMap = nullptr;
     std::unordered_set<std::string> wordSet;
 
+    /** Holds dictionary words with their IDs, and collects matches for searches. */
+    MatchCollector matchCollector;
+    /** Payloads of dictionary words which are passed to the match collector during construction. */
+    std::unordered_map<std::string, Payload> wordPayloads;
+
+    /** IDs of words matching the current query, reused across queries by forEachMatch. */
+    std::vector<WordId> queryWordIds;
+
+    /** True if hash map keys should be packed, and the packer which is built for the alphabet of wordSet. */
+    bool packKeys = false;
+    KeyPacker keyPacker;
+
+    /** True if split points should be tuned during construction (disabled by default, so that words are split
+     * as before), and the number of word sizes whose split points differ from the default ones. */
+    bool tuneSplitPoints = false;
+    size_t nTunedWordSizes = 0;
+
+    /** Entries storing more than this number of word parts get sub-indexes (0 = disabled),
+     * which are built once the hash map has been filled. */
+    size_t subIndexThreshold = defaultSubIndexThreshold;
+    EntrySubIndexes subIndexes;
+    /** True while many words are inserted at once (see merge), changed entries do not get sub-indexes then,
+     * and all sub-indexes are built once afterwards. */
+    bool areSubIndexesDeferred = false;
+
     /** The number of words is multiplied by this factor and passed as a bucket count hint to the hash map. */
     const float nBucketsHintFactor = 0.1;
-    /** Maximum word size, set to 127 because we use 8-bit counters.
-     * Could be possibly set to 255 if using unsigned char when compiling,
-     * with caveats for compression-based encoding. */
-    const size_t maxWordSize = 127;
+    /** Maximum word size for all index types, selected at compile time (see utils::SizeCoding). */
+    const size_t maxWordSize = utils::SizeCoding::maxWordSize;
+    /** Maximum word size for indexes whose entries store sizes (of unpacked or decoded word parts) in single bytes. */
+    const size_t maxByteWordSize = std::min<size_t>(maxWordSize, 127);
 };
 
+template<typename Callback>
+void SplitIndex::forEachMatch(const std::vector<std::string> &queries, Callback callback, int nIter)
+{
+    assert(constructed);
+    checkQuerySizes(queries);
+
+    measureSearch(nIter, [&]()
+    {
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            matchCollector.collectWordIds(queryWordIds);
+            processQuery(queries[iQuery], matchCollector);
+            matchCollector.finishQuery();
+
+            for (WordId id : queryWordIds)
+            {
+                callback(iQuery, id);
+            }
+        }
+    });
+}
+
+template<typename Search>
+void SplitIndex::measureSearch(int nIter, Search search)
+{
+    clock_t start = std::clock();
+
+    for (int i = 0; i < nIter; ++i)
+    {
+        search();
+    }
+
+    clock_t end = std::clock();
+
+    const float elapsedS = (end - start) / static_cast<float>(CLOCKS_PER_SEC);
+    elapsedUs = elapsedS * 1000000.0f;
+}
+
+const char *SplitIndex::getKey(const char *wordPart, size_t partSize, char *keyBuf, size_t &keySize) const
+{
+    if (not keyPacker.isEnabled())
+    {
+        keySize = partSize;
+        return wordPart;
+    }
+
+    keySize = keyPacker.pack(wordPart, partSize, keyBuf);
+    return (keySize != 0) ? keyBuf : nullptr;
+}
+
 } // namespace split_index
 
 #endif // SPLIT_INDEX_HPP
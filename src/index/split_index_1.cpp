@@ -4,8 +4,11 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 
 #include "split_index_1.hpp"
+#include "split_point_tuner.hpp"
 #include "../hash_map/hash_map_aligned.hpp"
 #include "../utils/distance.hpp"
 
@@ -19,7 +22,7 @@ SplitIndex1::SplitIndex1(const unordered_set<string> &wordSet,
     float maxLoadFactor)
     :SplitIndex(wordSet)
 {
-    const int nBucketsHint = std::max(1, static_cast<int>(nBucketsHintFactor * wordSet.size()));
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
     auto calcEntrySizeB = std::bind(&SplitIndex1::calcEntrySizeB, this, std::placeholders::_1);
 
     hashMap = new hash_map::HashMapAligned(calcEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
@@ -27,7 +30,18 @@ SplitIndex1::SplitIndex1(const unordered_set<string> &wordSet,
     prefixBuf = new char[maxWordSize];
     suffixBuf = new char[maxWordSize];
 
+    prefixKeyBuf = new char[maxWordSize];
+    suffixKeyBuf = new char[maxWordSize];
+
+    matchBuf = new char[maxWordSize];
+
     prefixSizeLUT = new size_t[maxWordSize + 1];
+
+    // Halves are used until the index is constructed.
+    for (size_t i = 0; i <= maxWordSize; ++i)
+    {
+        prefixSizeLUT[i] = i / 2;
+    }
 }
 
 SplitIndex1::~SplitIndex1()
@@ -35,6 +49,11 @@ SplitIndex1::~SplitIndex1()
     delete[] prefixBuf;
     delete[] suffixBuf;
 
+    delete[] prefixKeyBuf;
+    delete[] suffixKeyBuf;
+
+    delete[] matchBuf;
+
     delete[] prefixSizeLUT;
 }
 
@@ -45,12 +64,87 @@ string SplitIndex1::toString() const
 
 void SplitIndex1::construct()
 {
+    fillPrefixSizeLUT();
+    SplitIndex::construct();
+
+    buildSubIndexes();
+}
+
+void SplitIndex1::buildSubIndexes()
+{
+    if (subIndexThreshold == 0)
+    {
+        return;
+    }
+
+    unordered_set<const char *> visitedEntries;
+
+    for (const string &word : wordSet)
+    {
+        storePrefixSuffixInBuffers(word);
+
+        const char *keys[] = { prefixKey, suffixKey };
+        const size_t keySizes[] = { prefixKeySize, suffixKeySize };
+
+        for (size_t iKey = 0; iKey < 2; ++iKey)
+        {
+            char **entryPtr = hashMap->retrieve(keys[iKey], keySizes[iKey]);
+            assert(entryPtr != nullptr);
+
+            const char *entry = *entryPtr;
+
+            if (not visitedEntries.insert(entry).second or calcEntryNWords(entry) <= subIndexThreshold)
+            {
+                continue;
+            }
+
+            buildSubIndex(entry);
+        }
+    }
+}
+
+void SplitIndex1::updateSubIndex(const char *entry)
+{
+    if (subIndexThreshold != 0 and calcEntryNWords(entry) > subIndexThreshold)
+    {
+        buildSubIndex(entry);
+    }
+}
+
+void SplitIndex1::buildSubIndex(const char *entry)
+{
+    EntrySubIndex *subIndex = new EntrySubIndex(1);
+    const char *it = entry + sizeof(PrefixIndexType); // We jump over the prefix index.
+
+    for (uint32_t iWord = 0; *it != 0; ++iWord)
+    {
+        const uint32_t offset = static_cast<uint32_t>(it - entry);
+        const size_t partSize = utils::SizeCoding::read(it);
+
+        subIndex->add(it, partSize, { offset, iWord });
+        it += partSize;
+    }
+
+    subIndex->build();
+    subIndexes.add(entry, subIndex);
+}
+
+void SplitIndex1::fillPrefixSizeLUT()
+{
+    // Part starts for each word size: 0, prefix size, word size.
+    vector<vector<size_t>> partStarts(maxWordSize + 1);
+
     for (size_t i = 0; i <= maxWordSize; ++i)
     {
-        prefixSizeLUT[i] = i / 2;
+        partStarts[i] = { 0, i / 2, i };
     }
 
-    SplitIndex::construct();
+    nTunedWordSizes = tuneSplitPoints ? SplitPointTuner::tune(wordSet, partStarts) : 0;
+
+    for (size_t i = 0; i <= maxWordSize; ++i)
+    {
+        prefixSizeLUT[i] = partStarts[i][1];
+    }
 }
 
 void SplitIndex1::initEntry(const string &word)
@@ -58,55 +152,134 @@ void SplitIndex1::initEntry(const string &word)
     storePrefixSuffixInBuffers(word);
 
     // 1. We store the pair [prefix] -> [suffix].
-    char **entryPtr = hashMap->retrieve(prefixBuf, prefixSize);
+    char **entryPtr = hashMap->retrieve(prefixKey, prefixKeySize);
 
     if (entryPtr == nullptr)
     {
         char *newEntry = createEntry(suffixBuf, suffixSize, true);
-        hashMap->insert(prefixBuf, prefixSize, newEntry);
+        hashMap->insert(prefixKey, prefixKeySize, newEntry);
 
         free(newEntry); // The entry is copied inside the map, so it can be freed here.
     }
     else
     {
-        addToEntry(entryPtr, suffixBuf, suffixSize, true);
+        addToEntryUpdatingSubIndex(entryPtr, suffixBuf, suffixSize, true);
     }
 
     // 2. We store the pair [suffix] -> [prefix].
-    entryPtr = hashMap->retrieve(suffixBuf, suffixSize);
+    entryPtr = hashMap->retrieve(suffixKey, suffixKeySize);
 
     if (entryPtr == nullptr)
     {
         char *newEntry = createEntry(prefixBuf, prefixSize, false);
-        hashMap->insert(suffixBuf, suffixSize, newEntry);
+        hashMap->insert(suffixKey, suffixKeySize, newEntry);
 
         free(newEntry); // The entry is copied inside the map, so it can be freed here.
     }
     else
     {
-        addToEntry(entryPtr, prefixBuf, prefixSize, false);
+        addToEntryUpdatingSubIndex(entryPtr, prefixBuf, prefixSize, false);
     }
 }
 
-void SplitIndex1::processQuery(const string &query, ResultSetType &results)
+void SplitIndex1::addToEntryUpdatingSubIndex(char **entryPtr, const char *wordPart, size_t partSize,
+    bool isPartSuffix)
+{
+    if (not constructed or areSubIndexesDeferred)
+    {
+        addToEntry(entryPtr, wordPart, partSize, isPartSuffix);
+        return;
+    }
+
+    // The word is inserted after construction. The entry might be moved and the offsets of its word parts
+    // might change (when a suffix is inserted before prefixes), so its sub-index (if any) is built anew.
+    subIndexes.remove(*entryPtr);
+    addToEntry(entryPtr, wordPart, partSize, isPartSuffix);
+
+    updateSubIndex(*entryPtr);
+}
+
+void SplitIndex1::processQuery(const string &query, MatchCollector &matches)
 {
     assert(constructed);
     assert(query.size() > 0 and query.size() <= maxWordSize);
 
     storePrefixSuffixInBuffers(query);
+    searchBothKeys(matches);
+}
+
+void SplitIndex1::searchBothKeys(MatchCollector &matches)
+{
+    const char *prefixEntry = retrieveEntry(prefixKey, prefixKeySize);
+    const char *suffixEntry = retrieveEntry(suffixKey, suffixKeySize);
+
+    // When only checking existence, the entry with fewer candidates is searched first.
+    if (matches.isCheckingExistence() and prefixEntry != nullptr and suffixEntry != nullptr
+        and calcNCandidates(suffixEntry, false) < calcNCandidates(prefixEntry, true))
+    {
+        searchWithSuffixAsKey(suffixEntry, matches);
 
-    searchWithPrefixAsKey(results);
-    searchWithSuffixAsKey(results);
+        if (not matches.isDone())
+        {
+            searchWithPrefixAsKey(prefixEntry, matches);
+        }
+
+        return;
+    }
+
+    if (prefixEntry != nullptr)
+    {
+        searchWithPrefixAsKey(prefixEntry, matches);
+    }
+
+    // When only checking existence, the search stops at the first match.
+    if (suffixEntry != nullptr and not matches.isDone())
+    {
+        searchWithSuffixAsKey(suffixEntry, matches);
+    }
+}
+
+const char *SplitIndex1::retrieveEntry(const char *key, size_t keySize) const
+{
+    // The query part contains chars outside the alphabet, so it cannot be a key.
+    if (key == nullptr)
+    {
+        return nullptr;
+    }
+
+    char **entryPtr = hashMap->retrieve(key, keySize);
+    return (entryPtr != nullptr) ? *entryPtr : nullptr;
+}
+
+size_t SplitIndex1::calcNCandidates(const char *entry, bool isPrefixKey) const
+{
+    const PrefixIndexType prefixIndex = *reinterpret_cast<const PrefixIndexType *>(entry);
+
+    // Suffixes precede the first prefix, so only entries containing both need the words counted.
+    if (isPrefixKey and prefixIndex != 0)
+    {
+        return prefixIndex - 1;
+    }
+    else if (not isPrefixKey and prefixIndex == 0)
+    {
+        return 0;
+    }
+
+    const EntrySubIndex *subIndex = subIndexes.find(entry);
+    const size_t nWords = (subIndex != nullptr) ? subIndex->getNItems() : countEntryWords(entry);
+
+    return isPrefixKey ? nWords : nWords - (prefixIndex - 1);
 }
 
 size_t SplitIndex1::calcEntrySizeB(const char *entry) const
 {
     const char *start = entry;
-    entry += sizeof(uint16_t); // We jump over the prefix index.
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
 
     while (*entry != 0)
     {
-        entry += 1 + *entry;
+        const size_t partSize = utils::SizeCoding::read(entry);
+        entry += partSize;
     }
 
     return entry - start + 1; // This includes the terminating 0.
@@ -115,12 +288,14 @@ size_t SplitIndex1::calcEntrySizeB(const char *entry) const
 size_t SplitIndex1::calcEntryNWords(const char *entry)
 {
     size_t nWords = 0;
-    entry += sizeof(uint16_t); // We jump over the prefix index.
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
 
     while (*entry != 0)
     {
         nWords += 1;
-        entry += 1 + *entry;
+
+        const size_t partSize = utils::SizeCoding::read(entry);
+        entry += partSize;
     }
 
     return nWords;
@@ -137,16 +312,18 @@ void SplitIndex1::storePrefixSuffixInBuffers(const string &word)
     assert(suffixSize > 0 and suffixSize < word.size());
 
     assert(prefixSize + suffixSize == word.size());
-    assert(abs(static_cast<int>(prefixSize) - static_cast<int>(suffixSize)) <= 1);
 
     memcpy(prefixBuf, word.c_str(), prefixSize);
     memcpy(suffixBuf, word.c_str() + prefixSize, suffixSize);
+
+    prefixKey = getKey(prefixBuf, prefixSize, prefixKeyBuf, prefixKeySize);
+    suffixKey = getKey(suffixBuf, suffixSize, suffixKeyBuf, suffixKeySize);
 }
 
 char *SplitIndex1::createEntry(const char *wordPart, size_t partSize, bool isPartSuffix) const
 {
-    // 2 = size of word part, terminating 0.
-    const size_t newSize = sizeof(uint16_t) + 2 + partSize;
+    // 1 = terminating 0.
+    const size_t newSize = sizeof(PrefixIndexType) + utils::SizeCoding::calcSizeB(partSize) + partSize + 1;
 
     char *entry = static_cast<char *>(malloc(newSize * sizeof(char)));
     assert(entry != nullptr);
@@ -155,15 +332,15 @@ char *SplitIndex1::createEntry(const char *wordPart, size_t partSize, bool isPar
     // It is a 1-based index over the word count.
     if (not isPartSuffix)
     {
-        *reinterpret_cast<uint16_t *>(entry) = 1u;
+        *reinterpret_cast<PrefixIndexType *>(entry) = 1u;
     }
     else
     {
-        *reinterpret_cast<uint16_t *>(entry) = 0u;
+        *reinterpret_cast<PrefixIndexType *>(entry) = 0u;
     }
 
-    entry[2] = static_cast<char>(partSize);
-    memcpy(entry + 3, wordPart, partSize);
+    char *it = utils::SizeCoding::write(entry + sizeof(PrefixIndexType), partSize);
+    memcpy(it, wordPart, partSize);
 
     entry[newSize - 1] = 0;
     return entry;
@@ -173,32 +350,45 @@ void SplitIndex1::addToEntry(char **entryPtr,
     const char *wordPart, size_t partSize,
     bool isPartSuffix) const
 {
-    assert(partSize > 0 and partSize <= maxWordSize);
-    
+    assert(partSize > 0 and partSize <= utils::SizeCoding::maxSize);
+
+    // The prefix index is checked before any changes are made, so that the entry stays valid after throwing.
+    // It is incremented when a suffix is inserted, and it is set to the number of words when the first prefix is added.
+    const PrefixIndexType oldPrefixIndex = *reinterpret_cast<const PrefixIndexType *>(*entryPtr);
+    const size_t maxPrefixIndex = numeric_limits<PrefixIndexType>::max();
+
+    if ((isPartSuffix and oldPrefixIndex == maxPrefixIndex) or
+        (not isPartSuffix and oldPrefixIndex == 0 and calcEntryNWords(*entryPtr) >= maxPrefixIndex))
+    {
+        throw runtime_error("too many words stored under a single key, rebuild with SPLIT_INDEX_LONG_WORDS");
+    }
+
+    const size_t partSizeB = utils::SizeCoding::calcSizeB(partSize);
+
     const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
-    const size_t newEntrySize = oldEntrySize + partSize + 1;
-    
+    const size_t newEntrySize = oldEntrySize + partSizeB + partSize;
+
     char *newEntry = static_cast<char *>(realloc(*entryPtr, newEntrySize * sizeof(char)));
     assert(newEntry != nullptr);
 
     // We act depending on the value of the prefix index.
     // It is a 1-based index over the word count.
-    uint16_t *prefixIndex = reinterpret_cast<uint16_t *>(newEntry);
+    PrefixIndexType *prefixIndex = reinterpret_cast<PrefixIndexType *>(newEntry);
 
     if (isPartSuffix and (*prefixIndex) != 0)
     {
         // We want to insert a suffix and there exist some prefixes.
         // Hence, we need to move the prefixes to the right and insert a suffix somewhere in the middle.
-        char *prefixesStart = advanceInEntryByWordCount(newEntry + 2, (*prefixIndex) - 1);
+        char *prefixesStart = advanceInEntryByWordCount(newEntry + sizeof(PrefixIndexType), (*prefixIndex) - 1);
 
         const size_t prefixesListSize = oldEntrySize - (prefixesStart - newEntry);
-        assert(newEntrySize == prefixesStart - newEntry + partSize + 1 + prefixesListSize);
+        assert(newEntrySize == prefixesStart - newEntry + partSizeB + partSize + prefixesListSize);
 
-        memmove(prefixesStart + partSize + 1, prefixesStart, prefixesListSize);
+        memmove(prefixesStart + partSizeB + partSize, prefixesStart, prefixesListSize);
 
         // After moving, we can insert the suffix where old prefixes used to begin.
-        *prefixesStart = static_cast<char>(partSize);
-        memcpy(prefixesStart + 1, wordPart, partSize);
+        char *it = utils::SizeCoding::write(prefixesStart, partSize);
+        memcpy(it, wordPart, partSize);
 
         // We have added a suffix (1st part of the entry), so now the prefixes (2nd part of the entry) start one word further.
         *prefixIndex += 1;
@@ -215,7 +405,7 @@ void SplitIndex1::addToEntry(char **entryPtr,
         if (not isPartSuffix and *prefixIndex == 0)
         {
             // The new index is the old number of words + 1, no need for "+1" here since we have already inserted a new word.
-            *prefixIndex = calcEntryNWords(newEntry);
+            *prefixIndex = static_cast<PrefixIndexType>(calcEntryNWords(newEntry));
         }
     }
 
@@ -227,34 +417,51 @@ void SplitIndex1::addToEntry(char **entryPtr,
 void SplitIndex1::appendToEntry(char *entry, size_t oldEntrySize,
     const char *wordPart, size_t partSize) const
 {
-    entry[oldEntrySize - 1] = static_cast<char>(partSize);
+    // We start overwriting with the terminating 0.
+    char *it = utils::SizeCoding::write(entry + oldEntrySize - 1, partSize);
 
-    memcpy(entry + oldEntrySize, wordPart, partSize);
-    entry[oldEntrySize + partSize] = 0;
+    memcpy(it, wordPart, partSize);
+    it[partSize] = 0;
 }
 
-void SplitIndex1::searchWithPrefixAsKey(ResultSetType &results)
+void SplitIndex1::searchWithPrefixAsKey(const char *entry, MatchCollector &matches)
 {
-    char **entryPtr = hashMap->retrieve(prefixBuf, prefixSize);
+    // We search with the query's prefix as key, so we shall try to match suffixes.
+    const PrefixIndexType *prefixIndex = reinterpret_cast<const PrefixIndexType *>(entry);
 
-    if (entryPtr == nullptr)
+    // This check whether the entry contains only prefixes (i.e. no suffixes that we are looking for)
+    // is likely to provide some speedup.
+    if (*prefixIndex == 1)
     {
         return;
     }
 
-    const char *entry = *entryPtr;
-    // We search with the query's prefix as key, so we shall try to match suffixes.
-    const uint16_t *prefixIndex = reinterpret_cast<const uint16_t *>(entry);
+    const EntrySubIndex *subIndex = subIndexes.find(entry);
 
-    // This check whether the entry contains only prefixes (i.e. no suffixes that we are looking for)
-    // is likely to provide some speedup.
-    if (*prefixIndex == 1)
+    if (subIndex != nullptr)
     {
+        // Only the sub-bucket candidates are checked, suffixes precede the first prefix.
+        const char *entryStart = entry;
+        const size_t nSuffixes = (*prefixIndex != 0) ? *prefixIndex - 1 : numeric_limits<size_t>::max();
+
+        subIndex->forEachCandidate(suffixBuf, suffixSize, [&](const EntrySubIndex::Item &item)
+        {
+            const char *part = entryStart + item.offset;
+
+            if (item.iWord < nSuffixes and utils::SizeCoding::read(part) == suffixSize
+                and utils::Distance::isHammingAtMostK<1>(part, suffixBuf, suffixSize))
+            {
+                addMatch(matches, prefixBuf, part);
+            }
+
+            // When only checking existence, the search stops at the first match.
+            return not matches.isDone();
+        });
+
         return;
     }
 
-    entry += sizeof(uint16_t); // We jump over the prefix index.
-    const char cSuffixSize = static_cast<char>(suffixSize);
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
 
     if (*prefixIndex != 0)
     {
@@ -262,94 +469,133 @@ void SplitIndex1::searchWithPrefixAsKey(ResultSetType &results)
         const char *end = advanceInEntryByWordCount(entry, *prefixIndex - 1);
 
         while (entry != end)
-        {           
+        {
             assert(*entry != 0);
+            const size_t partSize = utils::SizeCoding::read(entry);
 
-            if (*entry == cSuffixSize)
+            if (partSize == suffixSize)
             {
-                if (utils::Distance::isHammingAtMostK<1>(entry + 1, suffixBuf, suffixSize))
+                if (utils::Distance::isHammingAtMostK<1>(entry, suffixBuf, suffixSize))
                 {
-                    results.emplace(string(prefixBuf, prefixSize) + string(entry + 1, suffixSize));
+                    addMatch(matches, prefixBuf, entry);
+
+                    if (matches.isDone())
+                    {
+                        return;
+                    }
                 }
             }
 
-            entry += 1 + *entry;
+            entry += partSize;
         }
     }
     else
     {
         // There are only suffixes stored in this entry, so we check everything.
         while (*entry != 0)
-        {       
-            if (*entry == cSuffixSize)
+        {
+            const size_t partSize = utils::SizeCoding::read(entry);
+
+            if (partSize == suffixSize)
             {
-                if (utils::Distance::isHammingAtMostK<1>(entry + 1, suffixBuf, suffixSize))
+                if (utils::Distance::isHammingAtMostK<1>(entry, suffixBuf, suffixSize))
                 {
-                    results.emplace(string(prefixBuf, prefixSize) + string(entry + 1, suffixSize));
+                    addMatch(matches, prefixBuf, entry);
+
+                    if (matches.isDone())
+                    {
+                        return;
+                    }
                 }
             }
 
-            entry += 1 + *entry;
+            entry += partSize;
         }
     }
 }
 
-void SplitIndex1::searchWithSuffixAsKey(ResultSetType &results)
+void SplitIndex1::searchWithSuffixAsKey(const char *entry, MatchCollector &matches)
 {
-    char **entryPtr = hashMap->retrieve(suffixBuf, suffixSize);
+    // We search with the query's suffix as key, so we shall try to match prefixes.
+    const PrefixIndexType *prefixIndex = reinterpret_cast<const PrefixIndexType *>(entry);
 
-    if (entryPtr == nullptr)
+    // This check whether the entry contains only suffixes (i.e. no prefixes that we are looking for)
+    // is likely to provide some speedup.
+    if (*prefixIndex == 0)
     {
         return;
     }
 
-    const char *entry = *entryPtr;
-    // We search with the query's suffix as key, so we shall try to match prefixes.
-    const uint16_t *prefixIndex = reinterpret_cast<const uint16_t *>(entry);
+    const EntrySubIndex *subIndex = subIndexes.find(entry);
 
-    // This check whether the entry contains only suffixes (i.e. no prefixes that we are looking for)
-    // is likely to provide some speedup.
-    if (*prefixIndex == 0)
+    if (subIndex != nullptr)
     {
+        // Only the sub-bucket candidates are checked, prefixes start at the (1-based) prefix index.
+        const char *entryStart = entry;
+        const size_t nSuffixes = *prefixIndex - 1;
+
+        subIndex->forEachCandidate(prefixBuf, prefixSize, [&](const EntrySubIndex::Item &item)
+        {
+            const char *part = entryStart + item.offset;
+
+            if (item.iWord >= nSuffixes and utils::SizeCoding::read(part) == prefixSize
+                and utils::Distance::isHammingAtMostK<1>(part, prefixBuf, prefixSize))
+            {
+                addMatch(matches, part, suffixBuf);
+            }
+
+            return not matches.isDone();
+        });
+
         return;
     }
 
-    entry = advanceInEntryByWordCount(entry + 2, *prefixIndex - 1);
-    const char cPrefixSize = static_cast<char>(prefixSize);
+    entry = advanceInEntryByWordCount(entry + sizeof(PrefixIndexType), *prefixIndex - 1);
 
     while (*entry != 0)
     {
-        if (*entry == cPrefixSize)
+        const size_t partSize = utils::SizeCoding::read(entry);
+
+        if (partSize == prefixSize)
         {
-            if (utils::Distance::isHammingAtMostK<1>(entry + 1, prefixBuf, prefixSize))
+            if (utils::Distance::isHammingAtMostK<1>(entry, prefixBuf, prefixSize))
             {
-                results.emplace(string(entry + 1, cPrefixSize) + string(suffixBuf, suffixSize));
+                addMatch(matches, entry, suffixBuf);
+
+                if (matches.isDone())
+                {
+                    return;
+                }
             }
         }
 
-        entry += 1 + *entry;
+        entry += partSize;
     }
 }
 
-char *SplitIndex1::advanceInEntryByWordCount(char *entry, uint16_t nWords) const
+char *SplitIndex1::advanceInEntryByWordCount(char *entry, PrefixIndexType nWords) const
 {
-    for (uint16_t i = 0; i < nWords; ++i)
+    for (PrefixIndexType i = 0; i < nWords; ++i)
     {
         assert(*entry != 0);
-        entry += 1 + *entry;
+
+        const size_t partSize = utils::SizeCoding::read(entry);
+        entry += partSize;
     }
-     
+
     return entry;
 }
 
-const char *SplitIndex1::advanceInEntryByWordCount(const char *entry, uint16_t nWords) const
+const char *SplitIndex1::advanceInEntryByWordCount(const char *entry, PrefixIndexType nWords) const
 {
-    for (uint16_t i = 0; i < nWords; ++i)
+    for (PrefixIndexType i = 0; i < nWords; ++i)
     {
         assert(*entry != 0);
-        entry += 1 + *entry;
+
+        const size_t partSize = utils::SizeCoding::read(entry);
+        entry += partSize;
     }
-     
+
     return entry;
 }
 
@@ -2,6 +2,7 @@
 #define SPLIT_INDEX_1_HPP
 
 #include <cmath>
+#include <cstring>
 #include <set>
 
 #include "split_index.hpp"
@@ -13,7 +14,9 @@
 namespace split_index
 {
 
-/** Split index for k = 1. */
+/** Split index for k = 1.
+ * Entries start with the prefix index, followed by word parts (suffixes first, then prefixes) preceded by their sizes
+ * (see utils::SizeCoding). */
 class SplitIndex1 : public SplitIndex
 {
 public:
@@ -25,8 +28,11 @@ public:
     std::string toString() const override;
 
 protected:
+    /** A 1-based index of the first prefix in an entry (0 if there are no prefixes), 16 or 32 bits wide. */
+    using PrefixIndexType = utils::SizeCoding::CounterType;
+
     void initEntry(const std::string &word) override;
-    void processQuery(const std::string &query, ResultSetType &results) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
 
     size_t calcEntrySizeB(const char *entry) const override;
 
@@ -35,7 +41,21 @@ protected:
     /** Returns the number of words (word parts) stored in [entry]. */
     static size_t calcEntryNWords(const char *entry);
 
-    /** Splits [word] into two and stores the parts (prefix and suffix) in prefixBuf and suffixBuf, resp. */
+    /** Builds sub-indexes for entries storing more than subIndexThreshold word parts (see EntrySubIndex).
+     * Sub-index items point to the size bytes of word parts, and their word indexes tell suffixes from prefixes. */
+    void buildSubIndexes() override;
+    /** Builds a sub-index for [entry] if it stores more than subIndexThreshold word parts, this is called for entries
+     * which have been changed after construction (and whose previous sub-indexes have been removed). */
+    virtual void updateSubIndex(const char *entry);
+    /** Builds the sub-index for [entry] and adds it to subIndexes. */
+    void buildSubIndex(const char *entry);
+
+    /** Fills prefixSizeLUT with the split point for each word size, i.e. halves which are then tuned
+     * for the dictionary if split point tuning is enabled. */
+    void fillPrefixSizeLUT();
+
+    /** Splits [word] into two and stores the parts (prefix and suffix) in prefixBuf and suffixBuf, resp.
+     * Also sets the hash map keys for both parts (see SplitIndex::getKey). */
     void storePrefixSuffixInBuffers(const std::string &word);
 
     /** Creates a new entry containing a [wordPart] of size [partSize].
@@ -48,20 +68,40 @@ protected:
         const char *wordPart, size_t partSize,
         bool isPartSuffix) const;
 
+    /** Adds a [wordPart] to an existing entry (see addToEntry), keeping its sub-index up to date after construction. */
+    void addToEntryUpdatingSubIndex(char **entryPtr, const char *wordPart, size_t partSize, bool isPartSuffix);
+
     /** A helper function for adding a [wordPart] of size [partSize],
      * at the end of an existing [entry] having [oldEntrySize] bytes . */
     virtual void appendToEntry(char *entry, size_t oldEntrySize,
         const char *wordPart, size_t partSize) const;
 
-    virtual void searchWithPrefixAsKey(ResultSetType &results);
-    virtual void searchWithSuffixAsKey(ResultSetType &results);
+    /** Searches the entries stored under the keys of both query parts (see storePrefixSuffixInBuffers).
+     * When only checking existence, the entry with fewer candidate parts is searched first,
+     * and the search stops at the first match. */
+    void searchBothKeys(MatchCollector &matches);
+    /** Returns the entry stored under [key] of size [keySize], nullptr if there is none or [key] is nullptr. */
+    const char *retrieveEntry(const char *key, size_t keySize) const;
+    /** Returns the number of parts of [entry] which are checked when searching with the query prefix as key
+     * (suffixes) if [isPrefixKey] is true, and with the query suffix as key (prefixes) otherwise. */
+    size_t calcNCandidates(const char *entry, bool isPrefixKey) const;
+    /** Returns the number of words stored in [entry], depends on the format of word parts. */
+    virtual size_t countEntryWords(const char *entry) const { return calcEntryNWords(entry); }
+
+    /** Searches [entry] (stored under the query prefix or suffix, resp.) and adds the matches to [matches]. */
+    virtual void searchWithPrefixAsKey(const char *entry, MatchCollector &matches);
+    virtual void searchWithSuffixAsKey(const char *entry, MatchCollector &matches);
+
+    /** Adds the word consisting of [prefix] (of prefixSize chars) and [suffix] (of suffixSize chars)
+     * to [matches], the word is assembled in matchBuf. */
+    inline void addMatch(MatchCollector &matches, const char *prefix, const char *suffix);
 
     /** Returns a pointer pointing [nWords] further within the [entry],
-     * which must point towards a word size byte. */
-    virtual char *advanceInEntryByWordCount(char *entry, uint16_t nWords) const;
-    virtual const char *advanceInEntryByWordCount(const char *entry, uint16_t nWords) const;
+     * which must point towards a word size. */
+    virtual char *advanceInEntryByWordCount(char *entry, PrefixIndexType nWords) const;
+    virtual const char *advanceInEntryByWordCount(const char *entry, PrefixIndexType nWords) const;
 
-    /** Lookup table to speed up access of prefix size.
+    /** Lookup table to speed up access of prefix size, which is used both during construction and for queries.
      * There are 2 parts, i.e. a prefix and a suffix for k = 1. */
     size_t *prefixSizeLUT = nullptr;
 
@@ -74,9 +114,29 @@ protected:
     /** Temporarily stores the word suffix. */
     char *suffixBuf = nullptr;
 
+    /** Temporarily store the hash map keys for word prefix and suffix (nullptr if a part cannot be a key),
+     * and their sizes. Keys point either to prefixBuf and suffixBuf or to the buffers for packed keys. */
+    const char *prefixKey = nullptr;
+    size_t prefixKeySize = 0;
+    const char *suffixKey = nullptr;
+    size_t suffixKeySize = 0;
+    char *prefixKeyBuf = nullptr;
+    char *suffixKeyBuf = nullptr;
+
+    /** Temporarily stores a matching word. */
+    char *matchBuf = nullptr;
+
     SPLIT_INDEX_1_WHITEBOX
 };
 
+void SplitIndex1::addMatch(MatchCollector &matches, const char *prefix, const char *suffix)
+{
+    std::memcpy(matchBuf, prefix, prefixSize);
+    std::memcpy(matchBuf + prefixSize, suffix, suffixSize);
+
+    matches.add(matchBuf, prefixSize + suffixSize);
+}
+
 } // namespace split_index
 
 #endif // SPLIT_INDEX_1_HPP
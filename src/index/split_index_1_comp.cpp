@@ -17,12 +17,17 @@ SplitIndex1Comp::SplitIndex1Comp(const unordered_set<string> &wordSet,
     float maxLoadFactor)
         :SplitIndex1(wordSet, hashType, maxLoadFactor)
 {
-    codingBuf = new char[maxWordSize];
+    // Decoding always copies whole fixed-size q-grams, hence the extra space.
+    codingBuf = new char[maxWordSize + QgramCodec::codingBufPadding];
+    digramLUT = new char[nDigrams];
+
+    clearQgramMaps();
 }
 
 SplitIndex1Comp::~SplitIndex1Comp()
 {
     delete[] codingBuf;
+    delete[] digramLUT;
 }
 
 string SplitIndex1Comp::toString() const
@@ -32,20 +37,31 @@ string SplitIndex1Comp::toString() const
         return "Index not constructed";
     }
 
-    string out = (boost::format("\nWith compression: #%1%-grams = %2%") % qgramSize % qgramToChar.size()).str();
+    string out = (boost::format("\nWith compression: #%1%-grams = %2%, compression ratio = %3%")
+        % qgramSize % qgramToChar.size() % calcCompressionRatio()).str();
     return SplitIndex1::toString() + out;
 }
 
 void SplitIndex1Comp::construct()
 {
+    nPartBytes = 0;
+    nEncodedPartBytes = 0;
+
+    // Split points are determined first, since q-grams may be tuned for the resulting word parts.
+    fillPrefixSizeLUT();
     calcQgramsAndFillMaps();
-    SplitIndex1::construct();
+
+    SplitIndex::construct();
+}
+
+double SplitIndex1Comp::calcCompressionRatio() const
+{
+    return (nEncodedPartBytes == 0) ? 1.0 : static_cast<double>(nPartBytes) / nEncodedPartBytes;
 }
 
 void SplitIndex1Comp::calcQgramsAndFillMaps()
 {
-    qgramToChar.clear();
-    charToQgram.clear();
+    clearQgramMaps();
 
     vector<string> qgrams = calcQGramsOrderedByFrequency(nQgrams, qgramSize);
     fillQgramMaps(qgrams, firstChar); // Invalidates insides of the qgrams vector.
@@ -58,59 +74,43 @@ void SplitIndex1Comp::calcQgramsAndFillMaps()
 
 vector<string> SplitIndex1Comp::calcQGramsOrderedByFrequency(size_t curNQgrams, size_t curQgramSize) const
 {
-    map<string, int> counter;
-
-    for (const string &word : wordSet)
-    {
-        if (word.size() < curQgramSize)
-        {
-            continue;
-        }
+    vector<pair<uint32_t, string>> qgramCounts = calcQgramCounts(curNQgrams, curQgramSize);
 
-        const size_t end = word.size() - curQgramSize + 1;
+    vector<string> ret;
+    ret.reserve(qgramCounts.size());
 
-        for (size_t i = 0; i < end; ++i)
-        {
-            assert(i + curQgramSize <= word.size());
-            const string qgram = word.substr(i, curQgramSize);
+    for (auto &qgramCount : qgramCounts)
+    {
+        ret.push_back(move(qgramCount.second));
+    }
 
-            assert(qgram.size() == curQgramSize);
-            auto it = counter.find(qgram);
+    return ret;
+}
 
-            if (it != counter.end())
-            {
-                counter[qgram] += 1;
-            }
-            else
-            {
-                counter[qgram] = 1;
-            }
-        }
-    }
+vector<pair<uint32_t, string>> SplitIndex1Comp::calcQgramCounts(size_t curNQgrams, size_t curQgramSize) const
+{
+    return QgramCodec::calcQgramCounts(wordSet, curNQgrams, curQgramSize);
+}
 
-    vector<pair<int, string>> sorter; // Pairs: [count, qgram].
-    sorter.reserve(curNQgrams);
+void SplitIndex1Comp::clearQgramMaps()
+{
+    qgramToChar.clear();
+    charToQgram.clear();
 
-    for (const auto &kv : counter)
+    for (size_t c = 0; c < 256; ++c)
     {
-        sorter.emplace_back(kv.second, kv.first);
+        decodingLUT[c].qgram[0] = static_cast<char>(c);
+        decodingLUT[c].size = 1;
     }
 
-    const size_t availableNQgrams = std::min(sorter.size(), curNQgrams);
-
-    // We sort in order to obtain the highest counts in front.
-    std::partial_sort(sorter.begin(), sorter.begin() + availableNQgrams, sorter.end(),
-        std::greater<pair<int, string>>());
+    memset(digramLUT, 0, nDigrams);
 
-    vector<string> ret;
-    ret.reserve(availableNQgrams);
-
-    for (size_t i = 0; i < availableNQgrams; ++i)
+    for (auto &codes : packedQgramCodes)
     {
-        ret.push_back(move(sorter[i].second));
+        codes.clear();
     }
 
-    return ret;
+    maxCodedQgramSize = 0;
 }
 
 void SplitIndex1Comp::fillQgramMaps(vector<string> &qgrams, char curFirstChar)
@@ -120,23 +120,67 @@ void SplitIndex1Comp::fillQgramMaps(vector<string> &qgrams, char curFirstChar)
         const char curIndex = curFirstChar + i;
         assert(curIndex < 255u);
 
+        const size_t curQgramSize = qgrams[i].size();
+        assert(curQgramSize >= 2 and curQgramSize <= maxQgramSize);
+
+        memcpy(decodingLUT[static_cast<size_t>(curIndex)].qgram, qgrams[i].c_str(), curQgramSize);
+        decodingLUT[static_cast<size_t>(curIndex)].size = curQgramSize;
+
+        const uint64_t packed = QgramCodec::packQgram(qgrams[i].c_str(), curQgramSize);
+
+        if (curQgramSize == 2)
+        {
+            digramLUT[packed] = curIndex;
+        }
+        else
+        {
+            vector<pair<uint64_t, char>> &codes = packedQgramCodes[curQgramSize];
+            codes.insert(std::lower_bound(codes.begin(), codes.end(), make_pair(packed, curIndex)),
+                make_pair(packed, curIndex));
+        }
+
+        maxCodedQgramSize = std::max(maxCodedQgramSize, curQgramSize);
+
         qgramToChar[qgrams[i]] = curIndex;
         charToQgram[curIndex] = move(qgrams[i]);
     }
 }
 
+char SplitIndex1Comp::findQgramCode(const char *qgram, size_t curQgramSize) const
+{
+    const uint64_t packed = QgramCodec::packQgram(qgram, curQgramSize);
+
+    if (curQgramSize == 2)
+    {
+        return digramLUT[packed];
+    }
+
+    const vector<pair<uint64_t, char>> &codes = packedQgramCodes[curQgramSize];
+    auto it = std::lower_bound(codes.begin(), codes.end(), make_pair(packed, static_cast<char>(0)));
+
+    if (it != codes.end() and it->first == packed)
+    {
+        return it->second;
+    }
+
+    return 0;
+}
+
 void SplitIndex1Comp::initEntry(const string &word)
 {
     storePrefixSuffixInBuffers(word);
 
+    // Each stored word part consists of its decoded size followed by the encoded part,
+    // so that parts having the wrong size can be skipped without decoding.
+
     // 1. We store the pair [prefix] -> [suffix].
-    char **entryPtr = hashMap->retrieve(prefixBuf, prefixSize);
-    const size_t encodedSuffixSize = encodeToBuf(suffixBuf, suffixSize);
+    char **entryPtr = hashMap->retrieve(prefixKey, prefixKeySize);
+    const size_t encodedSuffixSize = encodeWithSizeToBuf(suffixBuf, suffixSize);
 
     if (entryPtr == nullptr)
     {
         char *newEntry = createEntry(codingBuf, encodedSuffixSize, true);
-        hashMap->insert(prefixBuf, prefixSize, newEntry);
+        hashMap->insert(prefixKey, prefixKeySize, newEntry);
 
         free(newEntry); // The entry is copied inside the map, so it can be freed here.
     }
@@ -146,13 +190,13 @@ void SplitIndex1Comp::initEntry(const string &word)
     }
 
     // 2. We store the pair [suffix] -> [prefix].
-    entryPtr = hashMap->retrieve(suffixBuf, suffixSize);
-    const size_t encodedPrefixSize = encodeToBuf(prefixBuf, prefixSize);
+    entryPtr = hashMap->retrieve(suffixKey, suffixKeySize);
+    const size_t encodedPrefixSize = encodeWithSizeToBuf(prefixBuf, prefixSize);
 
     if (entryPtr == nullptr)
     {
         char *newEntry = createEntry(codingBuf, encodedPrefixSize, false);
-        hashMap->insert(suffixBuf, suffixSize, newEntry);
+        hashMap->insert(suffixKey, suffixKeySize, newEntry);
 
         free(newEntry); // The entry is copied inside the map, so it can be freed here.
     }
@@ -160,20 +204,15 @@ void SplitIndex1Comp::initEntry(const string &word)
     {
         addToEntry(entryPtr, codingBuf, encodedPrefixSize, false);
     }
+
+    nPartBytes += prefixSize + suffixSize;
+    nEncodedPartBytes += (encodedPrefixSize - 1) + (encodedSuffixSize - 1);
 }
 
-void SplitIndex1Comp::searchWithPrefixAsKey(ResultSetType &results)
+void SplitIndex1Comp::searchWithPrefixAsKey(const char *entry, MatchCollector &matches)
 {
-    char **entryPtr = hashMap->retrieve(prefixBuf, prefixSize);
-
-    if (entryPtr == nullptr)
-    {
-        return;
-    }
-
-    const char *entry = *entryPtr;
     // We search with the query's prefix as key, so we shall try to match suffixes.
-    const uint16_t *prefixIndex = reinterpret_cast<const uint16_t *>(entry);
+    const PrefixIndexType *prefixIndex = reinterpret_cast<const PrefixIndexType *>(entry);
 
     // This check whether the entry contains only prefixes (i.e. no suffixes that we are looking for)
     // is likely to provide some speedup.
@@ -182,75 +221,41 @@ void SplitIndex1Comp::searchWithPrefixAsKey(ResultSetType &results)
         return;
     }
 
-    entry += 2;
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
     const char cSuffixSize = static_cast<char>(suffixSize);
 
-    if (*prefixIndex != 0)
+    // If there are some prefixes stored in this entry, we shall stop when they are reached.
+    // Otherwise there are only suffixes stored in this entry, so we check everything.
+    const char *end = (*prefixIndex != 0) ? advanceInEntryByWordCount(entry, *prefixIndex - 1) : nullptr;
+
+    while (entry != end and *entry != 0)
     {
-        // There are some prefixes stored in this entry, so we shall advance until they are reached.
-        const char *end = advanceInEntryByWordCount(entry, *prefixIndex - 1);
+        const size_t partSize = utils::SizeCoding::read(entry);
 
-        while (entry != end)
-        {           
-            assert(*entry != 0);
+        // The first byte of each part holds its decoded size.
+        if (entry[0] == cSuffixSize)
+        {
+            decodeToBuf(entry + 1, partSize - 1, suffixSize);
 
-            if (*entry <= cSuffixSize)
+            if (utils::Distance::isHammingAtMostK<1>(codingBuf, suffixBuf, suffixSize))
             {
-                const size_t decodedSize = decodeToBuf(entry + 1, *entry, cSuffixSize);
+                addMatch(matches, prefixBuf, codingBuf);
 
-                if (decodedSize == cSuffixSize and 
-                    utils::Distance::isHammingAtMostK<1>(codingBuf, suffixBuf, suffixSize))
+                if (matches.isDone())
                 {
-                    const string result = string(prefixBuf, prefixSize) + string(codingBuf, decodedSize);
-
-                    if (results.find(result) == results.end())
-                    {
-                        results.insert(move(result));
-                    }
+                    return;
                 }
             }
-
-            entry += 1 + *entry;
         }
-    }
-    else
-    {
-        // There are only suffixes stored in this entry, so we check everything.
-        while (*entry != 0)
-        {       
-            if (*entry <= cSuffixSize)
-            {
-                const size_t decodedSize = decodeToBuf(entry + 1, *entry, cSuffixSize);
 
-                if (decodedSize == cSuffixSize and
-                    utils::Distance::isHammingAtMostK<1>(codingBuf, suffixBuf, suffixSize))
-                {
-                    const string result = string(prefixBuf, prefixSize) + string(codingBuf, decodedSize);
-
-                    if (results.find(result) == results.end())
-                    {
-                        results.insert(move(result));
-                    }
-                }
-            }
-
-            entry += 1 + *entry;
-        }
+        entry += partSize;
     }
 }
 
-void SplitIndex1Comp::searchWithSuffixAsKey(ResultSetType &results)
+void SplitIndex1Comp::searchWithSuffixAsKey(const char *entry, MatchCollector &matches)
 {
-    char **entryPtr = hashMap->retrieve(suffixBuf, suffixSize);
-
-    if (entryPtr == nullptr)
-    {
-        return;
-    }
-
-    const char *entry = *entryPtr;
     // We search with the query's suffix as key, so we shall try to match prefixes.
-    const uint16_t *prefixIndex = reinterpret_cast<const uint16_t *>(entry);
+    const PrefixIndexType *prefixIndex = reinterpret_cast<const PrefixIndexType *>(entry);
 
     // This check whether the entry contains only suffixes (i.e. no prefixes that we are looking for)
     // is likely to provide some speedup.
@@ -259,62 +264,64 @@ void SplitIndex1Comp::searchWithSuffixAsKey(ResultSetType &results)
         return;
     }
 
-    entry = advanceInEntryByWordCount(entry + 2, *prefixIndex - 1);
+    entry = advanceInEntryByWordCount(entry + sizeof(PrefixIndexType), *prefixIndex - 1);
     const char cPrefixSize = static_cast<char>(prefixSize);
 
     while (*entry != 0)
     {
-        if (*entry <= cPrefixSize)
+        const size_t partSize = utils::SizeCoding::read(entry);
+
+        // The first byte of each part holds its decoded size.
+        if (entry[0] == cPrefixSize)
         {
-            const size_t decodedSize = decodeToBuf(entry + 1, *entry, cPrefixSize);
+            decodeToBuf(entry + 1, partSize - 1, prefixSize);
 
-            if (decodedSize == cPrefixSize and
-                utils::Distance::isHammingAtMostK<1>(codingBuf, prefixBuf, prefixSize))
+            if (utils::Distance::isHammingAtMostK<1>(codingBuf, prefixBuf, prefixSize))
             {
-                const string result = string(codingBuf, decodedSize) + string(suffixBuf, suffixSize);
+                addMatch(matches, codingBuf, suffixBuf);
 
-                if (results.find(result) == results.end())
+                if (matches.isDone())
                 {
-                    results.insert(move(result));
+                    return;
                 }
             }
         }
 
-        entry += 1 + *entry;
+        entry += partSize;
     }
 }
 
 size_t SplitIndex1Comp::encodeToBuf(const char *word, size_t wordSize)
 {
-    assert(qgramSize <= wordSize);
-
-    const size_t qgramEnd = wordSize - qgramSize + 1;
     size_t iBuf = 0;
+    size_t iW = 0;
 
-    for (size_t iW = 0; iW < wordSize; ++iW)
+    while (iW < wordSize)
     {
-        if (iW < qgramEnd)
-        {
-            assert(iW + qgramSize <= wordSize);
-            auto it = qgramToChar.find(string(word + iW, qgramSize));
+        char code = 0;
+        size_t curQgramSize = std::min(maxCodedQgramSize, wordSize - iW);
 
-            if (it != qgramToChar.end())
-            {
-                codingBuf[iBuf++] = it->second;
-                iW += qgramSize - 1;
-            }
-            else
+        // We start with the longest q-grams.
+        for ( ; curQgramSize >= 2; --curQgramSize)
+        {
+            if ((code = findQgramCode(word + iW, curQgramSize)) != 0)
             {
-                codingBuf[iBuf++] = word[iW];
+                break;
             }
         }
+
+        if (code != 0)
+        {
+            codingBuf[iBuf++] = code;
+            iW += curQgramSize;
+        }
         else
         {
-            codingBuf[iBuf++] = word[iW];
+            codingBuf[iBuf++] = word[iW++];
         }
     }
 
-    assert(iBuf < maxWordSize);
+    assert(iBuf <= wordSize and iBuf < maxWordSize);
     return iBuf;
 }
 
@@ -324,19 +331,11 @@ size_t SplitIndex1Comp::decodeToBuf(const char *word, size_t wordSize, size_t ma
 
     for (size_t iW = 0; iW < wordSize; ++iW)
     {
-        auto it = charToQgram.find(word[iW]);
-
-        if (it != charToQgram.end())
-        {
-            const string &qgram = it->second;
+        const QgramDecoding &decoding = decodingLUT[static_cast<unsigned char>(word[iW])];
 
-            memcpy(codingBuf + iBuf, qgram.c_str(), qgram.size());
-            iBuf += qgram.size();
-        }
-        else
-        {
-            codingBuf[iBuf++] = word[iW];
-        }
+        // We always copy the maximum q-gram size, codingBuf has some extra space for this purpose.
+        memcpy(codingBuf + iBuf, decoding.qgram, maxQgramSize);
+        iBuf += decoding.size;
 
         if (iBuf > maxDecodedWordSize)
         {
@@ -347,4 +346,15 @@ size_t SplitIndex1Comp::decodeToBuf(const char *word, size_t wordSize, size_t ma
     return iBuf;
 }
 
+size_t SplitIndex1Comp::encodeWithSizeToBuf(const char *word, size_t wordSize)
+{
+    // We encode to the very beginning of the buffer and then shift the result by 1 byte
+    // in order to make room for the size.
+    const size_t encodedSize = encodeToBuf(word, wordSize);
+    memmove(codingBuf + 1, codingBuf, encodedSize);
+
+    codingBuf[0] = static_cast<char>(wordSize);
+    return encodedSize + 1;
+}
+
 } // namespace split_index
@@ -1,8 +1,12 @@
 #ifndef SPLIT_INDEX_1_COMP_HPP
 #define SPLIT_INDEX_1_COMP_HPP
 
+#include <cstdint>
 #include <map>
+#include <utility>
+#include <vector>
 
+#include "qgram_codec.hpp"
 #include "split_index_1.hpp"
 
 #ifndef SPLIT_INDEX_1_COMP_WHITEBOX
@@ -26,23 +30,44 @@ public:
 protected:
     virtual void calcQgramsAndFillMaps();
 
+    /** Returns (at most) [curNQgrams] most frequent q-grams of size [curQgramSize] in the dictionary,
+     * ordered by decreasing frequency. Counting is performed in parallel. */
     std::vector<std::string> calcQGramsOrderedByFrequency(size_t curNQgrams, size_t curQgramSize) const;
+    /** Returns (at most) [curNQgrams] pairs [count, q-gram] for the most frequent q-grams of size [curQgramSize],
+     * ordered by decreasing count. */
+    std::vector<std::pair<uint32_t, std::string>> calcQgramCounts(size_t curNQgrams, size_t curQgramSize) const;
 
-    /** Fills both q-gram maps with [qgrams], starting encoding with [curFirstChar].
+    /** Returns the ratio of the total size of stored word parts and the total size of their encodings. */
+    double calcCompressionRatio() const;
+
+    /** Clears both q-gram maps and resets the coding tables so that each char is decoded to itself. */
+    void clearQgramMaps();
+    /** Fills both q-gram maps and the coding tables with [qgrams], starting encoding with [curFirstChar].
      * Invalidates insides of [qgrams] vector for performance. */
     void fillQgramMaps(std::vector<std::string> &qgrams, char curFirstChar);
 
+    /** Returns the code for a q-gram of size [curQgramSize] starting at [qgram], or 0 if it is not encoded. */
+    inline char findQgramCode(const char *qgram, size_t curQgramSize) const;
+
     void initEntry(const std::string &word) override;
 
-    void searchWithPrefixAsKey(ResultSetType &results) override;
-    void searchWithSuffixAsKey(ResultSetType &results) override;
+    /** Decoded sizes of word parts are stored in single bytes. */
+    size_t getMaxWordSize() const override { return maxByteWordSize; }
+
+    void searchWithPrefixAsKey(const char *entry, MatchCollector &matches) override;
+    void searchWithSuffixAsKey(const char *entry, MatchCollector &matches) override;
 
-    /** Encodes [word] of size [wordSize] into codingBuf. Returns the size of encoded word. */
+    /** Encodes [word] of size [wordSize] into codingBuf. Returns the size of encoded word.
+     * At each position the longest q-gram which has a code is encoded. */
     virtual size_t encodeToBuf(const char *word, size_t wordSize);
     /** Decodes [word] of size [wordSize] into codingBuf.
      * Returns the size of decoded word or 0 if [maxDecodedWordSize] is exceeded. */
     virtual size_t decodeToBuf(const char *word, size_t wordSize, size_t maxDecodedWordSize);
 
+    /** Stores the size of [word] of size [wordSize] followed by its encoding in codingBuf.
+     * Returns the number of bytes stored, i.e. 1 + the size of encoded word. */
+    size_t encodeWithSizeToBuf(const char *word, size_t wordSize);
+
     char *codingBuf = nullptr;
 
     /** A map q-gram -> char. */
@@ -50,6 +75,29 @@ protected:
     /** A map char -> q-gram. */
     std::map<char, std::string> charToQgram;
 
+    /** The longest supported q-gram for the coding tables. */
+    static constexpr size_t maxQgramSize = 4;
+
+    /** A single decoding table entry, chars which do not encode q-grams are decoded to themselves. */
+    struct QgramDecoding
+    {
+        char qgram[maxQgramSize];
+        uint8_t size;
+    };
+
+    /** A flat decoding table char -> q-gram. */
+    QgramDecoding decodingLUT[256];
+
+    /** A flat encoding table for 2-grams, indexed by the packed 2-gram, 0 indicates no code. */
+    char *digramLUT = nullptr;
+    /** Packed q-grams (sorted) and their codes, indexed by the q-gram size (3 and 4). */
+    std::vector<std::pair<uint64_t, char>> packedQgramCodes[maxQgramSize + 1];
+    /** The longest size of q-grams which have been assigned codes. */
+    size_t maxCodedQgramSize = 0;
+
+    /** Total sizes of stored word parts before and after encoding (without size bytes). */
+    size_t nPartBytes = 0, nEncodedPartBytes = 0;
+
     /** Total number of q-grams used for encoding symbols. */
     const size_t nQgrams = 100;
     /** Size of each q-gram, e.g., use 2 for digrams. */
@@ -58,6 +106,8 @@ protected:
     /** First char value which is used for q-gram encoding (the rest is consecutive).
      * This assumes that the code is compiled using unsigned chars. */
     static constexpr char firstChar = 128;
+    /** The number of 2-grams, i.e. the size of the 2-gram encoding table. */
+    static constexpr size_t nDigrams = 256 * 256;
 
     SPLIT_INDEX_1_COMP_WHITEBOX
 };
@@ -0,0 +1,40 @@
+#include "split_index_1_comp_ext.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+SplitIndex1CompExt::SplitIndex1CompExt(const unordered_set<string> &wordSet,
+    hash_functions::HashFunctions::HashType hashType,
+    float maxLoadFactor)
+        :SplitIndex1Comp(wordSet, hashType, maxLoadFactor)
+{ }
+
+string SplitIndex1CompExt::toString() const
+{
+    if (not constructed)
+    {
+        return "Index not constructed";
+    }
+
+    return SplitIndex1::toString() + "\nWith extended compression: " + codec.toString();
+}
+
+void SplitIndex1CompExt::calcQgramsAndFillMaps()
+{
+    clearQgramMaps();
+    codec.build(wordSet);
+}
+
+size_t SplitIndex1CompExt::encodeToBuf(const char *word, size_t wordSize)
+{
+    return codec.encode(word, wordSize, codingBuf);
+}
+
+size_t SplitIndex1CompExt::decodeToBuf(const char *word, size_t wordSize, size_t maxDecodedWordSize)
+{
+    return codec.decode(word, wordSize, maxDecodedWordSize, codingBuf);
+}
+
+} // namespace split_index
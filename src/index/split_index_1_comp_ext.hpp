@@ -0,0 +1,41 @@
+#ifndef SPLIT_INDEX_1_COMP_EXT_HPP
+#define SPLIT_INDEX_1_COMP_EXT_HPP
+
+#include "qgram_codec.hpp"
+#include "split_index_1_comp.hpp"
+
+#ifndef SPLIT_INDEX_1_COMP_WHITEBOX
+#define SPLIT_INDEX_1_COMP_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for k = 1, using compression with an extended code space of 2- to 6-grams,
+ * i.e. single-byte and two-byte codes (see QgramCodec). */
+class SplitIndex1CompExt : public SplitIndex1Comp
+{
+public:
+    SplitIndex1CompExt(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType,
+        float maxLoadFactor);
+
+    std::string toString() const override;
+
+protected:
+    void calcQgramsAndFillMaps() override;
+
+    /** Encodes [word] of size [wordSize] into codingBuf using optimal parsing. Returns the size of encoded word. */
+    size_t encodeToBuf(const char *word, size_t wordSize) override;
+    /** Decodes [word] of size [wordSize] into codingBuf.
+     * Returns the size of decoded word or 0 if [maxDecodedWordSize] is exceeded. */
+    size_t decodeToBuf(const char *word, size_t wordSize, size_t maxDecodedWordSize) override;
+
+    QgramCodec codec;
+
+    SPLIT_INDEX_1_COMP_WHITEBOX
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_1_COMP_EXT_HPP
@@ -3,8 +3,11 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
 
 #include "split_index_1_comp_triple.hpp"
+#include "../utils/parallel.hpp"
 
 using namespace std;
 
@@ -15,16 +18,7 @@ SplitIndex1CompTriple::SplitIndex1CompTriple(const unordered_set<string> &wordSe
     hash_functions::HashFunctions::HashType hashType,
     float maxLoadFactor)
         :SplitIndex1Comp(wordSet, hashType, maxLoadFactor)
-{
-    encodingTmpBuf1 = new char[maxWordSize];
-    encodingTmpBuf2 = new char[maxWordSize];
-}
-
-SplitIndex1CompTriple::~SplitIndex1CompTriple()
-{
-    delete[] encodingTmpBuf1;
-    delete[] encodingTmpBuf2;
-}
+{ }
 
 string SplitIndex1CompTriple::toString() const
 {
@@ -34,104 +28,202 @@ string SplitIndex1CompTriple::toString() const
     }
 
     string out = "\nWith compression:\n";
-    out += (boost::format("#2-grams = %1%, #3-grams = %2%, #4-grams = %3%")
-        % curN2grams % curN3grams % curN4grams).str();
+    out += (boost::format("#2-grams = %1%, #3-grams = %2%, #4-grams = %3%, compression ratio = %4%")
+        % curN2grams % curN3grams % curN4grams % calcCompressionRatio()).str();
 
     return SplitIndex1::toString() + out;
 }
 
 void SplitIndex1CompTriple::calcQgramsAndFillMaps()
 {
-    qgramToChar.clear();
-    charToQgram.clear();
+    clearQgramMaps();
 
-    char curFirstChar = firstChar;
+    vector<string> q2grams = calcQGramsOrderedByFrequency(nCodes, 2);
+    vector<string> q3grams = calcQGramsOrderedByFrequency(nCodes, 3);
+    vector<string> q4grams = calcQGramsOrderedByFrequency(nCodes, 4);
 
-    vector<string> q2grams = calcQGramsOrderedByFrequency(n2grams, 2);
-    curN2grams = q2grams.size();
+    tuneQgramCounts(q2grams, q3grams, q4grams);
+
+    q2grams.resize(curN2grams);
+    q3grams.resize(curN3grams);
+    q4grams.resize(curN4grams);
+
+    char curFirstChar = firstChar;
 
     fillQgramMaps(q2grams, curFirstChar); // Invalidates insides of the qgrams vector.
     curFirstChar += curN2grams;
-    
-    vector<string> q3grams = calcQGramsOrderedByFrequency(n3grams, 3);
-    curN3grams = q3grams.size();
 
     fillQgramMaps(q3grams, curFirstChar); // Invalidates insides of the qgrams vector.
     curFirstChar += curN3grams;
 
-    vector<string> q4grams = calcQGramsOrderedByFrequency(n4grams, 4);
-    curN4grams = q4grams.size();
-
     fillQgramMaps(q4grams, curFirstChar); // Invalidates insides of the qgrams vector.
 
     assert(qgramToChar.size() == curN2grams + curN3grams + curN4grams);
     assert(charToQgram.size() == curN2grams + curN3grams + curN4grams);
-}
-
-size_t SplitIndex1CompTriple::encodeToBuf(const char *word, size_t wordSize)
-{        
-    // Note that the chars which are used for encoding do not appear in the input text,
-    // so such sequential encoding should not run into any unintended q-gram overlap issues.
 
-    const char *curSrc = word;
-    size_t curWordSize = wordSize;
+    cout << boost::format("Filled maps for %1% 2-grams, %2% 3-grams, %3% 4-grams")
+        % curN2grams % curN3grams % curN4grams << endl;
+}
 
-    // We start with the longest q-grams.
-    if (curWordSize >= 4)
+void SplitIndex1CompTriple::tuneQgramCounts(const vector<string> &q2grams,
+    const vector<string> &q3grams,
+    const vector<string> &q4grams)
+{
+    // If all q-grams fit, there is nothing to tune.
+    if (q2grams.size() + q3grams.size() + q4grams.size() <= nCodes)
     {
-        curWordSize = encodeToBuf(encodingTmpBuf1, word, wordSize, 4);
-        curSrc = encodingTmpBuf1;
+        curN2grams = q2grams.size();
+        curN3grams = q3grams.size();
+        curN4grams = q4grams.size();
+
+        return;
     }
 
-    if (curWordSize >= 3)
+    const vector<string> qgrams[] { { }, { }, q2grams, q3grams, q4grams };
+    vector<uint8_t> sampleRanks[maxQgramSize + 1];
+
+    calcSampleRanks(qgrams, sampleRanks);
+
+    // Candidates are pairs [#3-grams, #4-grams], all remaining codes are assigned to 2-grams.
+    auto evaluateCandidates = [&](const vector<pair<size_t, size_t>> &candidates) -> pair<size_t, size_t>
     {
-        curWordSize = encodeToBuf(encodingTmpBuf2, curSrc, curWordSize, 3);
-        curSrc = encodingTmpBuf2;
-    }
+        vector<size_t> encodedSizes(candidates.size());
+
+        utils::Parallel::forRanges(candidates.size(), [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const size_t n2 = std::min(q2grams.size(), nCodes - candidates[i].first - candidates[i].second);
+                encodedSizes[i] = calcEncodedSampleSize(sampleRanks, n2, candidates[i].first, candidates[i].second);
+            }
+        });
+
+        // Ties are resolved in favor of the first candidate.
+        const size_t iBest = std::min_element(encodedSizes.begin(), encodedSizes.end()) - encodedSizes.begin();
+        return candidates[iBest];
+    };
 
-    if (curWordSize >= 2)
+    const size_t maxN3 = std::min(q3grams.size(), static_cast<size_t>(nCodes));
+    const size_t maxN4 = std::min(q4grams.size(), static_cast<size_t>(nCodes));
+
+    // 1. Coarse grid search.
+    vector<pair<size_t, size_t>> candidates;
+
+    for (size_t n3 = 0; n3 <= maxN3; n3 += tuningGridStep)
     {
-        return encodeToBuf(codingBuf, curSrc, curWordSize, 2);
+        for (size_t n4 = 0; n4 <= maxN4 and n3 + n4 <= nCodes; n4 += tuningGridStep)
+        {
+            candidates.emplace_back(n3, n4);
+        }
     }
-    else
+
+    const pair<size_t, size_t> coarseBest = evaluateCandidates(candidates);
+
+    // 2. Local search around the best grid point.
+    candidates.clear();
+
+    const size_t minN3 = coarseBest.first - std::min(coarseBest.first, tuningGridStep - 1);
+    const size_t minN4 = coarseBest.second - std::min(coarseBest.second, tuningGridStep - 1);
+
+    for (size_t n3 = minN3; n3 <= std::min(maxN3, coarseBest.first + tuningGridStep - 1); ++n3)
     {
-        memcpy(codingBuf, curSrc, curWordSize);
-        return curWordSize;
+        for (size_t n4 = minN4; n4 <= std::min(maxN4, coarseBest.second + tuningGridStep - 1) and n3 + n4 <= nCodes; ++n4)
+        {
+            candidates.emplace_back(n3, n4);
+        }
     }
+
+    const pair<size_t, size_t> best = evaluateCandidates(candidates);
+
+    curN3grams = best.first;
+    curN4grams = best.second;
+    curN2grams = std::min(q2grams.size(), nCodes - curN3grams - curN4grams);
+
+    assert(curN2grams + curN3grams + curN4grams <= nCodes);
 }
 
-size_t SplitIndex1CompTriple::encodeToBuf(char *dstBuf, const char *word, size_t curWordSize, size_t curQgramSize)
+void SplitIndex1CompTriple::calcSampleRanks(const vector<string> *qgrams, vector<uint8_t> *sampleRanks)
 {
-    assert(curQgramSize <= curWordSize);
+    unordered_map<uint64_t, uint8_t> packedToRank[maxQgramSize + 1];
 
-    const size_t qgramEnd = curWordSize - curQgramSize + 1;
-    size_t iBuf = 0;
+    for (size_t q = 2; q <= maxQgramSize; ++q)
+    {
+        assert(qgrams[q].size() < maxRank);
 
-    for (size_t iW = 0; iW < curWordSize; ++iW)
+        for (size_t rank = 0; rank < qgrams[q].size(); ++rank)
+        {
+            packedToRank[q][QgramCodec::packQgram(qgrams[q][rank].c_str(), q)] = rank;
+        }
+
+        sampleRanks[q].clear();
+    }
+
+    // Word parts are split in the same way as during the construction, using prefixSizeLUT.
+    const size_t sampleStep = std::max<size_t>(1, wordSet.size() / maxNTuningWords);
+    size_t iWord = 0;
+
+    for (const string &word : wordSet)
     {
-        if (iW < qgramEnd)
+        if (iWord++ % sampleStep != 0 or word.size() < getMinWordSize() or word.size() > maxWordSize)
         {
-            assert(iW + curQgramSize <= curWordSize);
-            auto it = qgramToChar.find(string(word + iW, curQgramSize));
+            continue;
+        }
 
-            if (it != qgramToChar.end())
-            {
-                dstBuf[iBuf++] = it->second;
-                iW += curQgramSize - 1;
-            }
-            else
+        const size_t prefixSize = prefixSizeLUT[word.size()];
+
+        for (const pair<size_t, size_t> &part : { pair<size_t, size_t>(0, prefixSize),
+            pair<size_t, size_t>(prefixSize, word.size()) })
+        {
+            for (size_t i = part.first; i < part.second; ++i)
             {
-                dstBuf[iBuf++] = word[iW];
+                for (size_t q = 2; q <= maxQgramSize; ++q)
+                {
+                    uint8_t rank = maxRank;
+
+                    if (i + q <= part.second)
+                    {
+                        auto it = packedToRank[q].find(QgramCodec::packQgram(word.c_str() + i, q));
+
+                        if (it != packedToRank[q].end())
+                        {
+                            rank = it->second;
+                        }
+                    }
+
+                    sampleRanks[q].push_back(rank);
+                }
             }
         }
+    }
+}
+
+size_t SplitIndex1CompTriple::calcEncodedSampleSize(const vector<uint8_t> *sampleRanks, size_t n2, size_t n3, size_t n4)
+{
+    const size_t sampleSize = sampleRanks[2].size();
+    size_t encodedSize = 0;
+
+    // This mimics the encoding: the longest q-gram which has a code is chosen at each position.
+    for (size_t i = 0; i < sampleSize; ++encodedSize)
+    {
+        if (sampleRanks[4][i] < n4)
+        {
+            i += 4;
+        }
+        else if (sampleRanks[3][i] < n3)
+        {
+            i += 3;
+        }
+        else if (sampleRanks[2][i] < n2)
+        {
+            i += 2;
+        }
         else
         {
-            dstBuf[iBuf++] = word[iW];
+            i += 1;
         }
     }
 
-    assert(iBuf < maxWordSize);
-    return iBuf;
+    return encodedSize;
 }
 
 } // namespace split_index
@@ -1,6 +1,9 @@
 #ifndef SPLIT_INDEX_1_COMP_TRIPLE_HPP
 #define SPLIT_INDEX_1_COMP_TRIPLE_HPP
 
+#include <cstdint>
+#include <vector>
+
 #include "split_index_1_comp.hpp"
 
 #ifndef SPLIT_INDEX_1_COMP_WHITEBOX
@@ -10,33 +13,48 @@
 namespace split_index
 {
 
-/** Split index for k = 1, using compression with a combination of 2-, 3-, and 4-grams. */
+/** Split index for k = 1, using compression with a combination of 2-, 3-, and 4-grams.
+ * The encoding (performed by the base class) always prefers the longest q-gram at each position.
+ * The numbers of 2-, 3-, and 4-grams are tuned during construction for the indexed dictionary. */
 class SplitIndex1CompTriple : public SplitIndex1Comp
 {
 public:
     SplitIndex1CompTriple(const std::unordered_set<std::string> &wordSet,
         hash_functions::HashFunctions::HashType hashType,
         float maxLoadFactor);
-    ~SplitIndex1CompTriple();
 
     std::string toString() const override;
 
 protected:
     void calcQgramsAndFillMaps() override;
 
-    size_t encodeToBuf(const char *word, size_t wordSize) override;
-    size_t encodeToBuf(char *dstBuf, const char *word, size_t curWordSize, size_t curQgramSize);
+    /** Sets curN2grams, curN3grams, and curN4grams so that the total size of encoded word parts
+     * (from a sample of the dictionary) is minimized, the code space (nCodes) is shared by all q-gram sizes.
+     * Candidate q-grams are ordered by frequency, only their prefixes are used. */
+    void tuneQgramCounts(const std::vector<std::string> &q2grams,
+        const std::vector<std::string> &q3grams,
+        const std::vector<std::string> &q4grams);
+
+    /** Fills [sampleRanks] with ranks of q-grams (from [qgrams], indexed by q-gram size) starting at consecutive
+     * positions of sampled word parts (concatenated), maxRank is used for q-grams which are absent or would cross parts. */
+    void calcSampleRanks(const std::vector<std::string> *qgrams, std::vector<uint8_t> *sampleRanks);
 
-    char *encodingTmpBuf1 = nullptr;
-    char *encodingTmpBuf2 = nullptr;
+    /** Returns the total encoded size of sampled word parts represented by [sampleRanks]
+     * when using [n2] 2-grams, [n3] 3-grams, and [n4] 4-grams. */
+    static size_t calcEncodedSampleSize(const std::vector<uint8_t> *sampleRanks, size_t n2, size_t n3, size_t n4);
 
-    /** These are actual q-gram counts extracted from the text.
-     * They cannot be greater than the constants below. */
+    /** These are actual q-gram counts chosen for the dictionary, their sum cannot be greater than nCodes. */
     size_t curN2grams = 0, curN3grams = 0, curN4grams = 0;
 
-    /** These are all compile-time constants.
-     * They should be determined earlier for specific (expected) data. */
-    static constexpr size_t n2grams = 96, n3grams = 3, n4grams = 1;
+    /** The number of available codes, i.e. chars in [firstChar, 255). */
+    static constexpr size_t nCodes = 127;
+    /** The rank denoting a q-gram which has no code. */
+    static constexpr uint8_t maxRank = 255;
+
+    /** At most this many words are sampled for tuning q-gram counts. */
+    static constexpr size_t maxNTuningWords = 20000;
+    /** The step of the coarse grid search over q-gram counts, which is followed by a local search. */
+    static constexpr size_t tuningGridStep = 8;
 
     // We can take advantage of the whitebox class for the base class since functions are overridden here.
     SPLIT_INDEX_1_COMP_WHITEBOX
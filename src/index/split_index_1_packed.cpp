@@ -0,0 +1,261 @@
+#include <boost/format.hpp>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "split_index_1_packed.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+SplitIndex1Packed::SplitIndex1Packed(const unordered_set<string> &wordSet,
+    hash_functions::HashFunctions::HashType hashType,
+    float maxLoadFactor)
+        :SplitIndex1(wordSet, hashType, maxLoadFactor)
+{
+    unpackingBuf = new char[maxWordSize];
+}
+
+SplitIndex1Packed::~SplitIndex1Packed()
+{
+    delete[] unpackingBuf;
+}
+
+void SplitIndex1Packed::construct()
+{
+    packer.build(wordSet);
+    SplitIndex1::construct();
+}
+
+string SplitIndex1Packed::toString() const
+{
+    if (not constructed)
+    {
+        return "Index not constructed";
+    }
+
+    return SplitIndex1::toString() + "\nWith packed word parts: " + packer.toString();
+}
+
+bool SplitIndex1Packed::canInsertInPlace(const string &word) const
+{
+    return SplitIndex1::canInsertInPlace(word) and packer.isInAlphabet(word.c_str(), word.size());
+}
+
+void SplitIndex1Packed::processQuery(const string &query, MatchCollector &matches)
+{
+    assert(constructed);
+    assert(query.size() > 0 and query.size() <= maxWordSize);
+
+    storePrefixSuffixInBuffers(query);
+
+    packer.packQuery(prefixBuf, prefixSize, prefixWords, prefixForeignMasks);
+    packer.packQuery(suffixBuf, suffixSize, suffixWords, suffixForeignMasks);
+
+    searchBothKeys(matches);
+}
+
+size_t SplitIndex1Packed::calcEntrySizeB(const char *entry) const
+{
+    const char *start = entry;
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
+
+    while (*entry != 0)
+    {
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+
+    return entry - start + 1; // This includes the terminating 0.
+}
+
+size_t SplitIndex1Packed::calcEntryNWords(const char *entry) const
+{
+    size_t nWords = 0;
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
+
+    while (*entry != 0)
+    {
+        nWords += 1;
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+
+    return nWords;
+}
+
+char *SplitIndex1Packed::createEntry(const char *wordPart, size_t partSize, bool isPartSuffix) const
+{
+    const size_t packedSize = packer.calcPackedSize(partSize);
+    // 2 = size of word part, terminating 0.
+    const size_t newSize = sizeof(PrefixIndexType) + 2 + packedSize;
+
+    char *entry = static_cast<char *>(malloc(newSize * sizeof(char)));
+    assert(entry != nullptr);
+
+    // The prefix index is a 1-based index over the word count, as in SplitIndex1.
+    *reinterpret_cast<PrefixIndexType *>(entry) = isPartSuffix ? 0u : 1u;
+
+    // Parts have at most maxByteWordSize chars, so their sizes are single bytes.
+    entry[sizeof(PrefixIndexType)] = static_cast<char>(partSize);
+    packer.pack(wordPart, partSize, entry + sizeof(PrefixIndexType) + 1);
+
+    entry[newSize - 1] = 0;
+    return entry;
+}
+
+void SplitIndex1Packed::addToEntry(char **entryPtr,
+    const char *wordPart, size_t partSize,
+    bool isPartSuffix) const
+{
+    assert(partSize > 0 and partSize <= maxByteWordSize);
+
+    // The prefix index is checked before any changes are made, see SplitIndex1::addToEntry.
+    const PrefixIndexType oldPrefixIndex = *reinterpret_cast<const PrefixIndexType *>(*entryPtr);
+    const size_t maxPrefixIndex = numeric_limits<PrefixIndexType>::max();
+
+    if ((isPartSuffix and oldPrefixIndex == maxPrefixIndex) or
+        (not isPartSuffix and oldPrefixIndex == 0 and calcEntryNWords(*entryPtr) >= maxPrefixIndex))
+    {
+        throw runtime_error("too many words stored under a single key, rebuild with SPLIT_INDEX_LONG_WORDS");
+    }
+
+    char packed[PartPacker::maxPartSize];
+    const size_t packedSize = packer.pack(wordPart, partSize, packed);
+
+    const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
+    const size_t newEntrySize = oldEntrySize + packedSize + 1;
+
+    char *newEntry = static_cast<char *>(realloc(*entryPtr, newEntrySize * sizeof(char)));
+    assert(newEntry != nullptr);
+
+    PrefixIndexType *prefixIndex = reinterpret_cast<PrefixIndexType *>(newEntry);
+
+    if (isPartSuffix and (*prefixIndex) != 0)
+    {
+        // We insert a suffix before the prefixes, see SplitIndex1::addToEntry.
+        char *prefixesStart = advanceInEntryByWordCount(newEntry + sizeof(PrefixIndexType), (*prefixIndex) - 1);
+
+        const size_t prefixesListSize = oldEntrySize - (prefixesStart - newEntry);
+        assert(newEntrySize == prefixesStart - newEntry + packedSize + 1 + prefixesListSize);
+
+        memmove(prefixesStart + packedSize + 1, prefixesStart, prefixesListSize);
+
+        *prefixesStart = static_cast<char>(partSize);
+        memcpy(prefixesStart + 1, packed, packedSize);
+
+        *prefixIndex += 1;
+    }
+    else
+    {
+        appendPackedToEntry(newEntry, oldEntrySize, packed, partSize, packedSize);
+
+        if (not isPartSuffix and *prefixIndex == 0)
+        {
+            *prefixIndex = static_cast<PrefixIndexType>(calcEntryNWords(newEntry));
+        }
+    }
+
+    // This is required in the case the memory has been moved by realloc.
+    *entryPtr = newEntry;
+    assert(newEntry[newEntrySize - 1] == 0);
+}
+
+void SplitIndex1Packed::appendPackedToEntry(char *entry, size_t oldEntrySize,
+    const char *wordPart, size_t partSize, size_t packedSize) const
+{
+    entry[oldEntrySize - 1] = static_cast<char>(partSize);
+
+    memcpy(entry + oldEntrySize, wordPart, packedSize);
+    entry[oldEntrySize + packedSize] = 0;
+}
+
+void SplitIndex1Packed::searchWithPrefixAsKey(const char *entry, MatchCollector &matches)
+{
+    // We search with the query's prefix as key, so we shall try to match suffixes.
+    const PrefixIndexType prefixIndex = *reinterpret_cast<const PrefixIndexType *>(entry);
+
+    if (prefixIndex == 1)
+    {
+        return;
+    }
+
+    entry += sizeof(PrefixIndexType); // We jump over the prefix index.
+    const char cSuffixSize = static_cast<char>(suffixSize);
+
+    // Suffixes end either where prefixes start or at the terminating 0.
+    const char *end = (prefixIndex != 0) ? advanceInEntryByWordCount(entry, prefixIndex - 1) : nullptr;
+
+    while (entry != end and *entry != 0)
+    {
+        if (*entry == cSuffixSize and
+            packer.isHammingAtMostK(entry + 1, suffixWords, suffixForeignMasks, suffixSize, 1))
+        {
+            packer.unpack(entry + 1, suffixSize, unpackingBuf);
+            addMatch(matches, prefixBuf, unpackingBuf);
+
+            if (matches.isDone())
+            {
+                return;
+            }
+        }
+
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+}
+
+void SplitIndex1Packed::searchWithSuffixAsKey(const char *entry, MatchCollector &matches)
+{
+    // We search with the query's suffix as key, so we shall try to match prefixes.
+    const PrefixIndexType prefixIndex = *reinterpret_cast<const PrefixIndexType *>(entry);
+
+    if (prefixIndex == 0)
+    {
+        return;
+    }
+
+    entry = advanceInEntryByWordCount(entry + sizeof(PrefixIndexType), prefixIndex - 1);
+    const char cPrefixSize = static_cast<char>(prefixSize);
+
+    while (*entry != 0)
+    {
+        if (*entry == cPrefixSize and
+            packer.isHammingAtMostK(entry + 1, prefixWords, prefixForeignMasks, prefixSize, 1))
+        {
+            packer.unpack(entry + 1, prefixSize, unpackingBuf);
+            addMatch(matches, unpackingBuf, suffixBuf);
+
+            if (matches.isDone())
+            {
+                return;
+            }
+        }
+
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+}
+
+char *SplitIndex1Packed::advanceInEntryByWordCount(char *entry, PrefixIndexType nWords) const
+{
+    for (PrefixIndexType i = 0; i < nWords; ++i)
+    {
+        assert(*entry != 0);
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+
+    return entry;
+}
+
+const char *SplitIndex1Packed::advanceInEntryByWordCount(const char *entry, PrefixIndexType nWords) const
+{
+    for (PrefixIndexType i = 0; i < nWords; ++i)
+    {
+        assert(*entry != 0);
+        entry += 1 + packer.calcPackedSize(*entry);
+    }
+
+    return entry;
+}
+
+} // namespace split_index
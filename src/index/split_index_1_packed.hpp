@@ -0,0 +1,80 @@
+#ifndef SPLIT_INDEX_1_PACKED_HPP
+#define SPLIT_INDEX_1_PACKED_HPP
+
+#include <cstdint>
+
+#include "part_packer.hpp"
+#include "split_index_1.hpp"
+
+#ifndef SPLIT_INDEX_1_PACKED_WHITEBOX
+#define SPLIT_INDEX_1_PACKED_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for k = 1, storing word parts packed using alphabet ranks (see PartPacker).
+ * Stored word parts consist of their (unpacked) size followed by the packed part,
+ * and they are verified in the packed form, only matches are unpacked. */
+class SplitIndex1Packed : public SplitIndex1
+{
+public:
+    SplitIndex1Packed(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor);
+    ~SplitIndex1Packed() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+protected:
+    void processQuery(const std::string &query, MatchCollector &matches) override;
+
+    size_t calcEntrySizeB(const char *entry) const override;
+
+    /** Sizes of word parts are stored in single bytes. */
+    size_t getMaxWordSize() const override { return maxByteWordSize; }
+
+    /** Returns the number of words (word parts) stored in [entry], hides SplitIndex1::calcEntryNWords. */
+    size_t calcEntryNWords(const char *entry) const;
+    size_t countEntryWords(const char *entry) const override { return calcEntryNWords(entry); }
+
+    /** These functions take unpacked word parts and pack them before storing. */
+    char *createEntry(const char *wordPart, size_t partSize, bool isPartSuffix) const override;
+    void addToEntry(char **entryPtr,
+        const char *wordPart, size_t partSize,
+        bool isPartSuffix) const override;
+
+    /** Appends a packed [wordPart] of [packedSize] bytes having [partSize] chars
+     * at the end of an existing [entry] having [oldEntrySize] bytes. */
+    void appendPackedToEntry(char *entry, size_t oldEntrySize,
+        const char *wordPart, size_t partSize, size_t packedSize) const;
+
+    void searchWithPrefixAsKey(const char *entry, MatchCollector &matches) override;
+    void searchWithSuffixAsKey(const char *entry, MatchCollector &matches) override;
+
+    /** Packed entries are scanned using SWAR verification, so no sub-indexes are built. */
+    void buildSubIndexes() override { }
+    void updateSubIndex(const char *) override { }
+
+    /** Word parts can only be packed if they consist of chars from the alphabet. */
+    bool canInsertInPlace(const std::string &word) const override;
+
+    char *advanceInEntryByWordCount(char *entry, PrefixIndexType nWords) const override;
+    const char *advanceInEntryByWordCount(const char *entry, PrefixIndexType nWords) const override;
+
+    PartPacker packer;
+
+    /** Temporarily store the query prefix and suffix packed into 64-bit words,
+     * and the masks of their chars which are outside the alphabet. */
+    uint64_t prefixWords[PartPacker::maxNWords], prefixForeignMasks[PartPacker::maxNWords];
+    uint64_t suffixWords[PartPacker::maxNWords], suffixForeignMasks[PartPacker::maxNWords];
+
+    /** Temporarily stores unpacked word parts. */
+    char *unpackingBuf = nullptr;
+
+    SPLIT_INDEX_1_PACKED_WHITEBOX
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_1_PACKED_HPP
@@ -0,0 +1,237 @@
+#include <boost/format.hpp>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+#include "split_index_1_router.hpp"
+#include "../hash_map/hash_map_aligned.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+SplitIndex1Router::SplitIndex1Router(const unordered_set<string> &wordSet,
+    hash_functions::HashFunctions::HashType hashType,
+    float maxLoadFactor)
+        :SplitIndex1(wordSet, hashType, maxLoadFactor)
+{
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
+    // Entries in the word map are empty, i.e. they consist of a single terminating '\0'.
+    auto calcWordEntrySizeB = [](const char *) -> size_t { return 1; };
+
+    wordMap = new hash_map::HashMapAligned(calcWordEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
+    sketchHash = hash_functions::HashFunctions::getHashFunction(hashType);
+
+    neighborBuf = new char[maxWordSize];
+}
+
+SplitIndex1Router::~SplitIndex1Router()
+{
+    delete wordMap;
+    delete[] neighborBuf;
+}
+
+string SplitIndex1Router::toString() const
+{
+    string out = (boost::format("\nWith routing: alphabet size = %1%, word map:\n") % alphabet.size()).str();
+    return SplitIndex1::toString() + out + wordMap->toString();
+}
+
+long SplitIndex1Router::calcHashMapSizeB() const
+{
+    return SplitIndex1::calcHashMapSizeB() + wordMap->calcTotalSizeB()
+        + entrySizeSketch.size() * sizeof(uint32_t);
+}
+
+void SplitIndex1Router::construct()
+{
+    calcAlphabet();
+
+    size_t sketchSize = 1;
+
+    while (sketchSize < sketchSizeFactor * wordSet.size())
+    {
+        sketchSize *= 2;
+    }
+
+    entrySizeSketch.assign(sketchSize, 0);
+
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
+    wordMap->clear(nBucketsHint);
+
+    SplitIndex1::construct();
+}
+
+void SplitIndex1Router::initEntry(const string &word)
+{
+    SplitIndex1::initEntry(word);
+
+    // The prefix and the suffix are still stored in the buffers after the base class call.
+    // Each key (part) holds the other part together with its size byte.
+    const size_t sketchMask = entrySizeSketch.size() - 1;
+
+    entrySizeSketch[sketchHash(prefixBuf, prefixSize) & sketchMask] += 1 + suffixSize;
+    entrySizeSketch[sketchHash(suffixBuf, suffixSize) & sketchMask] += 1 + prefixSize;
+
+    char emptyEntry = 0;
+    wordMap->insert(word.c_str(), word.size(), &emptyEntry);
+}
+
+bool SplitIndex1Router::canInsertInPlace(const string &word) const
+{
+    for (const char c : word)
+    {
+        if (not isInAlphabet[static_cast<unsigned char>(c)])
+        {
+            return false;
+        }
+    }
+
+    return SplitIndex1::canInsertInPlace(word);
+}
+
+void SplitIndex1Router::processQuery(const string &query, MatchCollector &matches)
+{
+    assert(constructed);
+    assert(query.size() > 0 and query.size() <= maxWordSize);
+
+    storePrefixSuffixInBuffers(query);
+
+    if (calcRoute(query) == RouteType::Neighborhood)
+    {
+        searchNeighborhood(query, matches);
+    }
+    else
+    {
+        searchBothKeys(matches);
+    }
+}
+
+void SplitIndex1Router::calcAlphabet()
+{
+    memset(isInAlphabet, 0, sizeof(isInAlphabet));
+
+    for (const string &word : wordSet)
+    {
+        for (const char c : word)
+        {
+            isInAlphabet[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    alphabet.clear();
+
+    for (size_t c = 0; c < 256; ++c)
+    {
+        if (isInAlphabet[c])
+        {
+            alphabet.push_back(static_cast<char>(c));
+        }
+    }
+
+    cout << "Calculated alphabet size = " << alphabet.size() << endl;
+}
+
+SplitIndex1Router::RouteType SplitIndex1Router::calcRoute(const string &query) const
+{
+    if (calcNeighborhoodCost(query.size()) < calcSplitCost(query.size()))
+    {
+        return RouteType::Neighborhood;
+    }
+
+    return RouteType::Split;
+}
+
+size_t SplitIndex1Router::calcSplitCost(size_t querySize) const
+{
+    // Both parts are hashed twice (once for the sketch and once for the actual retrieval),
+    // which is negligible when compared with scanning the entries.
+    return 2 * probeCost + querySize
+        + estimateEntrySizeB(prefixBuf, prefixSize)
+        + estimateEntrySizeB(suffixBuf, suffixSize);
+}
+
+size_t SplitIndex1Router::calcNeighborhoodCost(size_t querySize) const
+{
+    assert(alphabet.size() > 0);
+    const size_t nNeighbors = 1 + querySize * (alphabet.size() - 1);
+
+    return nNeighbors * (probeCost + querySize);
+}
+
+size_t SplitIndex1Router::estimateEntrySizeB(const char *key, size_t keySize) const
+{
+    const size_t sketchMask = entrySizeSketch.size() - 1;
+    return entrySizeSketch[sketchHash(key, keySize) & sketchMask];
+}
+
+void SplitIndex1Router::searchNeighborhood(const string &query, MatchCollector &matches)
+{
+    const size_t querySize = query.size();
+
+    // A dictionary word can differ from the query on at most one position,
+    // so we check how many query characters are absent from the dictionary.
+    size_t nForeign = 0, iForeign = 0;
+
+    for (size_t i = 0; i < querySize; ++i)
+    {
+        if (not isInAlphabet[static_cast<unsigned char>(query[i])])
+        {
+            nForeign += 1;
+            iForeign = i;
+        }
+    }
+
+    if (nForeign > 1)
+    {
+        return;
+    }
+
+    memcpy(neighborBuf, query.c_str(), querySize);
+
+    // If a single character is absent from the dictionary, then only this position can be substituted.
+    const size_t iStart = (nForeign == 1) ? iForeign : 0;
+    const size_t iEnd = (nForeign == 1) ? iForeign + 1 : querySize;
+
+    if (nForeign == 0 and wordMap->retrieve(neighborBuf, querySize) != nullptr)
+    {
+        matches.add(neighborBuf, querySize);
+
+        // When only checking existence, the search stops at the first match.
+        if (matches.isDone())
+        {
+            return;
+        }
+    }
+
+    for (size_t i = iStart; i < iEnd; ++i)
+    {
+        const char original = neighborBuf[i];
+
+        for (const char c : alphabet)
+        {
+            if (c == original)
+            {
+                continue;
+            }
+
+            neighborBuf[i] = c;
+
+            if (wordMap->retrieve(neighborBuf, querySize) != nullptr)
+            {
+                matches.add(neighborBuf, querySize);
+
+                if (matches.isDone())
+                {
+                    return;
+                }
+            }
+        }
+
+        neighborBuf[i] = original;
+    }
+}
+
+} // namespace split_index
@@ -0,0 +1,85 @@
+#ifndef SPLIT_INDEX_1_ROUTER_HPP
+#define SPLIT_INDEX_1_ROUTER_HPP
+
+#include <vector>
+
+#include "split_index_1.hpp"
+
+#ifndef SPLIT_INDEX_1_ROUTER_WHITEBOX
+#define SPLIT_INDEX_1_ROUTER_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for k = 1, which additionally stores an exact-match hash set of whole words.
+ * For each query the cost of both the split index search and the neighborhood generation
+ * (enumerating all substitution neighbors and looking them up in the hash set) is estimated,
+ * and the query is dispatched to the cheaper one. */
+class SplitIndex1Router : public SplitIndex1
+{
+public:
+    SplitIndex1Router(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor);
+    ~SplitIndex1Router() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+    /** Returns the size of both hash maps and the entry size sketch in bytes. */
+    long calcHashMapSizeB() const override;
+
+protected:
+    enum class RouteType { Split, Neighborhood };
+
+    void initEntry(const std::string &word) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
+
+    /** Neighbors are generated over the alphabet, so inserted words must consist of chars from the alphabet. */
+    bool canInsertInPlace(const std::string &word) const override;
+
+    /** Fills the alphabet with all distinct characters from the word set. */
+    void calcAlphabet();
+
+    /** Returns the (cheaper) search strategy for [query], prefixBuf and suffixBuf must be already filled. */
+    RouteType calcRoute(const std::string &query) const;
+
+    /** Returns the estimated cost of the split index search in byte units, prefixBuf and suffixBuf must be already filled. */
+    size_t calcSplitCost(size_t querySize) const;
+    /** Returns the estimated cost of the neighborhood generation in byte units. */
+    size_t calcNeighborhoodCost(size_t querySize) const;
+
+    /** Returns the estimated number of bytes stored in the entry under [key] of size [keySize]. */
+    size_t estimateEntrySizeB(const char *key, size_t keySize) const;
+
+    /** Generates all neighbors of [query] within Hamming distance 1 over the alphabet and
+     * adds those which are present in the dictionary to [matches]. */
+    void searchNeighborhood(const std::string &query, MatchCollector &matches);
+
+    /** Exact-match hash set of whole words, entries are empty (a single terminating '\0'). */
+    hash_map::HashMap *wordMap = nullptr;
+
+    /** All distinct characters occurring in the dictionary. */
+    std::vector<char> alphabet;
+    /** True for characters which are present in the alphabet. */
+    bool isInAlphabet[256];
+
+    /** Approximate sizes of entries (in bytes) indexed by key hash, collisions are summed up. */
+    std::vector<uint32_t> entrySizeSketch;
+    /** A hash function used for the entry size sketch, the same as in the hash map. */
+    hash_functions::HashFunctions::HashFunctionType sketchHash;
+
+    /** Temporarily stores the currently probed neighbor. */
+    char *neighborBuf = nullptr;
+
+    /** Estimated cost of a single hash map probe (hashing, bucket access, cache misses) in byte units. */
+    static constexpr size_t probeCost = 64;
+    /** The number of sketch counters is the number of words multiplied by this factor (rounded up to a power of 2). */
+    static constexpr float sketchSizeFactor = 1.0f;
+
+    SPLIT_INDEX_1_ROUTER_WHITEBOX
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_1_ROUTER_HPP
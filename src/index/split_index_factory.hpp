@@ -3,32 +3,52 @@
 
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "../hash_function/hash_functions.hpp"
 
 #include "split_index_1.hpp"
 #include "split_index_1_comp.hpp"
+#include "split_index_1_comp_ext.hpp"
 #include "split_index_1_comp_triple.hpp"
+#include "split_index_1_packed.hpp"
+#include "split_index_1_router.hpp"
 #include "split_index_k.hpp"
+#include "split_index_k_budgets.hpp"
+#include "split_index_k_comp.hpp"
+#include "split_index_k_spaced.hpp"
+#include "split_index_ks.hpp"
 
 namespace split_index
 {
 
 struct SplitIndexFactory
 {
-    enum class IndexType { K1, K1Comp, K1CompTriple, K2, K3 };
+    enum class IndexType { K1, K1Comp, K1CompTriple, K1CompExt, K1Packed, K1Router, K2, K2Budgets, K2Comp, K2KS, K2Spaced, K3, K3Budgets, K3Comp, K3KS, K3Spaced };
 
     inline static SplitIndex *initIndex(const std::unordered_set<std::string> &words, 
         hash_functions::HashFunctions::HashType hashType, 
         IndexType indexType,
-        float maxLoadFactor);
+        float maxLoadFactor,
+        bool packKeys = false,
+        bool tuneSplitPoints = false,
+        size_t nKeyParts = 2,
+        size_t seedBlockSize = 1,
+        size_t subIndexThreshold = SplitIndex::defaultSubIndexThreshold,
+        const std::unordered_map<std::string, SplitIndex::Payload> &wordPayloads = { });
 };
 
 SplitIndex *SplitIndexFactory::initIndex(const std::unordered_set<std::string> &words, 
     hash_functions::HashFunctions::HashType hashType, 
     IndexType indexType,
-    float maxLoadFactor)
+    float maxLoadFactor,
+    bool packKeys,
+    bool tuneSplitPoints,
+    size_t nKeyParts,
+    size_t seedBlockSize,
+    size_t subIndexThreshold,
+    const std::unordered_map<std::string, SplitIndex::Payload> &wordPayloads)
 {
     SplitIndex *index;
     
@@ -43,16 +63,53 @@ SplitIndex *SplitIndexFactory::initIndex(const std::unordered_set<std::string> &
         case IndexType::K1CompTriple:
             index = new SplitIndex1CompTriple(words, hashType, maxLoadFactor);
             break;
+        case IndexType::K1CompExt:
+            index = new SplitIndex1CompExt(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K1Packed:
+            index = new SplitIndex1Packed(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K1Router:
+            index = new SplitIndex1Router(words, hashType, maxLoadFactor);
+            break;
         case IndexType::K2:
             index = new SplitIndexK<2>(words, hashType, maxLoadFactor);
             break;
+        case IndexType::K2Budgets:
+            index = new SplitIndexKBudgets<2>(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K2Comp:
+            index = new SplitIndexKComp<2>(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K2KS:
+            index = new SplitIndexKS<2>(words, hashType, maxLoadFactor, nKeyParts);
+            break;
+        case IndexType::K2Spaced:
+            index = new SplitIndexKSpaced<2>(words, hashType, maxLoadFactor, seedBlockSize);
+            break;
         case IndexType::K3:
             index = new SplitIndexK<3>(words, hashType, maxLoadFactor);
             break;
+        case IndexType::K3Budgets:
+            index = new SplitIndexKBudgets<3>(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K3Comp:
+            index = new SplitIndexKComp<3>(words, hashType, maxLoadFactor);
+            break;
+        case IndexType::K3KS:
+            index = new SplitIndexKS<3>(words, hashType, maxLoadFactor, nKeyParts);
+            break;
+        case IndexType::K3Spaced:
+            index = new SplitIndexKSpaced<3>(words, hashType, maxLoadFactor, seedBlockSize);
+            break;
         default:
             throw std::invalid_argument("bad index type: " + std::to_string(static_cast<int>(indexType)));
     }
 
+    index->setKeyPacking(packKeys);
+    index->setSplitPointTuning(tuneSplitPoints);
+    index->setSubIndexThreshold(subIndexThreshold);
+    index->setWordPayloads(wordPayloads);
     index->construct();
     return index;
 }
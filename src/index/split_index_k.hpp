@@ -1,12 +1,16 @@
 #ifndef SPLIT_INDEX_K_HPP
 #define SPLIT_INDEX_K_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "split_index.hpp"
+#include "split_point_tuner.hpp"
 
 #include "../hash_map/hash_map_aligned.hpp"
 #include "../utils/distance.hpp"
@@ -18,7 +22,9 @@
 namespace split_index
 {
 
-/** Split index for any k = 1, 2, 3. */
+/** Split index for any k = 1, 2, 3.
+ * Entries start with the number of part bytes, followed by part bytes (2 bits per word, see setPartBits)
+ * and word parts preceded by their sizes (see utils::SizeCoding). */
 template<size_t k>
 class SplitIndexK : public SplitIndex
 {
@@ -27,23 +33,76 @@ public:
         hash_functions::HashFunctions::HashType hashType, float maxLoadFactor);
     ~SplitIndexK() override;
 
+    void construct() override;
     std::string toString() const override;
 
 protected:
+    /** The number of part bytes in an entry, 16 or 32 bits wide. */
+    using PartBytesCountType = utils::SizeCoding::CounterType;
+
     void initEntry(const std::string &word) override;
-    void processQuery(const std::string &query, ResultSetType &results) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
 
     size_t calcEntrySizeB(const char *entry) const override;
 
     size_t getMinWordSize() const override { return k + 1; }
 
+    /** Searches [entry] stored under the key of query part [iPart] and reports matching words. */
+    virtual void searchPartEntry(const std::string &query, size_t iPart, const char *entry, MatchCollector &matches);
+
+    /** Returns true if [wordParts] (all parts except for [iPart]) stored under the key of query part [iPart]
+     * do not match [query] exactly in any of the earlier parts. A matching word is found through every part
+     * it matches exactly, so it is verified and reported (i.e. canonical) only for the first such part.
+     * Parts before [iPart] are stored at the same positions as in the word. */
+    inline bool isCanonicalCandidate(const std::string &query, const char *wordParts, size_t iPart) const
+    {
+        const size_t *partStarts = partStartsLUT[query.size()];
+
+        for (size_t jPart = 0; jPart < iPart; ++jPart)
+        {
+            const char *wordPart = wordParts + partStarts[jPart];
+            const char *queryPart = query.c_str() + partStarts[jPart];
+
+            // Parts usually differ at the first char, so memcmp is mostly not called.
+            if (wordPart[0] == queryPart[0] and std::memcmp(wordPart + 1, queryPart + 1, wordPartSizes[jPart] - 1) == 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     /** Returns the number of words (contiguous word parts) stored in [entry]. */
     static size_t calcEntryNWords(const char *entry);
+    /** Returns the pointer to the first word stored in [entry], i.e. skips the part bytes. */
+    static const char *getEntryWords(const char *entry)
+    {
+        return entry + sizeof(PartBytesCountType) + *reinterpret_cast<const PartBytesCountType *>(entry);
+    }
 
-    /** Splits [word] into k + 1 parts and stores these parts in wordPartBuf. */
+    /** Builds sub-indexes for entries storing more than subIndexThreshold words (see EntrySubIndex).
+     * Sub-index items point to the size bytes of remaining word parts, which may have up to k errors. */
+    void buildSubIndexes() override;
+    /** Builds a sub-index for [entry] if it stores more than subIndexThreshold words, this is called for entries
+     * which have been changed after construction (and whose previous sub-indexes have been removed). */
+    virtual void updateSubIndex(const char *entry);
+    /** Builds the sub-index for [entry] and adds it to subIndexes. */
+    void buildSubIndex(const char *entry);
+
+    /** Fills partStartsLUT with the split points for each word size, i.e. parts of (almost) equal sizes
+     * which are then tuned for the dictionary if split point tuning is enabled. */
+    void fillPartStartsLUT();
+
+    /** Splits [word] into k + 1 parts and stores these parts in wordPartBuf.
+     * Also sets the hash map keys for all parts (see SplitIndex::getKey). */
     void storeWordPartsInBuffers(const std::string &word);
 
-    /** Returns the size of a single part for [wordSize].
+    /** Stores [wordParts] of size [partsSize] (all parts except for [iPart]) in the entry
+     * under the key wordPartKeys[iPart], which must be already filled. */
+    virtual void storeRemainingParts(size_t iPart, const char *wordParts, size_t partsSize);
+
+    /** Returns the default size of a single part for [wordSize], i.e. without split point tuning.
      * This is the same for the first [0, k - 1] parts.
      * The last part might have a different size. */
     inline static size_t getPartSize(size_t wordSize);
@@ -58,9 +117,9 @@ protected:
 
     /** Tries to match a [query] against word parts in [entry].
      * Word parts have [matchSize] characters and are missing [iPart] out of [0, k] parts.
-     * Returns an empty string if unsuccessful. */
-    std::string tryMatchPart(const std::string &query, const char *entry,
-        size_t matchSize, size_t iPart) const;
+     * Returns true and stores the matching word in matchBuf if successful. */
+    bool tryMatchPart(const std::string &query, const char *entry,
+        size_t matchSize, size_t iPart);
 
     /** Sets bits for word index [iWord] and part index [iPart] in [entry].
      * iPart = 0 -> 0,0
@@ -76,8 +135,20 @@ protected:
     /** Temporarily stores all word part sizes. */
     size_t wordPartSizes[k + 1];
 
+    /** Temporarily store the hash map keys for all word parts (nullptr if a part cannot be a key) and their sizes.
+     * Keys point either to wordPartBuf or to wordPartKeyBuf (packed keys). */
+    const char *wordPartKeys[k + 1];
+    size_t wordPartKeySizes[k + 1];
+    char *wordPartKeyBuf[k + 1];
+
+    /** Lookup table holding the starts of all k + 1 parts followed by the word size, for each word size.
+     * It is used both during construction and for queries. */
+    size_t (*partStartsLUT)[k + 2] = nullptr;
+
     /** Temporarily stores remaining word parts in a contiguous fashion. */
     char *remainingWordPartsBuf = nullptr;
+    /** Temporarily stores a matching word. */
+    char *matchBuf = nullptr;
 
     /** We store 2 bits (4 positions) per word, so we can handle at most 3 errors. */
     static constexpr const size_t maxK = 3;
@@ -95,7 +166,7 @@ SplitIndexK<k>::SplitIndexK(const std::unordered_set<std::string> &wordSet,
         throw std::invalid_argument("k must be between (inclusive) 1 and " + std::to_string(maxK));
     }
 
-    const int nBucketsHint = std::max(1, static_cast<int>(nBucketsHintFactor * wordSet.size()));
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
     auto calcEntrySizeB = std::bind(&SplitIndexK<k>::calcEntrySizeB, this, std::placeholders::_1);
 
     hashMap = new hash_map::HashMapAligned(calcEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
@@ -103,9 +174,23 @@ SplitIndexK<k>::SplitIndexK(const std::unordered_set<std::string> &wordSet,
     for (size_t i = 0; i < k + 1; ++i)
     {
         wordPartBuf[i] = new char[maxWordSize];
+        wordPartKeyBuf[i] = new char[maxWordSize];
     }
 
     remainingWordPartsBuf = new char[maxWordSize];
+    matchBuf = new char[maxWordSize];
+    partStartsLUT = new size_t[maxWordSize + 1][k + 2];
+
+    // Parts of equal sizes are used until the index is constructed.
+    for (size_t wordSize = 0; wordSize <= maxWordSize; ++wordSize)
+    {
+        for (size_t iPart = 0; iPart < k + 1; ++iPart)
+        {
+            partStartsLUT[wordSize][iPart] = iPart * getPartSize(wordSize);
+        }
+
+        partStartsLUT[wordSize][k + 1] = wordSize;
+    }
 }
 
 template<size_t k>
@@ -114,9 +199,103 @@ SplitIndexK<k>::~SplitIndexK()
     for (size_t i = 0; i < k + 1; ++i)
     {
         delete[] wordPartBuf[i];
+        delete[] wordPartKeyBuf[i];
     }
 
     delete[] remainingWordPartsBuf;
+    delete[] matchBuf;
+    delete[] partStartsLUT;
+}
+
+template<size_t k>
+void SplitIndexK<k>::construct()
+{
+    fillPartStartsLUT();
+    SplitIndex::construct();
+
+    buildSubIndexes();
+}
+
+template<size_t k>
+void SplitIndexK<k>::buildSubIndexes()
+{
+    if (subIndexThreshold == 0)
+    {
+        return;
+    }
+
+    std::unordered_set<const char *> visitedEntries;
+
+    for (const std::string &word : wordSet)
+    {
+        storeWordPartsInBuffers(word);
+
+        for (size_t iPart = 0; iPart < k + 1; ++iPart)
+        {
+            char **entryPtr = hashMap->retrieve(wordPartKeys[iPart], wordPartKeySizes[iPart]);
+            assert(entryPtr != nullptr);
+
+            const char *entry = *entryPtr;
+
+            if (not visitedEntries.insert(entry).second or calcEntryNWords(entry) <= subIndexThreshold)
+            {
+                continue;
+            }
+
+            buildSubIndex(entry);
+        }
+    }
+}
+
+template<size_t k>
+void SplitIndexK<k>::updateSubIndex(const char *entry)
+{
+    if (subIndexThreshold != 0 and calcEntryNWords(entry) > subIndexThreshold)
+    {
+        buildSubIndex(entry);
+    }
+}
+
+template<size_t k>
+void SplitIndexK<k>::buildSubIndex(const char *entry)
+{
+    EntrySubIndex *subIndex = new EntrySubIndex(k);
+    const char *it = getEntryWords(entry);
+
+    for (uint32_t iWord = 0; *it != 0; ++iWord)
+    {
+        const uint32_t offset = static_cast<uint32_t>(it - entry);
+        const size_t partsSize = utils::SizeCoding::read(it);
+
+        subIndex->add(it, partsSize, { offset, iWord });
+        it += partsSize;
+    }
+
+    subIndex->build();
+    subIndexes.add(entry, subIndex);
+}
+
+template<size_t k>
+void SplitIndexK<k>::fillPartStartsLUT()
+{
+    std::vector<std::vector<size_t>> partStarts(maxWordSize + 1);
+
+    for (size_t wordSize = 0; wordSize <= maxWordSize; ++wordSize)
+    {
+        for (size_t iPart = 0; iPart < k + 1; ++iPart)
+        {
+            partStarts[wordSize].push_back(iPart * getPartSize(wordSize));
+        }
+
+        partStarts[wordSize].push_back(wordSize);
+    }
+
+    nTunedWordSizes = tuneSplitPoints ? SplitPointTuner::tune(wordSet, partStarts) : 0;
+
+    for (size_t wordSize = 0; wordSize <= maxWordSize; ++wordSize)
+    {
+        std::copy(partStarts[wordSize].begin(), partStarts[wordSize].end(), partStartsLUT[wordSize]);
+    }
 }
 
 template<size_t k>
@@ -129,88 +308,175 @@ template<size_t k>
 void SplitIndexK<k>::initEntry(const std::string &word)
 {
     storeWordPartsInBuffers(word);
-    
-    const size_t partSize = getPartSize(word.size());
-    assert(partSize >= 1 and partSize < word.size());
+
+    const size_t *partStarts = partStartsLUT[word.size()];
 
     for (size_t iPart = 0; iPart < k + 1; ++iPart)
     {
         assert(wordPartSizes[iPart] > 0);
 
-        const size_t start = iPart * partSize;
-        size_t remainingWordPartsSize;
+        // Remaining parts are the ones before and after the current part.
+        const size_t start = partStarts[iPart];
+        const size_t end = partStarts[iPart + 1];
 
-        if (iPart != k)
-        {
-            memcpy(remainingWordPartsBuf, word.c_str(), start);
+        memcpy(remainingWordPartsBuf, word.c_str(), start);
+        memcpy(remainingWordPartsBuf + start, word.c_str() + end, word.size() - end);
 
-            const size_t lastPartSize = word.size() - start - partSize;
-            memcpy(remainingWordPartsBuf + start, word.c_str() + start + partSize, lastPartSize);
+        const size_t remainingWordPartsSize = word.size() - wordPartSizes[iPart];
+        storeRemainingParts(iPart, remainingWordPartsBuf, remainingWordPartsSize);
+    }
+}
 
-            remainingWordPartsSize = start + lastPartSize;
-            assert(remainingWordPartsSize == word.size() - partSize);
-        }
-        else
-        {
-            memcpy(remainingWordPartsBuf, word.c_str(), start);
-            remainingWordPartsSize = start;
-        }
+template<size_t k>
+void SplitIndexK<k>::storeRemainingParts(size_t iPart, const char *wordParts, size_t partsSize)
+{
+    char **entryPtr = hashMap->retrieve(wordPartKeys[iPart], wordPartKeySizes[iPart]);
 
-        char **entryPtr = hashMap->retrieve(wordPartBuf[iPart], wordPartSizes[iPart]);
+    if (entryPtr == nullptr)
+    {
+        char *newEntry = createEntry(wordParts, partsSize, iPart);
+        hashMap->insert(wordPartKeys[iPart], wordPartKeySizes[iPart], newEntry);
 
-        if (entryPtr == nullptr)
-        {
-            char *newEntry = createEntry(remainingWordPartsBuf, remainingWordPartsSize, iPart);
-            hashMap->insert(wordPartBuf[iPart], wordPartSizes[iPart], newEntry);
+        free(newEntry); // The entry is copied inside the map, so it can be freed here.
+    }
+    else if (not constructed or areSubIndexesDeferred)
+    {
+        addToEntry(entryPtr, wordParts, partsSize, iPart);
+    }
+    else
+    {
+        // The word is inserted after construction. The entry might be moved and the offsets of its word parts
+        // might change (when a part byte is added), so its sub-index (if any) is built anew.
+        subIndexes.remove(*entryPtr);
+        addToEntry(entryPtr, wordParts, partsSize, iPart);
 
-            free(newEntry); // The entry is copied inside the map, so it can be freed here.
-        }
-        else
-        {
-            addToEntry(entryPtr, remainingWordPartsBuf, remainingWordPartsSize, iPart);
-        }
+        updateSubIndex(*entryPtr);
     }
 }
 
 template<size_t k>
-void SplitIndexK<k>::processQuery(const std::string &query, ResultSetType &results)
+void SplitIndexK<k>::processQuery(const std::string &query, MatchCollector &matches)
 {
     assert(constructed);
     assert(query.size() > k and query.size() <= maxWordSize);
 
     storeWordPartsInBuffers(query);
 
+    char **entryPtrs[k + 1];
+    size_t partOrder[k + 1];
+    size_t nParts = 0;
+
     for (size_t iPart = 0; iPart < k + 1; ++iPart)
     {
-        char **entryPtr = hashMap->retrieve(wordPartBuf[iPart], wordPartSizes[iPart]);
-
-        if (entryPtr == nullptr)
+        // The query part contains chars outside the alphabet, so it cannot be a key.
+        if (wordPartKeys[iPart] == nullptr)
         {
             continue;
         }
 
-        const char *entry = *entryPtr;
-        const char cMatchSize = query.size() - wordPartSizes[iPart];
+        entryPtrs[iPart] = hashMap->retrieve(wordPartKeys[iPart], wordPartKeySizes[iPart]);
 
-        size_t iWord = 0;
-        entry += sizeof(uint16_t) + *reinterpret_cast<const uint16_t *>(entry);
+        if (entryPtrs[iPart] != nullptr)
+        {
+            partOrder[nParts++] = iPart;
+        }
+    }
 
-        while (*entry != 0)
+    // When only checking existence, parts whose entries store the fewest words are searched first.
+    // The number of part bytes in an entry is proportional to its number of words. At most k + 1 parts are
+    // ordered, hence insertion sort.
+    if (matches.isCheckingExistence())
+    {
+        for (size_t i = 1; i < nParts; ++i)
         {
-            if (*entry == cMatchSize and 
-                iPart == retrievePartIndexFromBits(*entryPtr, iWord))
+            const size_t iPart = partOrder[i];
+            const PartBytesCountType nPartBytes = *reinterpret_cast<const PartBytesCountType *>(*entryPtrs[iPart]);
+
+            size_t j = i;
+
+            for (; j > 0 and *reinterpret_cast<const PartBytesCountType *>(*entryPtrs[partOrder[j - 1]]) > nPartBytes;
+                --j)
             {
-                const std::string result = tryMatchPart(query, entry + 1, cMatchSize, iPart);
+                partOrder[j] = partOrder[j - 1];
+            }
+
+            partOrder[j] = iPart;
+        }
+    }
+
+    for (size_t i = 0; i < nParts; ++i)
+    {
+        searchPartEntry(query, partOrder[i], *entryPtrs[partOrder[i]], matches);
+
+        if (matches.isDone())
+        {
+            return;
+        }
+    }
+}
 
-                if (not result.empty())
+template<size_t k>
+void SplitIndexK<k>::searchPartEntry(const std::string &query, size_t iPart, const char *entry, MatchCollector &matches)
+{
+    const char *entryStart = entry;
+    const size_t matchSize = query.size() - wordPartSizes[iPart];
+
+    const EntrySubIndex *subIndex = subIndexes.find(entry);
+
+    if (subIndex != nullptr)
+    {
+        // Remaining query parts are looked up in the sub-index, so only its candidates are checked.
+        const size_t start = partStartsLUT[query.size()][iPart];
+        const size_t end = partStartsLUT[query.size()][iPart + 1];
+
+        memcpy(remainingWordPartsBuf, query.c_str(), start);
+        memcpy(remainingWordPartsBuf + start, query.c_str() + end, query.size() - end);
+
+        subIndex->forEachCandidate(remainingWordPartsBuf, matchSize, [&](const EntrySubIndex::Item &item)
+        {
+            const char *part = entry + item.offset;
+
+            if (utils::SizeCoding::read(part) == matchSize
+                and iPart == retrievePartIndexFromBits(entry, item.iWord) and isCanonicalCandidate(query, part, iPart))
+            {
+                // A candidate is found once for each of its pieces which have the same hash as query pieces,
+                // so it might be reported repeatedly.
+                if (tryMatchPart(query, part, matchSize, iPart))
                 {
-                    results.insert(move(result));
+                    matches.add(matchBuf, query.size());
                 }
             }
 
-            iWord += 1;
-            entry += 1 + *entry;
+            // When only checking existence, the search stops at the first match.
+            return not matches.isDone();
+        });
+
+        return;
+    }
+
+    size_t iWord = 0;
+    entry = getEntryWords(entry);
+
+    while (*entry != 0)
+    {
+        const size_t partsSize = utils::SizeCoding::read(entry);
+
+        if (partsSize == matchSize and
+            iPart == retrievePartIndexFromBits(entryStart, iWord) and isCanonicalCandidate(query, entry, iPart))
+        {
+            if (tryMatchPart(query, entry, matchSize, iPart))
+            {
+                matches.addUnique(matchBuf, query.size());
+
+                if (matches.isDone())
+                {
+                    return;
+                }
+            }
         }
+
+        iWord += 1;
+        entry += partsSize;
     }
 }
 
@@ -218,11 +484,12 @@ template<size_t k>
 size_t SplitIndexK<k>::calcEntrySizeB(const char *entry) const
 {
     const char *start = entry;
-    entry += sizeof(uint16_t) + *reinterpret_cast<const uint16_t *>(entry);
+    entry = getEntryWords(entry);
 
     while (*entry != 0)
     {
-        entry += 1 + *entry;
+        const size_t partsSize = utils::SizeCoding::read(entry);
+        entry += partsSize;
     }
 
     return entry - start + 1; // This includes the terminating 0.
@@ -232,12 +499,14 @@ template<size_t k>
 size_t SplitIndexK<k>::calcEntryNWords(const char *entry)
 {
     size_t nWords = 0;
-    entry += sizeof(uint16_t) + *reinterpret_cast<const uint16_t *>(entry);
+    entry = getEntryWords(entry);
 
     while (*entry != 0)
     {
         nWords += 1;
-        entry += 1 + *entry;
+
+        const size_t partsSize = utils::SizeCoding::read(entry);
+        entry += partsSize;
     }
 
     return nWords;
@@ -246,25 +515,16 @@ size_t SplitIndexK<k>::calcEntryNWords(const char *entry)
 template<size_t k>
 void SplitIndexK<k>::storeWordPartsInBuffers(const std::string &word)
 {
-    const size_t partSize = getPartSize(word.size());
-    assert(partSize >= 1 and partSize < word.size());
+    const size_t *partStarts = partStartsLUT[word.size()];
 
     for (size_t iPart = 0; iPart < k + 1; ++iPart)
     {
-        const size_t start = iPart * partSize;
-
-        if (iPart != k)
-        {
-            std::memcpy(wordPartBuf[iPart], word.c_str() + start, partSize);
-            wordPartSizes[iPart] = partSize;
-        }
-        else
-        {
-            const size_t lastPartSize = word.size() - start;
+        wordPartSizes[iPart] = partStarts[iPart + 1] - partStarts[iPart];
+        assert(wordPartSizes[iPart] >= 1 and wordPartSizes[iPart] < word.size());
 
-            std::memcpy(wordPartBuf[iPart], word.c_str() + start, lastPartSize);
-            wordPartSizes[iPart] = lastPartSize;
-        }
+        std::memcpy(wordPartBuf[iPart], word.c_str() + partStarts[iPart], wordPartSizes[iPart]);
+        wordPartKeys[iPart] = getKey(wordPartBuf[iPart], wordPartSizes[iPart], wordPartKeyBuf[iPart],
+            wordPartKeySizes[iPart]);
     }
 }
 
@@ -278,24 +538,21 @@ template<size_t k>
 char *SplitIndexK<k>::createEntry(const char *wordParts, size_t partsSize, size_t iPart) const
 {
     assert(partsSize > 0 and partsSize < maxWordSize);
-    // 3 = part byte, size of word parts, terminating 0.
-    const size_t newSize = sizeof(uint16_t) + 3 + partsSize;
+    // 2 = part byte, terminating 0.
+    const size_t newSize = sizeof(PartBytesCountType) + 2 + utils::SizeCoding::calcSizeB(partsSize) + partsSize;
 
     char *entry = static_cast<char *>(malloc(newSize * sizeof(char)));
     assert(entry != nullptr);
 
     // We set the part index byte counter to 1 since there is only a single byte at the beginning.
-    *reinterpret_cast<uint16_t *>(entry) = 0x1u;
+    *reinterpret_cast<PartBytesCountType *>(entry) = 0x1u;
 
-    char *it = entry + sizeof(uint16_t);
+    char *it = entry + sizeof(PartBytesCountType);
     *it = 0x0u; // Originally no bits are set.
 
     setPartBits(entry, 0, iPart);
 
-    it += 1;
-    *it = static_cast<char>(partsSize);
-
-    it += 1;
+    it = utils::SizeCoding::write(it + 1, partsSize);
     memcpy(it, wordParts, partsSize);
 
     entry[newSize - 1] = 0;
@@ -306,19 +563,26 @@ template<size_t k>
 void SplitIndexK<k>::addToEntry(char **entryPtr, const char *wordParts, size_t partsSize, size_t iPart) const
 {
     assert(partsSize > 0 and partsSize < maxWordSize);
-    uint16_t *nPartBytes = reinterpret_cast<uint16_t *>(*entryPtr);
+    PartBytesCountType *nPartBytes = reinterpret_cast<PartBytesCountType *>(*entryPtr);
 
     const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
     const size_t oldNWords = calcEntryNWords(*entryPtr);
 
-    assert(oldNWords <= *nPartBytes * 4);
+    assert(oldNWords <= *nPartBytes * 4u);
 
-    size_t newEntrySize = oldEntrySize + 1 + partsSize;
+    const size_t partsSizeB = utils::SizeCoding::calcSizeB(partsSize);
+    size_t newEntrySize = oldEntrySize + partsSizeB + partsSize;
     bool addNewPartByte = false;
 
     // If this is true all part bytes have been exhausted and we need to add a new one.
-    if (oldNWords == *nPartBytes * 4)
+    if (oldNWords == *nPartBytes * 4u)
     {
+        // The counter is checked before any changes are made, so that the entry stays valid after throwing.
+        if (*nPartBytes == std::numeric_limits<PartBytesCountType>::max())
+        {
+            throw std::runtime_error("too many words stored under a single key, rebuild with SPLIT_INDEX_LONG_WORDS");
+        }
+
         newEntrySize += 1;
         addNewPartByte = true;
     }
@@ -330,9 +594,9 @@ void SplitIndexK<k>::addToEntry(char **entryPtr, const char *wordParts, size_t p
 
     if (addNewPartByte)
     {
-        nPartBytes = reinterpret_cast<uint16_t *>(newEntry);
+        nPartBytes = reinterpret_cast<PartBytesCountType *>(newEntry);
 
-        const size_t iWordsStart = sizeof(uint16_t) + *nPartBytes;
+        const size_t iWordsStart = sizeof(PartBytesCountType) + *nPartBytes;
         memmove(newEntry + iWordsStart + 1, newEntry + iWordsStart,
             oldEntrySize - iWordsStart);
 
@@ -349,9 +613,7 @@ void SplitIndexK<k>::addToEntry(char **entryPtr, const char *wordParts, size_t p
         newEntryWordStart = newEntry + oldEntrySize - 1;
     }
 
-    *newEntryWordStart = static_cast<char>(partsSize);
-
-    newEntryWordStart += 1;
+    newEntryWordStart = utils::SizeCoding::write(newEntryWordStart, partsSize);
     memcpy(newEntryWordStart, wordParts, partsSize);
 
     newEntryWordStart[partsSize] = 0;
@@ -367,47 +629,55 @@ void SplitIndexK<k>::addToEntry(char **entryPtr, const char *wordParts, size_t p
 }
 
 template<size_t k>
-std::string SplitIndexK<k>::tryMatchPart(const std::string &query, const char *entry,
-    size_t matchSize, size_t iPart) const
+bool SplitIndexK<k>::tryMatchPart(const std::string &query, const char *entry,
+    size_t matchSize, size_t iPart)
 {
     // This is an implementation for k = 1.
     // Template specializations for k = 2 and k = 3 are located below.
-    assert(k == 1);
+    // Other instantiations (e.g. k = 0, whose construction throws) must not index the parts of k = 1.
+    if (k != 1)
+    {
+        assert(false);
+        return false;
+    }
 
     switch (iPart)
     {
         case 0:
             if (utils::Distance::isHammingAtMostK<1>(entry, query.c_str() + wordPartSizes[0], matchSize))
             {
-                return std::string(query.c_str(), wordPartSizes[0]) +
-                    std::string(entry, matchSize);
+                std::memcpy(matchBuf, query.c_str(), wordPartSizes[0]);
+                std::memcpy(matchBuf + wordPartSizes[0], entry, matchSize);
+                return true;
             }
             break;
         case 1:
             if (utils::Distance::isHammingAtMostK<1>(entry, query.c_str(), matchSize))
             {
-                return std::string(entry, matchSize) +
-                    std::string(query.c_str() + matchSize, wordPartSizes[1]);
+                std::memcpy(matchBuf, entry, matchSize);
+                std::memcpy(matchBuf + matchSize, query.c_str() + matchSize, wordPartSizes[1]);
+                return true;
             }
             break;
         default:
             assert(false);
     }
 
-    return "";
+    return false;
 }
 
 template<>
-inline std::string SplitIndexK<2>::tryMatchPart(const std::string &query, const char *entry,
-    size_t matchSize, size_t iPart) const
+inline bool SplitIndexK<2>::tryMatchPart(const std::string &query, const char *entry,
+    size_t matchSize, size_t iPart)
 {
     switch (iPart)
     {
         case 0:
             if (utils::Distance::isHammingAtMostK<2>(entry, query.c_str() + wordPartSizes[0], matchSize))
             {
-                return std::string(query.c_str(), wordPartSizes[0]) +
-                    std::string(entry, matchSize);
+                std::memcpy(matchBuf, query.c_str(), wordPartSizes[0]);
+                std::memcpy(matchBuf + wordPartSizes[0], entry, matchSize);
+                return true;
             }
             break;
         case 1:
@@ -418,37 +688,41 @@ inline std::string SplitIndexK<2>::tryMatchPart(const std::string &query, const
 
                 if (nErrors <= 2)
                 {
-                    return std::string(entry, wordPartSizes[0]) +
-                        std::string(query.c_str() + wordPartSizes[0], wordPartSizes[1]) +
-                        std::string(entry + wordPartSizes[0], wordPartSizes[2]);
+                    std::memcpy(matchBuf, entry, wordPartSizes[0]);
+                    std::memcpy(matchBuf + wordPartSizes[0], query.c_str() + wordPartSizes[0], wordPartSizes[1]);
+                    std::memcpy(matchBuf + wordPartSizes[0] + wordPartSizes[1], entry + wordPartSizes[0],
+                        wordPartSizes[2]);
+                    return true;
                 }
             }
             break;
         case 2:
             if (utils::Distance::isHammingAtMostK<2>(entry, query.c_str(), matchSize))
             {
-                return std::string(entry, matchSize) +
-                    std::string(query.c_str() + matchSize, wordPartSizes[2]);
+                std::memcpy(matchBuf, entry, matchSize);
+                std::memcpy(matchBuf + matchSize, query.c_str() + matchSize, wordPartSizes[2]);
+                return true;
             }
             break;
         default:
             assert(false);
     }
 
-    return "";
+    return false;
 }
 
 template<>
-inline std::string SplitIndexK<3>::tryMatchPart(const std::string &query, const char *entry,
-    size_t matchSize, size_t iPart) const
+inline bool SplitIndexK<3>::tryMatchPart(const std::string &query, const char *entry,
+    size_t matchSize, size_t iPart)
 {
     switch (iPart)
     {
         case 0:
             if (utils::Distance::isHammingAtMostK<3>(entry, query.c_str() + wordPartSizes[0], matchSize))
             {
-                return std::string(query.c_str(), wordPartSizes[0]) +
-                    std::string(entry, matchSize);
+                std::memcpy(matchBuf, query.c_str(), wordPartSizes[0]);
+                std::memcpy(matchBuf + wordPartSizes[0], entry, matchSize);
+                return true;
             }
             break;
         case 1:
@@ -461,9 +735,10 @@ inline std::string SplitIndexK<3>::tryMatchPart(const std::string &query, const
 
                 if (nErrors <= 3)
                 {
-                    return std::string(entry, wordPartSizes[0]) +
-                        std::string(query.c_str() + wordPartSizes[0], wordPartSizes[1]) +
-                        std::string(entry + wordPartSizes[0], partSize2);
+                    std::memcpy(matchBuf, entry, wordPartSizes[0]);
+                    std::memcpy(matchBuf + wordPartSizes[0], query.c_str() + wordPartSizes[0], wordPartSizes[1]);
+                    std::memcpy(matchBuf + wordPartSizes[0] + wordPartSizes[1], entry + wordPartSizes[0], partSize2);
+                    return true;
                 }
             }
             break;
@@ -477,24 +752,26 @@ inline std::string SplitIndexK<3>::tryMatchPart(const std::string &query, const
 
                 if (nErrors <= 3)
                 {
-                    return std::string(entry, partSize1) +
-                        std::string(query.c_str() + partSize1, wordPartSizes[2]) +
-                        std::string(entry + partSize1, wordPartSizes[3]);
+                    std::memcpy(matchBuf, entry, partSize1);
+                    std::memcpy(matchBuf + partSize1, query.c_str() + partSize1, wordPartSizes[2]);
+                    std::memcpy(matchBuf + partSize1 + wordPartSizes[2], entry + partSize1, wordPartSizes[3]);
+                    return true;
                 }
             }
             break;
         case 3:
             if (utils::Distance::isHammingAtMostK<3>(entry, query.c_str(), matchSize))
             {
-                return std::string(entry, matchSize) +
-                    std::string(query.c_str() + matchSize, wordPartSizes[3]);
+                std::memcpy(matchBuf, entry, matchSize);
+                std::memcpy(matchBuf + matchSize, query.c_str() + matchSize, wordPartSizes[3]);
+                return true;
             }
             break;
         default:
             assert(false);
     }
 
-    return "";
+    return false;
 }
 
 template<size_t k>
@@ -507,11 +784,11 @@ void SplitIndexK<k>::setPartBits(char *entry, size_t iWord, size_t iPart)
     const size_t iByte = pos / 8;
     const size_t iBit = pos % 8;
 
-    entry += sizeof(uint16_t); // Go to the first byte.
+    entry += sizeof(PartBytesCountType); // Go to the first byte.
     entry += iByte; // Go to the requested byte.
 
     *entry |= static_cast<char>(iPart << iBit);
-    assert(retrievePartIndexFromBits(entry - sizeof(uint16_t) - iByte, iWord) == iPart);
+    assert(retrievePartIndexFromBits(entry - sizeof(PartBytesCountType) - iByte, iWord) == iPart);
 }
 
 template<size_t k>
@@ -522,7 +799,7 @@ size_t SplitIndexK<k>::retrievePartIndexFromBits(const char *entry, size_t iWord
     const size_t iByte = pos / 8;
     const size_t iBit = pos % 8;
 
-    entry += sizeof(uint16_t); // Go to the first byte.
+    entry += sizeof(PartBytesCountType); // Go to the first byte.
     entry += iByte; // Go to the requested byte.
 
     const size_t first = (*entry & (0x1u << iBit)) >> iBit;
@@ -0,0 +1,565 @@
+#ifndef SPLIT_INDEX_K_BUDGETS_HPP
+#define SPLIT_INDEX_K_BUDGETS_HPP
+
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "split_index.hpp"
+
+#include "../hash_map/hash_map_aligned.hpp"
+#include "../utils/distance.hpp"
+#include "../utils/size_coding.hpp"
+
+#ifndef SPLIT_INDEX_K_BUDGETS_WHITEBOX
+#define SPLIT_INDEX_K_BUDGETS_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for any k = 1, 2, 3 using the generalized pigeonhole principle: words are split into p <= k + 1 parts,
+ * and each part i has an error budget b_i such that the sum of (b_i + 1) equals k + 1.
+ * Hence at least one part of a matching word has at most b_i errors, and it is found by exact lookups
+ * of all neighbors of the query part within Hamming distance b_i.
+ * Fewer, longer parts produce much smaller entries at the cost of neighborhood probes,
+ * the number of parts is chosen for each word size using a cost model based on the alphabet size.
+ * Keys start with the part index, entries consist of the remaining chars of the word with their sizes. */
+template<size_t k>
+class SplitIndexKBudgets : public SplitIndex
+{
+public:
+    SplitIndexKBudgets(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor);
+    ~SplitIndexKBudgets() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+protected:
+    /** Parts and their error budgets for a single word size. */
+    struct Scheme
+    {
+        /** Starts of all parts followed by the word size. */
+        std::vector<size_t> partStarts;
+        /** The maximum number of errors in each part. */
+        std::vector<size_t> budgets;
+    };
+
+    void initEntry(const std::string &word) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
+
+    /** Inserted words must have a scheme for their size, and consist of chars from the alphabet
+     * (over which neighbors are generated). */
+    bool canInsertInPlace(const std::string &word) const override;
+
+    size_t calcEntrySizeB(const char *entry) const override;
+
+    size_t getMinWordSize() const override { return k + 1; }
+
+    /** Fills the alphabet with all distinct characters from the word set. */
+    void calcAlphabet();
+
+    /** Picks the cheapest scheme for each word size occurring in the word set. */
+    void fillSchemes();
+
+    /** Returns a scheme for [wordSize] with [nParts] parts, whose sizes are proportional to (budget + 1),
+     * the budgets differ by at most 1 and they sum up to k + 1 - [nParts]. */
+    static Scheme makeScheme(size_t wordSize, size_t nParts);
+
+    /** Returns the estimated cost of a query search with [scheme] for [wordSize] in byte units,
+     * assuming [nWords] words of this size with chars distributed uniformly over the alphabet. */
+    double calcSchemeCost(const Scheme &scheme, size_t wordSize, size_t nWords) const;
+
+    /** Returns the number of strings of [partSize] chars within Hamming distance [budget] from a string over the alphabet. */
+    double calcNNeighbors(size_t partSize, size_t budget) const;
+
+    /** Stores part [iPart] of [word] in keyBuf after the part index,
+     * and the remaining chars (before and after the part) in restBuf. */
+    void storePartAndRest(const std::string &word, size_t iPart);
+
+    /** Probes all neighbors of the part stored in keyBuf which differ on between 1 and [budget] positions
+     * starting from [iChar], [nErrors] positions have already been substituted. Matches are added to [matches]. */
+    void searchNeighborhood(const std::string &query, size_t iPart, size_t iChar,
+        size_t budget, size_t nErrors, MatchCollector &matches);
+
+    /** Retrieves the entry for the key in keyBuf and adds words whose remaining chars
+     * differ from restBuf on at most k - [nErrors] positions to [matches]. */
+    void searchEntry(const std::string &query, size_t iPart, size_t nErrors, MatchCollector &matches);
+
+    /** Stores [rest] of size [restSize] in the entry under the key [key] of size [keySize]. */
+    void storeRest(const char *key, size_t keySize, const char *rest, size_t restSize);
+
+    /** Returns the hash map key for the part stored in keyBuf (possibly packed, see SplitIndex::getKey),
+     * stores its size in [hashKeySize], returns nullptr if the part cannot be a key. */
+    const char *getPartKey(size_t partSize, size_t &hashKeySize);
+
+    /** Schemes for all word sizes, empty for sizes absent from the word set. */
+    std::vector<Scheme> schemes;
+    /** Scheme for the currently processed word. */
+    const Scheme *curScheme = nullptr;
+
+    /** All distinct characters occurring in the dictionary. */
+    std::vector<char> alphabet;
+
+    /** Temporarily store keys (the part index followed by the part), packed keys,
+     * remaining chars, and matching words. */
+    char *keyBuf = nullptr;
+    char *packedKeyBuf = nullptr;
+    char *restBuf = nullptr;
+    char *matchBuf = nullptr;
+
+    /** Estimated cost of a single hash map probe (hashing, bucket access, cache misses) in byte units. */
+    static constexpr double probeCost = 64.0;
+
+    SPLIT_INDEX_K_BUDGETS_WHITEBOX
+};
+
+template<size_t k>
+SplitIndexKBudgets<k>::SplitIndexKBudgets(const std::unordered_set<std::string> &wordSet,
+                                          hash_functions::HashFunctions::HashType hashType, float maxLoadFactor)
+    :SplitIndex(wordSet)
+{
+    if (k < 1 or k > 3)
+    {
+        throw std::invalid_argument("k must be between (inclusive) 1 and 3");
+    }
+
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
+    auto calcEntrySizeB = std::bind(&SplitIndexKBudgets<k>::calcEntrySizeB, this, std::placeholders::_1);
+
+    hashMap = new hash_map::HashMapAligned(calcEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
+
+    // The part index precedes the part.
+    keyBuf = new char[maxWordSize + 1];
+    packedKeyBuf = new char[maxWordSize + 1];
+    restBuf = new char[maxWordSize];
+    matchBuf = new char[maxWordSize];
+}
+
+template<size_t k>
+SplitIndexKBudgets<k>::~SplitIndexKBudgets()
+{
+    delete[] keyBuf;
+    delete[] packedKeyBuf;
+    delete[] restBuf;
+    delete[] matchBuf;
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::construct()
+{
+    // Split points are not tuned, part sizes are determined by error budgets.
+    tuneSplitPoints = false;
+
+    calcAlphabet();
+    fillSchemes();
+
+    SplitIndex::construct();
+}
+
+template<size_t k>
+std::string SplitIndexKBudgets<k>::toString() const
+{
+    // The number of word sizes for each number of parts.
+    std::vector<size_t> nWordSizes(k + 2, 0);
+
+    for (const Scheme &scheme : schemes)
+    {
+        if (not scheme.budgets.empty())
+        {
+            nWordSizes[scheme.budgets.size()] += 1;
+        }
+    }
+
+    std::string ret = SplitIndex::toString() + "\n(error budgets) alphabet size = " + std::to_string(alphabet.size())
+        + ", #word sizes per #parts:";
+
+    for (size_t nParts = 2; nParts <= k + 1; ++nParts)
+    {
+        ret += (boost::format(" %1% -> %2%") % nParts % nWordSizes[nParts]).str();
+    }
+
+    return ret;
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::initEntry(const std::string &word)
+{
+    curScheme = &schemes[word.size()];
+    assert(not curScheme->budgets.empty());
+
+    for (size_t iPart = 0; iPart < curScheme->budgets.size(); ++iPart)
+    {
+        storePartAndRest(word, iPart);
+
+        const size_t partSize = curScheme->partStarts[iPart + 1] - curScheme->partStarts[iPart];
+        size_t hashKeySize;
+
+        const char *key = getPartKey(partSize, hashKeySize);
+        assert(key != nullptr);
+
+        storeRest(key, hashKeySize, restBuf, word.size() - partSize);
+    }
+}
+
+template<size_t k>
+bool SplitIndexKBudgets<k>::canInsertInPlace(const std::string &word) const
+{
+    if (word.size() >= schemes.size() or schemes[word.size()].budgets.empty())
+    {
+        return false;
+    }
+
+    for (const char c : word)
+    {
+        if (std::find(alphabet.begin(), alphabet.end(), c) == alphabet.end())
+        {
+            return false;
+        }
+    }
+
+    return SplitIndex::canInsertInPlace(word);
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::processQuery(const std::string &query, MatchCollector &matches)
+{
+    assert(constructed);
+    assert(query.size() >= getMinWordSize() and query.size() <= maxWordSize);
+
+    // Queries of sizes absent from the dictionary cannot have any matches.
+    if (query.size() >= schemes.size() or schemes[query.size()].budgets.empty())
+    {
+        return;
+    }
+
+    curScheme = &schemes[query.size()];
+
+    for (size_t iPart = 0; iPart < curScheme->budgets.size(); ++iPart)
+    {
+        storePartAndRest(query, iPart);
+
+        searchEntry(query, iPart, 0, matches);
+        searchNeighborhood(query, iPart, 0, curScheme->budgets[iPart], 0, matches);
+
+        if (matches.isDone())
+        {
+            return;
+        }
+    }
+}
+
+template<size_t k>
+size_t SplitIndexKBudgets<k>::calcEntrySizeB(const char *entry) const
+{
+    const char *start = entry;
+
+    while (*entry != 0)
+    {
+        const size_t restSize = utils::SizeCoding::read(entry);
+        entry += restSize;
+    }
+
+    return entry - start + 1; // This includes the terminating 0.
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::calcAlphabet()
+{
+    bool isInAlphabet[256] = { };
+
+    for (const std::string &word : wordSet)
+    {
+        for (const char c : word)
+        {
+            isInAlphabet[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    alphabet.clear();
+
+    for (size_t c = 0; c < 256; ++c)
+    {
+        if (isInAlphabet[c])
+        {
+            alphabet.push_back(static_cast<char>(c));
+        }
+    }
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::fillSchemes()
+{
+    std::vector<size_t> nWords(maxWordSize + 1, 0);
+
+    for (const std::string &word : wordSet)
+    {
+        if (word.size() <= maxWordSize)
+        {
+            nWords[word.size()] += 1;
+        }
+    }
+
+    schemes.assign(maxWordSize + 1, Scheme());
+
+    for (size_t wordSize = getMinWordSize(); wordSize <= maxWordSize; ++wordSize)
+    {
+        if (nWords[wordSize] == 0)
+        {
+            continue;
+        }
+
+        double minCost = 0.0;
+
+        // We prefer more parts on ties, i.e. the standard pigeonhole split without neighborhood probes.
+        for (size_t nParts = k + 1; nParts >= 2; --nParts)
+        {
+            Scheme scheme = makeScheme(wordSize, nParts);
+            const double cost = calcSchemeCost(scheme, wordSize, nWords[wordSize]);
+
+            if (schemes[wordSize].budgets.empty() or cost < minCost)
+            {
+                schemes[wordSize] = std::move(scheme);
+                minCost = cost;
+            }
+        }
+    }
+}
+
+template<size_t k>
+typename SplitIndexKBudgets<k>::Scheme SplitIndexKBudgets<k>::makeScheme(size_t wordSize, size_t nParts)
+{
+    assert(nParts >= 2 and nParts <= k + 1 and wordSize >= k + 1);
+    Scheme scheme;
+
+    // Budgets of first parts are larger by 1 if the remaining budget cannot be distributed evenly.
+    const size_t totalBudget = k + 1 - nParts;
+
+    for (size_t iPart = 0; iPart < nParts; ++iPart)
+    {
+        scheme.budgets.push_back(totalBudget / nParts + (iPart < totalBudget % nParts));
+    }
+
+    // Part sizes are proportional to (budget + 1), i.e. each error is given (almost) the same number of chars.
+    size_t weightSum = 0;
+
+    for (size_t iPart = 0; iPart < nParts; ++iPart)
+    {
+        scheme.partStarts.push_back(wordSize * weightSum / (k + 1));
+        weightSum += scheme.budgets[iPart] + 1;
+    }
+
+    assert(weightSum == k + 1);
+    scheme.partStarts.push_back(wordSize);
+
+    return scheme;
+}
+
+template<size_t k>
+double SplitIndexKBudgets<k>::calcSchemeCost(const Scheme &scheme, size_t wordSize, size_t nWords) const
+{
+    double cost = 0.0;
+
+    for (size_t iPart = 0; iPart < scheme.budgets.size(); ++iPart)
+    {
+        const size_t partSize = scheme.partStarts[iPart + 1] - scheme.partStarts[iPart];
+
+        // The expected number of words sharing a single key, each of which is scanned together with its size byte.
+        const double nEntryWords = nWords / std::max(1.0, std::pow(static_cast<double>(alphabet.size()), partSize));
+        const double entrySizeB = std::min(static_cast<double>(nWords), nEntryWords) * (1 + wordSize - partSize);
+
+        cost += calcNNeighbors(partSize, scheme.budgets[iPart]) * (probeCost + partSize + entrySizeB);
+    }
+
+    return cost;
+}
+
+template<size_t k>
+double SplitIndexKBudgets<k>::calcNNeighbors(size_t partSize, size_t budget) const
+{
+    // The sum of (partSize choose i) * (sigma - 1)^i for i = 0, ..., budget.
+    double nNeighbors = 0.0, nChoices = 1.0;
+    const double nSubstitutions = std::max<size_t>(1, alphabet.size()) - 1;
+
+    for (size_t i = 0; i <= budget and i <= partSize; ++i)
+    {
+        nNeighbors += nChoices * std::pow(nSubstitutions, i);
+        nChoices = nChoices * (partSize - i) / (i + 1);
+    }
+
+    return nNeighbors;
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::storePartAndRest(const std::string &word, size_t iPart)
+{
+    assert(curScheme != nullptr and curScheme->partStarts.back() == word.size());
+
+    const size_t partStart = curScheme->partStarts[iPart];
+    const size_t partEnd = curScheme->partStarts[iPart + 1];
+
+    keyBuf[0] = static_cast<char>(iPart);
+    memcpy(keyBuf + 1, word.c_str() + partStart, partEnd - partStart);
+
+    memcpy(restBuf, word.c_str(), partStart);
+    memcpy(restBuf + partStart, word.c_str() + partEnd, word.size() - partEnd);
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::searchNeighborhood(const std::string &query, size_t iPart, size_t iChar,
+                                               size_t budget, size_t nErrors, MatchCollector &matches)
+{
+    const size_t partSize = curScheme->partStarts[iPart + 1] - curScheme->partStarts[iPart];
+
+    if (budget == 0)
+    {
+        return;
+    }
+
+    // Each neighbor is generated once, substituted positions are increasing.
+    for (size_t i = iChar; i < partSize; ++i)
+    {
+        char &c = keyBuf[1 + i];
+        const char original = c;
+
+        for (const char substitute : alphabet)
+        {
+            if (substitute == original)
+            {
+                continue;
+            }
+
+            c = substitute;
+
+            searchEntry(query, iPart, nErrors + 1, matches);
+            searchNeighborhood(query, iPart, i + 1, budget - 1, nErrors + 1, matches);
+
+            if (matches.isDone())
+            {
+                c = original;
+                return;
+            }
+        }
+
+        c = original;
+    }
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::searchEntry(const std::string &query, size_t iPart, size_t nErrors, MatchCollector &matches)
+{
+    const size_t partStart = curScheme->partStarts[iPart];
+    const size_t partSize = curScheme->partStarts[iPart + 1] - partStart;
+
+    size_t hashKeySize;
+    const char *key = getPartKey(partSize, hashKeySize);
+
+    // The part contains chars outside the alphabet, so it cannot be a key.
+    if (key == nullptr)
+    {
+        return;
+    }
+
+    char **entryPtr = hashMap->retrieve(key, hashKeySize);
+
+    if (entryPtr == nullptr)
+    {
+        return;
+    }
+
+    const char *entry = *entryPtr;
+    const size_t restSize = query.size() - partSize;
+
+    while (*entry != 0)
+    {
+        const size_t entryRestSize = utils::SizeCoding::read(entry);
+
+        // Errors within the part have already been spent on the neighbor.
+        if (entryRestSize == restSize and
+            utils::Distance::isHammingAtMost(entry, restBuf, restSize, k - nErrors))
+        {
+            memcpy(matchBuf, entry, partStart);
+            memcpy(matchBuf + partStart, keyBuf + 1, partSize);
+            memcpy(matchBuf + partStart + partSize, entry + partStart, restSize - partStart);
+
+            matches.add(matchBuf, query.size());
+
+            if (matches.isDone())
+            {
+                return;
+            }
+        }
+
+        entry += entryRestSize;
+    }
+}
+
+template<size_t k>
+void SplitIndexKBudgets<k>::storeRest(const char *key, size_t keySize, const char *rest, size_t restSize)
+{
+    assert(restSize > 0 and restSize < maxWordSize);
+    char **entryPtr = hashMap->retrieve(key, keySize);
+
+    if (entryPtr == nullptr)
+    {
+        // 1 = terminating 0.
+        const size_t newSize = utils::SizeCoding::calcSizeB(restSize) + restSize + 1;
+
+        char *newEntry = static_cast<char *>(malloc(newSize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        char *it = utils::SizeCoding::write(newEntry, restSize);
+        memcpy(it, rest, restSize);
+        newEntry[newSize - 1] = 0;
+
+        hashMap->insert(key, keySize, newEntry);
+        free(newEntry); // The entry is copied inside the map, so it can be freed here.
+    }
+    else
+    {
+        const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
+        const size_t newEntrySize = oldEntrySize + utils::SizeCoding::calcSizeB(restSize) + restSize;
+
+        char *newEntry = static_cast<char *>(realloc(*entryPtr, newEntrySize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        // We start overwriting with the terminating 0.
+        char *it = utils::SizeCoding::write(newEntry + oldEntrySize - 1, restSize);
+        memcpy(it, rest, restSize);
+        newEntry[newEntrySize - 1] = 0;
+
+        // This is required in the case the memory has been moved by realloc.
+        *entryPtr = newEntry;
+    }
+}
+
+template<size_t k>
+const char *SplitIndexKBudgets<k>::getPartKey(size_t partSize, size_t &hashKeySize)
+{
+    // Only the part is packed, the part index is prepended afterwards.
+    const char *key = getKey(keyBuf + 1, partSize, packedKeyBuf + 1, hashKeySize);
+
+    if (key == nullptr)
+    {
+        return nullptr;
+    }
+
+    hashKeySize += 1;
+
+    if (key == keyBuf + 1)
+    {
+        return keyBuf;
+    }
+
+    packedKeyBuf[0] = keyBuf[0];
+    return packedKeyBuf;
+}
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_K_BUDGETS_HPP
@@ -0,0 +1,130 @@
+#ifndef SPLIT_INDEX_K_COMP_HPP
+#define SPLIT_INDEX_K_COMP_HPP
+
+#include "qgram_codec.hpp"
+#include "split_index_k.hpp"
+
+#ifndef SPLIT_INDEX_K_WHITEBOX
+#define SPLIT_INDEX_K_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for any k = 1, 2, 3, using q-gram compression of stored word parts (see QgramCodec).
+ * Stored word parts consist of their decoded size followed by their encoding,
+ * so that word parts having the wrong size can be skipped without decoding. */
+template<size_t k>
+class SplitIndexKComp : public SplitIndexK<k>
+{
+public:
+    SplitIndexKComp(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor);
+    ~SplitIndexKComp() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+protected:
+    void searchPartEntry(const std::string &query, size_t iPart, const char *entry,
+        MatchCollector &matches) override;
+
+    void storeRemainingParts(size_t iPart, const char *wordParts, size_t partsSize) override;
+
+    /** Stored word parts are encoded, so no sub-indexes are built. */
+    void buildSubIndexes() override { }
+    void updateSubIndex(const char *) override { }
+
+    /** Decoded sizes of word parts are stored in single bytes. */
+    size_t getMaxWordSize() const override { return this->maxByteWordSize; }
+
+    QgramCodec codec;
+
+    /** Temporarily stores encoded or decoded word parts. */
+    char *codingBuf = nullptr;
+
+    SPLIT_INDEX_K_WHITEBOX
+};
+
+template<size_t k>
+SplitIndexKComp<k>::SplitIndexKComp(const std::unordered_set<std::string> &wordSet,
+                                    hash_functions::HashFunctions::HashType hashType, float maxLoadFactor)
+    :SplitIndexK<k>(wordSet, hashType, maxLoadFactor)
+{
+    // Decoding always copies whole fixed-size q-grams, hence the extra space.
+    codingBuf = new char[SplitIndex::maxWordSize + QgramCodec::codingBufPadding];
+}
+
+template<size_t k>
+SplitIndexKComp<k>::~SplitIndexKComp()
+{
+    delete[] codingBuf;
+}
+
+template<size_t k>
+void SplitIndexKComp<k>::construct()
+{
+    codec.build(this->wordSet);
+    SplitIndexK<k>::construct();
+}
+
+template<size_t k>
+std::string SplitIndexKComp<k>::toString() const
+{
+    if (not this->constructed)
+    {
+        return "Index not constructed";
+    }
+
+    return SplitIndexK<k>::toString() + "\nWith compression: " + codec.toString();
+}
+
+template<size_t k>
+void SplitIndexKComp<k>::searchPartEntry(const std::string &query, size_t iPart, const char *entry,
+    MatchCollector &matches)
+{
+    const char *entryStart = entry;
+    const char cMatchSize = query.size() - this->wordPartSizes[iPart];
+
+    size_t iWord = 0;
+    entry = this->getEntryWords(entry);
+
+    while (*entry != 0)
+    {
+        const size_t partsSize = utils::SizeCoding::read(entry);
+
+        // The first byte of stored word parts holds their decoded size.
+        if (entry[0] == cMatchSize and
+            iPart == this->retrievePartIndexFromBits(entryStart, iWord))
+        {
+            codec.decode(entry + 1, partsSize - 1, cMatchSize, codingBuf);
+
+            if (this->isCanonicalCandidate(query, codingBuf, iPart) and
+                this->tryMatchPart(query, codingBuf, cMatchSize, iPart))
+            {
+                matches.addUnique(this->matchBuf, query.size());
+
+                if (matches.isDone())
+                {
+                    return;
+                }
+            }
+        }
+
+        iWord += 1;
+        entry += partsSize;
+    }
+}
+
+template<size_t k>
+void SplitIndexKComp<k>::storeRemainingParts(size_t iPart, const char *wordParts, size_t partsSize)
+{
+    codingBuf[0] = static_cast<char>(partsSize);
+    const size_t encodedSize = codec.encode(wordParts, partsSize, codingBuf + 1);
+
+    SplitIndexK<k>::storeRemainingParts(iPart, codingBuf, encodedSize + 1);
+}
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_K_COMP_HPP
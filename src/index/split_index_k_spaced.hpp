@@ -0,0 +1,295 @@
+#ifndef SPLIT_INDEX_K_SPACED_HPP
+#define SPLIT_INDEX_K_SPACED_HPP
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "spaced_seeds.hpp"
+#include "split_index.hpp"
+
+#include "../hash_map/hash_map_aligned.hpp"
+#include "../utils/distance.hpp"
+#include "../utils/size_coding.hpp"
+
+#ifndef SPLIT_INDEX_K_SPACED_WHITEBOX
+#define SPLIT_INDEX_K_SPACED_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for any k = 1, 2, 3 whose k + 1 parts are spaced seeds (see SpacedSeeds) instead of contiguous slices.
+ * Low-complexity regions (e.g. runs or tandem repeats in DNA) span several contiguous parts, producing few but very
+ * long entries, whereas spaced parts sample chars from the whole word.
+ * Keys start with the part index, entries consist of the remaining chars of the word (in the order of positions)
+ * with their sizes. */
+template<size_t k>
+class SplitIndexKSpaced : public SplitIndex
+{
+public:
+    SplitIndexKSpaced(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor, size_t seedBlockSize = 1);
+    ~SplitIndexKSpaced() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+protected:
+    void initEntry(const std::string &word) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
+    bool hasSameConfig(const SplitIndex &other) const override;
+
+    size_t calcEntrySizeB(const char *entry) const override;
+
+    size_t getMinWordSize() const override { return k + 1; }
+    /** Spaced seeds support words of at most SpacedSeeds::maxSupportedWordSize chars. */
+    size_t getMaxWordSize() const override { return seedsMaxWordSize; }
+
+    /** Stores part [iPart] of [word] after the part index in keyBuf, followed by the remaining chars.
+     * Returns the size of the part. */
+    size_t storePartAndRest(const std::string &word, size_t iPart);
+
+    /** Stores [rest] of size [restSize] in the entry under the key [key] of size [keySize]. */
+    void storeRest(const char *key, size_t keySize, const char *rest, size_t restSize);
+
+    /** Returns the hash map key for the part of [partSize] chars stored in keyBuf (possibly packed,
+     * see SplitIndex::getKey), stores its size in [hashKeySize], returns nullptr if the part cannot be a key. */
+    const char *getPartKey(size_t partSize, size_t &hashKeySize);
+
+    const size_t seedsMaxWordSize = std::min(maxWordSize, static_cast<size_t>(SpacedSeeds::maxSupportedWordSize));
+    SpacedSeeds seeds;
+
+    /** Temporarily store words padded with zeros (see SpacedSeeds::gather), keys (the part index followed
+     * by the part and the remaining chars), packed keys, and matching words (gathered and scattered). */
+    char *wordBuf = nullptr;
+    char *keyBuf = nullptr;
+    char *packedKeyBuf = nullptr;
+    char *gatheredMatchBuf = nullptr;
+    char *matchBuf = nullptr;
+
+    SPLIT_INDEX_K_SPACED_WHITEBOX
+};
+
+template<size_t k>
+SplitIndexKSpaced<k>::SplitIndexKSpaced(const std::unordered_set<std::string> &wordSet,
+                                        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor,
+                                        size_t seedBlockSize)
+    :SplitIndex(wordSet), seeds(k + 1, seedBlockSize, seedsMaxWordSize)
+{
+    if (k < 1 or k > 3)
+    {
+        throw std::invalid_argument("k must be between (inclusive) 1 and 3");
+    }
+
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
+    auto calcEntrySizeB = std::bind(&SplitIndexKSpaced<k>::calcEntrySizeB, this, std::placeholders::_1);
+
+    hashMap = new hash_map::HashMapAligned(calcEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
+
+    // Gathering may read and write whole SIMD chunks, the part index precedes the part.
+    const size_t bufSize = std::max(maxWordSize, static_cast<size_t>(SpacedSeeds::maxSimdWordSize));
+
+    wordBuf = new char[bufSize]();
+    keyBuf = new char[bufSize + 1];
+    packedKeyBuf = new char[bufSize + 1];
+    gatheredMatchBuf = new char[bufSize];
+    matchBuf = new char[bufSize];
+}
+
+template<size_t k>
+SplitIndexKSpaced<k>::~SplitIndexKSpaced()
+{
+    delete[] wordBuf;
+    delete[] keyBuf;
+    delete[] packedKeyBuf;
+    delete[] gatheredMatchBuf;
+    delete[] matchBuf;
+}
+
+template<size_t k>
+void SplitIndexKSpaced<k>::construct()
+{
+    // Split points are not tuned, parts are defined by spaced seeds.
+    tuneSplitPoints = false;
+    SplitIndex::construct();
+}
+
+template<size_t k>
+std::string SplitIndexKSpaced<k>::toString() const
+{
+    return SplitIndex::toString() + "\n(spaced seeds) " + seeds.toString();
+}
+
+template<size_t k>
+bool SplitIndexKSpaced<k>::hasSameConfig(const SplitIndex &other) const
+{
+    if (not SplitIndex::hasSameConfig(other))
+    {
+        return false;
+    }
+
+    // Block sizes are only lowered for short words, so the block size of the longest words is the configured one.
+    const SpacedSeeds &otherSeeds = static_cast<const SplitIndexKSpaced<k> &>(other).seeds;
+    return seeds.getBlockSize(seedsMaxWordSize) == otherSeeds.getBlockSize(seedsMaxWordSize);
+}
+
+template<size_t k>
+void SplitIndexKSpaced<k>::initEntry(const std::string &word)
+{
+    for (size_t iPart = 0; iPart <= k; ++iPart)
+    {
+        const size_t partSize = storePartAndRest(word, iPart);
+        size_t hashKeySize;
+
+        const char *key = getPartKey(partSize, hashKeySize);
+        assert(key != nullptr);
+
+        storeRest(key, hashKeySize, keyBuf + 1 + partSize, word.size() - partSize);
+    }
+}
+
+template<size_t k>
+void SplitIndexKSpaced<k>::processQuery(const std::string &query, MatchCollector &matches)
+{
+    assert(constructed);
+    assert(query.size() >= k + 1 and query.size() <= seedsMaxWordSize);
+
+    for (size_t iPart = 0; iPart <= k; ++iPart)
+    {
+        const size_t partSize = storePartAndRest(query, iPart);
+        size_t hashKeySize;
+
+        const char *key = getPartKey(partSize, hashKeySize);
+
+        // The query part contains chars outside the alphabet, so it cannot be a key.
+        if (key == nullptr)
+        {
+            continue;
+        }
+
+        char **entryPtr = hashMap->retrieve(key, hashKeySize);
+
+        if (entryPtr == nullptr)
+        {
+            continue;
+        }
+
+        const char *entry = *entryPtr;
+        const char *queryRest = keyBuf + 1 + partSize;
+
+        const size_t restSize = query.size() - partSize;
+
+        while (*entry != 0)
+        {
+            const size_t entryRestSize = utils::SizeCoding::read(entry);
+
+            if (entryRestSize == restSize and utils::Distance::isHammingAtMostK<k>(entry, queryRest, restSize))
+            {
+                memcpy(gatheredMatchBuf, keyBuf + 1, partSize);
+                memcpy(gatheredMatchBuf + partSize, entry, restSize);
+
+                seeds.scatter(gatheredMatchBuf, query.size(), iPart, matchBuf);
+                matches.add(matchBuf, query.size());
+
+                if (matches.isDone())
+                {
+                    return;
+                }
+            }
+
+            entry += entryRestSize;
+        }
+    }
+}
+
+template<size_t k>
+size_t SplitIndexKSpaced<k>::calcEntrySizeB(const char *entry) const
+{
+    const char *start = entry;
+
+    while (*entry != 0)
+    {
+        const size_t restSize = utils::SizeCoding::read(entry);
+        entry += restSize;
+    }
+
+    return entry - start + 1; // This includes the terminating 0.
+}
+
+template<size_t k>
+size_t SplitIndexKSpaced<k>::storePartAndRest(const std::string &word, size_t iPart)
+{
+    // The padding after the word is never read into parts, so it does not need to be cleared.
+    memcpy(wordBuf, word.c_str(), word.size());
+
+    keyBuf[0] = static_cast<char>(iPart);
+    seeds.gather(wordBuf, word.size(), iPart, keyBuf + 1);
+
+    return seeds.getPartSize(word.size(), iPart);
+}
+
+template<size_t k>
+void SplitIndexKSpaced<k>::storeRest(const char *key, size_t keySize, const char *rest, size_t restSize)
+{
+    assert(restSize > 0 and restSize < maxWordSize);
+    char **entryPtr = hashMap->retrieve(key, keySize);
+
+    if (entryPtr == nullptr)
+    {
+        // 1 = terminating 0.
+        const size_t newSize = utils::SizeCoding::calcSizeB(restSize) + restSize + 1;
+
+        char *newEntry = static_cast<char *>(malloc(newSize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        char *it = utils::SizeCoding::write(newEntry, restSize);
+        memcpy(it, rest, restSize);
+        newEntry[newSize - 1] = 0;
+
+        hashMap->insert(key, keySize, newEntry);
+        free(newEntry); // The entry is copied inside the map, so it can be freed here.
+    }
+    else
+    {
+        const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
+        const size_t newEntrySize = oldEntrySize + utils::SizeCoding::calcSizeB(restSize) + restSize;
+
+        char *newEntry = static_cast<char *>(realloc(*entryPtr, newEntrySize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        // We start overwriting with the terminating 0.
+        char *it = utils::SizeCoding::write(newEntry + oldEntrySize - 1, restSize);
+        memcpy(it, rest, restSize);
+        newEntry[newEntrySize - 1] = 0;
+
+        // This is required in the case the memory has been moved by realloc.
+        *entryPtr = newEntry;
+    }
+}
+
+template<size_t k>
+const char *SplitIndexKSpaced<k>::getPartKey(size_t partSize, size_t &hashKeySize)
+{
+    // Only the part is packed, the part index is prepended afterwards.
+    const char *key = getKey(keyBuf + 1, partSize, packedKeyBuf + 1, hashKeySize);
+
+    if (key == nullptr)
+    {
+        return nullptr;
+    }
+
+    hashKeySize += 1;
+
+    if (key == keyBuf + 1)
+    {
+        return keyBuf;
+    }
+
+    packedKeyBuf[0] = keyBuf[0];
+    return packedKeyBuf;
+}
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_K_SPACED_HPP
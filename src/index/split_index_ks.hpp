@@ -0,0 +1,372 @@
+#ifndef SPLIT_INDEX_KS_HPP
+#define SPLIT_INDEX_KS_HPP
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "split_index.hpp"
+
+#include "../hash_map/hash_map_aligned.hpp"
+#include "../utils/distance.hpp"
+#include "../utils/size_coding.hpp"
+
+#ifndef SPLIT_INDEX_KS_WHITEBOX
+#define SPLIT_INDEX_KS_WHITEBOX
+#endif
+
+namespace split_index
+{
+
+/** Split index for any k = 1, 2, 3 using k + s splitting: words are split into k + s parts,
+ * and each combination of s parts (concatenated) forms a key, under which the remaining k parts are stored.
+ * By the pigeonhole principle, at least s parts of a matching word are the same as in the query,
+ * so keys are longer and more selective than single parts, at the cost of more keys per word.
+ * Keys start with the index of their combination, entries consist of the remaining parts with their sizes. */
+template<size_t k>
+class SplitIndexKS : public SplitIndex
+{
+public:
+    SplitIndexKS(const std::unordered_set<std::string> &wordSet,
+        hash_functions::HashFunctions::HashType hashType, float maxLoadFactor, size_t nKeyPartsArg = 2);
+    ~SplitIndexKS() override;
+
+    void construct() override;
+    std::string toString() const override;
+
+    /** The maximum number of parts forming a key. */
+    static constexpr size_t maxNKeyParts = 4;
+
+protected:
+    void initEntry(const std::string &word) override;
+    void processQuery(const std::string &query, MatchCollector &matches) override;
+    bool hasSameConfig(const SplitIndex &other) const override;
+
+    size_t calcEntrySizeB(const char *entry) const override;
+
+    size_t getMinWordSize() const override { return nParts; }
+
+    /** Fills partStarts with the starts of all parts of [wordSize], followed by [wordSize]. */
+    void fillPartStarts(size_t wordSize);
+
+    /** Stores the key for combination [iComb] of [word] in keyBuf (see getCombinationKey),
+     * and the remaining parts in remainingPartsBuf. Returns the size of remaining parts. */
+    size_t storeKeyAndRemainingParts(const std::string &word, size_t iComb);
+
+    /** Returns the hash map key stored in keyBuf for a key of [keySize] bytes
+     * (the combination index followed by key parts), possibly packed (see SplitIndex::getKey).
+     * Stores its size in [hashKeySize], returns nullptr if the key parts cannot be a key. */
+    const char *getCombinationKey(size_t keySize, size_t &hashKeySize);
+
+    /** Stores [remainingParts] of size [partsSize] in the entry under the key [key] of size [keySize]. */
+    void storeRemainingParts(const char *key, size_t keySize, const char *remainingParts, size_t partsSize);
+
+    /** Stores the word consisting of key parts of combination [iComb] from [query] and [remainingParts] in matchBuf. */
+    void storeMatch(const std::string &query, size_t iComb, const char *remainingParts);
+
+    /** The number of parts forming a key (s) and the number of all parts (k + s). */
+    const size_t nKeyParts, nParts;
+
+    /** All combinations of nKeyParts out of nParts part indices, and the complementary remaining part indices. */
+    std::vector<std::vector<size_t>> combinations;
+    std::vector<std::vector<size_t>> remainingPartIndices;
+
+    /** Temporarily store the starts of all parts followed by the word size, and the word size they are filled for. */
+    std::vector<size_t> partStarts;
+    size_t partStartsWordSize = 0;
+
+    /** Temporarily store keys (the combination index followed by key parts), packed keys,
+     * remaining parts, and matching words. */
+    char *keyBuf = nullptr;
+    char *packedKeyBuf = nullptr;
+    char *remainingPartsBuf = nullptr;
+    char *matchBuf = nullptr;
+
+    SPLIT_INDEX_KS_WHITEBOX
+};
+
+template<size_t k>
+SplitIndexKS<k>::SplitIndexKS(const std::unordered_set<std::string> &wordSet,
+                              hash_functions::HashFunctions::HashType hashType, float maxLoadFactor,
+                              size_t nKeyPartsArg)
+    :SplitIndex(wordSet), nKeyParts(nKeyPartsArg), nParts(k + nKeyPartsArg)
+{
+    if (k < 1 or k > 3)
+    {
+        throw std::invalid_argument("k must be between (inclusive) 1 and 3");
+    }
+
+    if (nKeyParts < 1 or nKeyParts > maxNKeyParts)
+    {
+        throw std::invalid_argument("#key parts must be between (inclusive) 1 and " + std::to_string(maxNKeyParts));
+    }
+
+    const size_t nBucketsHint = std::max<size_t>(1, nBucketsHintFactor * wordSet.size());
+    auto calcEntrySizeB = std::bind(&SplitIndexKS<k>::calcEntrySizeB, this, std::placeholders::_1);
+
+    hashMap = new hash_map::HashMapAligned(calcEntrySizeB, maxLoadFactor, nBucketsHint, hashType);
+
+    // Combinations are enumerated as bit masks over part indices, in the increasing order of masks.
+    for (size_t mask = 0; mask < (static_cast<size_t>(1) << nParts); ++mask)
+    {
+        std::vector<size_t> combination, remaining;
+
+        for (size_t iPart = 0; iPart < nParts; ++iPart)
+        {
+            ((mask >> iPart) & 1) ? combination.push_back(iPart) : remaining.push_back(iPart);
+        }
+
+        if (combination.size() == nKeyParts)
+        {
+            combinations.push_back(std::move(combination));
+            remainingPartIndices.push_back(std::move(remaining));
+        }
+    }
+
+    // The combination index precedes key parts.
+    keyBuf = new char[maxWordSize + 1];
+    packedKeyBuf = new char[maxWordSize + 1];
+    remainingPartsBuf = new char[maxWordSize];
+    matchBuf = new char[maxWordSize];
+
+    partStarts.resize(nParts + 1);
+}
+
+template<size_t k>
+SplitIndexKS<k>::~SplitIndexKS()
+{
+    delete[] keyBuf;
+    delete[] packedKeyBuf;
+    delete[] remainingPartsBuf;
+    delete[] matchBuf;
+}
+
+template<size_t k>
+void SplitIndexKS<k>::construct()
+{
+    // Split points are not tuned, words are always split into parts of (almost) equal sizes.
+    tuneSplitPoints = false;
+    SplitIndex::construct();
+}
+
+template<size_t k>
+std::string SplitIndexKS<k>::toString() const
+{
+    return SplitIndex::toString() + "\n(k + s splitting) k = " + std::to_string(k) + ", s = " + std::to_string(nKeyParts)
+        + ", #keys per word = " + std::to_string(combinations.size());
+}
+
+template<size_t k>
+bool SplitIndexKS<k>::hasSameConfig(const SplitIndex &other) const
+{
+    return SplitIndex::hasSameConfig(other) and nKeyParts == static_cast<const SplitIndexKS<k> &>(other).nKeyParts;
+}
+
+template<size_t k>
+void SplitIndexKS<k>::initEntry(const std::string &word)
+{
+    fillPartStarts(word.size());
+
+    for (size_t iComb = 0; iComb < combinations.size(); ++iComb)
+    {
+        const size_t remainingPartsSize = storeKeyAndRemainingParts(word, iComb);
+        size_t hashKeySize;
+
+        const char *key = getCombinationKey(word.size() - remainingPartsSize + 1, hashKeySize);
+        assert(key != nullptr);
+
+        storeRemainingParts(key, hashKeySize, remainingPartsBuf, remainingPartsSize);
+    }
+}
+
+template<size_t k>
+void SplitIndexKS<k>::processQuery(const std::string &query, MatchCollector &matches)
+{
+    assert(constructed);
+    assert(query.size() >= nParts and query.size() <= maxWordSize);
+
+    fillPartStarts(query.size());
+
+    for (size_t iComb = 0; iComb < combinations.size(); ++iComb)
+    {
+        const size_t remainingPartsSize = storeKeyAndRemainingParts(query, iComb);
+        size_t hashKeySize;
+
+        const char *key = getCombinationKey(query.size() - remainingPartsSize + 1, hashKeySize);
+
+        // The query parts contain chars outside the alphabet, so they cannot be a key.
+        if (key == nullptr)
+        {
+            continue;
+        }
+
+        char **entryPtr = hashMap->retrieve(key, hashKeySize);
+
+        if (entryPtr == nullptr)
+        {
+            continue;
+        }
+
+        const char *entry = *entryPtr;
+
+        while (*entry != 0)
+        {
+            const size_t partsSize = utils::SizeCoding::read(entry);
+
+            // All errors are located within the remaining parts, since key parts match exactly.
+            if (partsSize == remainingPartsSize and
+                utils::Distance::isHammingAtMostK<k>(entry, remainingPartsBuf, remainingPartsSize))
+            {
+                storeMatch(query, iComb, entry);
+                matches.add(matchBuf, query.size());
+
+                if (matches.isDone())
+                {
+                    return;
+                }
+            }
+
+            entry += partsSize;
+        }
+    }
+}
+
+template<size_t k>
+size_t SplitIndexKS<k>::calcEntrySizeB(const char *entry) const
+{
+    const char *start = entry;
+
+    while (*entry != 0)
+    {
+        const size_t partsSize = utils::SizeCoding::read(entry);
+        entry += partsSize;
+    }
+
+    return entry - start + 1; // This includes the terminating 0.
+}
+
+template<size_t k>
+void SplitIndexKS<k>::fillPartStarts(size_t wordSize)
+{
+    assert(wordSize >= nParts);
+
+    // Parts differ in size by at most 1.
+    for (size_t iPart = 0; iPart <= nParts; ++iPart)
+    {
+        partStarts[iPart] = iPart * wordSize / nParts;
+    }
+
+    partStartsWordSize = wordSize;
+}
+
+template<size_t k>
+size_t SplitIndexKS<k>::storeKeyAndRemainingParts(const std::string &word, size_t iComb)
+{
+    assert(partStartsWordSize == word.size());
+
+    keyBuf[0] = static_cast<char>(iComb);
+    size_t keySize = 1, remainingPartsSize = 0;
+
+    for (const size_t iPart : combinations[iComb])
+    {
+        const size_t partSize = partStarts[iPart + 1] - partStarts[iPart];
+
+        memcpy(keyBuf + keySize, word.c_str() + partStarts[iPart], partSize);
+        keySize += partSize;
+    }
+
+    for (const size_t iPart : remainingPartIndices[iComb])
+    {
+        const size_t partSize = partStarts[iPart + 1] - partStarts[iPart];
+
+        memcpy(remainingPartsBuf + remainingPartsSize, word.c_str() + partStarts[iPart], partSize);
+        remainingPartsSize += partSize;
+    }
+
+    assert(keySize - 1 + remainingPartsSize == word.size());
+    return remainingPartsSize;
+}
+
+template<size_t k>
+const char *SplitIndexKS<k>::getCombinationKey(size_t keySize, size_t &hashKeySize)
+{
+    // Only key parts are packed, the combination index is prepended afterwards.
+    const char *key = getKey(keyBuf + 1, keySize - 1, packedKeyBuf + 1, hashKeySize);
+
+    if (key == nullptr)
+    {
+        return nullptr;
+    }
+
+    hashKeySize += 1;
+
+    if (key == keyBuf + 1)
+    {
+        return keyBuf;
+    }
+
+    packedKeyBuf[0] = keyBuf[0];
+    return packedKeyBuf;
+}
+
+template<size_t k>
+void SplitIndexKS<k>::storeRemainingParts(const char *key, size_t keySize, const char *remainingParts, size_t partsSize)
+{
+    assert(partsSize > 0 and partsSize < maxWordSize);
+    char **entryPtr = hashMap->retrieve(key, keySize);
+
+    if (entryPtr == nullptr)
+    {
+        // 1 = terminating 0.
+        const size_t newSize = utils::SizeCoding::calcSizeB(partsSize) + partsSize + 1;
+
+        char *newEntry = static_cast<char *>(malloc(newSize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        char *it = utils::SizeCoding::write(newEntry, partsSize);
+        memcpy(it, remainingParts, partsSize);
+        newEntry[newSize - 1] = 0;
+
+        hashMap->insert(key, keySize, newEntry);
+        free(newEntry); // The entry is copied inside the map, so it can be freed here.
+    }
+    else
+    {
+        const size_t oldEntrySize = calcEntrySizeB(*entryPtr);
+        const size_t newEntrySize = oldEntrySize + utils::SizeCoding::calcSizeB(partsSize) + partsSize;
+
+        char *newEntry = static_cast<char *>(realloc(*entryPtr, newEntrySize * sizeof(char)));
+        assert(newEntry != nullptr);
+
+        // We start overwriting with the terminating 0.
+        char *it = utils::SizeCoding::write(newEntry + oldEntrySize - 1, partsSize);
+        memcpy(it, remainingParts, partsSize);
+        newEntry[newEntrySize - 1] = 0;
+
+        // This is required in the case the memory has been moved by realloc.
+        *entryPtr = newEntry;
+    }
+}
+
+template<size_t k>
+void SplitIndexKS<k>::storeMatch(const std::string &query, size_t iComb, const char *remainingParts)
+{
+    const std::vector<size_t> &remaining = remainingPartIndices[iComb];
+    size_t iRemaining = 0;
+
+    // Key parts are copied from the query, other parts from the entry.
+    memcpy(matchBuf, query.c_str(), query.size());
+
+    for (const size_t iPart : remaining)
+    {
+        const size_t partSize = partStarts[iPart + 1] - partStarts[iPart];
+
+        memcpy(matchBuf + partStarts[iPart], remainingParts + iRemaining, partSize);
+        iRemaining += partSize;
+    }
+}
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_KS_HPP
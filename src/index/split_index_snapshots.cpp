@@ -0,0 +1,53 @@
+#include "split_index_snapshots.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+SplitIndexSnapshots::SplitIndexSnapshots(const unordered_set<string> &words, IndexBuilder builderArg)
+    :builder(move(builderArg)), current(nullptr), epochs(1), iReader(epochs.registerReader()), nReloads(0)
+{
+    current.store(builder(words));
+}
+
+SplitIndexSnapshots::~SplitIndexSnapshots()
+{
+    if (isReloading())
+    {
+        reloadResult.wait();
+    }
+
+    delete current.load();
+}
+
+void SplitIndexSnapshots::reload(const unordered_set<string> &words)
+{
+    if (isReloading())
+    {
+        // The previous reload is only waited for, its failure does not prevent building the new snapshot.
+        reloadResult.wait();
+    }
+
+    reloadResult = async(launch::async, [this, words]() { buildAndPublish(words); });
+}
+
+void SplitIndexSnapshots::waitForReload()
+{
+    if (isReloading())
+    {
+        reloadResult.get();
+    }
+}
+
+void SplitIndexSnapshots::buildAndPublish(const unordered_set<string> &words)
+{
+    SplitIndex *snapshot = builder(words);
+    SplitIndex *oldSnapshot = current.exchange(snapshot);
+    nReloads.fetch_add(1);
+
+    epochs.waitForReaders();
+    delete oldSnapshot;
+}
+
+} // namespace split_index
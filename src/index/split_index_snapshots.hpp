@@ -0,0 +1,77 @@
+#ifndef SPLIT_INDEX_SNAPSHOTS_HPP
+#define SPLIT_INDEX_SNAPSHOTS_HPP
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_set>
+
+#include "split_index.hpp"
+#include "../utils/epoch_reclamation.hpp"
+
+namespace split_index
+{
+
+/** Serves queries from the current snapshot of a split index while a new one is built in a background thread,
+ * e.g. after the dictionary file has changed. A built index is published with an atomic pointer swap, queries
+ * which have started before finish on their old snapshot, which is deleted once no reader can access it anymore
+ * (epoch-based reclamation). Split indexes keep per-query buffers, hence queries must not run concurrently,
+ * i.e. only a single thread at a time may call query(), while reloads run in a background thread. */
+class SplitIndexSnapshots
+{
+public:
+    /** Builds and constructs a split index for a nonempty set of words. */
+    using IndexBuilder = std::function<SplitIndex *(const std::unordered_set<std::string> &)>;
+
+    /** Builds the first snapshot for [words] using [builderArg]. */
+    SplitIndexSnapshots(const std::unordered_set<std::string> &words, IndexBuilder builderArg);
+    /** Waits for the running reload, the query thread cannot be inside query() anymore. */
+    ~SplitIndexSnapshots();
+
+    SplitIndexSnapshots(const SplitIndexSnapshots &) = delete;
+    SplitIndexSnapshots &operator=(const SplitIndexSnapshots &) = delete;
+
+    /** Calls [fun](index) for the current snapshot and returns its result, calls must not be concurrent.
+     * The snapshot stays valid until [fun] returns, even if a new one is published in the meantime. */
+    template<typename Fun>
+    auto query(Fun fun) -> decltype(fun(std::declval<SplitIndex &>()));
+
+    /** Starts building a snapshot for [words] in a background thread, after the running reload (if any) has finished.
+     * Queries are served from the current snapshot until the new one is published. */
+    void reload(const std::unordered_set<std::string> &words);
+    /** Waits for the running reload (if any), rethrows the exception if the build has failed,
+     * in which case the previous snapshot is kept. */
+    void waitForReload();
+    bool isReloading() const { return reloadResult.valid(); }
+
+    /** Returns the number of snapshots published by reloads. */
+    size_t getNReloads() const { return nReloads.load(); }
+
+private:
+    /** Builds the snapshot for [words], publishes it and deletes the previous one when it is safe. */
+    void buildAndPublish(const std::unordered_set<std::string> &words);
+
+    IndexBuilder builder;
+    std::atomic<SplitIndex *> current;
+
+    /** The query thread is inside a read section while it queries, so that replaced snapshots are deleted only
+     * once no query can access them. */
+    utils::EpochReclamation epochs;
+    const size_t iReader;
+
+    std::future<void> reloadResult;
+    std::atomic<size_t> nReloads;
+};
+
+template<typename Fun>
+auto SplitIndexSnapshots::query(Fun fun) -> decltype(fun(std::declval<SplitIndex &>()))
+{
+    // The read section is entered before loading the snapshot, so that the snapshot cannot be deleted once loaded.
+    utils::EpochReclamation::ReadSection readSection(epochs, iReader);
+    return fun(*current.load());
+}
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_SNAPSHOTS_HPP
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "split_point_tuner.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+size_t SplitPointTuner::tune(const unordered_set<string> &wordSet, vector<vector<size_t>> &partStarts)
+{
+    // 1. We group sampled words by their sizes, skipping words which are too short or too long to be split.
+    vector<vector<const string *>> sampleWords(partStarts.size());
+
+    const size_t sampleStep = std::max<size_t>(1, wordSet.size() / maxNTuningWords);
+    size_t iWord = 0;
+
+    for (const string &word : wordSet)
+    {
+        if (iWord++ % sampleStep != 0 or word.size() >= partStarts.size())
+        {
+            continue;
+        }
+
+        const vector<size_t> &starts = partStarts[word.size()];
+
+        if (starts.back() == word.size() and
+            std::adjacent_find(starts.begin(), starts.end(), std::greater_equal<size_t>()) == starts.end())
+        {
+            sampleWords[word.size()].push_back(&word);
+        }
+    }
+
+    // 2. We count keys for the initial split points.
+    unordered_map<uint64_t, int64_t> keyCounts;
+    int64_t sumSquares = 0;
+
+    for (size_t wordSize = 0; wordSize < partStarts.size(); ++wordSize)
+    {
+        const vector<size_t> &starts = partStarts[wordSize];
+
+        for (const string *word : sampleWords[wordSize])
+        {
+            for (size_t iPart = 0; iPart + 1 < starts.size(); ++iPart)
+            {
+                updateKeyCount(keyCounts, sumSquares, *word, starts[iPart], starts[iPart + 1], 1);
+            }
+        }
+    }
+
+    // 3. We move each split point (i.e. the start of each part except for the first one) to its best position,
+    // keeping all other split points fixed.
+    const vector<vector<size_t>> initialPartStarts = partStarts;
+
+    for (size_t iPass = 0; iPass < maxNPasses; ++iPass)
+    {
+        bool improved = false;
+
+        for (size_t wordSize = 0; wordSize < partStarts.size(); ++wordSize)
+        {
+            vector<size_t> &starts = partStarts[wordSize];
+            const vector<const string *> &words = sampleWords[wordSize];
+
+            for (size_t iStart = 1; iStart + 1 < starts.size() and not words.empty(); ++iStart)
+            {
+                const size_t prevStart = starts[iStart - 1], nextStart = starts[iStart + 1];
+                const auto moveSplitPoint = [&](size_t from, size_t to)
+                {
+                    for (const string *word : words)
+                    {
+                        updateKeyCount(keyCounts, sumSquares, *word, prevStart, from, -1);
+                        updateKeyCount(keyCounts, sumSquares, *word, from, nextStart, -1);
+
+                        updateKeyCount(keyCounts, sumSquares, *word, prevStart, to, 1);
+                        updateKeyCount(keyCounts, sumSquares, *word, to, nextStart, 1);
+                    }
+                };
+
+                // Parts cannot be empty.
+                const size_t minCandidate = std::max(prevStart + 1,
+                    starts[iStart] - std::min(starts[iStart], static_cast<size_t>(maxSplitPointShift)));
+                const size_t maxCandidate = std::min(nextStart - 1, starts[iStart] + maxSplitPointShift);
+
+                for (size_t candidate = minCandidate; candidate <= maxCandidate; ++candidate)
+                {
+                    if (candidate == starts[iStart])
+                    {
+                        continue;
+                    }
+
+                    const int64_t oldSumSquares = sumSquares;
+                    moveSplitPoint(starts[iStart], candidate);
+
+                    if (sumSquares < oldSumSquares)
+                    {
+                        starts[iStart] = candidate;
+                        improved = true;
+                    }
+                    else
+                    {
+                        moveSplitPoint(candidate, starts[iStart]);
+                        assert(sumSquares == oldSumSquares);
+                    }
+                }
+            }
+        }
+
+        if (not improved)
+        {
+            break;
+        }
+    }
+
+    size_t nChanged = 0;
+
+    for (size_t wordSize = 0; wordSize < partStarts.size(); ++wordSize)
+    {
+        nChanged += (partStarts[wordSize] != initialPartStarts[wordSize]);
+    }
+
+    return nChanged;
+}
+
+uint64_t SplitPointTuner::hashPart(const char *part, size_t partSize)
+{
+    // FNV-1a, the size is mixed in as well, although parts of different sizes rarely collide anyway.
+    uint64_t hash = 14695981039346656037ull ^ partSize;
+
+    for (size_t i = 0; i < partSize; ++i)
+    {
+        hash ^= static_cast<unsigned char>(part[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void SplitPointTuner::updateKeyCount(unordered_map<uint64_t, int64_t> &keyCounts, int64_t &sumSquares,
+    const string &word, size_t start, size_t end, int64_t delta)
+{
+    int64_t &count = keyCounts[hashPart(word.c_str() + start, end - start)];
+
+    sumSquares -= count * count;
+    count += delta;
+    sumSquares += count * count;
+}
+
+} // namespace split_index
@@ -0,0 +1,46 @@
+#ifndef SPLIT_POINT_TUNER_HPP
+#define SPLIT_POINT_TUNER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace split_index
+{
+
+/** Picks split points (part starts) for each word size, minimizing the expected number of candidates per query.
+ * Queries are assumed to follow the dictionary, and a query which matches a word retrieves the entry of each
+ * of its exact parts, hence the expected number of candidates is proportional to the sum of squared entry sizes
+ * (in word parts) over all keys. This sum is minimized by a coordinate descent over the split points,
+ * using a sample of the dictionary. */
+class SplitPointTuner
+{
+public:
+    SplitPointTuner() = delete;
+
+    /** Tunes [partStarts], which holds the starts of all parts, i.e. 0, ..., [wordSize], for each word size.
+     * Only word sizes of words from [wordSet] are tuned, the initial split points are kept on ties.
+     * Returns the number of word sizes whose split points have been changed. */
+    static size_t tune(const std::unordered_set<std::string> &wordSet, std::vector<std::vector<size_t>> &partStarts);
+
+    /** At most this number of words (sampled uniformly) is used for tuning. */
+    static constexpr size_t maxNTuningWords = 50000;
+    /** Split points are moved by at most this number of chars in a single step. */
+    static constexpr size_t maxSplitPointShift = 3;
+    /** The maximum number of passes of the coordinate descent. */
+    static constexpr size_t maxNPasses = 3;
+
+private:
+    /** Returns a hash of [part] of size [partSize], used instead of the part itself when counting keys. */
+    static uint64_t hashPart(const char *part, size_t partSize);
+
+    /** Adds [delta] to the count of the key [word][start, end), updating [sumSquares] accordingly. */
+    static void updateKeyCount(std::unordered_map<uint64_t, int64_t> &keyCounts, int64_t &sumSquares,
+        const std::string &word, size_t start, size_t end, int64_t delta);
+};
+
+} // namespace split_index
+
+#endif // SPLIT_POINT_TUNER_HPP
@@ -6,15 +6,21 @@
 
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <numeric>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "../index/delta_split_index.hpp"
+#include "../index/disk_split_index.hpp"
 #include "../index/split_index_factory.hpp"
 #include "../utils/file_io.hpp"
 #include "../utils/string_utils.hpp"
@@ -47,13 +53,36 @@ bool checkInputFiles(const char *execName);
 /** Runs the main program and returns the program exit code. */
 int run();
 
-/** Searches for [queries] in [words] using a split index. */
-void runSearch(const vector<string> &words, const vector<string> &queries);
+/** Reads words from [dictFile] into [dict] (and their payloads into [wordPayloads] if records have payloads),
+ * skipping words which are too short. */
+void readDict(const string &dictFile, vector<string> &dict, unordered_map<string, SplitIndex::Payload> &wordPayloads);
+
+/** Searches for [queries] in [words] (with optional [wordPayloads]) using a split index. */
+void runSearch(const vector<string> &words, const vector<string> &queries,
+    const unordered_map<string, SplitIndex::Payload> &wordPayloads);
+
+/** Interleaves searching for [queries] in [index] (a split index or a delta index) with updates of [words],
+ * and prints the time per query and per update. */
+template<typename Index>
+void runMixedWorkload(Index &index, const vector<string> &words, const vector<string> &queries);
+/** Runs the mixed workload for [words] and [queries] using a delta index over a base split index,
+ * both of which are built with [wordPayloads]. */
+void runDeltaWorkload(const unordered_set<string> &wordSet, HashFunctions::HashType hashType,
+    SplitIndexFactory::IndexType indexType, const vector<string> &words, const vector<string> &queries,
+    const unordered_map<string, SplitIndex::Payload> &wordPayloads);
+
+/** Builds a split index (a shard) for each of params.mergeDictFiles and merges it into [index]. */
+void mergeShards(SplitIndex &index, HashFunctions::HashType hashType, SplitIndexFactory::IndexType indexType);
+
+/** Builds an out-of-core index in params.diskIndexDir by streaming the input dictionary, and searches for [queries]. */
+void runDiskSearch(const vector<string> &queries);
 
 void initSplitIndexParams(hash_functions::HashFunctions::HashType &hashType,
     SplitIndexFactory::IndexType &indexType);
 
 void dumpRunInfo(const SplitIndex *index, size_t nQueries);
+/** Prints the elapsed time and dumps it with the index size [indexSizeB] if params.dumpToFile is set. */
+void dumpRunInfo(float elapsedUs, long indexSizeB, size_t nQueries);
 
 } // namespace split_index
 
@@ -81,18 +110,34 @@ int handleParams(int argc, const char **argv)
     po::options_description options("Parameters");
     options.add_options()
        ("dump,d", "dump input files and params info with elapsed time to output file (useful for testing)")
+       ("compaction-threshold", po::value<float>(&params.compactionThreshold)->default_value(static_cast<float>(SplitIndex::defaultCompactionThreshold)), "ratio of erased words above which an update compacts (i.e. rebuilds) the index in the mixed search mode, 0 disables compaction")
+       ("delta", "run the mixed search mode using a delta index, i.e. an immutable base index with a mutable delta index and a deletion set, which are merged in the background")
+       ("disk-access", po::value<string>(&params.diskAccess)->default_value("random"), "access pattern of disk index segments during searching: random (no readahead), sequential (readahead within a segment, whose pages are released once it has been searched), prefetch (the next segment is read ahead)")
+       ("disk-index", po::value<string>(&params.diskIndexDir), "build an out-of-core index in the given directory by streaming the input dictionary, and search it (k1, k2, k3, words search mode)")
+       ("disk-run-size", po::value<size_t>(&params.diskRunSizeMB)->default_value(64), "memory used for sorting index keys when building a disk index in MB, larger dictionaries are sorted in many runs")
+       ("disk-segments", po::value<size_t>(&params.nDiskSegments)->default_value(64), "number of segment files of a disk index, each of them is mapped into memory")
        ("dump-all-matches", "dump the number of matches for each query to standard output, note: this invalidates time measurement")
        ("hash-type", po::value<string>(&params.hashType)->default_value("xxhash"), "hash type used by the split index: city, farm, farsh, fnv1, fnv1a, murmur3, sdbm, spookyv2, superfast, xxhash")
        ("help,h", "display help message")
-       ("index-type", po::value<string>(&params.indexType)->default_value("k1"), "split index type: k1 (k = 1), k1comp (k = 1 with q-gram compression), k1comptriple (k = 1 with 2-,3-,4-gram compression), k2 (k = 2), k3 (k = 3)")
+       ("index-type", po::value<string>(&params.indexType)->default_value("k1"), "split index type: k1 (k = 1), k1comp (k = 1 with q-gram compression), k1comptriple (k = 1 with 2-,3-,4-gram compression), k1compext (k = 1 with 2- to 6-gram compression using two-byte codes), k1packed (k = 1 with word parts packed using alphabet ranks), k1router (k = 1 with cost-based routing to neighborhood generation), k2 (k = 2), k2budgets (k = 2 with per-part error budgets and neighborhood probes), k2comp (k = 2 with q-gram compression), k2ks (k = 2 with k + s splitting), k2spaced (k = 2 with spaced-seed parts), k3 (k = 3), k3budgets (k = 3 with per-part error budgets and neighborhood probes), k3comp (k = 3 with q-gram compression), k3ks (k = 3 with k + s splitting), k3spaced (k = 3 with spaced-seed parts)")
        ("in-dict-file,i", po::value<string>(&params.inDictFile)->required(), "input dictionary file path (positional arg 1)")
        ("in-pattern-file,I", po::value<string>(&params.inPatternFile)->required(), "input pattern file path (positional arg 2)")
        ("iter", po::value<int>(&params.nIter)->default_value(1), "number of iterations per pattern lookup")
+       ("key-parts", po::value<size_t>(&params.nKeyParts)->default_value(2), "number of parts forming a key for k + s splitting (s), between 1 and 4")
        ("max-load-factor", po::value<float>(&params.maxLoadFactor)->default_value(2.0f), "maximum load factor which causes rehashing when crossed")
+       ("merge-dict", po::value<vector<string>>(&params.mergeDictFiles)->composing(), "dictionary file of a shard which is indexed separately (with the same index parameters) and merged into the index of the input dictionary, can be given many times")
        ("min-word-length", po::value<int>(&params.minWordLength)->default_value(4), "minimum word length from input dictionary and queries (shorter words are ignored)")
        ("out-file,o", po::value<string>(&params.outFile)->default_value("res.txt"), "output file path")
+       ("pack-keys", "pack hash map keys using alphabet ranks, i.e. use fewer than 8 bits per char for small alphabets")
+       ("payloads", "each dictionary record consists of a word and its payload (an unsigned integer weight, e.g. frequency) separated with whitespace")
+       ("search-mode", po::value<string>(&params.searchMode)->default_value("words"), "search mode: words (report matching words), exists (only check whether each query has a match), count (only count the matches of each query), top (report the best matches of each query ranked by distance and payload, see --top), mixed (interleave queries with dictionary updates, see --update-ratio)")
+       ("seed-block-size", po::value<size_t>(&params.seedBlockSize)->default_value(1), "block size of spaced-seed parts, i.e. the number of consecutive positions assigned to the same part (1 = interleaved parts)")
        // Not using a default value from Boost for separator because it literally prints a newline.
        ("separator,s", po::value<string>(&params.separator), "input data (dictionary and patterns) separator (default = newline)")
+       ("sub-index-threshold", po::value<size_t>(&params.subIndexThreshold)->default_value(static_cast<size_t>(SplitIndex::defaultSubIndexThreshold)), "number of word parts above which an entry gets its own sub-index keyed by pieces of stored parts, 0 disables sub-indexes (k1, k1router, k2, k3)")
+       ("top", po::value<size_t>(&params.nTopMatches)->default_value(10), "number of best matches reported for each query in the top search mode")
+       ("tune-splits", "tune split points for each word size using the dictionary instead of splitting words into parts of (almost) equal sizes")
+       ("update-ratio", po::value<float>(&params.updateRatio)->default_value(0.1f), "number of dictionary updates per query in the mixed search mode, each update erases a dictionary word and inserts its reversal")
        ("version,v", "display version info");
 
     po::positional_options_description positionalOptions;
@@ -136,10 +181,26 @@ int handleParams(int argc, const char **argv)
     {
         params.dumpToFile = true;
     }
+    if (vm.count("delta"))
+    {
+        params.deltaIndex = true;
+    }
     if (vm.count("dump-all-matches"))
     {
         params.dumpAllMatches = true;
     }
+    if (vm.count("payloads"))
+    {
+        params.dictPayloads = true;
+    }
+    if (vm.count("pack-keys"))
+    {
+        params.packKeys = true;
+    }
+    if (vm.count("tune-splits"))
+    {
+        params.tuneSplitPoints = true;
+    }
 
     return paramsResContinue;
 }
@@ -164,6 +225,18 @@ bool checkInputFiles(const char *execName)
         return false;
     }
 
+    for (const string &mergeDictFile : params.mergeDictFiles)
+    {
+        if (utils::FileIO::isFileReadable(mergeDictFile) == false)
+        {
+            cerr << "Cannot access shard dictionary file (doesn't exist or insufficient permissions): " <<
+                mergeDictFile << endl;
+            cerr << "Run " << execName << " -h for more information" << endl << endl;
+
+            return false;
+        }
+    }
+
     cout << "All input files exist" << endl;
     return true;
 }
@@ -172,13 +245,22 @@ int run()
 {
     try
     {
-        vector<string> dict = utils::FileIO::readWords(params.inDictFile, params.separator);
         vector<string> queries = utils::FileIO::readWords(params.inPatternFile, params.separator);
-       
-        utils::StringUtils::filterWordsByMinLength(dict, params.minWordLength);
         utils::StringUtils::filterWordsByMinLength(queries, params.minWordLength);
 
-        runSearch(dict, queries);
+        // The dictionary of a disk index is streamed, it is never read into memory.
+        if (not params.diskIndexDir.empty())
+        {
+            runDiskSearch(queries);
+        }
+        else
+        {
+            vector<string> dict;
+            unordered_map<string, SplitIndex::Payload> wordPayloads;
+
+            readDict(params.inDictFile, dict, wordPayloads);
+            runSearch(dict, queries, wordPayloads);
+        }
     }
     catch (const exception &ex)
     {
@@ -190,7 +272,26 @@ int run()
     return 0;
 }
 
-void runSearch(const vector<string> &dict, const vector<string> &queries)
+void readDict(const string &dictFile, vector<string> &dict, unordered_map<string, SplitIndex::Payload> &wordPayloads)
+{
+    if (params.dictPayloads)
+    {
+        for (const auto &record : utils::FileIO::readWordsWithPayloads(dictFile, params.separator))
+        {
+            dict.push_back(record.first);
+            wordPayloads[record.first] = record.second;
+        }
+    }
+    else
+    {
+        dict = utils::FileIO::readWords(dictFile, params.separator);
+    }
+
+    utils::StringUtils::filterWordsByMinLength(dict, params.minWordLength);
+}
+
+void runSearch(const vector<string> &dict, const vector<string> &queries,
+    const unordered_map<string, SplitIndex::Payload> &wordPayloads)
 {
     HashFunctions::HashType hashType;
     SplitIndexFactory::IndexType indexType;
@@ -201,27 +302,297 @@ void runSearch(const vector<string> &dict, const vector<string> &queries)
     cout << endl << boost::format("Processing #words (dict) = %1%, #queries = %2%")
             % wordSet.size() % queries.size() << endl;
 
-    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, indexType, params.maxLoadFactor);
+    if (params.searchMode == "mixed" and params.deltaIndex)
+    {
+        runDeltaWorkload(wordSet, hashType, indexType, dict, queries, wordPayloads);
+        return;
+    }
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, indexType, params.maxLoadFactor,
+        params.packKeys, params.tuneSplitPoints, params.nKeyParts, params.seedBlockSize,
+        params.subIndexThreshold, wordPayloads);
+
+    mergeShards(*index, hashType, indexType);
 
     cout << endl << "Index constructed:" << endl;
     cout << index->toString() << endl;
 
-    SplitIndex::ResultSetType results;
-
     if (params.dumpAllMatches)
     {
-        results = index->searchAndDumpMatchCounts(queries);
+        cout << "#matches = " << index->searchAndDumpMatchCounts(queries).size() << endl;
+    }
+    else if (params.searchMode == "exists")
+    {
+        vector<char> found;
+
+        index->searchExists(queries, found, params.nIter);
+        dumpRunInfo(index, queries.size());
+
+        cout << "#queries with matches = " << count(found.begin(), found.end(), 1) << endl;
+    }
+    else if (params.searchMode == "count")
+    {
+        vector<size_t> counts;
+
+        index->searchCount(queries, counts, params.nIter);
+        dumpRunInfo(index, queries.size());
+
+        cout << "#matches summed over queries = " << accumulate(counts.begin(), counts.end(), size_t(0)) << endl;
+    }
+    else if (params.searchMode == "mixed")
+    {
+        index->setCompactionThreshold(params.compactionThreshold);
+        runMixedWorkload(*index, dict, queries);
+
+        cout << boost::format("#erased words = %1%, #rebuilds = %2%")
+            % index->getNErasedWords() % index->getNRebuilds() << endl;
+    }
+    else if (params.searchMode == "top")
+    {
+        vector<vector<SplitIndex::Match>> matches;
+
+        index->searchTopMatches(queries, params.nTopMatches, matches, params.nIter);
+        dumpRunInfo(index, queries.size());
+
+        size_t nMatches = 0;
+
+        for (const vector<SplitIndex::Match> &queryMatches : matches)
+        {
+            nMatches += queryMatches.size();
+        }
+
+        cout << "#top matches summed over queries = " << nMatches << endl;
     }
     else
     {
-        results = index->search(queries, params.nIter);
+        SplitIndex::BatchResults results;
+
+        index->searchBatch(queries, results, params.nIter);
         dumpRunInfo(index, queries.size());
+
+        // The number of distinct matching words over all queries.
+        vector<bool> matched(index->getNWords(), false);
+        size_t nMatches = 0;
+
+        for (SplitIndex::WordId id : results.wordIds)
+        {
+            nMatches += matched[id] ? 0 : 1;
+            matched[id] = true;
+        }
+
+        cout << "#matches = " << nMatches << endl;
     }
 
-    cout << "#matches = " << results.size() << endl;
     delete index;
 }
 
+void runDeltaWorkload(const unordered_set<string> &wordSet, HashFunctions::HashType hashType,
+    SplitIndexFactory::IndexType indexType, const vector<string> &words, const vector<string> &queries,
+    const unordered_map<string, SplitIndex::Payload> &wordPayloads)
+{
+    // Indexes are also built by background merges, which only read the payloads.
+    DeltaSplitIndex index(wordSet, [hashType, indexType, &wordPayloads](const unordered_set<string> &indexWords)
+    {
+        return SplitIndexFactory::initIndex(indexWords, hashType, indexType, params.maxLoadFactor,
+            params.packKeys, params.tuneSplitPoints, params.nKeyParts, params.seedBlockSize,
+            params.subIndexThreshold, wordPayloads);
+    });
+
+    cout << endl << "Delta index constructed:" << endl;
+    cout << index.toString() << endl;
+
+    runMixedWorkload(index, words, queries);
+
+    cout << boost::format("#delta words = %1%, #erased base words = %2%, #merges = %3%")
+        % index.getNDeltaWords() % index.getNErasedBaseWords() % index.getNMerges() << endl;
+}
+
+void mergeShards(SplitIndex &index, HashFunctions::HashType hashType, SplitIndexFactory::IndexType indexType)
+{
+    using Clock = chrono::steady_clock;
+
+    for (const string &mergeDictFile : params.mergeDictFiles)
+    {
+        vector<string> shardDict;
+        unordered_map<string, SplitIndex::Payload> shardPayloads;
+
+        readDict(mergeDictFile, shardDict, shardPayloads);
+
+        const unordered_set<string> shardWordSet(shardDict.begin(), shardDict.end());
+
+        if (shardWordSet.empty())
+        {
+            cout << "Skipping empty shard: " << mergeDictFile << endl;
+            continue;
+        }
+
+        SplitIndex *shard = SplitIndexFactory::initIndex(shardWordSet, hashType, indexType, params.maxLoadFactor,
+            params.packKeys, params.tuneSplitPoints, params.nKeyParts, params.seedBlockSize,
+            params.subIndexThreshold, shardPayloads);
+
+        const Clock::time_point mergeStart = Clock::now();
+        const size_t nAdded = index.merge(*shard);
+        const double mergeMs = chrono::duration<double, milli>(Clock::now() - mergeStart).count();
+
+        cout << endl << boost::format("Merged shard %1%: #words = %2%, #added words = %3%, elapsed = %4% ms")
+            % mergeDictFile % shardWordSet.size() % nAdded % mergeMs << endl;
+
+        delete shard;
+    }
+}
+
+void runDiskSearch(const vector<string> &queries)
+{
+    HashFunctions::HashType hashType;
+    SplitIndexFactory::IndexType indexType;
+
+    initSplitIndexParams(hashType, indexType);
+
+    const map<SplitIndexFactory::IndexType, size_t> indexTypeKs {
+        { SplitIndexFactory::IndexType::K1, 1 },
+        { SplitIndexFactory::IndexType::K2, 2 },
+        { SplitIndexFactory::IndexType::K3, 3 }
+    };
+
+    const map<string, DiskSplitIndex::AccessPattern> accessPatternMap {
+        { "random", DiskSplitIndex::AccessPattern::Random },
+        { "sequential", DiskSplitIndex::AccessPattern::Sequential },
+        { "prefetch", DiskSplitIndex::AccessPattern::Prefetch }
+    };
+
+    if (accessPatternMap.count(params.diskAccess) == 0)
+    {
+        throw runtime_error("bad disk access pattern: " + params.diskAccess);
+    }
+
+    using Clock = chrono::steady_clock;
+    const Clock::time_point buildStart = Clock::now();
+
+    {
+        DiskSplitIndex::Builder builder(params.diskIndexDir, indexTypeKs.at(indexType), params.nDiskSegments, hashType,
+            params.diskRunSizeMB << 20);
+
+        utils::FileIO::forEachWord(params.inDictFile, params.separator, [&builder](const string &word)
+        {
+            if (word.size() >= static_cast<size_t>(params.minWordLength))
+            {
+                builder.add(word);
+            }
+        });
+
+        builder.finish();
+
+        cout << endl << boost::format("Processing #words (dict) = %1%, #queries = %2%, #runs = %3%")
+            % builder.getNAddedWords() % queries.size() % builder.getNRuns() << endl;
+    }
+
+    const double buildMs = chrono::duration<double, milli>(Clock::now() - buildStart).count();
+
+    DiskSplitIndex index(params.diskIndexDir);
+    index.setAccessPattern(accessPatternMap.at(params.diskAccess));
+
+    cout << endl << boost::format("Disk index constructed in %1% ms:") % buildMs << endl;
+    cout << index.toString() << endl;
+
+    if (params.dumpAllMatches)
+    {
+        vector<size_t> counts(queries.size(), 0);
+        DiskSplitIndex::ResultSetType matches;
+
+        index.forEachMatch(queries, [&counts, &matches](size_t iQuery, const string &word)
+        {
+            counts[iQuery] += 1;
+            matches.insert(word);
+        });
+
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            cout << queries[iQuery] << " -> " << counts[iQuery] << endl;
+        }
+
+        cout << "#matches = " << matches.size() << endl;
+        return;
+    }
+
+    const DiskSplitIndex::ResultSetType matches = index.search(queries, params.nIter);
+    dumpRunInfo(index.getElapsedUs(), index.getHashMap().calcTotalSizeB(), queries.size());
+
+    cout << "#matches = " << matches.size() << endl;
+}
+
+template<typename Index>
+void runMixedWorkload(Index &index, const vector<string> &words, const vector<string> &queries)
+{
+    using Clock = chrono::steady_clock;
+
+    size_t nMatches = 0;
+
+    size_t nUpdates = 0;
+    float pendingUpdates = 0.0f;
+
+    double queriesUs = 0.0;
+    double updatesUs = 0.0;
+    // Updates which rebuild the index (see SplitIndex::insert and SplitIndex::erase) take much longer than others.
+    double maxUpdateUs = 0.0;
+
+    for (int iIter = 0; iIter < params.nIter; ++iIter)
+    {
+        // Queries are timed in chunks between consecutive updates, so that the clock is not read for each query.
+        Clock::time_point chunkStart = Clock::now();
+
+        for (const string &query : queries)
+        {
+            nMatches += index.searchCount(query);
+
+            pendingUpdates += params.updateRatio;
+
+            if (pendingUpdates < 1.0f)
+            {
+                continue;
+            }
+
+            queriesUs += chrono::duration<double, micro>(Clock::now() - chunkStart).count();
+
+            for (; pendingUpdates >= 1.0f; pendingUpdates -= 1.0f)
+            {
+                const Clock::time_point updateStart = Clock::now();
+
+                // Words are replaced by their reversals (and back), so the dictionary size stays roughly the same.
+                const string &word = words[nUpdates % words.size()];
+                const string reversed(word.rbegin(), word.rend());
+
+                if (index.erase(word))
+                {
+                    index.insert(reversed);
+                }
+                else
+                {
+                    index.erase(reversed);
+                    index.insert(word);
+                }
+
+                const double updateUs = chrono::duration<double, micro>(Clock::now() - updateStart).count();
+
+                updatesUs += updateUs;
+                maxUpdateUs = max(maxUpdateUs, updateUs);
+
+                nUpdates += 1;
+            }
+
+            chunkStart = Clock::now();
+        }
+
+        queriesUs += chrono::duration<double, micro>(Clock::now() - chunkStart).count();
+    }
+
+    const size_t nQueries = queries.size() * params.nIter;
+
+    cout << boost::format("Elapsed per query = %1% us, per update = %2% us (max = %3% us)")
+        % (nQueries == 0 ? 0.0 : queriesUs / nQueries) % (nUpdates == 0 ? 0.0 : updatesUs / nUpdates)
+        % maxUpdateUs << endl;
+    cout << "#updates = " << nUpdates << ", #matches summed over queries = " << nMatches << endl;
+}
+
 void initSplitIndexParams(hash_functions::HashFunctions::HashType &hashType,
     SplitIndexFactory::IndexType &indexType)
 {
@@ -251,8 +622,19 @@ void initSplitIndexParams(hash_functions::HashFunctions::HashType &hashType,
         { "k1", SplitIndexFactory::IndexType::K1 },
         { "k1comp", SplitIndexFactory::IndexType::K1Comp },
         { "k1comptriple", SplitIndexFactory::IndexType::K1CompTriple },
-        { "k2", SplitIndexFactory::IndexType::K2},
-        { "k3", SplitIndexFactory::IndexType::K3}
+        { "k1compext", SplitIndexFactory::IndexType::K1CompExt },
+        { "k1packed", SplitIndexFactory::IndexType::K1Packed },
+        { "k1router", SplitIndexFactory::IndexType::K1Router },
+        { "k2", SplitIndexFactory::IndexType::K2 },
+        { "k2budgets", SplitIndexFactory::IndexType::K2Budgets },
+        { "k2comp", SplitIndexFactory::IndexType::K2Comp },
+        { "k2ks", SplitIndexFactory::IndexType::K2KS },
+        { "k2spaced", SplitIndexFactory::IndexType::K2Spaced },
+        { "k3", SplitIndexFactory::IndexType::K3 },
+        { "k3budgets", SplitIndexFactory::IndexType::K3Budgets },
+        { "k3comp", SplitIndexFactory::IndexType::K3Comp },
+        { "k3ks", SplitIndexFactory::IndexType::K3KS },
+        { "k3spaced", SplitIndexFactory::IndexType::K3Spaced }
     };
 
     if (indexTypeMap.count(params.indexType) == 0)
@@ -262,18 +644,74 @@ void initSplitIndexParams(hash_functions::HashFunctions::HashType &hashType,
 
     indexType = indexTypeMap.at(params.indexType);
 
+    if (params.searchMode != "words" and params.searchMode != "exists" and params.searchMode != "count"
+        and params.searchMode != "top" and params.searchMode != "mixed")
+    {
+        throw runtime_error("bad search mode: " + params.searchMode);
+    }
+
+    if (params.updateRatio < 0.0f)
+    {
+        throw runtime_error("bad update ratio: " + to_string(params.updateRatio));
+    }
+
+    if (params.compactionThreshold < 0.0f)
+    {
+        throw runtime_error("bad compaction threshold: " + to_string(params.compactionThreshold));
+    }
+
+    // The base of a delta index is never compacted, erased words are dropped when it is merged with the delta.
+    if (params.compactionThreshold > 0.0f and (params.searchMode != "mixed" or params.deltaIndex))
+    {
+        throw runtime_error("compaction can be enabled only in the mixed search mode without a delta index");
+    }
+
+    if (params.dumpAllMatches and params.searchMode != "words")
+    {
+        throw runtime_error("matches can be dumped only in the words search mode");
+    }
+
+    if (params.deltaIndex and params.searchMode != "mixed")
+    {
+        throw runtime_error("a delta index can be used only in the mixed search mode");
+    }
+
+    if (params.searchMode == "mixed" and params.deltaIndex and not params.mergeDictFiles.empty())
+    {
+        throw runtime_error("shards cannot be merged into a delta index");
+    }
+
+    if (not params.diskIndexDir.empty())
+    {
+        if (indexType != SplitIndexFactory::IndexType::K1 and indexType != SplitIndexFactory::IndexType::K2
+            and indexType != SplitIndexFactory::IndexType::K3)
+        {
+            throw runtime_error("disk indexes support only index types k1, k2 and k3");
+        }
+
+        if (params.searchMode != "words" or params.dictPayloads or not params.mergeDictFiles.empty())
+        {
+            throw runtime_error("disk indexes support only the words search mode, without payloads or shards");
+        }
+    }
+
     cout << boost::format("Using index type = %1%, hash function = %2%")
         % params.indexType % params.hashType << endl;
 }
 
 void dumpRunInfo(const SplitIndex *index, size_t nQueries)
 {
-    string elapsedInfo = utils::StringUtils::getElapsedInfo(index->getElapsedUs(), params.nIter, nQueries);
+    dumpRunInfo(index->getElapsedUs(), index->calcHashMapSizeB(), nQueries);
+}
+
+void dumpRunInfo(float elapsedUs, long indexSizeB, size_t nQueries)
+{
+    string elapsedInfo = utils::StringUtils::getElapsedInfo(elapsedUs, params.nIter, nQueries);
     cout << elapsedInfo << endl;
 
     if (params.dumpToFile)
     {
-        const float elapsedPerQueryUs = index->getElapsedUs() / params.nIter / nQueries;
+        const float elapsedPerQueryUs = elapsedUs / params.nIter / nQueries;
         string outStr = "";
 
         if (utils::FileIO::isFileEmpty(params.outFile))
@@ -281,7 +719,7 @@ void dumpRunInfo(const SplitIndex *index, size_t nQueries)
             outStr += params.outputHeader;
         }
 
-        const float hashMapSizeKB = index->calcHashMapSizeB() / 1024.0f;
+        const float hashMapSizeKB = indexSizeB / 1024.0f;
 
         outStr += (boost::format("%1% %2% %3% %4% %5% %6% %7% %8%") % params.inDictFile % params.inPatternFile
             % params.hashType % params.indexType % params.maxLoadFactor % params.nIter % hashMapSizeKB
@@ -2,6 +2,7 @@
 #define PARAMS_HPP
 
 #include <string>
+#include <vector>
 
 namespace split_index
 {
@@ -21,15 +22,48 @@ struct Params
     /** Dump the number of matches for each query to standard output, note: this invalidates time measurement. */
     bool dumpAllMatches = false;
 
+    /** Run the mixed search mode using a delta index over a base split index. */
+    bool deltaIndex = false;
+
+    /** Each dictionary record consists of a word and its payload. */
+    bool dictPayloads = false;
+
+    /** Pack hash map keys using alphabet ranks. */
+    bool packKeys = false;
+
+    /** Tune split points for each word size, otherwise words are split into parts of (almost) equal sizes. */
+    bool tuneSplitPoints = false;
+
     /** Hash type used by the split index. */
     std::string hashType;
 
     /** Split index type. */
     std::string indexType;
 
+    /** Search mode: words, exists, count, top or mixed. */
+    std::string searchMode;
+
+    /** Number of best matches reported for each query in the top search mode. */
+    size_t nTopMatches;
+
+    /** Number of dictionary updates per query in the mixed search mode. */
+    float updateRatio;
+
+    /** Ratio of erased words above which an update compacts the index in the mixed search mode (0 = never). */
+    float compactionThreshold;
+
     /** Number of iterations per pattern lookup. */
     int nIter;
 
+    /** Number of parts forming a key for k + s splitting (s). */
+    size_t nKeyParts;
+
+    /** Block size of spaced-seed parts (1 = interleaved parts). */
+    size_t seedBlockSize;
+
+    /** Number of word parts above which an entry gets its own sub-index (0 = disabled). */
+    size_t subIndexThreshold;
+
     /** Maximum load factor which causes rehashing when crossed. */
     float maxLoadFactor;
 
@@ -44,6 +78,21 @@ struct Params
     /** Input pattern file path (positional arg 2). */
     std::string inPatternFile;
 
+    /** Dictionary files of shards which are indexed separately and merged into the index of the input dictionary. */
+    std::vector<std::string> mergeDictFiles;
+
+    /** Directory of an out-of-core index which is built by streaming the input dictionary (empty = in-memory index). */
+    std::string diskIndexDir;
+
+    /** Access pattern of disk index segments: random, sequential or prefetch. */
+    std::string diskAccess;
+
+    /** Number of segment files of a disk index. */
+    size_t nDiskSegments;
+
+    /** Memory used for sorting index keys when building a disk index in MB. */
+    size_t diskRunSizeMB;
+
     /** Output file path. Cmd arg -o. */
     std::string outFile;
 
@@ -2,6 +2,7 @@
 #define DISTANCE_HPP
 
 #include <cstddef>
+#include <cstdint>
 
 namespace split_index
 {
@@ -33,6 +34,25 @@ struct Distance
         return true;
     }
 
+    /** The same as isHammingAtMostK, but with the maximum number of errors [maxErrors] known only at runtime. */
+    static bool isHammingAtMost(const char *str1, const char *str2, size_t length, unsigned maxErrors)
+    {
+        unsigned nErrors = 0;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (str1[i] != str2[i])
+            {
+                if (++nErrors > maxErrors)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
     static unsigned calcHamming(const char *str1, const char *str2, size_t length)
     {
         // With compiler optimizations, this version is faster than any bitwise/avx/sse magic (tested).
@@ -48,6 +68,28 @@ struct Distance
 
         return nErrors;
     }
+
+    /** The same as calcHamming, but also stores (at most [maxPositions]) positions of mismatches in [positions]. */
+    static unsigned calcHammingWithPositions(const char *str1, const char *str2, size_t length,
+        uint16_t *positions, unsigned maxPositions)
+    {
+        unsigned nErrors = 0;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (str1[i] != str2[i])
+            {
+                if (nErrors < maxPositions)
+                {
+                    positions[nErrors] = static_cast<uint16_t>(i);
+                }
+
+                nErrors += 1;
+            }
+        }
+
+        return nErrors;
+    }
 };
 
 } // namespace utils
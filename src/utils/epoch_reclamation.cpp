@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "epoch_reclamation.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+namespace utils
+{
+
+constexpr size_t EpochReclamation::reclaimBatchSize;
+constexpr uint64_t EpochReclamation::idleEpoch;
+
+EpochReclamation::EpochReclamation(size_t maxNReadersArg)
+    :globalEpoch(idleEpoch + 1), maxNReaders(maxNReadersArg),
+    readerEpochs(new atomic<uint64_t>[maxNReadersArg]), isReaderRegistered(new atomic<bool>[maxNReadersArg])
+{
+    for (size_t iReader = 0; iReader < maxNReaders; ++iReader)
+    {
+        readerEpochs[iReader].store(idleEpoch);
+        isReaderRegistered[iReader].store(false);
+    }
+}
+
+EpochReclamation::~EpochReclamation()
+{
+    for (const Retired &item : retired)
+    {
+        item.deleter(item.ptr);
+    }
+}
+
+size_t EpochReclamation::registerReader()
+{
+    for (size_t iReader = 0; iReader < maxNReaders; ++iReader)
+    {
+        bool isRegistered = false;
+
+        if (isReaderRegistered[iReader].compare_exchange_strong(isRegistered, true))
+        {
+            return iReader;
+        }
+    }
+
+    throw runtime_error("too many readers, the maximum is " + to_string(maxNReaders));
+}
+
+void EpochReclamation::unregisterReader(size_t iReader)
+{
+    assert(iReader < maxNReaders and readerEpochs[iReader].load() == idleEpoch);
+    isReaderRegistered[iReader].store(false);
+}
+
+void EpochReclamation::waitForReaders()
+{
+    // Readers which enter in the new epoch cannot see memory which has been unlinked before.
+    const uint64_t retireEpoch = globalEpoch.fetch_add(1);
+
+    while (calcMinReaderEpoch() <= retireEpoch)
+    {
+        this_thread::sleep_for(chrono::microseconds(100));
+    }
+}
+
+void EpochReclamation::retire(void *ptr, Deleter deleter)
+{
+    lock_guard<mutex> lock(retiredMutex);
+    retired.push_back({ globalEpoch.fetch_add(1), ptr, deleter });
+
+    if (retired.size() >= reclaimBatchSize)
+    {
+        reclaimLocked();
+    }
+}
+
+void EpochReclamation::reclaim()
+{
+    lock_guard<mutex> lock(retiredMutex);
+    reclaimLocked();
+}
+
+size_t EpochReclamation::getNRetired()
+{
+    lock_guard<mutex> lock(retiredMutex);
+    return retired.size();
+}
+
+uint64_t EpochReclamation::calcMinReaderEpoch() const
+{
+    uint64_t minEpoch = UINT64_MAX;
+
+    for (size_t iReader = 0; iReader < maxNReaders; ++iReader)
+    {
+        const uint64_t epoch = readerEpochs[iReader].load();
+
+        if (epoch != idleEpoch)
+        {
+            minEpoch = min(minEpoch, epoch);
+        }
+    }
+
+    return minEpoch;
+}
+
+void EpochReclamation::reclaimLocked()
+{
+    const uint64_t minReaderEpoch = calcMinReaderEpoch();
+
+    // Retired pointers are ordered by epochs, hence the ones which are safe to free form a prefix.
+    auto it = retired.begin();
+
+    for (; it != retired.end() and it->epoch < minReaderEpoch; ++it)
+    {
+        it->deleter(it->ptr);
+    }
+
+    retired.erase(retired.begin(), it);
+}
+
+} // namespace utils
+
+} // namespace split_index
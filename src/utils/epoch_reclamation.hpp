@@ -0,0 +1,113 @@
+#ifndef EPOCH_RECLAMATION_HPP
+#define EPOCH_RECLAMATION_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace split_index
+{
+
+namespace utils
+{
+
+/** Epoch-based reclamation of memory which is read without locks. Each reader thread registers once and wraps
+ * its reads in enter() and leave() (see ReadSection), which publishes the global epoch in the slot of the reader.
+ * Memory which has been unlinked by a writer is retired in the current epoch E (which bumps the global epoch),
+ * and it can be freed once all readers are idle or have entered in an epoch later than E, since such readers
+ * cannot see the unlinked memory anymore. Readers are wait-free, writers either wait (waitForReaders)
+ * or defer freeing to a retire list (retire). */
+class EpochReclamation
+{
+public:
+    /** Frees [ptr] which has been retired. */
+    using Deleter = void (*)(void *);
+
+    /** At most [maxNReadersArg] readers can be registered at the same time. */
+    explicit EpochReclamation(size_t maxNReadersArg);
+    /** Frees all retired memory, no reader can be inside a read section anymore. */
+    ~EpochReclamation();
+
+    EpochReclamation(const EpochReclamation &) = delete;
+    EpochReclamation &operator=(const EpochReclamation &) = delete;
+
+    /** Returns the ID of a new reader, throws if all reader slots are taken. */
+    size_t registerReader();
+    void unregisterReader(size_t iReader);
+
+    /** Starts a read section of reader [iReader], which must be registered. */
+    void enter(size_t iReader)
+    {
+        assert(iReader < maxNReaders and isReaderRegistered[iReader].load());
+        readerEpochs[iReader].store(globalEpoch.load());
+    }
+    void leave(size_t iReader) { readerEpochs[iReader].store(idleEpoch); }
+
+    /** Enters a read section of a reader on construction and leaves it on destruction. */
+    class ReadSection
+    {
+    public:
+        ReadSection(EpochReclamation &epochsArg, size_t iReaderArg) :epochs(epochsArg), iReader(iReaderArg)
+        {
+            epochs.enter(iReader);
+        }
+        ~ReadSection() { epochs.leave(iReader); }
+
+        ReadSection(const ReadSection &) = delete;
+        ReadSection &operator=(const ReadSection &) = delete;
+
+    private:
+        EpochReclamation &epochs;
+        const size_t iReader;
+    };
+
+    /** Waits until no reader can access memory which has been unlinked before this call. */
+    void waitForReaders();
+
+    /** Frees [ptr] using [deleter] once no reader can access it, [ptr] must have been unlinked before this call.
+     * Retired memory is freed in batches when retiring, this can be called by many writers. */
+    void retire(void *ptr, Deleter deleter);
+    /** Frees retired memory which cannot be accessed by readers anymore. */
+    void reclaim();
+
+    /** Returns the number of retired pointers which have not been freed yet. */
+    size_t getNRetired();
+
+    /** The number of retired pointers above which retire() tries to free them. */
+    static constexpr size_t reclaimBatchSize = 64;
+
+private:
+    struct Retired
+    {
+        uint64_t epoch;
+        void *ptr;
+        Deleter deleter;
+    };
+
+    /** Returns the smallest epoch in which an active reader has entered, or UINT64_MAX if all readers are idle. */
+    uint64_t calcMinReaderEpoch() const;
+    /** Frees retired memory, retiredMutex must be locked. */
+    void reclaimLocked();
+
+    /** Stored in the epoch slot of a reader which is outside read sections. */
+    static constexpr uint64_t idleEpoch = 0;
+
+    std::atomic<uint64_t> globalEpoch;
+
+    const size_t maxNReaders;
+    std::unique_ptr<std::atomic<uint64_t>[]> readerEpochs;
+    std::unique_ptr<std::atomic<bool>[]> isReaderRegistered;
+
+    std::mutex retiredMutex;
+    std::vector<Retired> retired;
+};
+
+} // namespace utils
+
+} // namespace split_index
+
+#endif // EPOCH_RECLAMATION_HPP
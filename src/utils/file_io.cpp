@@ -12,6 +12,8 @@ namespace split_index
 namespace utils
 {
 
+constexpr size_t FileIO::chunkSizeB;
+
 bool FileIO::isFileReadable(const string &filePath)
 {
     ifstream inStream(filePath);
@@ -53,6 +55,80 @@ vector<string> FileIO::readWords(const string &filePath, const string &separator
     return filt;
 }
 
+void FileIO::forEachWord(const string &filePath, const string &separator,
+    const function<void(const string &)> &callback)
+{
+    ifstream inStream(filePath, ios_base::binary);
+
+    if (!inStream)
+    {
+        throw runtime_error("failed to read file (insufficient permisions?): " + filePath);
+    }
+
+    vector<char> chunk(chunkSizeB);
+    string word;
+
+    auto reportWord = [&word, &callback]()
+    {
+        boost::trim(word);
+
+        if (word.empty() == false)
+        {
+            callback(word);
+        }
+
+        word.clear();
+    };
+
+    // Words may span many chunks, so the current word is kept until a separator is found.
+    while (inStream.read(chunk.data(), chunk.size()) or inStream.gcount() > 0)
+    {
+        const char *chunkEnd = chunk.data() + inStream.gcount();
+
+        for (const char *it = chunk.data(); it != chunkEnd; ++it)
+        {
+            if (separator.find(*it) != string::npos)
+            {
+                reportWord();
+            }
+            else
+            {
+                word.push_back(*it);
+            }
+        }
+    }
+
+    reportWord();
+}
+
+vector<pair<string, uint64_t>> FileIO::readWordsWithPayloads(const string &filePath, const string &separator)
+{
+    vector<pair<string, uint64_t>> ret;
+
+    for (const string &record : readWords(filePath, separator))
+    {
+        // Records are trimmed, so the payload follows the last whitespace.
+        const size_t payloadStart = record.find_last_of(" \t");
+        const string payloadStr = (payloadStart != string::npos) ? record.substr(payloadStart + 1) : "";
+
+        if (payloadStr.empty() or payloadStr.find_first_not_of("0123456789") != string::npos)
+        {
+            throw runtime_error("bad word payload in record: " + record);
+        }
+
+        string word = boost::trim_copy(record.substr(0, payloadStart));
+
+        if (word.empty())
+        {
+            throw runtime_error("missing word in record: " + record);
+        }
+
+        ret.emplace_back(move(word), stoull(payloadStr));
+    }
+
+    return ret;
+}
+
 void FileIO::dumpToFile(const string &text, const string &filePath, bool newline)
 {
     ofstream outStream(filePath, ios_base::app);
@@ -1,7 +1,10 @@
 #ifndef FILE_IO_HPP
 #define FILE_IO_HPP
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace split_index
@@ -18,9 +21,21 @@ struct FileIO
     static bool isFileEmpty(const std::string &filePath);
 
     static std::vector<std::string> readWords(const std::string &filePath, const std::string &separator);
+    /** Calls [callback] for each word of the file (as readWords does), reading the file in chunks,
+     * so that the whole file is never held in memory. */
+    static void forEachWord(const std::string &filePath, const std::string &separator,
+        const std::function<void(const std::string &)> &callback);
+    /** Reads records separated with [separator], each consisting of a word and its payload (an unsigned integer)
+     * separated with whitespace, e.g. "word 42". Throws if a record has no valid payload. */
+    static std::vector<std::pair<std::string, uint64_t>> readWordsWithPayloads(const std::string &filePath,
+        const std::string &separator);
 
     /** Appends [text] to file with [filePath] followed by an optional newline if [newline] is true. */
     static void dumpToFile(const std::string &text, const std::string &filePath, bool newline = false);
+
+private:
+    /** The number of bytes read at once by forEachWord. */
+    static constexpr size_t chunkSizeB = 1 << 20;
 };
 
 } // namespace utils
@@ -0,0 +1,61 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace split_index
+{
+
+namespace utils
+{
+
+struct Parallel
+{
+    Parallel() = delete;
+
+    /** Returns the number of threads used for parallel processing (at least 1). */
+    static size_t getNThreads()
+    {
+        const size_t nHardwareThreads = std::thread::hardware_concurrency();
+        return std::max<size_t>(1, std::min(nHardwareThreads, static_cast<size_t>(maxNThreads)));
+    }
+
+    /** Splits [0, [n]) into contiguous ranges and calls [fun](begin, end, iThread) for each range
+     * in a separate thread, where iThread is in [0, getNThreads()). Returns after all calls have finished. */
+    static void forRanges(size_t n, const std::function<void(size_t, size_t, size_t)> &fun)
+    {
+        const size_t nThreads = getNThreads();
+        const size_t rangeSize = (n + nThreads - 1) / nThreads;
+
+        std::vector<std::thread> threads;
+
+        for (size_t iThread = 1; iThread < nThreads; ++iThread)
+        {
+            const size_t begin = std::min(n, iThread * rangeSize);
+            const size_t end = std::min(n, begin + rangeSize);
+
+            threads.emplace_back(fun, begin, end, iThread);
+        }
+
+        // The first range is processed by the calling thread.
+        fun(0, std::min(n, rangeSize), 0);
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    /** The maximum number of threads used for parallel processing. */
+    static constexpr size_t maxNThreads = 16;
+};
+
+} // namespace utils
+
+} // namespace split_index
+
+#endif // PARALLEL_HPP
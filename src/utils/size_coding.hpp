@@ -0,0 +1,98 @@
+#ifndef SIZE_CODING_HPP
+#define SIZE_CODING_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace split_index
+{
+
+namespace utils
+{
+
+/** Coding of sizes (of word parts and hash map keys) and of entry counters, selected at compile time.
+ * By default sizes are single bytes and counters have 16 bits, which limits words to 127 chars.
+ * With SPLIT_INDEX_LONG_WORDS defined, sizes are varints of at most 2 bytes (7 bits per byte,
+ * the highest bit marks continuation) and counters have 32 bits, which allows long words (e.g. sequencing reads)
+ * and hot keys storing millions of words.
+ * Stored sizes are always positive, hence the first byte of a size is never 0 and entries can still be 0-terminated. */
+struct SizeCoding
+{
+    SizeCoding() = delete;
+
+#ifdef SPLIT_INDEX_LONG_WORDS
+    using CounterType = uint32_t;
+    /** Maximum size which can be stored, i.e. 2 varint bytes, and the maximum word size. */
+    static constexpr size_t maxSize = (1u << 14) - 1;
+    static constexpr size_t maxWordSize = 1023;
+#else
+    using CounterType = uint16_t;
+    /** Maximum size which can be stored, and the maximum word size, which is set to 127 because
+     * some compressed formats store sizes which are larger than words by 1. */
+    static constexpr size_t maxSize = 255;
+    static constexpr size_t maxWordSize = 127;
+#endif
+
+    /** Returns the size stored at [it] and advances [it] past the size. */
+    static size_t read(const char *&it)
+    {
+        size_t size = static_cast<unsigned char>(*it++);
+
+#ifdef SPLIT_INDEX_LONG_WORDS
+        if (size & 0x80u)
+        {
+            size = (size & 0x7Fu) | (static_cast<size_t>(static_cast<unsigned char>(*it++)) << 7);
+        }
+#endif
+
+        return size;
+    }
+
+    static size_t read(char *&it)
+    {
+        const char *constIt = it;
+        const size_t size = read(constIt);
+
+        it = const_cast<char *>(constIt);
+        return size;
+    }
+
+    /** Returns the size stored at [it] without advancing. */
+    static size_t peek(const char *it) { return read(it); }
+
+    /** Stores [size] at [it] and returns the pointer past the stored size. */
+    static char *write(char *it, size_t size)
+    {
+        assert(size > 0 and size <= maxSize);
+
+#ifdef SPLIT_INDEX_LONG_WORDS
+        if (size >= 0x80u)
+        {
+            *it++ = static_cast<char>((size & 0x7Fu) | 0x80u);
+            *it++ = static_cast<char>(size >> 7);
+            return it;
+        }
+#endif
+
+        *it++ = static_cast<char>(size);
+        return it;
+    }
+
+    /** Returns the number of bytes used for storing [size]. */
+    static size_t calcSizeB(size_t size)
+    {
+#ifdef SPLIT_INDEX_LONG_WORDS
+        return (size >= 0x80u) ? 2 : 1;
+#else
+        (void)size;
+        return 1;
+#endif
+    }
+};
+
+} // namespace utils
+
+} // namespace split_index
+
+#endif // SIZE_CODING_HPP
@@ -7,7 +7,7 @@ maxLF=3.0
 nIter=1
 
 # All index types.
-for iType in k1 k1comp k1comptriple k2 k3;
+for iType in k1 k1comp k1comptriple k1compext k1packed k1router k2 k2budgets k2comp k2ks k2spaced k3 k3budgets k3comp k3ks k3spaced;
 do
     # All hash types.
     for hType in city farm farsh fnv1 fnv1a murmur3 sdbm spookyv2 superfast xxhash;
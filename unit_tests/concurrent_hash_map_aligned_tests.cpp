@@ -0,0 +1,261 @@
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/hash_map/concurrent_hash_map_aligned.hpp"
+#include "../src/utils/epoch_reclamation.hpp"
+
+using namespace split_index::hash_map;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+auto calcEntrySizeB = [](const char *entry) -> size_t { return strlen(entry) + 1; };
+
+string retrieveString(ConcurrentHashMapAligned &hashMap, size_t iReader, const string &key)
+{
+    ConcurrentHashMapAligned::ReadSection readSection(hashMap, iReader);
+    const char *entry = hashMap.retrieve(key.c_str(), key.size());
+
+    return (entry == nullptr) ? "" : entry;
+}
+
+void appendString(ConcurrentHashMapAligned &hashMap, const string &key, const string &suffix)
+{
+    hashMap.update(key.c_str(), key.size(), [&suffix](const char *oldEntry)
+    {
+        const string newEntry = ((oldEntry == nullptr) ? "" : oldEntry) + suffix;
+
+        char *ret = static_cast<char *>(malloc(newEntry.size() + 1));
+        memcpy(ret, newEntry.c_str(), newEntry.size() + 1);
+
+        return ret;
+    });
+}
+
+}
+
+TEST_CASE("is number of buckets rounded to lock stripes", "[concurrent_hash_map_aligned]")
+{
+    ConcurrentHashMapAligned hashMap(calcEntrySizeB, 1.0f, 5, hashType, 4, 4);
+    REQUIRE(hashMap.getNBuckets() == 8);
+    REQUIRE(hashMap.getNEntries() == 0);
+
+    ConcurrentHashMapAligned empty(calcEntrySizeB, 1.0f, 0, hashType, 4, 4);
+    REQUIRE(empty.getNBuckets() == 4);
+}
+
+TEST_CASE("is inserting and retrieving correct", "[concurrent_hash_map_aligned]")
+{
+    ConcurrentHashMapAligned hashMap(calcEntrySizeB, 1.0f, 10, hashType, 4, 2);
+    const size_t iReader = hashMap.registerReader();
+
+    REQUIRE(retrieveString(hashMap, iReader, "key1") == "");
+
+    hashMap.insert("key1", 4, "entry1");
+    hashMap.insert("key2", 4, "entry2");
+
+    REQUIRE(retrieveString(hashMap, iReader, "key1") == "entry1");
+    REQUIRE(retrieveString(hashMap, iReader, "key2") == "entry2");
+    REQUIRE(retrieveString(hashMap, iReader, "key") == "");
+    REQUIRE(hashMap.getNEntries() == 2);
+
+    hashMap.insert("key1", 4, "other");
+    REQUIRE(retrieveString(hashMap, iReader, "key1") == "other");
+    REQUIRE(retrieveString(hashMap, iReader, "key2") == "entry2");
+    REQUIRE(hashMap.getNEntries() == 2);
+
+    hashMap.unregisterReader(iReader);
+}
+
+TEST_CASE("are entries kept when rehashing", "[concurrent_hash_map_aligned]")
+{
+    ConcurrentHashMapAligned hashMap(calcEntrySizeB, 2.0f, 4, hashType, 4, 4);
+    const size_t iReader = hashMap.registerReader();
+
+    const int nKeys = 1000;
+
+    for (int i = 0; i < nKeys; ++i)
+    {
+        const string key = "key" + to_string(i);
+        hashMap.insert(key.c_str(), key.size(), ("entry" + to_string(i)).c_str());
+    }
+
+    REQUIRE(hashMap.getNEntries() == nKeys);
+    REQUIRE(hashMap.getNBuckets() >= nKeys / 2);
+    REQUIRE(hashMap.getNBuckets() % 4 == 0);
+    REQUIRE(hashMap.getCurLoadFactor() <= 2.0f);
+
+    for (int i = 0; i < nKeys; ++i)
+    {
+        REQUIRE(retrieveString(hashMap, iReader, "key" + to_string(i)) == "entry" + to_string(i));
+    }
+
+    hashMap.unregisterReader(iReader);
+}
+
+TEST_CASE("are updates of the same key not lost", "[concurrent_hash_map_aligned]")
+{
+    ConcurrentHashMapAligned hashMap(calcEntrySizeB, 1.0f, 1, hashType, 4, 4);
+
+    const int nWriters = 4;
+    const int nAppends = 200;
+
+    vector<thread> writers;
+
+    for (int iWriter = 0; iWriter < nWriters; ++iWriter)
+    {
+        writers.emplace_back([&hashMap]()
+        {
+            for (int i = 0; i < nAppends; ++i)
+            {
+                appendString(hashMap, "key", "x");
+                appendString(hashMap, "key" + to_string(i), "y");
+            }
+        });
+    }
+
+    for (thread &writer : writers)
+    {
+        writer.join();
+    }
+
+    const size_t iReader = hashMap.registerReader();
+    REQUIRE(retrieveString(hashMap, iReader, "key") == string(nWriters * nAppends, 'x'));
+
+    for (int i = 0; i < nAppends; ++i)
+    {
+        REQUIRE(retrieveString(hashMap, iReader, "key" + to_string(i)) == string(nWriters, 'y'));
+    }
+
+    REQUIRE(hashMap.getNEntries() == nAppends + 1);
+    hashMap.unregisterReader(iReader);
+}
+
+TEST_CASE("are entries retrieved from many threads while writing", "[concurrent_hash_map_aligned]")
+{
+    ConcurrentHashMapAligned hashMap(calcEntrySizeB, 1.0f, 1, hashType, 8, 4);
+
+    const int nReaders = 4;
+    const int nWriters = 2;
+    const int nKeys = 500;
+
+    // Entries of each key only grow, and each of them consists of the key only.
+    atomic<bool> isWriting(true);
+    atomic<bool> isCorrect(true);
+
+    vector<thread> threads;
+
+    for (int iReaderThread = 0; iReaderThread < nReaders; ++iReaderThread)
+    {
+        threads.emplace_back([&]()
+        {
+            const size_t iReader = hashMap.registerReader();
+
+            while (isWriting.load())
+            {
+                for (int i = 0; i < nKeys; ++i)
+                {
+                    const string key = to_string(i);
+                    const string entry = retrieveString(hashMap, iReader, key);
+
+                    for (size_t iChar = 0; iChar < entry.size(); iChar += key.size())
+                    {
+                        if (entry.compare(iChar, key.size(), key) != 0)
+                        {
+                            isCorrect.store(false);
+                        }
+                    }
+                }
+            }
+
+            hashMap.unregisterReader(iReader);
+        });
+    }
+
+    vector<thread> writers;
+
+    for (int iWriter = 0; iWriter < nWriters; ++iWriter)
+    {
+        writers.emplace_back([&hashMap]()
+        {
+            for (int i = 0; i < nKeys; ++i)
+            {
+                appendString(hashMap, to_string(i), to_string(i));
+            }
+        });
+    }
+
+    for (thread &writer : writers)
+    {
+        writer.join();
+    }
+
+    isWriting.store(false);
+
+    for (thread &readerThread : threads)
+    {
+        readerThread.join();
+    }
+
+    REQUIRE(isCorrect.load());
+
+    const size_t iReader = hashMap.registerReader();
+
+    for (int i = 0; i < nKeys; ++i)
+    {
+        REQUIRE(retrieveString(hashMap, iReader, to_string(i)) == to_string(i) + to_string(i));
+    }
+
+    hashMap.unregisterReader(iReader);
+}
+
+TEST_CASE("is retired memory freed only after readers leave", "[epoch_reclamation]")
+{
+    utils::EpochReclamation epochs(2);
+
+    const size_t iReader = epochs.registerReader();
+    REQUIRE(epochs.registerReader() != iReader);
+    REQUIRE_THROWS(epochs.registerReader());
+
+    static int nFreed;
+    nFreed = 0;
+    auto deleter = [](void *ptr) { ++nFreed; delete static_cast<int *>(ptr); };
+
+    {
+        utils::EpochReclamation::ReadSection readSection(epochs, iReader);
+
+        epochs.retire(new int(1), deleter);
+        epochs.reclaim();
+
+        REQUIRE(nFreed == 0);
+        REQUIRE(epochs.getNRetired() == 1);
+    }
+
+    // Entering after retiring does not block freeing.
+    {
+        utils::EpochReclamation::ReadSection readSection(epochs, iReader);
+        epochs.reclaim();
+
+        REQUIRE(nFreed == 1);
+        REQUIRE(epochs.getNRetired() == 0);
+    }
+
+    epochs.waitForReaders();
+
+    epochs.retire(new int(2), deleter);
+    epochs.unregisterReader(iReader);
+    REQUIRE(epochs.registerReader() == iReader);
+}
+
+} // namespace split_index
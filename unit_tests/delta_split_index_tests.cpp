@@ -0,0 +1,137 @@
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+
+#include "../src/index/delta_split_index.hpp"
+#include "../src/index/split_index_factory.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+using IndexType = SplitIndexFactory::IndexType;
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** Returns a builder of indexes of [indexType] with default parameters. */
+DeltaSplitIndex::IndexBuilder makeBuilder(IndexType indexType)
+{
+    return [indexType](const unordered_set<string> &words)
+    {
+        return SplitIndexFactory::initIndex(words, hashType, indexType, 1.0f);
+    };
+}
+
+/** Checks all search modes of [index] against the brute force search in [wordSet] for [queries]. */
+void checkSearching(DeltaSplitIndex &index, const unordered_set<string> &wordSet, const vector<string> &queries,
+    size_t k)
+{
+    REQUIRE(index.getNWords() == wordSet.size());
+
+    for (const string &query : queries)
+    {
+        const DeltaSplitIndex::ResultSetType expected = searchBruteForce(wordSet, query, k);
+
+        size_t nMatches = 0;
+        DeltaSplitIndex::ResultSetType words;
+
+        index.forEachMatch(query, [&](const char *word, size_t size)
+        {
+            nMatches += 1;
+            words.emplace(word, size);
+        });
+
+        REQUIRE(nMatches == expected.size());
+        REQUIRE(words == expected);
+
+        REQUIRE(index.searchExists(query) == not expected.empty());
+        REQUIRE(index.searchCount(query) == expected.size());
+    }
+}
+
+/** Inserts and erases words in [index] and in [wordSet] alike. */
+void update(DeltaSplitIndex &index, unordered_set<string> &wordSet, const vector<string> &words, size_t iStart)
+{
+    for (size_t iWord = iStart; iWord < words.size(); iWord += 3)
+    {
+        REQUIRE(index.insert(words[iWord]) == wordSet.insert(words[iWord]).second);
+        REQUIRE(index.erase(words[iWord - iStart]) == (wordSet.erase(words[iWord - iStart]) == 1));
+    }
+}
+
+}
+
+TEST_CASE("are updates of base and delta indexes searched correctly", "[delta_split_index]")
+{
+    for (const IndexType indexType : { IndexType::K1, IndexType::K1Packed, IndexType::K2, IndexType::K2Comp })
+    {
+        const size_t k = (indexType == IndexType::K2 or indexType == IndexType::K2Comp) ? 2 : 1;
+
+        mt19937 gen(1234);
+        const vector<string> words = generateWords(300, "abcd", 8, 8, gen);
+
+        unordered_set<string> wordSet(words.begin(), words.begin() + 200);
+
+        DeltaSplitIndex index(wordSet, makeBuilder(indexType));
+        index.setMergeThreshold(0.0f);
+
+        REQUIRE(index.getDelta() == nullptr);
+
+        update(index, wordSet, words, 200);
+
+        REQUIRE(index.getNMerges() == 0);
+        REQUIRE(index.getNDeltaWords() > 0);
+        REQUIRE(index.getNErasedBaseWords() > 0);
+        checkSearching(index, wordSet, words, k);
+
+        // Erased base words are inserted again into the base index.
+        REQUIRE(index.insert(words[0]) == wordSet.insert(words[0]).second);
+        REQUIRE_FALSE(index.insert(words[0]));
+        checkSearching(index, wordSet, words, k);
+
+        index.merge();
+
+        REQUIRE(index.getNMerges() == 1);
+        REQUIRE(index.getDelta() == nullptr);
+        REQUIRE(index.getNErasedBaseWords() == 0);
+        REQUIRE(index.getBase().getWordSet() == wordSet);
+        checkSearching(index, wordSet, words, k);
+    }
+}
+
+TEST_CASE("are updates made during a background merge applied to the merged index", "[delta_split_index]")
+{
+    mt19937 gen(4321);
+    const vector<string> words = generateWords(400, "abcd", 8, 8, gen);
+
+    unordered_set<string> wordSet(words.begin(), words.begin() + 200);
+
+    DeltaSplitIndex index(wordSet, makeBuilder(IndexType::K1));
+    index.setMergeThreshold(0.05f);
+
+    // The merge is started once more than 10 words have been updated.
+    update(index, wordSet, words, 200);
+
+    REQUIRE((index.isMerging() or index.getNMerges() > 0));
+    checkSearching(index, wordSet, words, 1);
+
+    while (index.isMerging())
+    {
+        index.finishMerge(true);
+    }
+
+    REQUIRE(index.getNMerges() > 0);
+    REQUIRE(index.contains(*wordSet.begin()));
+    checkSearching(index, wordSet, words, 1);
+}
+
+} // namespace split_index
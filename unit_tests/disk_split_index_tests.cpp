@@ -0,0 +1,167 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+
+#include "../src/hash_map/disk_hash_map.hpp"
+#include "../src/index/disk_split_index.hpp"
+
+using namespace split_index::hash_map;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+const string tmpDirPath = "tmp_disk_index";
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+string retrieveString(const DiskHashMap &hashMap, const string &key)
+{
+    size_t entrySize = 0;
+    const char *entry = hashMap.retrieve(key.c_str(), key.size(), entrySize);
+
+    return (entry == nullptr) ? "<none>" : string(entry, entrySize);
+}
+
+void removeTmpDir()
+{
+    DiskSplitIndex::remove(tmpDirPath);
+    remove(tmpDirPath.c_str());
+}
+
+}
+
+TEST_CASE("is building disk hash map from many runs correct", "[disk_hash_map]")
+{
+    {
+        // Tiny runs, so that pairs are merged from many temporary files.
+        DiskHashMap::Builder builder(tmpDirPath, 3, hashType, 64);
+
+        for (int i = 0; i < 300; ++i)
+        {
+            const string key = "key" + to_string(i % 100);
+            const string value = to_string(i % 7);
+
+            builder.add(key.c_str(), key.size(), value.c_str(), value.size());
+        }
+
+        builder.add("dup", 3, "a", 1);
+        builder.add("dup", 3, "b", 1);
+        builder.add("dup", 3, "a", 1);
+
+        REQUIRE(builder.getNRuns() > 10);
+        builder.finish();
+    }
+
+    DiskHashMap hashMap(tmpDirPath);
+
+    REQUIRE(hashMap.getNSegments() == 3);
+    REQUIRE(hashMap.getNKeys() == 101);
+
+    // Values of a key are concatenated in sorted order, equal values are stored once.
+    REQUIRE(retrieveString(hashMap, "dup") == "ab");
+    REQUIRE(retrieveString(hashMap, "key0") == "024");
+    REQUIRE(retrieveString(hashMap, "key99") == "135");
+    REQUIRE(retrieveString(hashMap, "key100") == "<none>");
+    REQUIRE(retrieveString(hashMap, "ke") == "<none>");
+
+    for (DiskHashMap::Advice advice : { DiskHashMap::Advice::Sequential, DiskHashMap::Advice::DontNeed })
+    {
+        hashMap.advise(advice);
+        REQUIRE(retrieveString(hashMap, "dup") == "ab");
+    }
+
+    removeTmpDir();
+    REQUIRE_THROWS(DiskHashMap(tmpDirPath));
+}
+
+TEST_CASE("is building empty disk hash map correct", "[disk_hash_map]")
+{
+    {
+        DiskHashMap::Builder builder(tmpDirPath, 2, hashType);
+        builder.finish();
+    }
+
+    DiskHashMap hashMap(tmpDirPath);
+
+    REQUIRE(hashMap.getNKeys() == 0);
+    REQUIRE(retrieveString(hashMap, "key") == "<none>");
+
+    removeTmpDir();
+    REQUIRE_THROWS(DiskHashMap::Builder(tmpDirPath, 0, hashType));
+}
+
+TEST_CASE("is disk split index searching correct", "[disk_split_index]")
+{
+    mt19937 gen(2024);
+
+    const vector<string> words = generateWords(2000, "abcd", 4, 12, gen);
+    const unordered_set<string> wordSet(words.begin(), words.end());
+
+    vector<string> queries = generateWords(200, "abcd", 4, 12, gen);
+    queries.insert(queries.end(), words.begin(), words.begin() + 50);
+    queries.push_back("abc");
+
+    for (size_t k = 1; k <= 3; ++k)
+    {
+        {
+            DiskSplitIndex::Builder builder(tmpDirPath, k, 4, hashType, 4096);
+
+            for (const string &word : words)
+            {
+                builder.add(word);
+            }
+
+            REQUIRE_THROWS(builder.add(string(k, 'a')));
+            builder.finish();
+        }
+
+        DiskSplitIndex index(tmpDirPath);
+        REQUIRE(index.getK() == k);
+        REQUIRE(index.getNAddedWords() == words.size());
+
+        for (DiskSplitIndex::AccessPattern accessPattern : { DiskSplitIndex::AccessPattern::Random,
+            DiskSplitIndex::AccessPattern::Sequential, DiskSplitIndex::AccessPattern::Prefetch })
+        {
+            index.setAccessPattern(accessPattern);
+
+            vector<DiskSplitIndex::ResultSetType> matches(queries.size());
+            size_t nMatches = 0;
+
+            index.forEachMatch(queries, [&](size_t iQuery, const string &word)
+            {
+                nMatches += 1;
+                matches[iQuery].insert(word);
+            });
+
+            size_t nExpectedMatches = 0;
+            DiskSplitIndex::ResultSetType expectedWords;
+
+            for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+            {
+                const DiskSplitIndex::ResultSetType expected = searchBruteForce(wordSet, queries[iQuery], k);
+
+                REQUIRE(matches[iQuery] == expected);
+
+                nExpectedMatches += expected.size();
+                expectedWords.insert(expected.begin(), expected.end());
+            }
+
+            // Each word is reported once per query.
+            REQUIRE(nMatches == nExpectedMatches);
+            REQUIRE(index.search(queries) == expectedWords);
+        }
+
+        removeTmpDir();
+    }
+}
+
+} // namespace split_index
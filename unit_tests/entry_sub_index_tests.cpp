@@ -0,0 +1,144 @@
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "../src/index/entry_sub_index.hpp"
+#include "../src/utils/distance.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+/** Returns the word indexes of all candidates for [part] in [subIndex]. */
+set<uint32_t> getCandidates(const EntrySubIndex &subIndex, const string &part)
+{
+    set<uint32_t> ret;
+
+    subIndex.forEachCandidate(part.c_str(), part.size(), [&](const EntrySubIndex::Item &item)
+    {
+        ret.insert(item.iWord);
+        return true;
+    });
+
+    return ret;
+}
+
+}
+
+TEST_CASE("are entry sub-index candidates correct", "[entry_sub_index]")
+{
+    EntrySubIndex subIndex(1);
+    const vector<string> parts { "kota", "kotb", "psaa", "ma", "a" };
+
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        subIndex.add(parts[i].c_str(), parts[i].size(), { static_cast<uint32_t>(i), static_cast<uint32_t>(i) });
+    }
+
+    subIndex.build();
+    REQUIRE(subIndex.getNItems() == parts.size());
+
+    // "a" is too short to be split, so it is always a candidate.
+    REQUIRE(getCandidates(subIndex, "kota") == set<uint32_t>({ 0, 1, 4 }));
+    REQUIRE(getCandidates(subIndex, "xxta") == set<uint32_t>({ 0, 4 }));
+    REQUIRE(getCandidates(subIndex, "psxx") == set<uint32_t>({ 2, 4 }));
+    REQUIRE(getCandidates(subIndex, "mb") == set<uint32_t>({ 3, 4 }));
+    REQUIRE(getCandidates(subIndex, "xxxx") == set<uint32_t>({ 4 }));
+
+    // The search stops once the callback returns false.
+    size_t nCalls = 0;
+
+    subIndex.forEachCandidate("kota", 4, [&nCalls](const EntrySubIndex::Item &)
+    {
+        nCalls += 1;
+        return false;
+    });
+
+    REQUIRE(nCalls == 1);
+}
+
+TEST_CASE("does entry sub-index report all parts within max errors", "[entry_sub_index]")
+{
+    const string alphabet = "ACGT";
+    mt19937 gen(1);
+
+    for (size_t maxErrors = 1; maxErrors <= 3; ++maxErrors)
+    {
+        EntrySubIndex subIndex(maxErrors);
+        vector<string> parts;
+
+        for (uint32_t iWord = 0; iWord < 500; ++iWord)
+        {
+            string part(1 + gen() % 12, 'A');
+
+            for (char &c : part)
+            {
+                c = alphabet[gen() % alphabet.size()];
+            }
+
+            parts.push_back(part);
+            subIndex.add(part.c_str(), part.size(), { 0, iWord });
+        }
+
+        subIndex.build();
+        REQUIRE(subIndex.calcSizeB() > 0);
+
+        for (const string &part : parts)
+        {
+            string query = part;
+
+            for (size_t iError = 0; iError < maxErrors; ++iError)
+            {
+                query[gen() % query.size()] = alphabet[gen() % alphabet.size()];
+            }
+
+            const set<uint32_t> candidates = getCandidates(subIndex, query);
+
+            for (uint32_t iWord = 0; iWord < parts.size(); ++iWord)
+            {
+                if (parts[iWord].size() == query.size() and
+                    utils::Distance::isHammingAtMost(parts[iWord].c_str(), query.c_str(), query.size(), maxErrors))
+                {
+                    REQUIRE(candidates.count(iWord) == 1);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("is finding entry sub-indexes correct", "[entry_sub_index]")
+{
+    const char entries[4] = { 0 };
+    EntrySubIndexes subIndexes;
+
+    REQUIRE(subIndexes.empty());
+    REQUIRE(subIndexes.find(entries) == nullptr);
+
+    EntrySubIndex *subIndex2 = new EntrySubIndex(2);
+    EntrySubIndex *subIndex0 = new EntrySubIndex(1);
+
+    subIndexes.add(entries + 2, subIndex2);
+    subIndexes.add(entries, subIndex0);
+
+    REQUIRE(subIndexes.size() == 2);
+    REQUIRE(subIndexes.find(entries) == subIndex0);
+    REQUIRE(subIndexes.find(entries + 1) == nullptr);
+    REQUIRE(subIndexes.find(entries + 2) == subIndex2);
+    REQUIRE(subIndexes.find(entries + 3) == nullptr);
+
+    subIndexes.clear();
+
+    REQUIRE(subIndexes.empty());
+    REQUIRE(subIndexes.find(entries) == nullptr);
+}
+
+} // namespace split_index
@@ -176,6 +176,22 @@ TEST_CASE("is rehashing correct", "[hash_map_aligned]")
     REQUIRE(hashMap.getMaxLoadFactor() == 0.15f);
 }
 
+TEST_CASE("are entries kept in place when rehashing", "[hash_map_aligned]")
+{
+    string entry = "entry";
+    auto calcEntrySizeB = [&entry](const char *) -> size_t { return entry.size(); };
+
+    HashMapAligned hashMap(calcEntrySizeB, 0.15f, 5, hashType);
+    hashMap.insert("key1", 4, const_cast<char *>(entry.c_str()));
+
+    const char *storedEntry = *hashMap.retrieve("key1", 4);
+    hashMap.insert("key2", 4, const_cast<char *>(entry.c_str()));
+
+    REQUIRE(hashMap.getNBuckets() == 20);
+    REQUIRE(*hashMap.retrieve("key1", 4) == storedEntry);
+    REQUIRE(memcmp(storedEntry, entry.c_str(), entry.size()) == 0);
+}
+
 TEST_CASE("is copying entry correct", "[hash_map_aligned]")
 {
     // We want to include the terminating '\0'.
@@ -0,0 +1,101 @@
+#include <cstring>
+
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "../src/index/key_packer.hpp"
+#include "../src/index/split_index_1.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+}
+
+TEST_CASE("is key packer disabled before building", "[key_packer]")
+{
+    KeyPacker packer;
+    REQUIRE(not packer.isEnabled());
+}
+
+TEST_CASE("is calculating bits per char correct", "[key_packer]")
+{
+    KeyPacker packer;
+
+    packer.build({ "ACGT", "TTGA" });
+    REQUIRE(packer.isEnabled());
+    REQUIRE(packer.getAlphabetSize() == 4);
+    REQUIRE(packer.getNBitsPerChar() == 3); // Ranks 1..4, 0 is reserved for padding.
+
+    packer.build({ "abcdefg" });
+    REQUIRE(packer.getAlphabetSize() == 7);
+    REQUIRE(packer.getNBitsPerChar() == 3);
+
+    packer.build({ "abcdefgh" });
+    REQUIRE(packer.getNBitsPerChar() == 4);
+
+    // All chars except for 0 require 8 bits per char, hence packing is disabled.
+    string word;
+
+    for (int c = 1; c < 256; ++c)
+    {
+        word += static_cast<char>(c);
+    }
+
+    packer.build({ word });
+    REQUIRE(not packer.isEnabled());
+}
+
+TEST_CASE("is packing keys correct", "[key_packer]")
+{
+    KeyPacker packer;
+    packer.build({ "ACGT" });
+
+    char buf1[16], buf2[16];
+
+    REQUIRE(packer.pack("A", 1, buf1) == 1);
+    REQUIRE(packer.pack("ACGTACGT", 8, buf1) == 3);
+    REQUIRE(packer.pack("ACGTACGTA", 9, buf1) == 4);
+    REQUIRE(packer.calcPackedSize(9) == 4);
+
+    // Chars outside the alphabet cannot be packed.
+    REQUIRE(packer.pack("ACNT", 4, buf1) == 0);
+
+    // Packed keys of different sizes differ even if they have the same number of bytes.
+    const size_t size1 = packer.pack("AA", 2, buf1);
+    const size_t size2 = packer.pack("A", 1, buf2);
+
+    REQUIRE(size1 == size2);
+    REQUIRE(memcmp(buf1, buf2, size1) != 0);
+
+    // Packing is deterministic and distinguishes different keys.
+    REQUIRE(packer.pack("GATTACA", 7, buf1) == packer.pack("GATTACA", 7, buf2));
+    REQUIRE(memcmp(buf1, buf2, 3) == 0);
+
+    packer.pack("GATTACC", 7, buf2);
+    REQUIRE(memcmp(buf1, buf2, 3) != 0);
+}
+
+TEST_CASE("is hash map smaller with packed keys", "[key_packer]")
+{
+    const unordered_set<string> wordSet { "ACGTACGTAC", "TTGACCAGTA", "GATTACAGAT", "CCCAAATTTG", "AGAGAGTCTC" };
+
+    SplitIndex1 index1(wordSet, hashType, 1.0f);
+    index1.construct();
+
+    SplitIndex1 index2(wordSet, hashType, 1.0f);
+    index2.setKeyPacking(true);
+    index2.construct();
+
+    REQUIRE(index2.calcHashMapSizeB() < index1.calcHashMapSizeB());
+    REQUIRE(index2.search({ "ACGTACGTAA", "GATTACNGAT", "NNNNNNNNNN" }) == SplitIndex::ResultSetType{ "ACGTACGTAC", "GATTACAGAT" });
+}
+
+} // namespace split_index
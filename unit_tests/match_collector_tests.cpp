@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/index/match_collector.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+TEST_CASE("are match collector word IDs correct", "[match_collector]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "a", "kot" };
+
+    MatchCollector collector;
+    collector.build(wordSet);
+
+    REQUIRE(collector.getNWords() == wordSet.size());
+
+    unordered_set<string> words;
+
+    for (MatchCollector::WordId id = 0; id < collector.getNWords(); ++id)
+    {
+        const string word(collector.getWordChars(id), collector.getWordSize(id));
+
+        REQUIRE(collector.findWordId(word.c_str(), word.size()) == id);
+        words.insert(word);
+    }
+
+    REQUIRE(words == wordSet);
+
+    REQUIRE(collector.findWordId("kotb", 4) == MatchCollector::noWordId);
+    REQUIRE(collector.findWordId("kota", 3) == collector.findWordId("kot", 3));
+    REQUIRE(collector.findWordId("", 0) == MatchCollector::noWordId);
+}
+
+TEST_CASE("does match collector deduplicate word IDs per query", "[match_collector]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota" };
+
+    MatchCollector collector;
+    collector.build(wordSet);
+
+    vector<MatchCollector::WordId> ids;
+    collector.collectWordIds(ids);
+
+    collector.add("kota", 4);
+    collector.add("ala", 3);
+    collector.add("kota", 4);
+    collector.add("psa", 3);
+
+    // IDs are only stored when the query is finished.
+    REQUIRE(ids.empty());
+    collector.finishQuery();
+
+    REQUIRE(ids.size() == 2);
+    REQUIRE(ids[0] == collector.findWordId("kota", 4));
+    REQUIRE(ids[1] == collector.findWordId("ala", 3));
+
+    // The next query starts afresh.
+    collector.collectWordIds(ids);
+    REQUIRE(ids.empty());
+
+    collector.add("kota", 4);
+    collector.finishQuery();
+
+    REQUIRE(ids.size() == 1);
+}
+
+TEST_CASE("does match collector store unique word IDs without deduplication", "[match_collector]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota" };
+
+    MatchCollector collector;
+    collector.build(wordSet);
+
+    vector<MatchCollector::WordId> ids;
+    collector.collectWordIds(ids);
+
+    collector.addUnique("kota", 4);
+    collector.add("ala", 3);
+    collector.add("ala", 3);
+    collector.addUnique("psa", 3);
+    collector.finishQuery();
+
+    REQUIRE(ids == vector<MatchCollector::WordId>{ collector.findWordId("kota", 4), collector.findWordId("ala", 3) });
+}
+
+TEST_CASE("does match collector store matches ordered by distance", "[match_collector]")
+{
+    MatchCollector collector;
+    collector.build({ "kota", "kita", "kitb", "mama" });
+
+    const string query = "kota";
+    vector<MatchCollector::Match> matches;
+
+    collector.collectMatches(query.c_str(), query.size(), matches, true);
+
+    collector.add("kitb", 4);
+    collector.add("kita", 4);
+    collector.addUnique("kota", 4);
+    collector.add("kita", 4);
+    collector.finishQuery();
+
+    REQUIRE(matches.size() == 3);
+
+    REQUIRE(matches[0].id == collector.findWordId("kota", 4));
+    REQUIRE(matches[0].distance == 0);
+
+    REQUIRE(matches[1].id == collector.findWordId("kita", 4));
+    REQUIRE(matches[1].distance == 1);
+    REQUIRE(matches[1].mismatchPositions[0] == 1);
+
+    REQUIRE(matches[2].id == collector.findWordId("kitb", 4));
+    REQUIRE(matches[2].distance == 2);
+    REQUIRE(matches[2].mismatchPositions[0] == 1);
+    REQUIRE(matches[2].mismatchPositions[1] == 3);
+}
+
+TEST_CASE("does match collector keep top matches ranked by distance and payload", "[match_collector]")
+{
+    MatchCollector collector;
+    collector.build({ "kota", "kita", "kitb", "mota", "kotb" });
+    collector.setPayloads({ { "kita", 5 }, { "mota", 7 }, { "kitb", 100 }, { "psa", 1 } });
+
+    REQUIRE(collector.getPayload(collector.findWordId("kita", 4)) == 5);
+    REQUIRE(collector.getPayload(collector.findWordId("kotb", 4)) == 0);
+
+    const string query = "kota";
+    vector<MatchCollector::Match> matches;
+
+    const vector<string> words { "kitb", "kita", "mota", "kota", "kotb", "kita" };
+    const vector<string> expected { "kota", "mota", "kita", "kotb", "kitb" };
+
+    for (size_t nTop = 0; nTop <= expected.size() + 1; ++nTop)
+    {
+        collector.collectTopMatches(query.c_str(), query.size(), nTop, matches);
+
+        for (const string &word : words)
+        {
+            collector.add(word.c_str(), word.size());
+        }
+
+        collector.finishQuery();
+        REQUIRE(matches.size() == min(nTop, expected.size()));
+
+        for (size_t iMatch = 0; iMatch < matches.size(); ++iMatch)
+        {
+            REQUIRE(matches[iMatch].id == collector.findWordId(expected[iMatch].c_str(), expected[iMatch].size()));
+            REQUIRE(matches[iMatch].payload == collector.getPayload(matches[iMatch].id));
+        }
+    }
+}
+
+TEST_CASE("does match collector collect words", "[match_collector]")
+{
+    MatchCollector collector;
+    collector.build({ "ala", "ma", "kota" });
+
+    MatchCollector::ResultSetType results;
+    collector.collectWords(results);
+
+    collector.add("kota", 4);
+    collector.add("kota", 4);
+    collector.add("ala", 3);
+
+    REQUIRE(results == MatchCollector::ResultSetType{ "kota", "ala" });
+}
+
+TEST_CASE("does match collector check existence and count matches", "[match_collector]")
+{
+    MatchCollector collector;
+    collector.build({ "ala", "ma", "kota" });
+
+    collector.collectExistence();
+    REQUIRE_FALSE(collector.isDone());
+
+    collector.add("kota", 4);
+    REQUIRE(collector.isDone());
+    REQUIRE(collector.hasMatch());
+
+    // Duplicates are counted once.
+    collector.collectCount();
+    REQUIRE_FALSE(collector.isDone());
+
+    collector.add("kota", 4);
+    collector.add("ala", 3);
+    collector.add("kota", 4);
+    collector.finishQuery();
+
+    REQUIRE(collector.getCount() == 2);
+    REQUIRE_FALSE(collector.hasMatch());
+
+    // Unique matches are counted without lookups.
+    collector.collectCount();
+
+    collector.addUnique("kota", 4);
+    collector.addUnique("ma", 2);
+    collector.finishQuery();
+
+    REQUIRE(collector.getCount() == 2);
+}
+
+} // namespace split_index
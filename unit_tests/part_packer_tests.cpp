@@ -0,0 +1,142 @@
+#include <random>
+
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "../src/index/part_packer.hpp"
+#include "../src/index/split_index_1.hpp"
+#include "../src/index/split_index_1_packed.hpp"
+#include "../src/utils/distance.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** Returns a random string of [size] chars from [alphabet]. */
+string generateString(mt19937 &generator, const string &alphabet, size_t size)
+{
+    uniform_int_distribution<size_t> charDistribution(0, alphabet.size() - 1);
+    string ret;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        ret += alphabet[charDistribution(generator)];
+    }
+
+    return ret;
+}
+
+}
+
+TEST_CASE("is calculating part packer bits per char correct", "[part_packer]")
+{
+    PartPacker packer;
+
+    packer.build({ "ACGT", "TTGA" });
+    REQUIRE(packer.getAlphabetSize() == 4);
+    REQUIRE(packer.getNBitsPerChar() == 2);
+
+    REQUIRE(packer.calcPackedSize(4) == 1);
+    REQUIRE(packer.calcPackedSize(5) == 2);
+    REQUIRE(packer.calcPackedSize(32) == 8);
+    REQUIRE(packer.calcPackedSize(33) == 9);
+
+    packer.build({ "abcdefghijklmnopqrstuvwxyz" });
+    REQUIRE(packer.getNBitsPerChar() == 5);
+
+    // 12 chars per 64-bit word, the remaining 4 bits are unused.
+    REQUIRE(packer.calcPackedSize(12) == 8);
+    REQUIRE(packer.calcPackedSize(13) == 9);
+
+    packer.build({ "a" });
+    REQUIRE(packer.getNBitsPerChar() == 1);
+}
+
+TEST_CASE("is packing and unpacking parts correct", "[part_packer]")
+{
+    mt19937 generator(123);
+
+    for (const string alphabet : { "a", "ACGT", "abcdefghijklmnopqrstuvwxyz", "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789'-" })
+    {
+        PartPacker packer;
+        packer.build({ alphabet });
+
+        for (size_t partSize = 1; partSize <= 64; ++partSize)
+        {
+            const string part = generateString(generator, alphabet, partSize);
+
+            char packed[PartPacker::maxPartSize], unpacked[PartPacker::maxPartSize];
+
+            REQUIRE(packer.pack(part.c_str(), partSize, packed) == packer.calcPackedSize(partSize));
+            packer.unpack(packed, partSize, unpacked);
+
+            REQUIRE(string(unpacked, partSize) == part);
+        }
+    }
+}
+
+TEST_CASE("is packed Hamming distance correct", "[part_packer]")
+{
+    mt19937 generator(123);
+
+    for (const string alphabet : { "ab", "ACGT", "abcdefghijklmnopqrstuvwxyz" })
+    {
+        PartPacker packer;
+        packer.build({ alphabet });
+
+        // Queries may contain chars outside the alphabet.
+        const string queryAlphabet = alphabet + "N";
+
+        for (size_t partSize = 1; partSize <= 64; ++partSize)
+        {
+            repeat(20, [&]()
+            {
+                const string part = generateString(generator, alphabet, partSize);
+                string query = part;
+
+                uniform_int_distribution<size_t> posDistribution(0, partSize - 1);
+
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    query[posDistribution(generator)] = generateString(generator, queryAlphabet, 1)[0];
+                }
+
+                char packed[PartPacker::maxPartSize];
+                uint64_t queryWords[PartPacker::maxNWords], queryForeignMasks[PartPacker::maxNWords];
+
+                packer.pack(part.c_str(), partSize, packed);
+                packer.packQuery(query.c_str(), partSize, queryWords, queryForeignMasks);
+
+                const unsigned hamming = utils::Distance::calcHamming(part.c_str(), query.c_str(), partSize);
+
+                for (size_t k = 0; k <= 2; ++k)
+                {
+                    REQUIRE(packer.isHammingAtMostK(packed, queryWords, queryForeignMasks, partSize, k) == (hamming <= k));
+                }
+            });
+        }
+    }
+}
+
+TEST_CASE("is hash map smaller with packed parts", "[part_packer]")
+{
+    const unordered_set<string> wordSet { "ACGTACGTAC", "TTGACCAGTA", "GATTACAGAT", "CCCAAATTTG", "AGAGAGTCTC" };
+
+    SplitIndex1 index1(wordSet, hashType, 1.0f);
+    index1.construct();
+
+    SplitIndex1Packed index2(wordSet, hashType, 1.0f);
+    index2.construct();
+
+    REQUIRE(index2.calcHashMapSizeB() < index1.calcHashMapSizeB());
+    REQUIRE(index2.search({ "ACGTACGTAA", "GATTACNGAT", "NNNNNNNNNN" }) == SplitIndex::ResultSetType{ "ACGTACGTAC", "GATTACAGAT" });
+}
+
+} // namespace split_index
@@ -0,0 +1,92 @@
+#ifndef RANDOM_WORDS_HPP
+#define RANDOM_WORDS_HPP
+
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../src/utils/distance.hpp"
+
+/** Returns [nWords] random words of sizes between [minSize] and [maxSize] over [alphabet]. */
+inline std::vector<std::string> generateWords(size_t nWords, const std::string &alphabet,
+    size_t minSize, size_t maxSize, std::mt19937 &gen)
+{
+    std::uniform_int_distribution<size_t> sizeDist(minSize, maxSize);
+    std::uniform_int_distribution<size_t> charDist(0, alphabet.size() - 1);
+
+    std::vector<std::string> ret;
+
+    for (size_t iWord = 0; iWord < nWords; ++iWord)
+    {
+        std::string word(sizeDist(gen), ' ');
+
+        for (char &c : word)
+        {
+            c = alphabet[charDist(gen)];
+        }
+
+        ret.push_back(word);
+    }
+
+    return ret;
+}
+
+/** Returns [nWords] random words, each concatenating [nWordSyllables] random entries of [syllables]. */
+inline std::vector<std::string> generateSyllableWords(size_t nWords, const std::vector<std::string> &syllables,
+    size_t nWordSyllables, std::mt19937 &gen)
+{
+    std::uniform_int_distribution<size_t> syllableDist(0, syllables.size() - 1);
+
+    std::vector<std::string> ret;
+
+    for (size_t iWord = 0; iWord < nWords; ++iWord)
+    {
+        std::string word;
+
+        for (size_t iSyllable = 0; iSyllable < nWordSyllables; ++iSyllable)
+        {
+            word += syllables[syllableDist(gen)];
+        }
+
+        ret.push_back(word);
+    }
+
+    return ret;
+}
+
+/** Returns [word] with [nSubstitutions] chars at random (not necessarily distinct) positions replaced
+ * by random chars from [alphabet]. */
+inline std::string substituteChars(std::string word, size_t nSubstitutions, const std::string &alphabet,
+    std::mt19937 &gen)
+{
+    std::uniform_int_distribution<size_t> posDist(0, word.size() - 1);
+    std::uniform_int_distribution<size_t> charDist(0, alphabet.size() - 1);
+
+    for (size_t iSubstitution = 0; iSubstitution < nSubstitutions; ++iSubstitution)
+    {
+        word[posDist(gen)] = alphabet[charDist(gen)];
+    }
+
+    return word;
+}
+
+/** Returns the words from [words] which are within Hamming distance [k] from [query]. */
+template<typename Words>
+std::unordered_set<std::string> searchBruteForce(const Words &words, const std::string &query, size_t k)
+{
+    std::unordered_set<std::string> ret;
+
+    for (const std::string &word : words)
+    {
+        if (word.size() == query.size()
+            and split_index::utils::Distance::calcHamming(word.c_str(), query.c_str(), query.size()) <= k)
+        {
+            ret.insert(word);
+        }
+    }
+
+    return ret;
+}
+
+#endif // RANDOM_WORDS_HPP
@@ -0,0 +1,154 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "../src/index/spaced_seeds.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+constexpr size_t maxWordSize = 127;
+
+/** Returns the result of gathering part [iPart] of [word], the word is padded as required by SpacedSeeds::gather. */
+string gather(const SpacedSeeds &seeds, const string &word, size_t iPart)
+{
+    vector<char> wordBuf(max(word.size(), static_cast<size_t>(SpacedSeeds::maxSimdWordSize)), 'X');
+    vector<char> out(wordBuf.size());
+
+    copy(word.begin(), word.end(), wordBuf.begin());
+    seeds.gather(wordBuf.data(), word.size(), iPart, out.data());
+
+    return string(out.data(), word.size());
+}
+
+}
+
+TEST_CASE("does spaced seeds throw for bad params", "[spaced_seeds]")
+{
+    REQUIRE_THROWS(SpacedSeeds(0, 1, maxWordSize));
+    REQUIRE_THROWS(SpacedSeeds(3, 0, maxWordSize));
+    REQUIRE_THROWS(SpacedSeeds(3, 1, 1000));
+}
+
+TEST_CASE("is gathering interleaved parts correct", "[spaced_seeds]")
+{
+    SpacedSeeds seeds(3, 1, maxWordSize);
+
+    REQUIRE(gather(seeds, "abcdefgh", 0) == "adgbcefh");
+    REQUIRE(gather(seeds, "abcdefgh", 1) == "behacdfg");
+    REQUIRE(gather(seeds, "abcdefgh", 2) == "cfabdegh");
+
+    REQUIRE(seeds.getPartSize(8, 0) == 3);
+    REQUIRE(seeds.getPartSize(8, 1) == 3);
+    REQUIRE(seeds.getPartSize(8, 2) == 2);
+}
+
+TEST_CASE("is gathering patterned parts correct", "[spaced_seeds]")
+{
+    SpacedSeeds seeds(2, 2, maxWordSize);
+
+    REQUIRE(gather(seeds, "abcdefgh", 0) == "abefcdgh");
+    REQUIRE(gather(seeds, "abcdefgh", 1) == "cdghabef");
+
+    // The block size is lowered so that no part is empty.
+    REQUIRE(seeds.getBlockSize(8) == 2);
+    REQUIRE(seeds.getBlockSize(3) == 1);
+    REQUIRE(gather(seeds, "abc", 1) == "bac");
+}
+
+TEST_CASE("are gathering and scattering correct for all word sizes", "[spaced_seeds]")
+{
+    mt19937 mt(1);
+    uniform_int_distribution<int> dist('a', 'z');
+
+    for (size_t nParts = 1; nParts <= 4; ++nParts)
+    {
+        for (size_t blockSize = 1; blockSize <= 5; ++blockSize)
+        {
+            SpacedSeeds seeds(nParts, blockSize, maxWordSize);
+
+            for (size_t wordSize = nParts; wordSize <= maxWordSize; ++wordSize)
+            {
+                string word(wordSize, ' ');
+
+                for (char &c : word)
+                {
+                    c = static_cast<char>(dist(mt));
+                }
+
+                size_t partSizesSum = 0;
+                const size_t curBlockSize = seeds.getBlockSize(wordSize);
+
+                for (size_t iPart = 0; iPart < nParts; ++iPart)
+                {
+                    const string gathered = gather(seeds, word, iPart);
+                    const size_t partSize = seeds.getPartSize(wordSize, iPart);
+
+                    REQUIRE(partSize > 0);
+                    partSizesSum += partSize;
+
+                    // Part chars go first in the order of positions.
+                    string expectedPart;
+
+                    for (size_t pos = 0; pos < wordSize; ++pos)
+                    {
+                        if ((pos / curBlockSize) % nParts == iPart)
+                        {
+                            expectedPart += word[pos];
+                        }
+                    }
+
+                    REQUIRE(gathered.substr(0, partSize) == expectedPart);
+
+                    string scattered(wordSize, ' ');
+                    seeds.scatter(gathered.c_str(), wordSize, iPart, &scattered[0]);
+
+                    REQUIRE(scattered == word);
+                }
+
+                REQUIRE(partSizesSum == wordSize);
+            }
+        }
+    }
+}
+
+TEST_CASE("do words with at most k mismatches share a spaced seed", "[spaced_seeds]")
+{
+    const string word = "acgtacgtaaaaaaaaccgtgt";
+    const size_t k = 3;
+
+    SpacedSeeds seeds(k + 1, 2, maxWordSize);
+
+    mt19937 mt(2);
+    uniform_int_distribution<size_t> posDist(0, word.size() - 1);
+
+    repeat(100, [&] {
+        string curWord = word;
+
+        for (size_t i = 0; i < k; ++i)
+        {
+            curWord[posDist(mt)] = 'N';
+        }
+
+        size_t nSharedSeeds = 0;
+
+        for (size_t iPart = 0; iPart <= k; ++iPart)
+        {
+            const size_t partSize = seeds.getPartSize(word.size(), iPart);
+            nSharedSeeds += (gather(seeds, word, iPart).substr(0, partSize) == gather(seeds, curWord, iPart).substr(0, partSize));
+        }
+
+        REQUIRE(nSharedSeeds >= 1);
+    });
+}
+
+} // namespace split_index
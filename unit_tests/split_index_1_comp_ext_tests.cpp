@@ -0,0 +1,128 @@
+#include <cstring>
+#include <random>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+#include "repeat.hpp"
+
+#include "split_index_1_comp_whitebox.hpp"
+
+#include "../src/index/split_index_1_comp_ext.hpp"
+#include "../src/index/split_index_1_comp_triple.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** Returns 5000 random words, each consisting of 4 out of 1000 random 3-letter syllables. */
+unordered_set<string> generateSyllableWordSet()
+{
+    mt19937 gen(123);
+    const vector<string> syllables = generateWords(1000, "abcdefghijklmnopqrstuvwxyz", 3, 3, gen);
+    const vector<string> words = generateSyllableWords(5000, syllables, 4, gen);
+
+    return unordered_set<string>(words.begin(), words.end());
+}
+
+}
+
+TEST_CASE("does split index 1 comp ext throw for empty words", "[split_index_1_comp_ext]")
+{
+    REQUIRE_THROWS(SplitIndex1CompExt({ }, hashType, 1.0f));
+}
+
+TEST_CASE("is ext encoding to buffer correct", "[split_index_1_comp_ext]")
+{
+    const unordered_set<string> wordSet{ "ala", "ma", "kota" };
+
+    SplitIndex1CompExt index1(wordSet, hashType, 1.0f);
+    SplitIndex1CompWhitebox::calcQgramsAndFillMaps(index1);
+
+    // All q-grams of such a small dictionary obtain single-byte codes, so the shortest encoding is: kota|ma|ko|ala.
+    const size_t size1 = SplitIndex1CompWhitebox::encodeToBuf(index1, "kotamakoala", 11);
+    REQUIRE(size1 == 4);
+
+    for (size_t i = 0; i < size1; ++i)
+    {
+        REQUIRE(static_cast<unsigned char>(SplitIndex1CompWhitebox::getCodingBuf(index1)[i]) >= 128);
+    }
+
+    // Chars which are not a part of any q-gram are copied.
+    const size_t size2 = SplitIndex1CompWhitebox::encodeToBuf(index1, "alddd", 5);
+    REQUIRE(size2 == 4);
+    REQUIRE(memcmp(SplitIndex1CompWhitebox::getCodingBuf(index1) + 1, "ddd", 3) == 0);
+}
+
+TEST_CASE("is ext decoding to buffer correct", "[split_index_1_comp_ext]")
+{
+    const unordered_set<string> wordSet{ "ala", "ma", "kota" };
+
+    SplitIndex1CompExt index1(wordSet, hashType, 1.0f);
+    SplitIndex1CompWhitebox::calcQgramsAndFillMaps(index1);
+
+    const size_t encodedSize = SplitIndex1CompWhitebox::encodeToBuf(index1, "maalakotaddd", 12);
+    const string encoded(SplitIndex1CompWhitebox::getCodingBuf(index1), encodedSize);
+
+    const size_t size1 = SplitIndex1CompWhitebox::decodeToBuf(index1, encoded.c_str(), encoded.size(), 12);
+
+    REQUIRE(size1 == 12);
+    REQUIRE(memcmp(SplitIndex1CompWhitebox::getCodingBuf(index1), "maalakotaddd", 12) == 0);
+
+    const size_t size2 = SplitIndex1CompWhitebox::decodeToBuf(index1, encoded.c_str(), encoded.size(), 2);
+    REQUIRE(size2 == 0); // Exceeded expected max word size.
+}
+
+TEST_CASE("is ext encoding with two-byte codes correct", "[split_index_1_comp_ext]")
+{
+    // There are many more frequent q-grams than single-byte codes for such a dictionary.
+    const unordered_set<string> wordSet = generateSyllableWordSet();
+
+    SplitIndex1CompExt index1(wordSet, hashType, 1.0f);
+    SplitIndex1CompWhitebox::calcQgramsAndFillMaps(index1);
+
+    bool isTwoByteCodeUsed = false;
+
+    for (const string &word : wordSet)
+    {
+        const size_t encodedSize = SplitIndex1CompWhitebox::encodeToBuf(index1, word.c_str(), word.size());
+        const string encoded(SplitIndex1CompWhitebox::getCodingBuf(index1), encodedSize);
+
+        REQUIRE(encodedSize < word.size());
+
+        // Two-byte codes start with escape chars, which are the highest ones (except for 255).
+        for (const char c : encoded)
+        {
+            isTwoByteCodeUsed |= (c >= QgramCodec::firstEscapeChar);
+        }
+
+        const size_t decodedSize = SplitIndex1CompWhitebox::decodeToBuf(index1, encoded.c_str(), encoded.size(),
+            word.size());
+
+        REQUIRE(decodedSize == word.size());
+        REQUIRE(memcmp(SplitIndex1CompWhitebox::getCodingBuf(index1), word.c_str(), word.size()) == 0);
+    }
+
+    REQUIRE(isTwoByteCodeUsed);
+}
+
+TEST_CASE("is ext compression ratio better than triple", "[split_index_1_comp_ext]")
+{
+    const unordered_set<string> wordSet = generateSyllableWordSet();
+
+    SplitIndex1CompExt index1(wordSet, hashType, 1.0f);
+    index1.construct();
+
+    SplitIndex1CompTriple index2(wordSet, hashType, 1.0f);
+    index2.construct();
+
+    REQUIRE(SplitIndex1CompWhitebox::calcCompressionRatio(index1) > SplitIndex1CompWhitebox::calcCompressionRatio(index2));
+}
+
+} // namespace split_index
@@ -2,6 +2,7 @@
 #include "repeat.hpp"
 
 #include "../src/index/split_index_1_comp.hpp"
+#include "../src/index/split_index_1_comp_ext.hpp"
 #include "../src/index/split_index_1_comp_triple.hpp"
 
 using namespace split_index;
@@ -27,7 +28,8 @@ TEST_CASE("is searching compression empty patterns correct", "[split_index_1_com
     const unordered_set<string> wordSet { "ala", "kota", "jarek", "lubi", "psy" };
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp(wordSet, hashType, 1.0f),
-        new SplitIndex1CompTriple(wordSet, hashType, 1.0f) };
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -51,7 +53,8 @@ TEST_CASE("is searching compression words exact correct", "[split_index_1_comp_s
 
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp({ words.begin(), words.end() }, hashType, 1.0f),
-        new SplitIndex1CompTriple({ words.begin(), words.end() }, hashType, 1.0f) };
+        new SplitIndex1CompTriple({ words.begin(), words.end() }, hashType, 1.0f),
+        new SplitIndex1CompExt({ words.begin(), words.end() }, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -76,7 +79,8 @@ TEST_CASE("is searching compression words exact one-by-one correct", "[split_ind
 
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp(wordSet, hashType, 1.0f),
-        new SplitIndex1CompTriple(wordSet, hashType, 1.0f) };
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -108,7 +112,8 @@ TEST_CASE("is searching compression words for k = 1 for 1 error correct", "[spli
 
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp(wordSet, hashType, 1.0f),
-        new SplitIndex1CompTriple(wordSet, hashType, 1.0f) };
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -142,7 +147,8 @@ TEST_CASE("is searching compression words for k = 1 for 1 error one-by-one corre
 
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp(wordSet, hashType, 1.0f),
-        new SplitIndex1CompTriple(wordSet, hashType, 1.0f) };
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -177,7 +183,8 @@ TEST_CASE("is searching compression words for k = 1 for various number of mismat
 
     SplitIndex *indexes[] = { 
         new SplitIndex1Comp(wordSet, hashType, 1.0f),
-        new SplitIndex1CompTriple(wordSet, hashType, 1.0f) };
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -224,4 +231,49 @@ TEST_CASE("is searching words equal to triple q-gram size correct", "[split_inde
     REQUIRE(index1.search({ "twon" }, 1) == SplitIndex::ResultSetType{ "tion" });
 }
 
+TEST_CASE("is searching compression words with packed keys the same as without", "[split_index_1_comp_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "kota", "jarek", "psa", "bardzo", "lubie", "owoce", "kotara" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1Comp(wordSet, hashType, 1.0f),
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
+
+    SplitIndex *packedIndexes[] = {
+        new SplitIndex1Comp(wordSet, hashType, 1.0f),
+        new SplitIndex1CompTriple(wordSet, hashType, 1.0f),
+        new SplitIndex1CompExt(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        packedIndexes[iIndex]->setKeyPacking(true);
+        packedIndexes[iIndex]->construct();
+
+        REQUIRE(packedIndexes[iIndex]->calcHashMapSizeB() < indexes[iIndex]->calcHashMapSizeB());
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                // 'N' is outside the alphabet, while 'a' is a part of it.
+                for (const char c : { 'N', 'a' })
+                {
+                    string curWord = word;
+                    curWord[i] = c;
+
+                    REQUIRE(packedIndexes[iIndex]->search({ curWord }, 1) == indexes[iIndex]->search({ curWord }, 1));
+                }
+            }
+        }
+
+        delete indexes[iIndex];
+        delete packedIndexes[iIndex];
+    }
+}
+
 } // namespace split_index
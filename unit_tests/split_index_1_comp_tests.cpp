@@ -123,4 +123,28 @@ TEST_CASE("is decoding to buffer correct", "[split_index_1_comp]")
     REQUIRE(size2 == 0); // Exceeded expected max word size.
 }
 
+TEST_CASE("is encoding with size to buffer correct", "[split_index_1_comp]")
+{
+    const unordered_set<string> wordSet{ "ala", "ma", "kota" };
+
+    SplitIndex1Comp index1(wordSet, hashType, 1.0f);
+    SplitIndex1CompWhitebox::calcQgramsAndFillMaps(index1);
+
+    // 2-grams used for encoding: al, la, ma, ko, ot, ta.
+    size_t size1 = SplitIndex1CompWhitebox::encodeWithSizeToBuf(index1, "aldddko", 7);
+    const map<string, char> qgramToChar = SplitIndex1CompWhitebox::getQGramToCharMap(index1);
+
+    // The decoded size comes first.
+    const string expected = string(1, 7) + string(1, qgramToChar.at("al")) + "ddd" + string(1, qgramToChar.at("ko"));
+
+    REQUIRE(size1 == expected.size());
+    REQUIRE(memcmp(SplitIndex1CompWhitebox::getCodingBuf(index1), expected.c_str(), expected.size()) == 0);
+
+    // Words shorter than a q-gram are stored as they are.
+    size_t size2 = SplitIndex1CompWhitebox::encodeWithSizeToBuf(index1, "a", 1);
+
+    REQUIRE(size2 == 2);
+    REQUIRE(memcmp(SplitIndex1CompWhitebox::getCodingBuf(index1), "\1a", 2) == 0);
+}
+
 } // namespace split_index
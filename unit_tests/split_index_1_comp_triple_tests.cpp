@@ -1,4 +1,5 @@
 #include <cstring>
+#include <random>
 
 #include "catch.hpp"
 #include "repeat.hpp"
@@ -170,6 +171,56 @@ TEST_CASE("is triple decoding to buffer correct", "[split_index_1_comp_triple]")
     REQUIRE(size2 == 0); // Exceeded expected max word size.
 }
 
+TEST_CASE("is tuning 2,3,4-gram counts correct", "[split_index_1_comp_triple]")
+{
+    // Each word consists of 2 (out of 40) random 4-grams, so parts are exactly these 4-grams.
+    const size_t n4grams = 40;
+
+    mt19937 generator(123);
+    uniform_int_distribution<int> distribution('a', 'z');
+
+    set<string> q4grams;
+
+    while (q4grams.size() < n4grams)
+    {
+        string qgram;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            qgram += static_cast<char>(distribution(generator));
+        }
+
+        q4grams.insert(qgram);
+    }
+
+    unordered_set<string> wordSet;
+
+    for (const string &prefix : q4grams)
+    {
+        for (const string &suffix : q4grams)
+        {
+            wordSet.insert(prefix + suffix);
+        }
+    }
+
+    // Words are split in halves, i.e. into the 4-grams.
+    SplitIndex1CompTriple index1(wordSet, hashType, 1.0f);
+    index1.setSplitPointTuning(false);
+    index1.construct();
+
+    const map<string, char> qgramToChar = SplitIndex1CompWhitebox::getQGramToCharMap(index1);
+
+    // There are more q-grams in the dictionary than the available codes.
+    REQUIRE(qgramToChar.size() <= 127);
+
+    for (const string &qgram4 : q4grams)
+    {
+        REQUIRE(qgramToChar.find(qgram4) != qgramToChar.end());
+    }
+
+    REQUIRE(SplitIndex1CompWhitebox::calcCompressionRatio(index1) == Approx(4.0));
+}
+
 TEST_CASE("is triple decoding to buffer with decreasing word length correct", "[split_index_1_comp_triple]")
 {
     // TODO
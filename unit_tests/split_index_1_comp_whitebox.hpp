@@ -36,6 +36,16 @@ struct SplitIndex1CompWhitebox
         return index.decodeToBuf(word, wordSize, maxDecodedWordSize);
     }
 
+    inline static size_t encodeWithSizeToBuf(SplitIndex1Comp &index, const char *word, size_t wordSize)
+    {
+        return index.encodeWithSizeToBuf(word, wordSize);
+    }
+
+    inline static double calcCompressionRatio(const SplitIndex1Comp &index)
+    {
+        return index.calcCompressionRatio();
+    }
+
     inline static const char *getCodingBuf(const SplitIndex1Comp &index)
     {
         return index.codingBuf;
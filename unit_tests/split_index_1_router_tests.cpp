@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "split_index_1_router_whitebox.hpp"
+
+#include "../src/index/split_index_1.hpp"
+#include "../src/index/split_index_1_router.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+}
+
+TEST_CASE("does split index 1 router throw for empty words", "[split_index_1_router]")
+{
+    REQUIRE_THROWS(SplitIndex1Router({ }, hashType, 1.0f));
+}
+
+TEST_CASE("is calculating alphabet correct", "[split_index_1_router]")
+{
+    SplitIndex1Router index({ "ala", "ma", "kota" }, hashType, 1.0f);
+    index.construct();
+
+    REQUIRE(SplitIndex1RouterWhitebox::getAlphabet(index) == vector<char>{ 'a', 'k', 'l', 'm', 'o', 't' });
+}
+
+TEST_CASE("is estimating entry size correct", "[split_index_1_router]")
+{
+    SplitIndex1Router index({ "ACGTAA", "ACGTCC", "ACGTGG" }, hashType, 1.0f);
+    // Words are split in halves, otherwise the common prefix would be avoided.
+    index.setSplitPointTuning(false);
+    index.construct();
+
+    // Each suffix is stored under the common prefix key together with its size byte.
+    REQUIRE(SplitIndex1RouterWhitebox::estimateEntrySizeB(index, "ACG", 3) >= 3 * 4);
+}
+
+TEST_CASE("is searching neighborhood correct", "[split_index_1_router]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa", "bardzo", "lubie", "owoce" };
+
+    SplitIndex1Router index(wordSet, hashType, 1.0f);
+    index.construct();
+
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "kota") == SplitIndex::ResultSetType{ "kota" });
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "kofa") == SplitIndex::ResultSetType{ "kota" });
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "osa") == SplitIndex::ResultSetType{ "psa" });
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "ada") == SplitIndex::ResultSetType{ "ala" });
+
+    // Characters outside the alphabet.
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "jarXk") == SplitIndex::ResultSetType{ "jarek" });
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "jXrXk").empty());
+    REQUIRE(SplitIndex1RouterWhitebox::searchNeighborhood(index, "karzzo").empty());
+}
+
+TEST_CASE("is routing and searching with small alphabet correct", "[split_index_1_router]")
+{
+    // A single hot prefix key makes the split search expensive for the small DNA alphabet.
+    unordered_set<string> wordSet;
+    const string symbols = "ACGT";
+
+    for (int i = 0; i < 1024; ++i)
+    {
+        string word = "AAAAA";
+
+        for (int j = i; word.size() < 10; j /= 4)
+        {
+            word += symbols[j % 4];
+        }
+
+        wordSet.insert(word);
+    }
+
+    // Words are split in halves, otherwise the hot prefix key would be avoided.
+    SplitIndex1Router router(wordSet, hashType, 1.0f);
+    router.setSplitPointTuning(false);
+    router.construct();
+
+    SplitIndex1 index1(wordSet, hashType, 1.0f);
+    index1.setSplitPointTuning(false);
+    index1.construct();
+
+    REQUIRE(SplitIndex1RouterWhitebox::isRoutedToNeighborhood(router, "AAAAACGTAC"));
+    REQUIRE(not SplitIndex1RouterWhitebox::isRoutedToNeighborhood(router, "CCCCCCCCCC"));
+
+    const vector<string> queries { "AAAAACGTAC", "AAAACCGTAC", "TAAAACGTAC", "CCCCCCCCCC", "AAAAANNNNN" };
+
+    for (const string &query : queries)
+    {
+        REQUIRE(router.search({ query }) == index1.search({ query }));
+    }
+}
+
+} // namespace split_index
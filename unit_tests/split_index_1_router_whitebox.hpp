@@ -0,0 +1,48 @@
+#ifndef SPLIT_INDEX_1_ROUTER_WHITEBOX_HPP
+#define SPLIT_INDEX_1_ROUTER_WHITEBOX_HPP
+
+#ifndef SPLIT_INDEX_1_ROUTER_WHITEBOX
+#define SPLIT_INDEX_1_ROUTER_WHITEBOX \
+    friend struct SplitIndex1RouterWhitebox;
+#endif
+
+#include "../src/index/split_index_1_router.hpp"
+
+namespace split_index
+{
+
+struct SplitIndex1RouterWhitebox
+{
+    SplitIndex1RouterWhitebox() = delete;
+
+    inline static const std::vector<char> &getAlphabet(const SplitIndex1Router &index)
+    {
+        return index.alphabet;
+    }
+
+    inline static bool isRoutedToNeighborhood(SplitIndex1Router &index, const std::string &query)
+    {
+        index.storePrefixSuffixInBuffers(query);
+        return index.calcRoute(query) == SplitIndex1Router::RouteType::Neighborhood;
+    }
+
+    inline static size_t estimateEntrySizeB(const SplitIndex1Router &index, const char *key, size_t keySize)
+    {
+        return index.estimateEntrySizeB(key, keySize);
+    }
+
+    inline static SplitIndex::ResultSetType searchNeighborhood(SplitIndex1Router &index, const std::string &query)
+    {
+        SplitIndex::ResultSetType results;
+        MatchCollector matches;
+
+        matches.collectWords(results);
+        index.searchNeighborhood(query, matches);
+
+        return results;
+    }
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_1_ROUTER_WHITEBOX_HPP
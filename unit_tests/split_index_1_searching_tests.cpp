@@ -2,6 +2,9 @@
 #include "repeat.hpp"
 
 #include "../src/index/split_index_1.hpp"
+#include "../src/index/split_index_1_comp.hpp"
+#include "../src/index/split_index_1_packed.hpp"
+#include "../src/index/split_index_1_router.hpp"
 #include "../src/index/split_index_k.hpp"
 
 using namespace split_index;
@@ -16,6 +19,21 @@ namespace
 hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
 constexpr int maxNIter = 10;
 
+/** Returns the words whose IDs are reported by [index] for [query], each ID must be reported only once. */
+SplitIndex::ResultSetType searchWordIdsAsWords(SplitIndex &index, const string &query, vector<SplitIndex::WordId> &ids)
+{
+    index.searchWordIds(query, ids);
+    SplitIndex::ResultSetType ret;
+
+    for (const SplitIndex::WordId id : ids)
+    {
+        REQUIRE(id < index.getNWords());
+        REQUIRE(ret.insert(index.getWord(id)).second);
+    }
+
+    return ret;
+}
+
 }
 
 // Note that words for these tests have at least 2 characters.
@@ -26,7 +44,9 @@ TEST_CASE("is searching empty patterns correct", "[split_index_1_searching]")
     const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "lubi", "psy" };
     SplitIndex *indexes[] = { 
         new SplitIndex1(wordSet, hashType, 1.0f), 
-        new SplitIndexK<1>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -50,7 +70,9 @@ TEST_CASE("is searching words exact correct", "[split_index_1_searching]")
 
     SplitIndex *indexes[] = { 
         new SplitIndex1({ words.begin(), words.end() }, hashType, 1.0f), 
-        new SplitIndexK<1>({ words.begin(), words.end() }, hashType, 1.0f) };
+        new SplitIndexK<1>({ words.begin(), words.end() }, hashType, 1.0f),
+        new SplitIndex1Router({ words.begin(), words.end() }, hashType, 1.0f),
+        new SplitIndex1Packed({ words.begin(), words.end() }, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -75,7 +97,9 @@ TEST_CASE("is searching words exact one-by-one correct", "[split_index_1_searchi
 
     SplitIndex *indexes[] = { 
         new SplitIndex1(wordSet, hashType, 1.0f), 
-        new SplitIndexK<1>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -107,7 +131,9 @@ TEST_CASE("is searching words for k = 1 for 1 error correct", "[split_index_1_se
 
     SplitIndex *indexes[] = { 
         new SplitIndex1(wordSet, hashType, 1.0f), 
-        new SplitIndexK<1>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -141,7 +167,9 @@ TEST_CASE("is searching words for k = 1 for 1 error one-by-one correct", "[split
 
     SplitIndex *indexes[] = { 
         new SplitIndex1(wordSet, hashType, 1.0f), 
-        new SplitIndexK<1>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -176,7 +204,9 @@ TEST_CASE("is searching words for k = 1 for various number of mismatches correct
 
     SplitIndex *indexes[] = { 
         new SplitIndex1(wordSet, hashType, 1.0f), 
-        new SplitIndexK<1>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -207,4 +237,258 @@ TEST_CASE("is searching words for k = 1 for various number of mismatches correct
     }
 }
 
+TEST_CASE("is searching words for k = 1 with packed keys the same as without", "[split_index_1_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa", "bardzo", "lubie", "owoce" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
+
+    SplitIndex *packedIndexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        packedIndexes[iIndex]->setKeyPacking(true);
+        packedIndexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                // 'N' is outside the alphabet, while 'a' is a part of it.
+                for (const char c : { 'N', 'a' })
+                {
+                    string curWord = word;
+                    curWord[i] = c;
+
+                    REQUIRE(packedIndexes[iIndex]->search({ curWord }, 1) == indexes[iIndex]->search({ curWord }, 1));
+                }
+            }
+        }
+
+        delete indexes[iIndex];
+        delete packedIndexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching words for k = 1 with entry sub-indexes the same as without", "[split_index_1_searching]")
+{
+    // Many words share their prefixes and suffixes, so their entries get sub-indexes.
+    unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa" };
+
+    for (const char *affix : { "kot", "bar" })
+    {
+        for (const char c1 : { 'a', 'b', 'c', 'd' })
+        {
+            for (const char c2 : { 'a', 'e', 'k' })
+            {
+                wordSet.insert(affix + string { c1, c2, 'a' });
+                wordSet.insert(string { c1, c2, 'a' } + affix);
+            }
+        }
+    }
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f) };
+
+    SplitIndex *subIndexedIndexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->setSubIndexThreshold(0);
+        indexes[iIndex]->construct();
+
+        subIndexedIndexes[iIndex]->setSubIndexThreshold(2);
+        subIndexedIndexes[iIndex]->construct();
+
+        REQUIRE(subIndexedIndexes[iIndex]->toString().find("With entry sub-indexes") != string::npos);
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                for (const char c : { 'N', 'a' })
+                {
+                    string curWord = word;
+                    curWord[i] = c;
+
+                    REQUIRE(subIndexedIndexes[iIndex]->search({ curWord }, 1) == indexes[iIndex]->search({ curWord }, 1));
+                }
+            }
+        }
+
+        delete indexes[iIndex];
+        delete subIndexedIndexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching word IDs for k = 1 the same as searching words", "[split_index_1_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa", "bardzo", "lubie", "owoce", "kotb", "mb" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndex1Comp(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    // Reused across queries, as for allocation-free searching.
+    vector<SplitIndex::WordId> ids;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+        REQUIRE(indexes[iIndex]->getNWords() == wordSet.size());
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                for (const char c : { 'N', 'a', 'b' })
+                {
+                    string curWord = word;
+                    curWord[i] = c;
+
+                    REQUIRE(searchWordIdsAsWords(*indexes[iIndex], curWord, ids) == indexes[iIndex]->search({ curWord }, 1));
+                }
+            }
+        }
+
+        REQUIRE_THROWS(indexes[iIndex]->searchWordIds("", ids));
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching batches for k = 1 the same as searching single queries", "[split_index_1_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa", "bardzo", "lubie", "owoce", "kotb", "mb" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndex1Comp(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+    vector<string> queries;
+
+    for (const string &word : wordSet)
+    {
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            for (const char c : { 'N', 'a', 'b' })
+            {
+                string curWord = word;
+                curWord[i] = c;
+
+                queries.push_back(curWord);
+            }
+        }
+    }
+
+    vector<SplitIndex::WordId> ids;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        SplitIndex::BatchResults results;
+        vector<vector<SplitIndex::WordId>> callbackIds(queries.size());
+
+        indexes[iIndex]->forEachMatch(queries,
+            [&callbackIds](size_t iQuery, SplitIndex::WordId id) { callbackIds[iQuery].push_back(id); });
+
+        for (int nIter = 1; nIter <= maxNIter; nIter += 3)
+        {
+            indexes[iIndex]->searchBatch(queries, results, nIter);
+
+            REQUIRE(results.getNQueries() == queries.size());
+            REQUIRE(results.offsets.back() == results.wordIds.size());
+
+            for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+            {
+                indexes[iIndex]->searchWordIds(queries[iQuery], ids);
+
+                REQUIRE(results.getNMatches(iQuery) == ids.size());
+                REQUIRE(vector<SplitIndex::WordId>(results.begin(iQuery), results.end(iQuery)) == ids);
+                REQUIRE(callbackIds[iQuery] == ids);
+            }
+        }
+
+        REQUIRE_THROWS(indexes[iIndex]->searchBatch({ "" }, results));
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("are existence and count searches for k = 1 consistent with searching word IDs", "[split_index_1_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa", "bardzo", "lubie", "owoce", "kotb", "mb" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndex1(wordSet, hashType, 1.0f),
+        new SplitIndex1Comp(wordSet, hashType, 1.0f),
+        new SplitIndex1Router(wordSet, hashType, 1.0f),
+        new SplitIndex1Packed(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+    vector<string> queries;
+
+    for (const string &word : wordSet)
+    {
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            for (const char c : { 'N', 'a', 'b' })
+            {
+                string curWord = word;
+                curWord[i] = c;
+
+                queries.push_back(curWord);
+            }
+        }
+    }
+
+    vector<SplitIndex::WordId> ids;
+    vector<char> found;
+    vector<size_t> counts;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        indexes[iIndex]->searchExists(queries, found);
+        indexes[iIndex]->searchCount(queries, counts);
+
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            indexes[iIndex]->searchWordIds(queries[iQuery], ids);
+
+            REQUIRE(indexes[iIndex]->searchExists(queries[iQuery]) == not ids.empty());
+            REQUIRE(indexes[iIndex]->searchCount(queries[iQuery]) == ids.size());
+
+            REQUIRE(found[iQuery] == (ids.empty() ? 0 : 1));
+            REQUIRE(counts[iQuery] == ids.size());
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
 } // namespace split_index
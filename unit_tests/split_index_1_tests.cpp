@@ -18,6 +18,10 @@ namespace
 
 hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
 
+/** Entries start with a counter whose width depends on SPLIT_INDEX_LONG_WORDS. */
+using CounterType = utils::SizeCoding::CounterType;
+constexpr size_t counterSize = sizeof(CounterType);
+
 }
 
 TEST_CASE("does split index 1 throw for empty words", "[split_index_1]")
@@ -68,21 +72,30 @@ TEST_CASE("is word size correctly initialized", "[split_index_1]")
     REQUIRE(index2.calcWordsSizeB() == 19);
 }
 
+TEST_CASE("is match collector storage included in index size", "[split_index_1]")
+{
+    SplitIndex1 index({ "ala", "ma", "kota", "jarek", "da", "psa" }, hashType, 1.0f);
+    index.construct();
+
+    REQUIRE(index.calcHashMapSizeB() > index.calcWordsSizeB());
+    REQUIRE(index.toString().find("With match collector: #word IDs = 6") != string::npos);
+}
+
 TEST_CASE("is entry size calculation correct", "[split_index_1]")
 {
     SplitIndex1 index({ "index" }, hashType, 1.0f);
 
     char *entry = SplitIndex1Whitebox::createEntry(index, "ala", 3, true);
-    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == 7);
+    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == counterSize + 5);
 
     SplitIndex1Whitebox::addToEntry(index, &entry, "ada", 3, true);
-    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == 11);
+    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == counterSize + 9);
 
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, false);
-    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == 17);
+    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == counterSize + 15);
 
     SplitIndex1Whitebox::addToEntry(index, &entry, "pies", 4, false);
-    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == 22);
+    REQUIRE(SplitIndex1Whitebox::calcEntrySizeB(index, entry) == counterSize + 20);
 }
 
 TEST_CASE("is entry word count calculation correct", "[split_index_1]")
@@ -135,7 +148,8 @@ TEST_CASE("is creating suffix entry correct", "[split_index_1]")
     SplitIndex1 index({ "index" }, hashType, 1.0f);
 
     char *entry = SplitIndex1Whitebox::createEntry(index, "ala", 3, true);
-    REQUIRE(memcmp(entry, "\0\0\3ala\0", 7) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0u);
+    REQUIRE(memcmp(entry + counterSize, "\3ala\0", 5) == 0);
 }
 
 TEST_CASE("is creating prefix entry correct", "[split_index_1]")
@@ -144,8 +158,8 @@ TEST_CASE("is creating prefix entry correct", "[split_index_1]")
 
     char *entry = SplitIndex1Whitebox::createEntry(index, "ala", 3, false);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 1u);
-    REQUIRE(memcmp(entry + 2, "\3ala\0", 5) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 1u);
+    REQUIRE(memcmp(entry + counterSize, "\3ala\0", 5) == 0);
 }
 
 TEST_CASE("is adding to entry only suffixes correct", "[split_index_1]")
@@ -156,7 +170,8 @@ TEST_CASE("is adding to entry only suffixes correct", "[split_index_1]")
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, true);
     SplitIndex1Whitebox::addToEntry(index, &entry, "ba", 2, true);
 
-    REQUIRE(memcmp(entry, "\0\0\3ala\5index\2ba\0", 16) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0u);
+    REQUIRE(memcmp(entry + counterSize, "\3ala\5index\2ba\0", 14) == 0);
 }
 
 TEST_CASE("is adding to entry only prefixes correct", "[split_index_1]")
@@ -167,8 +182,8 @@ TEST_CASE("is adding to entry only prefixes correct", "[split_index_1]")
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, false);
     SplitIndex1Whitebox::addToEntry(index, &entry, "ba", 2, false);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 1u);
-    REQUIRE(memcmp(entry + 2, "\3ala\5index\2ba\0", 14) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 1u);
+    REQUIRE(memcmp(entry + counterSize, "\3ala\5index\2ba\0", 14) == 0);
 }
 
 TEST_CASE("is adding to entry prefixes and suffixes correct 1", "[split_index_1]")
@@ -180,8 +195,8 @@ TEST_CASE("is adding to entry prefixes and suffixes correct 1", "[split_index_1]
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, true);
     SplitIndex1Whitebox::addToEntry(index, &entry, "pies", 4, true);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 3u);
-    REQUIRE(memcmp(entry + 2, "\5index\4pies\3ala\0", 16) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 3u);
+    REQUIRE(memcmp(entry + counterSize, "\5index\4pies\3ala\0", 16) == 0);
 }
 
 TEST_CASE("is adding to entry prefixes and suffixes correct 2", "[split_index_1]")
@@ -193,8 +208,8 @@ TEST_CASE("is adding to entry prefixes and suffixes correct 2", "[split_index_1]
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, false);
     SplitIndex1Whitebox::addToEntry(index, &entry, "pies", 4, false);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 2u);
-    REQUIRE(memcmp(entry + 2, "\3ala\5index\4pies\0", 16) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 2u);
+    REQUIRE(memcmp(entry + counterSize, "\3ala\5index\4pies\0", 16) == 0);
 }
 
 TEST_CASE("is advancing by word count in entry with prefixes correct", "[split_index_1]")
@@ -207,14 +222,14 @@ TEST_CASE("is advancing by word count in entry with prefixes correct", "[split_i
     SplitIndex1Whitebox::addToEntry(index, &entry, "dla", 3, false);
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, false);
 
-    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 1);
-    REQUIRE(advanced1 == entry + 6);
+    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 1);
+    REQUIRE(advanced1 == entry + counterSize + 4);
 
-    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 2);
-    REQUIRE(advanced2 == entry + 10);
+    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 2);
+    REQUIRE(advanced2 == entry + counterSize + 8);
 
-    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 3);
-    REQUIRE(advanced3 == entry + 14);
+    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 3);
+    REQUIRE(advanced3 == entry + counterSize + 12);
 }
 
 TEST_CASE("is advancing by word count in entry with suffixes correct", "[split_index_1]")
@@ -227,14 +242,14 @@ TEST_CASE("is advancing by word count in entry with suffixes correct", "[split_i
     SplitIndex1Whitebox::addToEntry(index, &entry, "dla", 3, true);
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, true);
 
-    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 1);
-    REQUIRE(advanced1 == entry + 6);
+    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 1);
+    REQUIRE(advanced1 == entry + counterSize + 4);
 
-    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 2);
-    REQUIRE(advanced2 == entry + 10);
+    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 2);
+    REQUIRE(advanced2 == entry + counterSize + 8);
 
-    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 3);
-    REQUIRE(advanced3 == entry + 14);
+    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 3);
+    REQUIRE(advanced3 == entry + counterSize + 12);
 }
 
 TEST_CASE("is advancing by word count in entry with prefixes and suffixes correct", "[split_index_1]")
@@ -247,14 +262,14 @@ TEST_CASE("is advancing by word count in entry with prefixes and suffixes correc
     SplitIndex1Whitebox::addToEntry(index, &entry, "dla", 3, true);
     SplitIndex1Whitebox::addToEntry(index, &entry, "index", 5, false);
 
-    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 1);
-    REQUIRE(advanced1 == entry + 6);
+    char *advanced1 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 1);
+    REQUIRE(advanced1 == entry + counterSize + 4);
 
-    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 2);
-    REQUIRE(advanced2 == entry + 10);
+    char *advanced2 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 2);
+    REQUIRE(advanced2 == entry + counterSize + 8);
 
-    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + 2, 3);
-    REQUIRE(advanced3 == entry + 14);
+    char *advanced3 = SplitIndex1Whitebox::advanceInEntryByWordCount(index, entry + counterSize, 3);
+    REQUIRE(advanced3 == entry + counterSize + 12);
 }
 
 } // namespace split_index
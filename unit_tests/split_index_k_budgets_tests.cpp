@@ -0,0 +1,159 @@
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+#include "repeat.hpp"
+
+#include "split_index_k_budgets_whitebox.hpp"
+
+#include "../src/index/split_index_k.hpp"
+#include "../src/index/split_index_k_budgets.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+constexpr int maxNIter = 10;
+
+}
+
+TEST_CASE("does split index k budgets throw for bad k", "[split_index_k_budgets]")
+{
+    REQUIRE_THROWS(SplitIndexKBudgets<0>({ "ala" }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKBudgets<100>({ "ala" }, hashType, 1.0f));
+}
+
+TEST_CASE("does split index k budgets throw for empty words", "[split_index_k_budgets]")
+{
+    REQUIRE_THROWS(SplitIndexKBudgets<1>({ }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKBudgets<2>({ }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKBudgets<3>({ }, hashType, 1.0f));
+}
+
+TEST_CASE("are schemes for error budgets correct", "[split_index_k_budgets]")
+{
+    using Scheme = pair<vector<size_t>, vector<size_t>>;
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<3>(8, 2) == Scheme({ 0, 4, 8 }, { 1, 1 }));
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<3>(8, 3) == Scheme({ 0, 4, 6, 8 }, { 1, 0, 0 }));
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<3>(8, 4) == Scheme({ 0, 2, 4, 6, 8 }, { 0, 0, 0, 0 }));
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<2>(9, 2) == Scheme({ 0, 6, 9 }, { 1, 0 }));
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<2>(9, 3) == Scheme({ 0, 3, 6, 9 }, { 0, 0, 0 }));
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<1>(5, 2) == Scheme({ 0, 2, 5 }, { 0, 0 }));
+
+    // Parts cannot be empty for the shortest words.
+    REQUIRE(SplitIndexKBudgetsWhitebox::makeScheme<3>(4, 3) == Scheme({ 0, 2, 3, 4 }, { 1, 0, 0 }));
+}
+
+TEST_CASE("is the number of neighbors correct", "[split_index_k_budgets]")
+{
+    SplitIndexKBudgets<2> index({ "acgt", "ttga" }, hashType, 1.0f);
+    index.construct();
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::getAlphabet(index) == vector<char>({ 'a', 'c', 'g', 't' }));
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::calcNNeighbors(index, 5, 0) == 1.0);
+    REQUIRE(SplitIndexKBudgetsWhitebox::calcNNeighbors(index, 5, 1) == 1.0 + 5 * 3);
+    REQUIRE(SplitIndexKBudgetsWhitebox::calcNNeighbors(index, 5, 2) == 1.0 + 5 * 3 + 10 * 9);
+    REQUIRE(SplitIndexKBudgetsWhitebox::calcNNeighbors(index, 1, 2) == 1.0 + 3);
+}
+
+TEST_CASE("are fewer parts chosen for long words over a small alphabet", "[split_index_k_budgets]")
+{
+    // Entries for short parts are long, so longer parts with neighborhood probes are cheaper.
+    mt19937 gen(1);
+    const vector<string> words = generateWords(5000, "ab", 20, 20, gen);
+    const unordered_set<string> binaryWords(words.begin(), words.end());
+
+    SplitIndexKBudgets<3> indexBinary(binaryWords, hashType, 1.0f);
+    indexBinary.construct();
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexBinary, 20) < 4);
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexBinary, 19) == 0);
+
+    // Neighborhoods over a large alphabet are costly, so the standard split is used for a few short words.
+    SplitIndexKBudgets<3> indexShort({ "kota", "jarek", "bardzo", "lubie", "owoce" }, hashType, 1.0f);
+    indexShort.construct();
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexShort, 5) == 4);
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexShort, 6) == 4);
+}
+
+TEST_CASE("is searching words for k = 2, 3 with error budgets for various number of mismatches correct", "[split_index_k_budgets]")
+{
+    const unordered_set<string> wordSet { "kota", "jarek", "bardzo", "lubie", "owoce" };
+
+    SplitIndexKBudgets<2> indexk2(wordSet, hashType, 1.0f);
+    SplitIndexKBudgets<3> indexk3(wordSet, hashType, 1.0f);
+
+    indexk2.construct();
+    indexk3.construct();
+
+    for (int nIter = 1; nIter <= maxNIter; ++nIter)
+    {
+        REQUIRE(indexk2.search({ "jacek", "gacek" }, nIter) == SplitIndex::ResultSetType{ "jarek" });
+        REQUIRE(indexk2.search({ "barczo", "darczo" }, nIter) == SplitIndex::ResultSetType{ "bardzo" });
+        REQUIRE(indexk2.search({ "darcza", "pccek", "jaxyz", "xyzw" }, nIter).empty());
+
+        REQUIRE(indexk3.search({ "kott", "ccca" }, nIter) == SplitIndex::ResultSetType{ "kota" });
+        REQUIRE(indexk3.search({ "owddd" }, nIter) == SplitIndex::ResultSetType{ "owoce" });
+        REQUIRE(indexk3.search({ "odddd", "aaaaa" }, nIter).empty());
+    }
+}
+
+TEST_CASE("is searching words over a small alphabet for k = 2, 3 with error budgets the same as without", "[split_index_k_budgets]")
+{
+    // Long entries make neighborhood probes worthwhile.
+    mt19937 gen(1);
+    const vector<string> words = generateWords(5000, "ab", 20, 20, gen);
+    const unordered_set<string> wordSet(words.begin(), words.end());
+
+    SplitIndexK<2> indexk2(wordSet, hashType, 1.0f);
+    SplitIndexK<3> indexk3(wordSet, hashType, 1.0f);
+
+    SplitIndexKBudgets<2> indexk2Budgets(wordSet, hashType, 1.0f);
+    SplitIndexKBudgets<3> indexk3Budgets(wordSet, hashType, 1.0f);
+
+    SplitIndexKBudgets<3> indexk3BudgetsPacked(wordSet, hashType, 1.0f);
+    indexk3BudgetsPacked.setKeyPacking(true);
+
+    indexk2.construct();
+    indexk3.construct();
+    indexk2Budgets.construct();
+    indexk3Budgets.construct();
+    indexk3BudgetsPacked.construct();
+
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexk2Budgets, 20) < 3);
+    REQUIRE(SplitIndexKBudgetsWhitebox::getNParts(indexk3Budgets, 20) < 4);
+
+    size_t iWord = 0;
+
+    for (const string &word : wordSet)
+    {
+        // Verification is slow for too many queries.
+        if (iWord++ % 50 != 0)
+        {
+            continue;
+        }
+
+        // The last substitution uses a char outside the alphabet.
+        const string curWord = substituteChars(substituteChars(word, 2, "ab", gen), 1, "N", gen);
+
+        REQUIRE(indexk2Budgets.search({ curWord }, 1) == indexk2.search({ curWord }, 1));
+        REQUIRE(indexk3Budgets.search({ curWord }, 1) == indexk3.search({ curWord }, 1));
+        REQUIRE(indexk3BudgetsPacked.search({ curWord }, 1) == indexk3.search({ curWord }, 1));
+    }
+}
+
+} // namespace split_index
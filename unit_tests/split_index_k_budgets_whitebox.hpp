@@ -0,0 +1,48 @@
+#ifndef SPLIT_INDEX_K_BUDGETS_WHITEBOX_HPP
+#define SPLIT_INDEX_K_BUDGETS_WHITEBOX_HPP
+
+#ifndef SPLIT_INDEX_K_BUDGETS_WHITEBOX
+#define SPLIT_INDEX_K_BUDGETS_WHITEBOX \
+    friend struct SplitIndexKBudgetsWhitebox;
+#endif
+
+#include "../src/index/split_index_k_budgets.hpp"
+
+namespace split_index
+{
+
+struct SplitIndexKBudgetsWhitebox
+{
+    SplitIndexKBudgetsWhitebox() = delete;
+
+    /** Returns the part starts and budgets of a scheme for [wordSize] with [nParts] parts. */
+    template<size_t k>
+    inline static std::pair<std::vector<size_t>, std::vector<size_t>> makeScheme(size_t wordSize, size_t nParts)
+    {
+        const typename SplitIndexKBudgets<k>::Scheme scheme = SplitIndexKBudgets<k>::makeScheme(wordSize, nParts);
+        return { scheme.partStarts, scheme.budgets };
+    }
+
+    /** Returns the number of parts chosen for [wordSize], 0 if there is no scheme for this size. */
+    template<size_t k>
+    inline static size_t getNParts(const SplitIndexKBudgets<k> &index, size_t wordSize)
+    {
+        return index.schemes[wordSize].budgets.size();
+    }
+
+    template<size_t k>
+    inline static const std::vector<char> &getAlphabet(const SplitIndexKBudgets<k> &index)
+    {
+        return index.alphabet;
+    }
+
+    template<size_t k>
+    inline static double calcNNeighbors(const SplitIndexKBudgets<k> &index, size_t partSize, size_t budget)
+    {
+        return index.calcNNeighbors(partSize, budget);
+    }
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_K_BUDGETS_WHITEBOX_HPP
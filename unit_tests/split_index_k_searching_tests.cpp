@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+
 #include "catch.hpp"
 #include "repeat.hpp"
 
 #include "../src/index/split_index_k.hpp"
+#include "../src/index/split_index_k_comp.hpp"
 
 using namespace split_index;
 using namespace std;
@@ -15,6 +21,21 @@ namespace
 hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
 constexpr int maxNIter = 10;
 
+/** Returns the words whose IDs are reported by [index] for [query], each ID must be reported only once. */
+SplitIndex::ResultSetType searchWordIdsAsWords(SplitIndex &index, const string &query, vector<SplitIndex::WordId> &ids)
+{
+    index.searchWordIds(query, ids);
+    SplitIndex::ResultSetType ret;
+
+    for (const SplitIndex::WordId id : ids)
+    {
+        REQUIRE(id < index.getNWords());
+        REQUIRE(ret.insert(index.getWord(id)).second);
+    }
+
+    return ret;
+}
+
 }
 
 TEST_CASE("is searching empty patterns correct for k > 1", "[split_index_k_searching]")
@@ -22,7 +43,9 @@ TEST_CASE("is searching empty patterns correct for k > 1", "[split_index_k_searc
     const unordered_set<string> wordSet { "alama", "kota", "jarek", "lubi" };
     SplitIndex *indexes[] = {
         new SplitIndexK<2>(wordSet, hashType, 1.0f),
-        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -46,7 +69,9 @@ TEST_CASE("is searching words exact correct for k > 1", "[split_index_k_searchin
 
     SplitIndex *indexes[] = {
         new SplitIndexK<2>({ words.begin(), words.end() }, hashType, 1.0f),
-        new SplitIndexK<3>({ words.begin(), words.end() }, hashType, 1.0f) };
+        new SplitIndexK<3>({ words.begin(), words.end() }, hashType, 1.0f),
+        new SplitIndexKComp<2>({ words.begin(), words.end() }, hashType, 1.0f),
+        new SplitIndexKComp<3>({ words.begin(), words.end() }, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -71,7 +96,9 @@ TEST_CASE("is searching words exact one-by-one correct for k > 1", "[split_index
 
     SplitIndex *indexes[] = {
         new SplitIndexK<2>(wordSet, hashType, 1.0f),
-        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -102,7 +129,9 @@ TEST_CASE("is searching for k > 1 for 1 error correct", "[split_index_k_searchin
 
     SplitIndex *indexes[] = {
         new SplitIndexK<2>(wordSet, hashType, 1.0f),
-        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
 
     const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
 
@@ -217,4 +246,452 @@ TEST_CASE("is searching words for k = 3 for various number of mismatches correct
     }
 }
 
+TEST_CASE("is searching words for k = 2, 3 with compression the same as without", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "ala", "kota", "jarek", "psa", "bardzo", "lubie", "owoce", "kotara", "barwa",
+        "owocowe", "jarmark", "bardziej", "lubiane" };
+
+    // Words for k = 3 must have at least 4 characters.
+    unordered_set<string> wordSetk3;
+    copy_if(wordSet.begin(), wordSet.end(), inserter(wordSetk3, wordSetk3.end()),
+        [](const string &word) { return word.size() >= 4; });
+
+    SplitIndexK<2> indexk2(wordSet, hashType, 1.0f);
+    SplitIndexKComp<2> indexk2Comp(wordSet, hashType, 1.0f);
+    SplitIndexK<3> indexk3(wordSetk3, hashType, 1.0f);
+    SplitIndexKComp<3> indexk3Comp(wordSetk3, hashType, 1.0f);
+
+    indexk2.construct();
+    indexk2Comp.construct();
+    indexk3.construct();
+    indexk3Comp.construct();
+
+    for (const string &word : wordSet)
+    {
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            string curWord = word;
+
+            curWord[i] = 'N';
+            curWord[(i + 2) % word.size()] = 'N';
+
+            REQUIRE(indexk2Comp.search({ curWord }, 1) == indexk2.search({ curWord }, 1));
+
+            if (curWord.size() >= 4)
+            {
+                REQUIRE(indexk3Comp.search({ curWord }, 1) == indexk3.search({ curWord }, 1));
+            }
+        }
+    }
+}
+
+TEST_CASE("is searching words for k = 2, 3 with packed keys the same as without", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "kota", "jarek", "bardzo", "lubie", "owoce", "kotara", "barwa",
+        "owocowe", "jarmark", "bardziej", "lubiane" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    SplitIndex *packedIndexes[] = {
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        packedIndexes[iIndex]->setKeyPacking(true);
+        packedIndexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string curWord = word;
+
+                curWord[i] = 'N';
+                curWord[(i + 2) % word.size()] = 'a';
+
+                REQUIRE(packedIndexes[iIndex]->search({ curWord }, 1) == indexes[iIndex]->search({ curWord }, 1));
+            }
+        }
+
+        delete indexes[iIndex];
+        delete packedIndexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching words for k = 2, 3 with tuned split points the same as without", "[split_index_k_searching]")
+{
+    // Many words share their prefixes, so tuning moves the split points.
+    const unordered_set<string> wordSet { "konto", "kontrola", "kontrakt", "kontur", "kontener", "konteksty", "kontynent",
+        "przedmiot", "przedszkole", "przedwczoraj", "przedsionek", "bardzo", "lubie", "owoce", "barwa", "jarmark" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    SplitIndex *untunedIndexes[] = {
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        untunedIndexes[iIndex]->setSplitPointTuning(false);
+        untunedIndexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string curWord = word;
+
+                curWord[i] = 'N';
+                curWord[(i + 3) % word.size()] = 'a';
+
+                REQUIRE(indexes[iIndex]->search({ curWord }, 1) == untunedIndexes[iIndex]->search({ curWord }, 1));
+            }
+        }
+
+        delete indexes[iIndex];
+        delete untunedIndexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching words for k = 1, 2, 3 with entry sub-indexes the same as without", "[split_index_k_searching]")
+{
+    // Many words share their parts, so their entries get sub-indexes.
+    unordered_set<string> wordSet { "kota", "jarek", "bardzo", "lubie", "owoce", "barwa", "jarmark" };
+
+    for (const char c1 : { 'a', 'b', 'c', 'd' })
+    {
+        for (const char c2 : { 'a', 'e', 'k' })
+        {
+            wordSet.insert(string("kotar") + c1 + c2 + "ra");
+            wordSet.insert(string("kot") + c1 + c2 + "ar");
+            wordSet.insert(string { c1, 'o', c2 } + "owocowe");
+        }
+    }
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+
+    SplitIndex *subIndexedIndexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->setSubIndexThreshold(0);
+        indexes[iIndex]->construct();
+
+        subIndexedIndexes[iIndex]->setSubIndexThreshold(2);
+        subIndexedIndexes[iIndex]->construct();
+
+        REQUIRE(subIndexedIndexes[iIndex]->toString().find("With entry sub-indexes") != string::npos);
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string curWord = word;
+
+                curWord[i] = 'N';
+                curWord[(i + 3) % word.size()] = 'a';
+
+                REQUIRE(subIndexedIndexes[iIndex]->search({ curWord }, 1) == indexes[iIndex]->search({ curWord }, 1));
+            }
+        }
+
+        delete indexes[iIndex];
+        delete subIndexedIndexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching words of max size correct for k = 1, 2, 3", "[split_index_k_searching]")
+{
+    // Up to 127 chars by default, longer with SPLIT_INDEX_LONG_WORDS.
+    const size_t maxWordSize = utils::SizeCoding::maxWordSize;
+
+    const string word1 = string(maxWordSize, 'a');
+    const string word2 = string(maxWordSize / 2, 'c') + string(maxWordSize - maxWordSize / 2, 'g');
+
+    const unordered_set<string> wordSet { word1, word2, "alama", "kota" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        string query1 = word1, query2 = word2;
+
+        // iIndex + 1 mismatches spread over the whole word.
+        for (int iError = 0; iError <= iIndex; ++iError)
+        {
+            query1[(iError * maxWordSize) / (iIndex + 1)] = 't';
+            query2[maxWordSize - 1 - (iError * maxWordSize) / (iIndex + 1)] = 't';
+        }
+
+        REQUIRE(indexes[iIndex]->search({ query1, query2, "alama" }, 1) == SplitIndex::ResultSetType{ word1, word2, "alama" });
+        REQUIRE_THROWS(indexes[iIndex]->search({ string(maxWordSize + 1, 'a') }));
+
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching word IDs for k = 1, 2, 3 the same as searching words", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "alama", "kotka", "jarek", "psami", "bardzo", "lubie", "owoce", "kotki", "jacek" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    // Reused across queries, as for allocation-free searching.
+    vector<SplitIndex::WordId> ids;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string curWord = word;
+
+                curWord[i] = 'N';
+                curWord[(i + 2) % word.size()] = 'k';
+
+                REQUIRE(searchWordIdsAsWords(*indexes[iIndex], curWord, ids) == indexes[iIndex]->search({ curWord }, 1));
+            }
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("are existence and count searches for k = 1, 2, 3 consistent with searching word IDs", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "alama", "kotka", "jarek", "psami", "bardzo", "lubie", "owoce", "kotki", "jacek", "kotek", "kitka", "kotko" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    // Indexes 3 and 4 search entries using sub-indexes.
+    const int iSubIndexedStart = 3, iSubIndexedEnd = 5;
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+    vector<string> queries;
+
+    for (const string &word : wordSet)
+    {
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            for (const char c : { 'N', 'a', 'k', 't' })
+            {
+                string curWord = word;
+                curWord[i] = c;
+
+                queries.push_back(curWord);
+            }
+        }
+    }
+
+    vector<SplitIndex::WordId> ids;
+    vector<char> found;
+    vector<size_t> counts;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        if (iIndex >= iSubIndexedStart and iIndex < iSubIndexedEnd)
+        {
+            indexes[iIndex]->setSubIndexThreshold(1);
+        }
+
+        indexes[iIndex]->construct();
+
+        indexes[iIndex]->searchExists(queries, found);
+        indexes[iIndex]->searchCount(queries, counts);
+
+        for (size_t iQuery = 0; iQuery < queries.size(); ++iQuery)
+        {
+            indexes[iIndex]->searchWordIds(queries[iQuery], ids);
+
+            REQUIRE(indexes[iIndex]->searchExists(queries[iQuery]) == not ids.empty());
+            REQUIRE(indexes[iIndex]->searchCount(queries[iQuery]) == ids.size());
+
+            REQUIRE(found[iQuery] == (ids.empty() ? 0 : 1));
+            REQUIRE(counts[iQuery] == ids.size());
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("are distances and mismatch positions of matches for k = 1, 2, 3 correct", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "alama", "kotka", "jarek", "psami", "bardzo", "lubie", "owoce", "kotki", "jacek" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<2>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    vector<SplitIndex::WordId> ids;
+    vector<SplitIndex::Match> matches;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                for (const char c : { 'N', 'a', 'k' })
+                {
+                    string query = word;
+                    query[i] = c;
+
+                    indexes[iIndex]->searchWordIds(query, ids);
+                    indexes[iIndex]->searchMatches(query, matches, true);
+
+                    vector<SplitIndex::WordId> matchIds;
+                    transform(matches.begin(), matches.end(), back_inserter(matchIds),
+                        [](const SplitIndex::Match &match) { return match.id; });
+
+                    REQUIRE(is_permutation(ids.begin(), ids.end(), matchIds.begin(), matchIds.end()));
+
+                    for (size_t iMatch = 0; iMatch < matches.size(); ++iMatch)
+                    {
+                        const SplitIndex::Match &match = matches[iMatch];
+                        const string matchWord = indexes[iIndex]->getWord(match.id);
+
+                        REQUIRE(match.distance == utils::Distance::calcHamming(matchWord.c_str(), query.c_str(), query.size()));
+
+                        for (size_t iPos = 0; iPos < match.distance; ++iPos)
+                        {
+                            REQUIRE(matchWord[match.mismatchPositions[iPos]] != query[match.mismatchPositions[iPos]]);
+                        }
+
+                        if (iMatch > 0)
+                        {
+                            REQUIRE(matches[iMatch - 1].distance <= match.distance);
+                        }
+                    }
+                }
+            }
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("are top matches with payloads for k = 1, 2, 3 the best of all matches", "[split_index_k_searching]")
+{
+    const unordered_set<string> wordSet { "alama", "kotka", "jarek", "psami", "bardzo", "lubie", "owoce", "kotki", "jacek" };
+    unordered_map<string, SplitIndex::Payload> wordPayloads;
+
+    for (const string &word : wordSet)
+    {
+        wordPayloads[word] = word[1] + word[3];
+    }
+
+    SplitIndex *indexes[] = {
+        new SplitIndexK<1>(wordSet, hashType, 1.0f),
+        new SplitIndexK<2>(wordSet, hashType, 1.0f),
+        new SplitIndexK<3>(wordSet, hashType, 1.0f),
+        new SplitIndexKComp<3>(wordSet, hashType, 1.0f) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    vector<SplitIndex::Match> matches, topMatches;
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->setWordPayloads(wordPayloads);
+        indexes[iIndex]->construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string query = word;
+                query[i] = 'k';
+
+                indexes[iIndex]->searchMatches(query, matches);
+
+                for (SplitIndex::Match &match : matches)
+                {
+                    REQUIRE(match.payload == wordPayloads.at(indexes[iIndex]->getWord(match.id)));
+                }
+
+                sort(matches.begin(), matches.end(), [](const SplitIndex::Match &m1, const SplitIndex::Match &m2)
+                {
+                    return make_tuple(m1.distance, -static_cast<int64_t>(m1.payload), m1.id)
+                        < make_tuple(m2.distance, -static_cast<int64_t>(m2.payload), m2.id);
+                });
+
+                for (size_t nTop : { 1, 2, 5 })
+                {
+                    indexes[iIndex]->searchTopMatches(query, nTop, topMatches);
+                    REQUIRE(topMatches.size() == min(nTop, matches.size()));
+
+                    for (size_t iMatch = 0; iMatch < topMatches.size(); ++iMatch)
+                    {
+                        REQUIRE(topMatches[iMatch].id == matches[iMatch].id);
+                        REQUIRE(topMatches[iMatch].distance == matches[iMatch].distance);
+                        REQUIRE(topMatches[iMatch].payload == matches[iMatch].payload);
+                    }
+                }
+            }
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
 } // namespace split_index
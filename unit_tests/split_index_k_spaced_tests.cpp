@@ -0,0 +1,108 @@
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+#include "repeat.hpp"
+
+#include "../src/index/split_index_k_spaced.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+constexpr int maxNIter = 10;
+
+}
+
+TEST_CASE("does split index k spaced throw for bad params", "[split_index_k_spaced]")
+{
+    REQUIRE_THROWS(SplitIndexKSpaced<0>({ "ala" }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKSpaced<100>({ "ala" }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKSpaced<2>({ "ala" }, hashType, 1.0f, 0));
+    REQUIRE_THROWS(SplitIndexKSpaced<2>({ }, hashType, 1.0f));
+}
+
+TEST_CASE("is searching words for k = 2, 3 with spaced seeds for various number of mismatches correct", "[split_index_k_spaced]")
+{
+    const unordered_set<string> wordSet { "kota", "jarek", "bardzo", "lubie", "owoce" };
+
+    SplitIndexKSpaced<2> indexk2(wordSet, hashType, 1.0f);
+    SplitIndexKSpaced<3> indexk3(wordSet, hashType, 1.0f, 2);
+
+    indexk2.construct();
+    indexk3.construct();
+
+    for (int nIter = 1; nIter <= maxNIter; ++nIter)
+    {
+        REQUIRE(indexk2.search({ "jacek", "gacek" }, nIter) == SplitIndex::ResultSetType{ "jarek" });
+        REQUIRE(indexk2.search({ "barczo", "darczo" }, nIter) == SplitIndex::ResultSetType{ "bardzo" });
+        REQUIRE(indexk2.search({ "darcza", "pccek", "jaxyz", "xyzw" }, nIter).empty());
+
+        REQUIRE(indexk3.search({ "kott", "ccca" }, nIter) == SplitIndex::ResultSetType{ "kota" });
+        REQUIRE(indexk3.search({ "owddd" }, nIter) == SplitIndex::ResultSetType{ "owoce" });
+        REQUIRE(indexk3.search({ "odddd", "aaaaa" }, nIter).empty());
+    }
+}
+
+TEST_CASE("is searching words for k = 1, 2, 3 with spaced seeds the same as brute force", "[split_index_k_spaced]")
+{
+    // Words of various sizes over a small alphabet with runs, including words longer than SIMD gathering handles.
+    mt19937 gen(1);
+    const vector<string> prefixes = generateWords(2000, "acgt", 2, 20, gen);
+
+    unordered_set<string> wordSet;
+
+    for (size_t iWord = 0; iWord < prefixes.size(); ++iWord)
+    {
+        wordSet.insert(prefixes[iWord] + string(prefixes[iWord].size() + iWord % 2, 'a'));
+    }
+
+    for (size_t seedBlockSize = 1; seedBlockSize <= 3; ++seedBlockSize)
+    {
+        SplitIndexKSpaced<1> indexk1Spaced(wordSet, hashType, 1.0f, seedBlockSize);
+        SplitIndexKSpaced<2> indexk2Spaced(wordSet, hashType, 1.0f, seedBlockSize);
+        SplitIndexKSpaced<3> indexk3Spaced(wordSet, hashType, 1.0f, seedBlockSize);
+
+        SplitIndexKSpaced<3> indexk3SpacedPacked(wordSet, hashType, 1.0f, seedBlockSize);
+        indexk3SpacedPacked.setKeyPacking(true);
+
+        indexk1Spaced.construct();
+        indexk2Spaced.construct();
+        indexk3Spaced.construct();
+        indexk3SpacedPacked.construct();
+
+        size_t iWord = 0;
+
+        for (const string &word : wordSet)
+        {
+            if (iWord++ % 20 != 0)
+            {
+                continue;
+            }
+
+            string curWord = word;
+
+            curWord[0] = 'c';
+            REQUIRE(indexk1Spaced.search({ curWord }, 1) == searchBruteForce(wordSet, curWord, 1));
+
+            curWord[curWord.size() - 1] = 'N';
+            REQUIRE(indexk2Spaced.search({ curWord }, 1) == searchBruteForce(wordSet, curWord, 2));
+
+            curWord[curWord.size() / 2] = 'g';
+            const SplitIndex::ResultSetType expected = searchBruteForce(wordSet, curWord, 3);
+            REQUIRE(indexk3Spaced.search({ curWord }, 1) == expected);
+            REQUIRE(indexk3SpacedPacked.search({ curWord }, 1) == expected);
+        }
+    }
+}
+
+} // namespace split_index
@@ -18,6 +18,10 @@ namespace
 {
 
 hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** Entries start with a counter whose width depends on SPLIT_INDEX_LONG_WORDS. */
+using CounterType = utils::SizeCoding::CounterType;
+constexpr size_t counterSize = sizeof(CounterType);
 constexpr size_t maxK = 3;
 
 }
@@ -101,23 +105,23 @@ TEST_CASE("is k entry size calculation correct", "[split_index_k]")
     SplitIndexK<1> indexk1({ "index" }, hashType, 1.0f);
 
     char *entry = SplitIndexKWhitebox::createEntry(indexk1, "ala", 3, 0);
-    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == 8);
+    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == counterSize + 6);
 
     // 4 words in total -- no additional part bytes added.
 
     SplitIndexKWhitebox::addToEntry(indexk1, &entry, "ada", 3, 0);
-    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == 12);
+    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == counterSize + 10);
 
     SplitIndexKWhitebox::addToEntry(indexk1, &entry, "index", 5, 1);
-    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == 18);
+    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == counterSize + 16);
 
     SplitIndexKWhitebox::addToEntry(indexk1, &entry, "pies", 4, 1);
-    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == 23);
+    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == counterSize + 21);
 
     // 5 words in total -- one additional part byte added.
 
     SplitIndexKWhitebox::addToEntry(indexk1, &entry, "smok", 4, 0);
-    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == 29);
+    REQUIRE(SplitIndexKWhitebox::calcEntrySizeB(indexk1, entry) == counterSize + 27);
 }
 
 TEST_CASE("is k entry word count calculation correct", "[split_index_k]")
@@ -264,15 +268,15 @@ TEST_CASE("is creating entry correct for k = 1", "[split_index_k]")
     // Word = tyradami
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk1, "dami", 4, 0);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
-    REQUIRE(entry1[2] == 0x0u);
-    REQUIRE(memcmp(entry1 + 3, "\4dami\0", 6) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
+    REQUIRE(entry1[counterSize] == 0x0u);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\4dami\0", 6) == 0);
 
     char *entry2 = SplitIndexKWhitebox::createEntry(indexk1, "tyra", 4, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry2) == 1u);
-    REQUIRE(entry2[2] == 0x1u);
-    REQUIRE(memcmp(entry2 + 3, "\4tyra\0", 6) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry2) == 1u);
+    REQUIRE(entry2[counterSize] == 0x1u);
+    REQUIRE(memcmp(entry2 + counterSize + 1, "\4tyra\0", 6) == 0);
 }
 
 TEST_CASE("is creating entry correct for k = 2", "[split_index_k]")
@@ -282,21 +286,21 @@ TEST_CASE("is creating entry correct for k = 2", "[split_index_k]")
     // Word = tyradami
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk2, "radami", 6, 0);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
-    REQUIRE(entry1[2] == 0x0u);
-    REQUIRE(memcmp(entry1 + 3, "\6radami\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
+    REQUIRE(entry1[counterSize] == 0x0u);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\6radami\0", 8) == 0);
 
     char *entry2 = SplitIndexKWhitebox::createEntry(indexk2, "tydami", 6, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry2) == 1u);
-    REQUIRE(entry2[2] == 0x1u);
-    REQUIRE(memcmp(entry2 + 3, "\6tydami\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry2) == 1u);
+    REQUIRE(entry2[counterSize] == 0x1u);
+    REQUIRE(memcmp(entry2 + counterSize + 1, "\6tydami\0", 8) == 0);
 
     char *entry3 = SplitIndexKWhitebox::createEntry(indexk2, "tyra", 4, 2);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry3) == 1u);
-    REQUIRE(entry3[2] == 0x2u);
-    REQUIRE(memcmp(entry3 + 3, "\4tyra\0", 6) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry3) == 1u);
+    REQUIRE(entry3[counterSize] == 0x2u);
+    REQUIRE(memcmp(entry3 + counterSize + 1, "\4tyra\0", 6) == 0);
 }
 
 TEST_CASE("is creating entry correct for k = 3", "[split_index_k]")
@@ -306,27 +310,27 @@ TEST_CASE("is creating entry correct for k = 3", "[split_index_k]")
     // Word = tyradami
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk3, "radami", 6, 0);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
-    REQUIRE(entry1[2] == 0x0u);
-    REQUIRE(memcmp(entry1 + 3, "\6radami\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
+    REQUIRE(entry1[counterSize] == 0x0u);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\6radami\0", 8) == 0);
 
     char *entry2 = SplitIndexKWhitebox::createEntry(indexk3, "tydami", 6, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry2) == 1u);
-    REQUIRE(entry2[2] == 0x1u);
-    REQUIRE(memcmp(entry2 + 3, "\6tydami\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry2) == 1u);
+    REQUIRE(entry2[counterSize] == 0x1u);
+    REQUIRE(memcmp(entry2 + counterSize + 1, "\6tydami\0", 8) == 0);
 
     char *entry3 = SplitIndexKWhitebox::createEntry(indexk3, "tyrami", 6, 2);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry3) == 1u);
-    REQUIRE(entry3[2] == 0x2u);
-    REQUIRE(memcmp(entry3 + 3, "\6tyrami\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry3) == 1u);
+    REQUIRE(entry3[counterSize] == 0x2u);
+    REQUIRE(memcmp(entry3 + counterSize + 1, "\6tyrami\0", 8) == 0);
 
     char *entry4 = SplitIndexKWhitebox::createEntry(indexk3, "tyrada", 6, 3);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry4) == 1u);
-    REQUIRE(entry4[2] == 0x3u);
-    REQUIRE(memcmp(entry4 + 3, "\6tyrada\0", 8) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry4) == 1u);
+    REQUIRE(entry4[counterSize] == 0x3u);
+    REQUIRE(memcmp(entry4 + counterSize + 1, "\6tyrada\0", 8) == 0);
 }
 
 TEST_CASE("is adding to entry correct for k = 1", "[split_index_k]")
@@ -337,10 +341,10 @@ TEST_CASE("is adding to entry correct for k = 1", "[split_index_k]")
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk1, "ami", 3, 0);
     SplitIndexKWhitebox::addToEntry(indexk1, &entry1, "ps", 2, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
 
-    REQUIRE(entry1[2] == 0b00000100);
-    REQUIRE(memcmp(entry1 + 3, "\3ami\2ps\0", 8) == 0);
+    REQUIRE(entry1[counterSize] == 0b00000100);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\3ami\2ps\0", 8) == 0);
 }
 
 TEST_CASE("is adding to entry correct for k = 2", "[split_index_k]")
@@ -353,9 +357,9 @@ TEST_CASE("is adding to entry correct for k = 2", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tydami", 6, 1);
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tyra", 4, 2);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
-    REQUIRE(entry1[2] == 0b00100100);
-    REQUIRE(memcmp(entry1 + 3, "\6radami\6tydami\4tyra\0", 20) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
+    REQUIRE(entry1[counterSize] == 0b00100100);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\6radami\6tydami\4tyra\0", 20) == 0);
 }
 
 TEST_CASE("is adding to entry correct for k = 3", "[split_index_k]")
@@ -369,9 +373,9 @@ TEST_CASE("is adding to entry correct for k = 3", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrami", 6, 2);
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrada", 6, 3);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry1) == 1u);
-    REQUIRE(entry1[2] == 0b11100100);
-    REQUIRE(memcmp(entry1 + 3, "\6radami\6tydami\6tyrami\6tyrada\0", 29) == 0);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry1) == 1u);
+    REQUIRE(entry1[counterSize] == 0b11100100);
+    REQUIRE(memcmp(entry1 + counterSize + 1, "\6radami\6tydami\6tyrami\6tyrada\0", 29) == 0);
 }
 
 TEST_CASE("is trying match part correct empty for k = 1", "[split_index_k]")
@@ -382,7 +386,7 @@ TEST_CASE("is trying match part correct empty for k = 1", "[split_index_k]")
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk1, "ami", 3, 0);
     SplitIndexKWhitebox::addToEntry(indexk1, &entry1, "ps", 2, 1);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "pscci";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk1, query1);
@@ -407,7 +411,7 @@ TEST_CASE("is trying match part correct matches for k = 1", "[split_index_k]")
     char *entry1 = SplitIndexKWhitebox::createEntry(indexk1, "ami", 3, 0);
     SplitIndexKWhitebox::addToEntry(indexk1, &entry1, "ps", 2, 1);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "psamk";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk1, query1);
@@ -434,7 +438,7 @@ TEST_CASE("is trying match part correct empty for k = 2", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tydami", 6, 1);
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tyra", 4, 2);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "tyradccc";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk2, query1);
@@ -466,7 +470,7 @@ TEST_CASE("is trying match part correct matches for k = 2", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tydami", 6, 1);
     SplitIndexKWhitebox::addToEntry(indexk2, &entry1, "tyra", 4, 2);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "tyradacc";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk2, query1);
@@ -499,7 +503,7 @@ TEST_CASE("is trying match part correct empty for k = 3", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrami", 6, 2);
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrada", 6, 3);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "tyracccc";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk3, query1);
@@ -540,7 +544,7 @@ TEST_CASE("is trying match part correct matches for k = 3", "[split_index_k]")
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrami", 6, 2);
     SplitIndexKWhitebox::addToEntry(indexk3, &entry1, "tyrada", 6, 3);
 
-    entry1 += 3;
+    entry1 += counterSize + 1;
 
     const string query1 = "tyradccc";
     SplitIndexKWhitebox::storeWordPartsInBuffers(indexk3, query1);
@@ -572,72 +576,72 @@ TEST_CASE("is trying match part correct matches for k = 3", "[split_index_k]")
 
 TEST_CASE("is setting part bits correct", "[split_index_k]")
 {
-    const size_t nBytes = 4;
+    const size_t nBytes = counterSize + 2;
     char *entry = new char[nBytes];
 
     memset(entry, 0x0u, nBytes);
-    *reinterpret_cast<uint16_t *>(entry) = 0x2u;
+    *reinterpret_cast<CounterType *>(entry) = 0x2u;
 
     SplitIndexKWhitebox::setPartBits<3>(entry, 0, 0);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
-    REQUIRE(entry[2] == 0x0u);
-    REQUIRE(entry[3] == 0x0u);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
+    REQUIRE(entry[counterSize] == 0x0u);
+    REQUIRE(entry[counterSize + 1] == 0x0u);
 
     SplitIndexKWhitebox::setPartBits<3>(entry, 0, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
-    REQUIRE(entry[2] == 0x1u);
-    REQUIRE(entry[3] == 0x0u);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
+    REQUIRE(entry[counterSize] == 0x1u);
+    REQUIRE(entry[counterSize + 1] == 0x0u);
 
     SplitIndexKWhitebox::setPartBits<3>(entry, 1, 1);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
-    REQUIRE(entry[2] == 0b00000101);
-    REQUIRE(entry[3] == 0x0u);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
+    REQUIRE(entry[counterSize] == 0b00000101);
+    REQUIRE(entry[counterSize + 1] == 0x0u);
 
     SplitIndexKWhitebox::setPartBits<3>(entry, 2, 2);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
-    REQUIRE(entry[2] == 0b00100101);
-    REQUIRE(entry[3] == 0x0u);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
+    REQUIRE(entry[counterSize] == 0b00100101);
+    REQUIRE(entry[counterSize + 1] == 0x0u);
 
     SplitIndexKWhitebox::setPartBits<3>(entry, 5, 3);
 
-    REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
-    REQUIRE(entry[2] == 0b00100101);
-    REQUIRE(entry[3] == 0b00001100);
+    REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
+    REQUIRE(entry[counterSize] == 0b00100101);
+    REQUIRE(entry[counterSize + 1] == 0b00001100);
 
     delete[] entry;
 }
 
 TEST_CASE("is retrieving part index from bits correct", "[split_index_k]")
 {
-    const size_t nBytes = 4;
+    const size_t nBytes = counterSize + 2;
     char *entry = new char[nBytes];
 
     memset(entry, 0x0u, nBytes);
-    *reinterpret_cast<uint16_t *>(entry) = 0x2u;
+    *reinterpret_cast<CounterType *>(entry) = 0x2u;
 
     for (size_t iWord = 0; iWord < 8; ++iWord)
     {
         REQUIRE(SplitIndexKWhitebox::retrievePartIndexFromBits<3>(entry, iWord) == 0);
-        REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
+        REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
     }
 
-    entry[2] = 0x1u;
+    entry[counterSize] = 0x1u;
     REQUIRE(SplitIndexKWhitebox::retrievePartIndexFromBits<3>(entry, 0) == 1);
     REQUIRE(SplitIndexKWhitebox::retrievePartIndexFromBits<3>(entry, 1) == 0);
 
-    entry[2] = 0b00100101;
-    entry[3] = 0b10001100;
+    entry[counterSize] = 0b00100101;
+    entry[counterSize + 1] = 0b10001100;
 
     vector<size_t> expected{ 1, 1, 2, 0, 0, 3, 0, 2 };
 
     for (size_t iWord = 0; iWord < 8; ++iWord)
     {
         REQUIRE(SplitIndexKWhitebox::retrievePartIndexFromBits<3>(entry, iWord) == expected[iWord]);
-        REQUIRE(*reinterpret_cast<uint16_t *>(entry) == 0x2u);
+        REQUIRE(*reinterpret_cast<CounterType *>(entry) == 0x2u);
     }
 
     delete[] entry;
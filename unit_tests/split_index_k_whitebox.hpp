@@ -66,11 +66,11 @@ struct SplitIndexKWhitebox
     }
 
     template<size_t k>
-    inline static std::string tryMatchPart(const SplitIndexK<k> &index,
+    inline static std::string tryMatchPart(SplitIndexK<k> &index,
         const std::string &query, const char *entry,
         size_t matchSize, size_t iPart)
     {
-        return index.tryMatchPart(query, entry, matchSize, iPart);
+        return index.tryMatchPart(query, entry, matchSize, iPart) ? std::string(index.matchBuf, query.size()) : "";
     }
 
     template<size_t k>
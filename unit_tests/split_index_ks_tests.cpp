@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "split_index_ks_whitebox.hpp"
+
+#include "../src/index/split_index_k.hpp"
+#include "../src/index/split_index_ks.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+constexpr int maxNIter = 10;
+
+}
+
+TEST_CASE("does split index ks throw for bad k", "[split_index_ks]")
+{
+    REQUIRE_THROWS(SplitIndexKS<0>({ "ala" }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKS<100>({ "ala" }, hashType, 1.0f));
+}
+
+TEST_CASE("does split index ks throw for bad #key parts", "[split_index_ks]")
+{
+    REQUIRE_THROWS(SplitIndexKS<2>({ "ala" }, hashType, 1.0f, 0));
+    REQUIRE_THROWS(SplitIndexKS<2>({ "ala" }, hashType, 1.0f, SplitIndexKS<2>::maxNKeyParts + 1));
+
+    REQUIRE_NOTHROW(SplitIndexKS<2>({ "ala" }, hashType, 1.0f, 1));
+    REQUIRE_NOTHROW(SplitIndexKS<2>({ "ala" }, hashType, 1.0f, SplitIndexKS<2>::maxNKeyParts));
+}
+
+TEST_CASE("does split index ks throw for empty words", "[split_index_ks]")
+{
+    REQUIRE_THROWS(SplitIndexKS<1>({ }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKS<2>({ }, hashType, 1.0f));
+    REQUIRE_THROWS(SplitIndexKS<3>({ }, hashType, 1.0f));
+}
+
+TEST_CASE("does split index ks throw for words shorter than k + s", "[split_index_ks]")
+{
+    SplitIndexKS<2> index({ "ala", "kota" }, hashType, 1.0f, 2);
+    REQUIRE_THROWS(index.construct());
+
+    SplitIndexKS<2> indexOneKeyPart({ "ala", "kota" }, hashType, 1.0f, 1);
+    REQUIRE_NOTHROW(indexOneKeyPart.construct());
+}
+
+TEST_CASE("are combinations of key parts correct", "[split_index_ks]")
+{
+    const unordered_set<string> wordSet { "abcdefgh" };
+
+    for (size_t nKeyParts = 1; nKeyParts <= SplitIndexKS<2>::maxNKeyParts; ++nKeyParts)
+    {
+        SplitIndexKS<2> index(wordSet, hashType, 1.0f, nKeyParts);
+
+        const vector<vector<size_t>> &combinations = SplitIndexKSWhitebox::getCombinations(index);
+        const vector<vector<size_t>> &remaining = SplitIndexKSWhitebox::getRemainingPartIndices(index);
+
+        // Binomial coefficients (k + s) choose s for k = 2.
+        const size_t nExpected[] = { 0, 3, 6, 10, 15 };
+
+        REQUIRE(combinations.size() == nExpected[nKeyParts]);
+        REQUIRE(remaining.size() == combinations.size());
+
+        for (size_t iComb = 0; iComb < combinations.size(); ++iComb)
+        {
+            REQUIRE(combinations[iComb].size() == nKeyParts);
+            REQUIRE(remaining[iComb].size() == 2);
+
+            vector<size_t> all;
+            merge(combinations[iComb].begin(), combinations[iComb].end(), remaining[iComb].begin(), remaining[iComb].end(),
+                back_inserter(all));
+
+            for (size_t iPart = 0; iPart < all.size(); ++iPart)
+            {
+                REQUIRE(all[iPart] == iPart);
+            }
+        }
+    }
+}
+
+TEST_CASE("are part starts correct", "[split_index_ks]")
+{
+    SplitIndexKS<2> index({ "abcdefgh" }, hashType, 1.0f, 2);
+
+    SplitIndexKSWhitebox::fillPartStarts(index, 8);
+    REQUIRE(SplitIndexKSWhitebox::getPartStarts(index) == vector<size_t>({ 0, 2, 4, 6, 8 }));
+
+    SplitIndexKSWhitebox::fillPartStarts(index, 10);
+    REQUIRE(SplitIndexKSWhitebox::getPartStarts(index) == vector<size_t>({ 0, 2, 5, 7, 10 }));
+
+    SplitIndexKSWhitebox::fillPartStarts(index, 4);
+    REQUIRE(SplitIndexKSWhitebox::getPartStarts(index) == vector<size_t>({ 0, 1, 2, 3, 4 }));
+}
+
+TEST_CASE("are keys, remaining parts and matches correct", "[split_index_ks]")
+{
+    SplitIndexKS<2> index({ "abcdefgh" }, hashType, 1.0f, 2);
+    const vector<vector<size_t>> &combinations = SplitIndexKSWhitebox::getCombinations(index);
+
+    // Parts are: ab, cd, ef, gh.
+    REQUIRE(combinations[0] == vector<size_t>({ 0, 1 }));
+    REQUIRE(SplitIndexKSWhitebox::getKeyAndRemainingParts(index, "abcdefgh", 0) == make_pair(string("abcd"), string("efgh")));
+
+    REQUIRE(combinations[1] == vector<size_t>({ 0, 2 }));
+    REQUIRE(SplitIndexKSWhitebox::getKeyAndRemainingParts(index, "abcdefgh", 1) == make_pair(string("abef"), string("cdgh")));
+
+    REQUIRE(combinations.back() == vector<size_t>({ 2, 3 }));
+    REQUIRE(SplitIndexKSWhitebox::getKeyAndRemainingParts(index, "abcdefgh", combinations.size() - 1)
+        == make_pair(string("efgh"), string("abcd")));
+
+    REQUIRE(SplitIndexKSWhitebox::getMatch(index, "abcdNNNN", 0, "efgh") == "abcdefgh");
+    REQUIRE(SplitIndexKSWhitebox::getMatch(index, "abNNefNN", 1, "cdgh") == "abcdefgh");
+    REQUIRE(SplitIndexKSWhitebox::getMatch(index, "NNNNefgh", combinations.size() - 1, "abcd") == "abcdefgh");
+}
+
+TEST_CASE("is searching words exact correct for k + s splitting", "[split_index_ks]")
+{
+    const vector<string> words { "jarek", "lubi", "koty" };
+    const vector<string> patternsOut { "this", "dict" };
+
+    SplitIndex *indexes[] = {
+        new SplitIndexKS<1>({ words.begin(), words.end() }, hashType, 1.0f, 2),
+        new SplitIndexKS<2>({ words.begin(), words.end() }, hashType, 1.0f, 1),
+        new SplitIndexKS<2>({ words.begin(), words.end() }, hashType, 1.0f, 2),
+        new SplitIndexKS<3>({ words.begin(), words.end() }, hashType, 1.0f, 1) };
+
+    const int nIndexes = sizeof(indexes) / sizeof(indexes[0]);
+
+    for (int iIndex = 0; iIndex < nIndexes; ++iIndex)
+    {
+        indexes[iIndex]->construct();
+
+        for (int nIter = 1; nIter <= maxNIter; ++nIter)
+        {
+            REQUIRE(indexes[iIndex]->search(words, nIter) == SplitIndex::ResultSetType(words.begin(), words.end()));
+            REQUIRE(indexes[iIndex]->search(patternsOut, nIter).empty());
+        }
+
+        delete indexes[iIndex];
+    }
+}
+
+TEST_CASE("is searching words for k = 2 with k + s splitting for various number of mismatches correct", "[split_index_ks]")
+{
+    const unordered_set<string> wordSet { "kota", "jarek", "bardzo", "lubie", "owoce" };
+
+    SplitIndexKS<2> index(wordSet, hashType, 1.0f, 2);
+    index.construct();
+
+    for (int nIter = 1; nIter <= maxNIter; ++nIter)
+    {
+        REQUIRE(index.search({ "jacek" }, nIter) == SplitIndex::ResultSetType{ "jarek" });
+        REQUIRE(index.search({ "gacek" }, nIter) == SplitIndex::ResultSetType{ "jarek" });
+        REQUIRE(index.search({ "pccek", "jaxyz" }, nIter).empty());
+
+        REQUIRE(index.search({ "barczo", "dardzo", "aardzo" }, nIter) == SplitIndex::ResultSetType{ "bardzo" });
+        REQUIRE(index.search({ "darczo" }, nIter) == SplitIndex::ResultSetType{ "bardzo" });
+        REQUIRE(index.search({ "darcza" }, nIter).empty());
+    }
+}
+
+TEST_CASE("is searching words for k = 2, 3 with k + s splitting the same as without", "[split_index_ks]")
+{
+    const unordered_set<string> wordSet { "kontrola", "kontrakt", "kontener", "konteksty", "kontynent",
+        "przedmiot", "przedszkole", "przedwczoraj", "bardzo", "lubiane", "owocowe", "barwnik", "jarmark" };
+
+    SplitIndexK<2> indexk2(wordSet, hashType, 1.0f);
+    SplitIndexK<3> indexk3(wordSet, hashType, 1.0f);
+
+    indexk2.construct();
+    indexk3.construct();
+
+    // Words must have at least k + s characters.
+    for (size_t nKeyParts = 1; nKeyParts <= 3; ++nKeyParts)
+    {
+        SplitIndexKS<2> indexk2KS(wordSet, hashType, 1.0f, nKeyParts);
+        SplitIndexKS<3> indexk3KS(wordSet, hashType, 1.0f, nKeyParts);
+
+        SplitIndexKS<2> indexk2KSPacked(wordSet, hashType, 1.0f, nKeyParts);
+        indexk2KSPacked.setKeyPacking(true);
+
+        indexk2KS.construct();
+        indexk3KS.construct();
+        indexk2KSPacked.construct();
+
+        for (const string &word : wordSet)
+        {
+            for (size_t i = 0; i < word.size(); ++i)
+            {
+                string curWord = word;
+
+                curWord[i] = 'N';
+                curWord[(i + 3) % word.size()] = 'a';
+
+                REQUIRE(indexk2KS.search({ curWord }, 1) == indexk2.search({ curWord }, 1));
+                REQUIRE(indexk2KSPacked.search({ curWord }, 1) == indexk2.search({ curWord }, 1));
+
+                curWord[(i + 5) % word.size()] = 'N';
+                REQUIRE(indexk3KS.search({ curWord }, 1) == indexk3.search({ curWord }, 1));
+            }
+        }
+    }
+}
+
+} // namespace split_index
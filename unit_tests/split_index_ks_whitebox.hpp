@@ -0,0 +1,68 @@
+#ifndef SPLIT_INDEX_KS_WHITEBOX_HPP
+#define SPLIT_INDEX_KS_WHITEBOX_HPP
+
+#ifndef SPLIT_INDEX_KS_WHITEBOX
+#define SPLIT_INDEX_KS_WHITEBOX \
+    friend struct SplitIndexKSWhitebox;
+#endif
+
+#include "../src/index/split_index_ks.hpp"
+
+namespace split_index
+{
+
+struct SplitIndexKSWhitebox
+{
+    SplitIndexKSWhitebox() = delete;
+
+    template<size_t k>
+    inline static const std::vector<std::vector<size_t>> &getCombinations(const SplitIndexKS<k> &index)
+    {
+        return index.combinations;
+    }
+
+    template<size_t k>
+    inline static const std::vector<std::vector<size_t>> &getRemainingPartIndices(const SplitIndexKS<k> &index)
+    {
+        return index.remainingPartIndices;
+    }
+
+    template<size_t k>
+    inline static const std::vector<size_t> &getPartStarts(const SplitIndexKS<k> &index)
+    {
+        return index.partStarts;
+    }
+
+    template<size_t k>
+    inline static void fillPartStarts(SplitIndexKS<k> &index, size_t wordSize)
+    {
+        index.fillPartStarts(wordSize);
+    }
+
+    /** Returns the key (without the combination index) and the remaining parts for combination [iComb] of [word]. */
+    template<size_t k>
+    inline static std::pair<std::string, std::string> getKeyAndRemainingParts(SplitIndexKS<k> &index,
+        const std::string &word, size_t iComb)
+    {
+        index.fillPartStarts(word.size());
+        const size_t remainingPartsSize = index.storeKeyAndRemainingParts(word, iComb);
+
+        return { std::string(index.keyBuf + 1, word.size() - remainingPartsSize),
+            std::string(index.remainingPartsBuf, remainingPartsSize) };
+    }
+
+    /** Returns the word made of key parts of combination [iComb] of [query] and [remainingParts]. */
+    template<size_t k>
+    inline static std::string getMatch(SplitIndexKS<k> &index, const std::string &query, size_t iComb,
+        const std::string &remainingParts)
+    {
+        index.fillPartStarts(query.size());
+        index.storeMatch(query, iComb, remainingParts.c_str());
+
+        return std::string(index.matchBuf, query.size());
+    }
+};
+
+} // namespace split_index
+
+#endif // SPLIT_INDEX_KS_WHITEBOX_HPP
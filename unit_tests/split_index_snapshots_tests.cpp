@@ -0,0 +1,137 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "catch.hpp"
+
+#include "../src/index/split_index_factory.hpp"
+#include "../src/index/split_index_snapshots.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+SplitIndexSnapshots::IndexBuilder builder = [](const unordered_set<string> &words)
+{
+    return SplitIndexFactory::initIndex(words, hashType, SplitIndexFactory::IndexType::K1, 1.0f);
+};
+
+const unordered_set<string> oldWords { "ala", "ma", "kota", "jarek", "lubi", "psy" };
+const unordered_set<string> newWords { "ala", "ma", "kotka", "jarek", "lubi", "psiaki" };
+
+}
+
+TEST_CASE("is reloaded snapshot published", "[split_index_snapshots]")
+{
+    SplitIndexSnapshots snapshots(oldWords, builder);
+
+    auto searchKotx = [](SplitIndex &index) { return index.search({ "kotx" }); };
+
+    REQUIRE(snapshots.query(searchKotx) == SplitIndex::ResultSetType({ "kota" }));
+
+    snapshots.reload(newWords);
+    snapshots.waitForReload();
+
+    REQUIRE(snapshots.getNReloads() == 1);
+    REQUIRE_FALSE(snapshots.isReloading());
+    REQUIRE(snapshots.query(searchKotx).empty());
+    REQUIRE(snapshots.query([](SplitIndex &index) { return index.searchCount("kotki"); }) == 1);
+}
+
+TEST_CASE("do in-flight queries finish on their snapshot", "[split_index_snapshots]")
+{
+    SplitIndexSnapshots snapshots(oldWords, builder);
+
+    atomic<bool> isQueryStarted(false);
+    SplitIndex::ResultSetType results;
+
+    thread queryThread([&]()
+    {
+        results = snapshots.query([&](SplitIndex &index)
+        {
+            isQueryStarted.store(true);
+
+            // The new snapshot is published while this query holds the old one, which cannot be deleted yet.
+            while (snapshots.getNReloads() == 0)
+            {
+                this_thread::yield();
+            }
+
+            return index.search({ "kotx", "psx" });
+        });
+    });
+
+    while (not isQueryStarted.load())
+    {
+        this_thread::yield();
+    }
+
+    snapshots.reload(newWords);
+
+    queryThread.join();
+    snapshots.waitForReload();
+
+    REQUIRE(results == SplitIndex::ResultSetType({ "kota", "psy" }));
+    REQUIRE(snapshots.query([](SplitIndex &index) { return index.search({ "kotx", "psx" }); }).empty());
+}
+
+TEST_CASE("are queries served during reloads", "[split_index_snapshots]")
+{
+    SplitIndexSnapshots snapshots(oldWords, builder);
+
+    const SplitIndex::ResultSetType oldResults { "kota", "jarek" };
+    const SplitIndex::ResultSetType newResults { "kotka", "jarek" };
+
+    atomic<bool> isDone(false);
+    size_t nBadResults = 0;
+
+    thread queryThread([&]()
+    {
+        while (not isDone.load())
+        {
+            const SplitIndex::ResultSetType results = snapshots.query([](SplitIndex &index)
+            {
+                return index.search({ "kotx", "kotkx", "jarex" });
+            });
+
+            if (results != oldResults and results != newResults)
+            {
+                nBadResults += 1;
+            }
+        }
+    });
+
+    for (size_t iReload = 0; iReload < 10; ++iReload)
+    {
+        snapshots.reload((iReload % 2 == 0) ? newWords : oldWords);
+    }
+
+    snapshots.waitForReload();
+    isDone.store(true);
+
+    queryThread.join();
+
+    REQUIRE(snapshots.getNReloads() == 10);
+    REQUIRE(nBadResults == 0);
+}
+
+TEST_CASE("is previous snapshot kept if reload fails", "[split_index_snapshots]")
+{
+    SplitIndexSnapshots snapshots(oldWords, builder);
+
+    snapshots.reload({ });
+    REQUIRE_THROWS(snapshots.waitForReload());
+
+    REQUIRE(snapshots.getNReloads() == 0);
+    REQUIRE(snapshots.query([](SplitIndex &index) { return index.searchExists("kotx"); }));
+}
+
+} // namespace split_index
@@ -0,0 +1,424 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "catch.hpp"
+#include "random_words.hpp"
+
+#include "../src/index/split_index_factory.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+using IndexType = SplitIndexFactory::IndexType;
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** All index types together with their k. */
+const vector<pair<IndexType, size_t>> indexTypes {
+    { IndexType::K1, 1 }, { IndexType::K1Comp, 1 }, { IndexType::K1CompTriple, 1 }, { IndexType::K1CompExt, 1 },
+    { IndexType::K1Packed, 1 }, { IndexType::K1Router, 1 },
+    { IndexType::K2, 2 }, { IndexType::K2Budgets, 2 }, { IndexType::K2Comp, 2 }, { IndexType::K2KS, 2 },
+    { IndexType::K2Spaced, 2 },
+    { IndexType::K3, 3 }, { IndexType::K3Budgets, 3 }, { IndexType::K3Comp, 3 }, { IndexType::K3KS, 3 },
+    { IndexType::K3Spaced, 3 } };
+
+/** Checks all search modes of [index] against the brute force search in [wordSet] for [queries]. */
+void checkSearching(SplitIndex &index, const unordered_set<string> &wordSet, const vector<string> &queries, size_t k)
+{
+    vector<SplitIndex::WordId> ids;
+
+    for (const string &query : queries)
+    {
+        const SplitIndex::ResultSetType expected = searchBruteForce(wordSet, query, k);
+        index.searchWordIds(query, ids);
+
+        SplitIndex::ResultSetType words;
+
+        for (const SplitIndex::WordId id : ids)
+        {
+            REQUIRE(id < index.getNWords());
+            REQUIRE(words.insert(index.getWord(id)).second);
+        }
+
+        REQUIRE(words == expected);
+        REQUIRE(index.search({ query }) == expected);
+
+        REQUIRE(index.searchExists(query) == not expected.empty());
+        REQUIRE(index.searchCount(query) == expected.size());
+    }
+}
+
+/** Returns queries which are words from [words] with a single char substituted by a char from [alphabet]. */
+vector<string> generateQueries(const vector<string> &words, const string &alphabet)
+{
+    vector<string> ret;
+
+    for (size_t iWord = 0; iWord < words.size(); ++iWord)
+    {
+        string query = words[iWord];
+        query[iWord % query.size()] = alphabet[iWord % alphabet.size()];
+
+        ret.push_back(query);
+    }
+
+    return ret;
+}
+
+}
+
+TEST_CASE("are inserted and erased words searched correctly for all index types", "[split_index_updates]")
+{
+    const string alphabet = "abcd";
+
+    for (const pair<IndexType, size_t> &indexType : indexTypes)
+    {
+        for (size_t subIndexThreshold : { static_cast<size_t>(0), static_cast<size_t>(4) })
+        {
+            INFO("index type = " << static_cast<int>(indexType.first) << ", sub-index threshold = " << subIndexThreshold);
+            mt19937 gen(1234);
+
+            const vector<string> initialWords = generateWords(200, alphabet, 6, 9, gen);
+            const vector<string> newWords = generateWords(100, alphabet, 6, 9, gen);
+
+            unordered_set<string> wordSet(initialWords.begin(), initialWords.end());
+
+            SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, indexType.first, 1.0f, false, true, 2, 1,
+                subIndexThreshold);
+
+            // Compaction is disabled, so that words are only inserted in place and erased using tombstones.
+            index->setCompactionThreshold(0.0f);
+
+            vector<string> queries = generateQueries(initialWords, alphabet);
+            const vector<string> newQueries = generateQueries(newWords, alphabet);
+
+            queries.insert(queries.end(), newQueries.begin(), newQueries.end());
+            queries.insert(queries.end(), newWords.begin(), newWords.end());
+
+            for (size_t iWord = 0; iWord < newWords.size(); ++iWord)
+            {
+                REQUIRE(index->insert(newWords[iWord]) == wordSet.insert(newWords[iWord]).second);
+                REQUIRE_FALSE(index->insert(newWords[iWord]));
+
+                REQUIRE(index->erase(initialWords[iWord]) == (wordSet.erase(initialWords[iWord]) == 1));
+                REQUIRE_FALSE(index->erase(initialWords[iWord]));
+            }
+
+            REQUIRE(index->getNRebuilds() == 0);
+            REQUIRE(index->getNErasedWords() > 0);
+            checkSearching(*index, wordSet, queries, indexType.second);
+
+            // Erased words are inserted again by removing their tombstones.
+            for (size_t iWord = 0; iWord < newWords.size(); iWord += 2)
+            {
+                REQUIRE(index->insert(initialWords[iWord]) == wordSet.insert(initialWords[iWord]).second);
+            }
+
+            checkSearching(*index, wordSet, queries, indexType.second);
+
+            index->compact();
+
+            REQUIRE(index->getNRebuilds() == 1);
+            REQUIRE(index->getNErasedWords() == 0);
+            REQUIRE(index->getNWords() == wordSet.size());
+            checkSearching(*index, wordSet, queries, indexType.second);
+
+            delete index;
+        }
+    }
+}
+
+TEST_CASE("is index compacted once the ratio of erased words crosses the threshold", "[split_index_updates]")
+{
+    const unordered_set<string> initialWordSet { "alamakota", "kotmaale", "jareklubi", "psamiastki", "bardzolubie" };
+    unordered_set<string> wordSet = initialWordSet;
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f);
+
+    // Compaction is disabled by default.
+    REQUIRE(index->erase("alamakota"));
+    REQUIRE(index->erase("kotmaale"));
+    REQUIRE(index->erase("jareklubi"));
+
+    REQUIRE(index->getNRebuilds() == 0);
+    REQUIRE(index->getNErasedWords() == 3);
+
+    REQUIRE(index->insert("alamakota"));
+    REQUIRE(index->insert("kotmaale"));
+    REQUIRE(index->insert("jareklubi"));
+
+    index->setCompactionThreshold(0.5f);
+
+    REQUIRE(index->erase("alamakota"));
+    REQUIRE(index->erase("kotmaale"));
+
+    REQUIRE(index->getNRebuilds() == 0);
+    REQUIRE(index->getNErasedWords() == 2);
+    REQUIRE(index->getNWords() == 5);
+
+    REQUIRE(index->erase("jareklubi"));
+
+    REQUIRE(index->getNRebuilds() == 1);
+    REQUIRE(index->getNErasedWords() == 0);
+    REQUIRE(index->getNWords() == 2);
+
+    // The last word cannot be compacted away.
+    REQUIRE(index->erase("psamiastki"));
+    REQUIRE(index->erase("bardzolubie"));
+
+    REQUIRE(index->getNRebuilds() == 1);
+    REQUIRE(index->search({ "psamiastki", "bardzolubie" }).empty());
+
+    REQUIRE(index->insert("bardzolubie"));
+    REQUIRE(index->search({ "bardzolubix" }) == SplitIndex::ResultSetType({ "bardzolubie" }));
+
+    delete index;
+}
+
+TEST_CASE("is payload of erased word updated when it is inserted again", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "alamakota", "alamakoty", "jareklubi" };
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1, 1.0f, false, true, 2, 1,
+        SplitIndex::defaultSubIndexThreshold, { { "alamakota", 5 }, { "alamakoty", 3 } });
+
+    vector<SplitIndex::Match> matches;
+
+    index->searchTopMatches("alamakotx", 2, matches);
+
+    REQUIRE(matches.size() == 2);
+    REQUIRE(index->getWord(matches[0].id) == "alamakota");
+    REQUIRE(matches[0].payload == 5);
+
+    // The word is still stored in the entries, so it is inserted again only by removing its tombstone.
+    REQUIRE(index->erase("alamakota"));
+    index->setWordPayloads({ { "alamakota", 1 }, { "alamakoty", 3 } });
+    REQUIRE(index->insert("alamakota"));
+
+    REQUIRE(index->getNRebuilds() == 0);
+    index->searchTopMatches("alamakotx", 2, matches);
+
+    REQUIRE(matches.size() == 2);
+    REQUIRE(index->getWord(matches[0].id) == "alamakoty");
+    REQUIRE(matches[0].payload == 3);
+    REQUIRE(index->getWord(matches[1].id) == "alamakota");
+    REQUIRE(matches[1].payload == 1);
+
+    delete index;
+}
+
+TEST_CASE("are words which do not fit the index layout inserted by rebuilding", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "aabbaabb", "abababab", "bbbbaaaa", "baabbaab" };
+
+    SplitIndex *indexes[] = {
+        SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1Packed, 1.0f),
+        SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1Router, 1.0f),
+        SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2Budgets, 1.0f),
+        SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f, true) };
+
+    for (SplitIndex *index : indexes)
+    {
+        // The size and the alphabet fit the layout, so the word is inserted in place.
+        REQUIRE(index->insert("babababa"));
+        REQUIRE(index->getNRebuilds() == 0);
+
+        // These chars are absent from the alphabet of the dictionary.
+        REQUIRE(index->insert("aabbaaxy"));
+        REQUIRE(index->getNRebuilds() == 1);
+
+        REQUIRE(index->search({ "babababb", "aabbaxxy" }) == SplitIndex::ResultSetType({ "babababa", "aabbaaxy" }));
+        REQUIRE(index->getNWords() == 6);
+
+        delete index;
+    }
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f);
+
+    REQUIRE_THROWS(index->insert("ab"));
+    REQUIRE(index->getNWords() == wordSet.size());
+
+    delete index;
+}
+
+TEST_CASE("are merged indexes searched correctly for all index types", "[split_index_updates]")
+{
+    const string alphabet = "abcd";
+
+    for (const pair<IndexType, size_t> &indexType : indexTypes)
+    {
+        INFO("index type = " << static_cast<int>(indexType.first));
+        mt19937 gen(1234);
+
+        const vector<string> words = generateWords(200, alphabet, 6, 9, gen);
+        const vector<string> shardWords = generateWords(100, alphabet, 6, 9, gen);
+
+        unordered_set<string> wordSet(words.begin(), words.end());
+        unordered_set<string> shardWordSet(shardWords.begin(), shardWords.end());
+
+        // Some words are present in both indexes, and an erased word is merged again.
+        shardWordSet.insert(words[0]);
+        shardWordSet.insert(words[1]);
+
+        SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, indexType.first, 1.0f, false, true, 2, 1, 4);
+        SplitIndex *shard = SplitIndexFactory::initIndex(shardWordSet, hashType, indexType.first, 1.0f, false, true, 2, 1,
+            4);
+
+        index->setCompactionThreshold(0.0f);
+        REQUIRE(index->erase(words[1]));
+        wordSet.erase(words[1]);
+
+        size_t nNewWords = 0;
+
+        for (const string &word : shardWordSet)
+        {
+            nNewWords += wordSet.insert(word).second ? 1 : 0;
+        }
+
+        REQUIRE(index->merge(*shard) == nNewWords);
+        REQUIRE(index->getNRebuilds() == 0);
+        REQUIRE(index->getWordSet() == wordSet);
+        REQUIRE(shard->getWordSet() == shardWordSet);
+
+        vector<string> queries = generateQueries(words, alphabet);
+        const vector<string> shardQueries = generateQueries(shardWords, alphabet);
+
+        queries.insert(queries.end(), shardQueries.begin(), shardQueries.end());
+        checkSearching(*index, wordSet, queries, indexType.second);
+
+        delete index;
+        delete shard;
+    }
+}
+
+TEST_CASE("are merged words which do not fit the index layout inserted by rebuilding", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "aabbaabb", "abababab", "bbbbaaaa", "baabbaab" };
+    const unordered_set<string> shardWordSet { "babababa", "aabbaaxy" };
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f, true);
+    SplitIndex *shard = SplitIndexFactory::initIndex(shardWordSet, hashType, IndexType::K2, 1.0f, true);
+
+    REQUIRE(index->merge(*shard) == 2);
+    REQUIRE(index->getNRebuilds() == 1);
+
+    REQUIRE(index->search({ "babababb", "aabbaxxy" }) == SplitIndex::ResultSetType({ "babababa", "aabbaaxy" }));
+    REQUIRE(index->getNWords() == 6);
+
+    // Merging the same words again does not change the index.
+    REQUIRE(index->merge(*shard) == 0);
+    REQUIRE(index->getNRebuilds() == 1);
+    REQUIRE(index->getNWords() == 6);
+
+    delete index;
+    delete shard;
+}
+
+TEST_CASE("are payloads kept when merging", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "alamakota", "kotmaale" };
+    const unordered_set<string> shardWordSet { "jareklubi", "psamiastki" };
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1, 1.0f, false, true, 2, 1,
+        SplitIndex::defaultSubIndexThreshold, { { "alamakota", 5 } });
+    SplitIndex *shard = SplitIndexFactory::initIndex(shardWordSet, hashType, IndexType::K1, 1.0f, false, true, 2, 1,
+        SplitIndex::defaultSubIndexThreshold, { { "jareklubi", 7 } });
+
+    REQUIRE(index->merge(*shard) == 2);
+
+    const vector<pair<string, SplitIndex::Payload>> expected {
+        { "alamakota", 5 }, { "kotmaale", 0 }, { "jareklubi", 7 }, { "psamiastki", 0 } };
+
+    // Payloads are checked both for words stored in place and after rebuilding.
+    for (int iCheck = 0; iCheck < 2; ++iCheck)
+    {
+        vector<SplitIndex::WordId> ids;
+
+        for (const pair<string, SplitIndex::Payload> &wordPayload : expected)
+        {
+            index->searchWordIds(wordPayload.first, ids);
+
+            REQUIRE(ids.size() == 1);
+            REQUIRE(index->getPayload(ids[0]) == wordPayload.second);
+        }
+
+        index->compact();
+    }
+
+    delete index;
+    delete shard;
+}
+
+TEST_CASE("are payloads of merged words which have been erased locally taken from the shard", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "alamakota", "alamakoty", "kotmaale" };
+    const unordered_set<string> shardWordSet { "alamakota", "jareklubi" };
+
+    SplitIndex *index = SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1, 1.0f, false, true, 2, 1,
+        SplitIndex::defaultSubIndexThreshold, { { "alamakota", 5 }, { "alamakoty", 3 } });
+    SplitIndex *shard = SplitIndexFactory::initIndex(shardWordSet, hashType, IndexType::K1, 1.0f, false, true, 2, 1,
+        SplitIndex::defaultSubIndexThreshold, { { "alamakota", 1 } });
+
+    // The erased word is absent from the index, so it is merged with the payload from the shard.
+    REQUIRE(index->erase("alamakota"));
+    REQUIRE(index->merge(*shard) == 2);
+    REQUIRE(index->getNRebuilds() == 0);
+
+    vector<SplitIndex::Match> matches;
+
+    // The payload is checked both for the word stored in place and after rebuilding.
+    for (int iCheck = 0; iCheck < 2; ++iCheck)
+    {
+        index->searchTopMatches("alamakotx", 2, matches);
+
+        REQUIRE(matches.size() == 2);
+        REQUIRE(index->getWord(matches[0].id) == "alamakoty");
+        REQUIRE(matches[0].payload == 3);
+        REQUIRE(index->getWord(matches[1].id) == "alamakota");
+        REQUIRE(matches[1].payload == 1);
+
+        index->compact();
+    }
+
+    delete index;
+    delete shard;
+}
+
+TEST_CASE("are merges of different index types or configurations rejected", "[split_index_updates]")
+{
+    const unordered_set<string> wordSet { "alamakota", "kotmaale", "jareklubi" };
+
+    const vector<pair<SplitIndex *, SplitIndex *>> indexPairs {
+        { SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K1, 1.0f),
+            SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f) },
+        { SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f),
+            SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f, true) },
+        { SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f, false, true),
+            SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2, 1.0f, false, false) },
+        { SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2KS, 1.0f, false, true, 2),
+            SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2KS, 1.0f, false, true, 3) },
+        { SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2Spaced, 1.0f, false, true, 2, 1),
+            SplitIndexFactory::initIndex(wordSet, hashType, IndexType::K2Spaced, 1.0f, false, true, 2, 2) } };
+
+    for (const pair<SplitIndex *, SplitIndex *> &indexPair : indexPairs)
+    {
+        REQUIRE_THROWS(indexPair.first->merge(*indexPair.second));
+        REQUIRE_THROWS(indexPair.second->merge(*indexPair.first));
+
+        REQUIRE(indexPair.first->getNWords() == wordSet.size());
+
+        delete indexPair.first;
+        delete indexPair.second;
+    }
+}
+
+} // namespace split_index
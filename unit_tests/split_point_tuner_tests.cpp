@@ -0,0 +1,128 @@
+#include "catch.hpp"
+#include "repeat.hpp"
+
+#include "split_index_1_whitebox.hpp"
+
+#include "../src/index/split_index_1.hpp"
+#include "../src/index/split_point_tuner.hpp"
+
+using namespace split_index;
+using namespace std;
+
+namespace split_index
+{
+
+namespace
+{
+
+hash_functions::HashFunctions::HashType hashType = hash_functions::HashFunctions::HashType::XxHash;
+
+/** Returns all words of size 10 made of [prefix] followed by chars from "ACGT". */
+unordered_set<string> generateWordsWithCommonPrefix(const string &prefix)
+{
+    const string symbols = "ACGT";
+    unordered_set<string> wordSet;
+
+    for (int i = 0; i < 1024; ++i)
+    {
+        string word = prefix;
+
+        for (int j = i; word.size() < 10; j /= 4)
+        {
+            word += symbols[j % 4];
+        }
+
+        wordSet.insert(word);
+    }
+
+    return wordSet;
+}
+
+/** Returns the starts of 2 parts (halves) followed by the word size, for each word size up to 127. */
+vector<vector<size_t>> getHalves()
+{
+    vector<vector<size_t>> partStarts;
+
+    for (size_t wordSize = 0; wordSize <= 127; ++wordSize)
+    {
+        partStarts.push_back({ 0, wordSize / 2, wordSize });
+    }
+
+    return partStarts;
+}
+
+}
+
+TEST_CASE("is tuning split points avoiding common prefixes", "[split_point_tuner]")
+{
+    const unordered_set<string> wordSet = generateWordsWithCommonPrefix("AAAAA");
+    vector<vector<size_t>> partStarts = getHalves();
+
+    REQUIRE(SplitPointTuner::tune(wordSet, partStarts) == 1);
+
+    // Splitting in halves yields a single hot prefix key, hence prefixes should extend beyond the common prefix.
+    REQUIRE(partStarts[10].size() == 3);
+    REQUIRE(partStarts[10][1] > 5);
+
+    // Other word sizes are not changed.
+    REQUIRE(partStarts[9] == vector<size_t>{ 0, 4, 9 });
+}
+
+TEST_CASE("is tuning split points keeping halves on ties", "[split_point_tuner]")
+{
+    const unordered_set<string> wordSet { "ala", "ma", "kota", "jarek", "psa" };
+    vector<vector<size_t>> partStarts = getHalves();
+
+    REQUIRE(SplitPointTuner::tune(wordSet, partStarts) == 0);
+    REQUIRE(partStarts == getHalves());
+}
+
+TEST_CASE("is tuning split points for more parts correct", "[split_point_tuner]")
+{
+    const unordered_set<string> wordSet = generateWordsWithCommonPrefix("AAAA");
+    vector<vector<size_t>> partStarts;
+
+    for (size_t wordSize = 0; wordSize <= 127; ++wordSize)
+    {
+        partStarts.push_back({ 0, wordSize / 3, 2 * (wordSize / 3), wordSize });
+    }
+
+    SplitPointTuner::tune(wordSet, partStarts);
+
+    // Parts are never empty.
+    for (size_t iPart = 0; iPart < 3; ++iPart)
+    {
+        REQUIRE(partStarts[10][iPart] < partStarts[10][iPart + 1]);
+    }
+
+    REQUIRE(partStarts[10].back() == 10);
+}
+
+TEST_CASE("is storing prefix and suffix in buffers using tuned split points correct", "[split_point_tuner]")
+{
+    const unordered_set<string> wordSet = generateWordsWithCommonPrefix("AAAAA");
+
+    SplitIndex1 index1(wordSet, hashType, 1.0f);
+    index1.setSplitPointTuning(true);
+    index1.construct();
+
+    SplitIndex1Whitebox::storePrefixSuffixInBuffers(index1, "AAAAACGTAC");
+    REQUIRE(SplitIndex1Whitebox::getPrefixSize(index1) > 5);
+
+    // Split points are not tuned by default.
+    SplitIndex1 index2(wordSet, hashType, 1.0f);
+    index2.construct();
+
+    SplitIndex1Whitebox::storePrefixSuffixInBuffers(index2, "AAAAACGTAC");
+    REQUIRE(SplitIndex1Whitebox::getPrefixSize(index2) == 5);
+
+    // Results do not depend on split points.
+    const vector<string> queries { "AAAAACGTAC", "AAAACCGTAC", "TAAAACGTAC", "CCCCCCCCCC", "AAAAANNNNN" };
+
+    for (const string &query : queries)
+    {
+        REQUIRE(index1.search({ query }) == index2.search({ query }));
+    }
+}
+
+} // namespace split_index
@@ -1,6 +1,7 @@
 #include <array>
 #include <random>
 #include <set>
+#include <vector>
 
 #include "catch.hpp"
 #include "repeat.hpp"
@@ -183,4 +184,48 @@ TEST_CASE("is Hamming at most k=0,1,2,3,4 randomized calculation correct", "[uti
     });
 }
 
+TEST_CASE("is Hamming at most for runtime k the same as for compile-time k", "[utils_distance]")
+{
+    const string str = "ala ma kota";
+    const vector<string> others { "ala ma kota", "ala ma psa.", "ola ma kota", "olo mo koto", "xxxxxxxxxxx" };
+
+    for (const string &other : others)
+    {
+        REQUIRE(utils::Distance::isHammingAtMost(str.c_str(), other.c_str(), str.size(), 0)
+            == utils::Distance::isHammingAtMostK<0>(str.c_str(), other.c_str(), str.size()));
+        REQUIRE(utils::Distance::isHammingAtMost(str.c_str(), other.c_str(), str.size(), 1)
+            == utils::Distance::isHammingAtMostK<1>(str.c_str(), other.c_str(), str.size()));
+        REQUIRE(utils::Distance::isHammingAtMost(str.c_str(), other.c_str(), str.size(), 3)
+            == utils::Distance::isHammingAtMostK<3>(str.c_str(), other.c_str(), str.size()));
+
+        const unsigned distance = utils::Distance::calcHamming(str.c_str(), other.c_str(), str.size());
+
+        REQUIRE(utils::Distance::isHammingAtMost(str.c_str(), other.c_str(), str.size(), distance) == true);
+
+        if (distance > 0)
+        {
+            REQUIRE(utils::Distance::isHammingAtMost(str.c_str(), other.c_str(), str.size(), distance - 1) == false);
+        }
+    }
+}
+
+TEST_CASE("are Hamming mismatch positions correct", "[utils_distance]")
+{
+    const string str = "ala ma kota";
+    uint16_t positions[3];
+
+    REQUIRE(utils::Distance::calcHammingWithPositions(str.c_str(), "ala ma kota", str.size(), positions, 3) == 0);
+
+    REQUIRE(utils::Distance::calcHammingWithPositions(str.c_str(), "ola ma kotb", str.size(), positions, 3) == 2);
+    REQUIRE(positions[0] == 0);
+    REQUIRE(positions[1] == 10);
+
+    // Only the first positions are stored, but all mismatches are counted.
+    REQUIRE(utils::Distance::calcHammingWithPositions(str.c_str(), "olo mo koto", str.size(), positions, 3) == 4);
+    REQUIRE(vector<uint16_t>(positions, positions + 3) == vector<uint16_t>{ 0, 2, 5 });
+
+    REQUIRE(utils::Distance::calcHammingWithPositions(str.c_str(), "xxxxxxxxxxx", str.size(), positions, 0)
+        == utils::Distance::calcHamming(str.c_str(), "xxxxxxxxxxx", str.size()));
+}
+
 } // namespace split_index
@@ -85,4 +85,40 @@ TEST_CASE("is reading words with whitespace correct", "[utils_file_io]")
     REQUIRE(utils::FileIO::isFileReadable(tmpFileName) == false);
 }
 
+TEST_CASE("is streaming words correct", "[utils_file_io]")
+{
+    // The long word spans many chunks.
+    const string longWord(3 << 20, 'x');
+    utils::FileIO::dumpToFile("ala\nma  \n\n kota;" + longWord + "\n", tmpFileName, false);
+
+    vector<string> words;
+    utils::FileIO::forEachWord(tmpFileName, "\n;", [&words](const string &word) { words.push_back(word); });
+
+    REQUIRE(words == vector<string> { "ala", "ma", "kota", longWord });
+    removeFile(tmpFileName);
+
+    REQUIRE_THROWS(utils::FileIO::forEachWord(tmpFileName, "\n", [](const string &) { }));
+}
+
+TEST_CASE("is reading words with payloads correct", "[utils_file_io]")
+{
+    string str = "ala 1\nma\t20\n\n kota   300 \n";
+    utils::FileIO::dumpToFile(str, tmpFileName, false);
+
+    const vector<pair<string, uint64_t>> records = utils::FileIO::readWordsWithPayloads(tmpFileName, "\n");
+
+    REQUIRE(records == vector<pair<string, uint64_t>> { { "ala", 1 }, { "ma", 20 }, { "kota", 300 } });
+    removeFile(tmpFileName);
+
+    for (const char *badStr : { "ala", "ala 1\nma", "ala x", "ala -1", "42" })
+    {
+        utils::FileIO::dumpToFile(badStr, tmpFileName, false);
+        REQUIRE_THROWS(utils::FileIO::readWordsWithPayloads(tmpFileName, "\n"));
+
+        removeFile(tmpFileName);
+    }
+
+    REQUIRE(utils::FileIO::isFileReadable(tmpFileName) == false);
+}
+
 } // namespace split_index
@@ -0,0 +1,62 @@
+#include <limits>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/utils/size_coding.hpp"
+
+using namespace std;
+
+namespace split_index
+{
+
+TEST_CASE("is size coding round trip correct", "[utils_size_coding]")
+{
+    vector<size_t> sizes{ 1, 2, 100, 127, utils::SizeCoding::maxWordSize, utils::SizeCoding::maxSize };
+    char buf[64];
+
+    char *it = buf;
+
+    for (size_t size : sizes)
+    {
+        char *next = utils::SizeCoding::write(it, size);
+
+        REQUIRE(static_cast<size_t>(next - it) == utils::SizeCoding::calcSizeB(size));
+        REQUIRE(*it != 0);
+
+        it = next;
+    }
+
+    const char *readIt = buf;
+
+    for (size_t size : sizes)
+    {
+        REQUIRE(utils::SizeCoding::peek(readIt) == size);
+        REQUIRE(utils::SizeCoding::read(readIt) == size);
+    }
+
+    REQUIRE(readIt == it);
+}
+
+TEST_CASE("are short sizes stored as single bytes", "[utils_size_coding]")
+{
+    char buf[2];
+
+    for (size_t size = 1; size < 128; ++size)
+    {
+        REQUIRE(utils::SizeCoding::calcSizeB(size) == 1);
+        REQUIRE(utils::SizeCoding::write(buf, size) == buf + 1);
+        REQUIRE(static_cast<size_t>(static_cast<unsigned char>(buf[0])) == size);
+    }
+}
+
+TEST_CASE("can counters store max word sizes", "[utils_size_coding]")
+{
+    const size_t maxWordSize = utils::SizeCoding::maxWordSize;
+    const size_t maxSize = utils::SizeCoding::maxSize;
+
+    REQUIRE(maxWordSize <= maxSize);
+    REQUIRE(numeric_limits<utils::SizeCoding::CounterType>::max() >= maxSize);
+}
+
+} // namespace split_index